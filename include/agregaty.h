@@ -0,0 +1,60 @@
+#ifndef AGREGATY_H
+#define AGREGATY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "types.h"
+
+/* ========== AGREGATY RAPORTU NA ŻYWO ========== */
+/* Liczniki w stan->agregaty zwiększane w chwili zdarzenia:
+ *
+ *   turysta --agregaty_przejscie()--> zjazdy per typ, per bramka, per godzina
+ *   kasjer  --agregaty_sprzedaz()---> sprzedaż i przychód per typ, per godzina
+ *
+ * Każda aktualizacja to kilka atomic_fetch_add (relaxed) - bez semaforów.
+ * Raport w dowolnej chwili kosztuje O(liczba agregatów), a nie O(rejestr):
+ * wątek statystyk main co sekundę zapisuje go do logs/statystyki_live.txt,
+ * a raport dzienny wypisuje ostatnią migawkę.
+ *
+ * Migawka czyta liczniki po kolei, więc w trakcie dnia sumy z różnych sekcji
+ * mogą się różnić o zdarzenia dopisane w międzyczasie. */
+
+/* Ustawia kubełek 0 na pełną godzinę zawierającą czas (przed pierwszym zdarzeniem) */
+void agregaty_inicjalizuj(AgregatyLive *a, time_t czas);
+
+/* ========== AKTUALIZACJA (turysta, kasjer, odtwarzanie dziennika) ========== */
+void agregaty_przejscie(StanWspoldzielony *stan, const WpisRejestru *wpis);
+void agregaty_sprzedaz(StanWspoldzielony *stan, int typ_biletu, int cena, time_t czas);
+
+/* ========== MIGAWKA ========== */
+typedef struct {
+    unsigned long przejscia[MAX_BRAMEK_WEJSCIOWYCH];
+    unsigned long razem;
+    unsigned long sprzedaze;
+    unsigned long przychod;
+} GodzinaMigawki;
+
+typedef struct {
+    int64_t poczatek;
+    int liczba_bramek;                          /* konfiguracja.bramki_wejsciowe */
+    unsigned long zjazdy_per_typ[LICZBA_TYPOW_BILETOW];
+    unsigned long przejscia_per_bramka[MAX_BRAMEK_WEJSCIOWYCH];
+    unsigned long sprzedaze_per_typ[LICZBA_TYPOW_BILETOW];
+    unsigned long przychod_per_typ[LICZBA_TYPOW_BILETOW];
+    unsigned long nieznany_typ;
+    unsigned long poza_godzinami;
+    unsigned long zjazdy;                       /* Sumy sekcji per typ */
+    unsigned long sprzedaze;
+    unsigned long przychod;
+    int liczba_godzin;                          /* Do ostatniej niepustej godziny */
+    GodzinaMigawki godziny[MAX_GODZIN_AGREGATOW];
+} MigawkaAgregatow;
+
+void agregaty_migawka(const StanWspoldzielony *stan, MigawkaAgregatow *m);
+
+/* Tekst migawki (stała szerokość pól); zwraca długość bez '\0' */
+size_t agregaty_formatuj(const MigawkaAgregatow *m, char *bufor, size_t rozmiar);
+
+extern const char *const nazwy_typow_biletow[LICZBA_TYPOW_BILETOW];
+
+#endif
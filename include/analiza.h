@@ -0,0 +1,45 @@
+#ifndef ANALIZA_H
+#define ANALIZA_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "rejestr_plik.h"
+
+/* ========== JĄDRA ANALIZY KOLUMN REJESTRU ========== */
+/* Agregacje po kolumnach pliku rejestru (rejestr_plik.h) w wersjach
+ * skalarnej, SSE4.2 i AVX2. Wersja wybierana raz, w czasie działania
+ * (__builtin_cpu_supports); KOLEJ_SIMD=skalar|sse|avx2 wymusza niższą -
+ * wyższej niż obsługuje procesor nie da się wybrać. Wyniki wszystkich
+ * wersji są identyczne. */
+
+typedef enum {
+    SIMD_SKALAR = 0,
+    SIMD_SSE,
+    SIMD_AVX2,
+    LICZBA_POZIOMOW_SIMD
+} PoziomSimd;
+
+PoziomSimd analiza_poziom(void);
+PoziomSimd analiza_ustaw_poziom(PoziomSimd poziom);    /* Zwraca faktycznie ustawiony */
+const char *analiza_nazwa_poziomu(PoziomSimd poziom);
+
+/* Histogram małej dziedziny: wynik[v - min] += 1 dla v z [min, min + liczba).
+ * Wartości spoza zakresu są pomijane. SIMD dla liczba <= 16. */
+void analiza_histogram_i32(const int32_t *kolumna, size_t n, int32_t min, int liczba,
+                           uint64_t *wynik);
+
+/* Histogram godzinowy: wynik[(czas - poczatek) / 3600] dla kubełków
+ * z [0, liczba); liczba * 3600 musi być < 2^31 */
+void analiza_histogram_godzin(const int64_t *czas, size_t n, int64_t poczatek, int liczba,
+                              uint64_t *wynik);
+
+/* Minimum i maksimum kolumny (n > 0) */
+void analiza_min_max_i64(const int64_t *kolumna, size_t n, int64_t *min, int64_t *max);
+
+/* Początki serii równych kluczy w indeksie posortowanym po kluczu.
+ * Zapisuje pozycje do poczatki (miejsce na n) i zwraca liczbę serii;
+ * seria i to [poczatki[i], poczatki[i + 1]) - pierwszy i ostatni przejazd
+ * biletu to czas[indeks[poczatki[i]].wiersz] i czas[indeks[koniec - 1].wiersz]. */
+size_t analiza_serie(const WpisIndeksu *indeks, size_t n, uint32_t *poczatki);
+
+#endif
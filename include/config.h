@@ -2,17 +2,50 @@
 #define CONFIG_H
 
 /* ========== PARAMETRY KOLEI ========== */
+/* Wartości domyślne - w czasie działania obowiązuje stan->konfiguracja
+ * (konfiguracja.h: plik -c, nadpisania -o); MAX_* to górne granice */
 #define LICZBA_KRZESELEK 72
 #define MAX_AKTYWNYCH_KRZESELEK 36
 #define POJEMNOSC_KRZESELKA 4
 #define MAX_ROWERZYSTOW_NA_KRZESELKU 2
+#define MAX_KRZESELEK_LINII 1024
+#define MAX_POJEMNOSC_KRZESELKA 8
 
 /* ========== BRAMKI ========== */
 #define LICZBA_BRAMEK_WEJSCIOWYCH 4
 #define LICZBA_BRAMEK_PERONOWYCH 3
+#define MAX_BRAMEK_WEJSCIOWYCH 8
+#define MAX_BRAMEK_PERONOWYCH 4
+
+/* ========== KASA ========== */
+#define LICZBA_KASJEROW 1
+#define MAX_KASJEROW 8
+#define CZAS_SPRZEDAZY_MS 0    /* Obsługa jednego klienta przy okienku */
 
 /* ========== STACJA ========== */
 #define MAX_OSOB_NA_STACJI 50  /* N osób między bramkami */
+#define MAX_LIMIT_STACJI 32767 /* Wartość semafora SysV */
+
+/* ========== LINIE OŚRODKA ========== */
+#define MAX_LINII 4  /* Linie w jednym segmencie stanu (main -l, KOLEJ_LINIE) */
+
+/* ========== NAPŁYW TURYSTÓW (main -n, -a) ========== */
+#define MAX_TURYSTOW 500
+#define MAX_GRUP_NA_SEKUNDE 100
+#define PROCENT_GRUPY_NA_SEKUNDE 70 /* Bez -a: szansa na grupę w danej sekundzie */
+#define PROCENT_GRUP_Z_DZIECMI 25
+#define PROCENT_ROWERZYSTOW 40      /* Wśród turystów od 12 lat */
+#define PROCENT_KONCA_DNIA 30       /* Szansa na wyjście po każdym zjeździe */
+
+/* ========== PĘTLE PROCESÓW (model.h zakłada te same okresy) ========== */
+#define OKRES_KASJERA_MS 10         /* Odpytywanie pustej kolejki kasy */
+#define OKRES_PRACOWNIKA1_MS 50     /* Jedna prośba o peron na obrót pętli */
+#define OKRES_PRACOWNIKA2_MS 100    /* Sprawdzanie przyjazdów krzesełek */
+#define CZAS_JAZDY_KRZESELKA 2      /* s, stacja dolna -> górna */
+
+/* ========== UKŁAD STANU WSPÓŁDZIELONEGO ========== */
+#define ROZMIAR_LINII_CACHE 64      /* Wyrównanie regionów StanWspoldzielony */
+#define LICZBA_SHARDOW_TURYSTOW 16  /* Shardy liczników turystów (stan_kolei.h) */
 
 /* ========== WYJŚCIA STACJA GÓRNA ========== */
 #define LICZBA_WYJSC 2
@@ -32,6 +65,7 @@
 #define BILET_CZASOWY_TK2 3
 #define BILET_CZASOWY_TK3 4
 #define BILET_DZIENNY 5
+#define LICZBA_TYPOW_BILETOW 5
 
 /* ========== CZASY KARNETÓW CZASOWYCH (sekundy) ========== */
 #define CZAS_TK1 15
@@ -47,7 +81,11 @@
 #define MAX_DZIECI_POD_OPIEKA 2
 
 /* ========== VIP ========== */
-#define PROCENT_VIP 1  /* 1% */
+/* Bilet przed zwykłymi (MTYPE_BILET_VIP), rezerwa procent_vip miejsc na
+ * stacji (SEM_IDX_VIP), ostatnia bramka wejściowa linii zarezerwowana, gdy
+ * linia ma ich więcej niż jedną (VIP bierze też każdą inną wolną), i początek
+ * kolejki pracownika1 */
+#define PROCENT_VIP 1  /* 1%; konfiguracja procent_vip */
 
 /* ========== CENY BILETÓW ========== */
 #define CENA_JEDNORAZOWY 15
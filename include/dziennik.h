@@ -0,0 +1,99 @@
+#ifndef DZIENNIK_H
+#define DZIENNIK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "types.h"
+
+/* ========== DZIENNIK PRZEJŚĆ I SPRZEDAŻY (GROUP COMMIT) ========== */
+/* Rejestr żyje tylko w pamięci współdzielonej - po SIGKILL procesu main
+ * dzień jest stracony. Dziennik to plik tylko do dopisywania:
+ *
+ *   turysta/kasjer/pracownik2 --dziennik_*()--> pierścień w segmencie SysV
+ *                                       |
+ *   main: wątek zapisujący  <-----------+  partia -> jeden zapis + fdatasync()
+ *
+ * Segment pierścienia jest oznaczany IPC_RMID zaraz po dołączeniu przez main
+ * (Linux pozwala dołączyć oznaczony segment po identyfikatorze), więc znika
+ * razem z ostatnim procesem także po SIGKILL procesu main.
+ *
+ * Piszący rezerwuje slot pierścienia atomic_fetch_add, wypełnia go i publikuje
+ * flagą z semantyką release - bez semaforów i bez wywołań systemowych.
+ * Wątek zapisujący zbiera ciągły zakres opublikowanych slotów i utrwala go,
+ * gdy zbierze się KOLEJ_DZIENNIK_PACZKA wpisów albo minie KOLEJ_DZIENNIK_MS
+ * od poprzedniego utrwalenia (to górna granica utraty danych po awarii).
+ * Slot wraca do puli dopiero po fdatasync(); przy pełnym pierścieniu
+ * piszący czeka (backpressure). Nieudany zapis partii jest ponawiany pod tym
+ * samym przesunięciem; gdy i to zawiedzie, dziennik jest oznaczany jako
+ * uszkodzony i odrzuca kolejne wpisy. Slot, którego piszący nie opublikował
+ * (albo ze złą sumą), trafia do pliku jako WPIS_LUKA.
+ *
+ * KOLEJ_DZIENNIK=0 wyłącza dziennik (dziennik_* nic nie robią).
+ * Poprzedni plik dziennika jest przenoszony do <plik>.poprzedni, więc dzień
+ * przerwany awarią można odtworzyć po ponownym uruchomieniu: main -r <plik>. */
+
+#define DZIENNIK_MAGIA          0x4B5A4944u   /* "DIZK" */
+#define DZIENNIK_WERSJA         5
+#define POJEMNOSC_DZIENNIKA     4096          /* Slotów w pierścieniu */
+
+typedef enum {
+    WPIS_PRZEJSCIE = 1,
+    WPIS_SPRZEDAZ = 2,
+    WPIS_KONIEC = 3,                /* Poprawne zamknięcie dziennika */
+    WPIS_ZJAZD = 4,                 /* Krzesełko dojechało na górę (pracownik2) */
+    WPIS_LUKA = 5                   /* Slot numer pominięty przez wątek zapisujący */
+} TypWpisuDziennika;
+
+/* ========== FORMAT PLIKU ========== */
+typedef struct {
+    uint32_t magia;
+    uint32_t wersja;
+    uint32_t rozmiar_wpisu;
+    uint32_t zarezerwowane;
+    int64_t start;
+} NaglowekDziennika;
+
+typedef struct {
+    uint32_t typ;                   /* TypWpisuDziennika */
+    uint32_t suma;                  /* FNV-1a wpisu z suma = 0 */
+    uint64_t numer;                 /* Kolejny numer rezerwacji */
+    int64_t czas;
+    int32_t bilet_id;
+    int32_t turysta_id;
+    union {
+        struct { int32_t linia, numer_bramki, numer_zjazdu, typ_biletu; } przejscie;
+        struct { int32_t typ_biletu, cena; } sprzedaz;
+        struct { int32_t linia, krzeselko, pasazerowie; } zjazd;
+    };                              /* 16 bajtów - bez niejawnego wyrównania (suma po bajtach) */
+} WpisDziennika;
+
+_Static_assert(sizeof(WpisDziennika) == 48, "WpisDziennika nie może mieć dopełnienia");
+
+/* ========== PISZĄCY (turysta, kasjer, pracownik2) ========== */
+/* 0 = zapisane w pierścieniu (lub dziennik wyłączony), -1 = błąd
+ * (także dziennik uszkodzony po nieudanym zapisie partii) */
+int dziennik_przejscie(StanWspoldzielony *stan, const WpisRejestru *wpis);
+int dziennik_sprzedaz(StanWspoldzielony *stan, const Bilet *bilet, int cena);
+int dziennik_zjazd(StanWspoldzielony *stan, int linia, int krzeselko, int pasazerowie);
+
+/* ========== WĄTEK ZAPISUJĄCY (main) ========== */
+int dziennik_uruchom(StanWspoldzielony *stan, const char *sciezka);
+void dziennik_zatrzymaj(void);      /* Utrwala resztę i dopisuje WPIS_KONIEC */
+
+/* ========== ODTWARZANIE ========== */
+typedef struct {
+    unsigned long przejscia;
+    unsigned long sprzedaze;
+    unsigned long zjazdy;
+    unsigned long luki;             /* Wpisy WPIS_LUKA - przejścia/sprzedaże utracone przed zapisem */
+    bool zamkniety;                 /* Był WPIS_KONIEC */
+    bool uciety_ogon;               /* Niepełny / uszkodzony wpis na końcu */
+} WynikOdtworzenia;
+
+/* Wypełnia pusty stan (rejestr + liczniki) wpisami z pliku */
+int dziennik_odtworz(const char *sciezka, StanWspoldzielony *stan, WynikOdtworzenia *wynik);
+
+/* ========== SPRZĄTANIE ========== */
+void dziennik_odlacz(StanWspoldzielony *stan, bool usun);
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef INSTANCJA_H
+#define INSTANCJA_H
+
+#include <stddef.h>
+#include <sys/types.h>
+
+/* ========== PRZESTRZEŃ NAZW INSTANCJI ========== */
+/* KOLEJ_INSTANCJA=<n> (main: -i <n>) oddziela od siebie symulacje
+ * uruchomione równolegle na jednym hoście. Procesy potomne dziedziczą
+ * zmienną przez exec(). Od numeru instancji zależą:
+ *
+ *   klucze SysV        n = 0: ftok("/tmp", proj)
+ *                      n > 0: 0x01000000 | n << 8 | proj (proj to litery,
+ *                      więc ftok() nigdy nie daje najstarszego bajtu 0x01)
+ *   FIFO, pliki /tmp   /tmp/kolej_<nazwa> lub /tmp/kolej_<n>_<nazwa>
+ *   segment POSIX      /kolej_stan lub /kolej_<n>_stan
+ *   katalog logów      logs/ lub logs/instancja_<n>/
+ *
+ * Instancja 0 (domyślna) zachowuje dotychczasowe nazwy. Usuwanie starych
+ * obiektów przy starcie dotyczy tylko własnej instancji. */
+
+#define MAX_INSTANCJA 0xFFFF
+
+/* Numer z KOLEJ_INSTANCJA (0, gdy brak); -1 dla niepoprawnej wartości */
+int instancja_id(void);
+
+/* Klucz SysV obiektu proj ('K', 'S', 'A'...) w tej instancji */
+key_t instancja_klucz(int proj);
+
+/* przedrostek + "kolej_" [+ "<n>_"] + nazwa, np. ("/tmp/", "kasjer_req") */
+const char *instancja_nazwa(const char *przedrostek, const char *nazwa,
+                            char *bufor, size_t rozmiar);
+
+/* To samo dla podanej instancji - sprzątanie cudzej (przeglad) */
+key_t instancja_klucz_dla(int id, int proj);
+const char *instancja_nazwa_dla(int id, const char *przedrostek, const char *nazwa,
+                                char *bufor, size_t rozmiar);
+
+/* Ścieżka pliku w katalogu logów instancji */
+const char *instancja_log(const char *plik, char *bufor, size_t rozmiar);
+
+/* Tworzy logs/ i katalog instancji; 0 lub -1 */
+int instancja_utworz_katalog_logow(void);
+
+#endif
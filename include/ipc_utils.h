@@ -16,19 +16,34 @@
 #define MQ_KEY_KRZESLA   0x5004
 
 /* ========== INDEKSY SEMAFORÓW W ZESTAWIE ========== */
-#define SEM_IDX_STACJA_DOLNA    0   /* Limit osób na stacji */
+#define SEM_IDX_STACJA_DOLNA    0   /* Miejsca na stacji dla zwykłych turystów */
 #define SEM_IDX_PERON           1   /* Sygnalizacja wejścia na peron */
 #define SEM_IDX_KRZESELKA       2   /* Dostępne krzesełka */
-#define SEM_IDX_KASA            3   /* Mutex kasy */
-#define SEM_IDX_REJESTR         4   /* Mutex rejestru */
-#define SEM_IDX_STAN            5   /* Mutex stanu */
-#define SEM_IDX_PRACOWNIK1      6   /* Sygnalizacja dla P1 */
-#define SEM_IDX_PRACOWNIK2      7   /* Sygnalizacja dla P2 */
-#define SEM_IDX_SYNC            8   /* Synchronizacja zatrzymania */
-#define SEM_IDX_VIP             9   /* Priorytet VIP */
-#define SEM_IDX_BRAMKA_WEJ_BASE 10  /* Bramki wejściowe 10-13 */
-#define SEM_IDX_BRAMKA_PER_BASE 14  /* Bramki peronowe 14-16 */
-#define LICZBA_SEMAFOROW        17
+#define SEM_IDX_KASA            3   /* Wolne okienka kasy (konfiguracja.kasjerzy) */
+#define SEM_IDX_STAN            4   /* Mutex stanu */
+#define SEM_IDX_PRACOWNIK1      5   /* Sygnalizacja dla P1 */
+#define SEM_IDX_PRACOWNIK2      6   /* Sygnalizacja dla P2 */
+#define SEM_IDX_SYNC            7   /* Synchronizacja zatrzymania */
+#define SEM_IDX_VIP             8   /* Miejsca na stacji tylko dla VIP (konfiguracja_miejsca_vip) */
+#define SEM_IDX_BRAMKA_WEJ_BASE 9   /* Bramki wejściowe 9-16 (MAX_BRAMEK_WEJSCIOWYCH) */
+#define SEM_IDX_BRAMKA_PER_BASE 17  /* Bramki peronowe 17-20 (MAX_BRAMEK_PERONOWYCH) */
+#define SEM_IDX_LINIA           21  /* Mutex pól Linia (krzesełka, pracownicy) */
+#define LICZBA_SEMAFOROW_LINII  22
+
+/* Każda linia ma własny blok LICZBA_SEMAFOROW_LINII semaforów o układzie
+ * jak wyżej; blok linii 0 zaczyna się od zera, więc SEM_IDX_* bez
+ * SEM_LINII() to linia 0. KASA i STAN są wspólne dla ośrodka - używany
+ * jest tylko ich egzemplarz w bloku 0.
+ *
+ * Pojemność stacji to STACJA_DOLNA + VIP = max_osob_na_stacji. VIP bierze
+ * wolne miejsce zwykłe bez czekania, a gdy go nie ma - czeka tylko na
+ * rezerwę VIP, nie w kolejce FIFO zwykłych turystów. */
+#define SEM_LINII(linia, idx)   ((linia) * LICZBA_SEMAFOROW_LINII + (idx))
+#define LICZBA_SEMAFOROW        (MAX_LINII * LICZBA_SEMAFOROW_LINII)
+
+_Static_assert(SEM_IDX_BRAMKA_WEJ_BASE + MAX_BRAMEK_WEJSCIOWYCH == SEM_IDX_BRAMKA_PER_BASE &&
+               SEM_IDX_BRAMKA_PER_BASE + MAX_BRAMEK_PERONOWYCH == SEM_IDX_LINIA,
+               "Blok semaforów linii nie mieści bramek");
 
 /* ========== UNION DLA semctl ========== */
 union semun {
@@ -44,10 +59,29 @@ typedef struct {
 } SemaforySysV;
 
 /* ========== STRUKTURA PAMIĘCI WSPÓŁDZIELONEJ ========== */
+/* Backend segmentu stanu - KOLEJ_SHM (dziedziczone przez procesy potomne):
+ *   sysv  - shmget/shmat (domyślnie)
+ *   posix - shm_open("/kolej_stan", instancja.h) + mmap(MAP_POPULATE)
+ *   memfd - memfd_create + mmap(MAP_POPULATE); deskryptor dziedziczony
+ *           przez exec(), numer w KOLEJ_SHM_FD
+ * KOLEJ_SHM_HUGE=thp     - madvise(MADV_HUGEPAGE) po dołączeniu
+ * KOLEJ_SHM_HUGE=hugetlb - strony 2MB (memfd MFD_HUGETLB, sysv SHM_HUGETLB);
+ *                          bez zarezerwowanych stron - zwykłe strony
+ * KOLEJ_SHM_MLOCK=1      - mlock() segmentu stanu w każdym procesie
+ * Segmenty rejestru i dziennika pozostają segmentami SysV. */
+typedef enum {
+    PAMIEC_SYSV = 0,
+    PAMIEC_POSIX,
+    PAMIEC_MEMFD
+} BackendPamieci;
+
 typedef struct {
-    int shm_id;
+    int shm_id;                     /* sysv, -1 dla pozostałych */
     key_t klucz;
     StanWspoldzielony *stan;
+    BackendPamieci backend;
+    int fd;                         /* posix/memfd, -1 dla sysv */
+    size_t rozmiar;                 /* Rozmiar odwzorowania */
 } PamiecWspoldzielona;
 
 /* ========== STRUKTURA KOLEJEK KOMUNIKATÓW ========== */
@@ -66,10 +100,10 @@ typedef struct {
 } ZasobyIPC;
 
 /* ========== FUNKCJE INICJALIZACJI ========== */
-int inicjalizuj_semafory_sysv(SemaforySysV *sem);
-int inicjalizuj_pamiec_wspoldzielona(PamiecWspoldzielona *shm);
+int inicjalizuj_semafory_sysv(SemaforySysV *sem, const KonfiguracjaKolei *k);
+int inicjalizuj_pamiec_wspoldzielona(PamiecWspoldzielona *shm, const KonfiguracjaKolei *k);
 int inicjalizuj_kolejki(KolejkiKomunikatow *mq);
-int inicjalizuj_wszystkie_zasoby(ZasobyIPC *zasoby);
+int inicjalizuj_wszystkie_zasoby(ZasobyIPC *zasoby, const KonfiguracjaKolei *k);
 
 /* ========== FUNKCJE ŁĄCZENIA ========== */
 int polacz_semafory_sysv(SemaforySysV *sem);
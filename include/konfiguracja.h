@@ -0,0 +1,82 @@
+#ifndef KONFIGURACJA_H
+#define KONFIGURACJA_H
+
+#include <stddef.h>
+#include "types.h"
+
+/* ========== KONFIGURACJA CZASU WYKONANIA ========== */
+/* Pojemności i czasy kolei bez przebudowy. main składa konfigurację
+ * w kolejności (późniejsze wygrywa):
+ *
+ *   config.h -> plik (-c <plik> lub KOLEJ_KONFIG) -> -o klucz=wartość
+ *            -> KOLEJ_LINIE (-l)
+ *
+ * i zapisuje ją w pierwszej stronie segmentu stanu, chronionej potem
+ * mprotect(PROT_READ) w każdym procesie. Procesy potomne czytają
+ * stan->konfiguracja zamiast makr config.h. Plik to wiersze
+ * "klucz = wartość", '#' zaczyna komentarz. Klucze:
+ *
+ *   linie                  1..MAX_LINII
+ *   krzeselka              krzesełka w ruchu na linię, 1..MAX_KRZESELEK_LINII
+ *   krzeselka_lacznie      wszystkie krzesełka linii (opis), >= krzeselka
+ *   pojemnosc_krzeselka    2..MAX_POJEMNOSC_KRZESELKA
+ *   max_rowerzystow        rowerzysta zajmuje 2 miejsca, 1..pojemnosc/2
+ *   bramki_wejsciowe       1..MAX_BRAMEK_WEJSCIOWYCH
+ *   bramki_peronowe        1..MAX_BRAMEK_PERONOWYCH
+ *   max_osob_na_stacji     1..MAX_LIMIT_STACJI
+ *   kasjerzy               procesy kasjera (okienka), 1..MAX_KASJEROW
+ *   czas_sprzedazy_ms      obsługa klienta przy okienku, 0..60000
+ *   procent_vip            turystów VIP, 0..100
+ *   czas_trasy_t1..t3      s
+ *   czas_tk1..tk3          s
+ *
+ * Krzesełka i bramki linii leżą za StanWspoldzielony, rozłożone przez
+ * konfiguracja_rozloz(); pętle pracowników biorą wskaźnik do tablicy
+ * i jej długość raz, przy starcie. */
+
+/* Wartości z config.h */
+void konfiguracja_domyslna(KonfiguracjaKolei *k);
+
+/* Jeden klucz; 0 lub -1 (nieznany klucz / wartość spoza zakresu, opis na stderr) */
+int konfiguracja_ustaw(KonfiguracjaKolei *k, const char *klucz, const char *wartosc);
+
+/* "klucz=wartość" (main -o) */
+int konfiguracja_ustaw_pare(KonfiguracjaKolei *k, const char *para);
+
+/* Wiersze pliku po kolei; 0 lub -1 przy pierwszym błędnym wierszu */
+int konfiguracja_wczytaj_plik(KonfiguracjaKolei *k, const char *sciezka);
+
+/* Zależności między kluczami (krzeselka_lacznie, max_rowerzystow); 0 lub -1 */
+int konfiguracja_sprawdz(const KonfiguracjaKolei *k);
+
+/* ========== UKŁAD TABLIC LINII W SEGMENCIE ========== */
+/* Wypełnia przesunięcia tablic linii 0..k->linie-1 i zwraca rozmiar
+ * całego segmentu stanu */
+size_t konfiguracja_rozloz(const KonfiguracjaKolei *k, PrzesunieciaLinii tablice[MAX_LINII]);
+
+/* PROT_READ na pierwszej stronie segmentu (naglowek, konfiguracja,
+ * tablice). Bez ochrony, gdy strona systemu jest większa niż
+ * ROZMIAR_STRONY_STANU albo segment ma strony hugetlb. 0 lub -1 */
+int konfiguracja_zablokuj(StanWspoldzielony *stan);
+
+/* Miejsca stacji zarezerwowane dla VIP (SEM_IDX_VIP): procent_vip
+ * z max_osob_na_stacji, co najmniej 1 przy procent_vip > 0; zwykłym
+ * zostaje zawsze co najmniej jedno miejsce (SEM_IDX_STACJA_DOLNA) */
+static inline int konfiguracja_miejsca_vip(const KonfiguracjaKolei *k) {
+    if (k->procent_vip <= 0 || k->max_osob_na_stacji < 2) return 0;
+    int miejsca = (k->max_osob_na_stacji * k->procent_vip + 99) / 100;
+    if (miejsca < 1) miejsca = 1;
+    if (miejsca > k->max_osob_na_stacji - 1) miejsca = k->max_osob_na_stacji - 1;
+    return miejsca;
+}
+
+static inline Krzeselko *linia_krzeselka(StanWspoldzielony *stan, int linia) {
+    return (Krzeselko *)((char *)stan + stan->tablice[linia].krzeselka);
+}
+
+/* bramki_wejsciowe bramek wejściowych, za nimi peronowe */
+static inline Bramka *linia_bramki(StanWspoldzielony *stan, int linia) {
+    return (Bramka *)((char *)stan + stan->tablice[linia].bramki);
+}
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef LINIE_H
+#define LINIE_H
+
+#include <stddef.h>
+#include "types.h"
+
+/* ========== TOPOLOGIA OŚRODKA ========== */
+/* Ośrodek ma 1..MAX_LINII linii w jednym segmencie stanu (stan->linie).
+ * Linia ma własnych pracowników, bramki, krzesełka, liczniki i blok
+ * semaforów SEM_LINII(linia, ...); kasa, rejestr i agregaty są wspólne.
+ *
+ *   KOLEJ_LINIE=<n>         liczba linii (main: -l <n>), domyślnie 1
+ *   KOLEJ_LINIE_CPU=<lista> rdzenie pracowników, np. "0,2,4" - linia l
+ *                           na l-tym rdzeniu listy (modulo długość listy)
+ *
+ * Pracownicy dostają numer linii jako argv[1]. Turysta wybiera linię przed
+ * każdym zjazdem - najkrótsza kolejka (stacja + peron) - a bilet jest
+ * ważny na wszystkich liniach. */
+
+/* Liczba z KOLEJ_LINIE (1, gdy brak); -1 dla niepoprawnej wartości */
+int linie_liczba_z_env(void);
+
+/* Numer linii pracownika z argv[1] (0, gdy brak); -1 dla niepoprawnego */
+int linia_z_argumentow(int argc, char *argv[]);
+
+/* Przypina proces do rdzenia linii z KOLEJ_LINIE_CPU.
+ * 0 - przypięty lub lista nieustawiona, -1 - błąd */
+int linia_przypnij_cpu(int linia);
+
+/* Linia z najkrótszą kolejką; remisy rozstrzygane losowo */
+int linia_wybierz(const StanWspoldzielony *stan);
+
+/* Plik logu roli: "<rola>.log" dla linii 0, "<rola>_linia<n>.log" dla pozostałych */
+const char *linia_log(const char *rola, int linia, char *bufor, size_t rozmiar);
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef LOG_LIMITY_H
+#define LOG_LIMITY_H
+
+#include <stdbool.h>
+#include <stdatomic.h>
+
+/* ========== LIMITOWANIE I PRÓBKOWANIE WPISÓW (DEBUG/INFO) ========== */
+/* Reguły z KOLEJ_LOG_LIMITY, oddzielone przecinkami:
+ *     <rola>.<POZIOM>=<N>/s[:<P>%]   lub   <rola>.<POZIOM>=<P>%
+ * np. "turysta.INFO=20/s:50%,*.DEBUG=10%". Rola to nazwa programu
+ * (turysta, kasjer, pracownik1, ...), "*" pasuje do każdej; przy kilku
+ * pasujących regułach wygrywa ostatnia. WARN i ERROR nie są ograniczane.
+ *
+ * Limit N/s jest wspólny dla wszystkich procesów danej roli (tablica
+ * limity_<rola>.tab w katalogu logów instancji, mapowana MAP_SHARED
+ * i usuwana przez main na starcie i przy końcu), próbkowanie P% - losowe
+ * w każdym procesie. Pominięte wpisy obu rodzajów zlicza wspólny slot;
+ * linię podsumowania (najwyżej co kilka sekund na miejsce) pisze proces,
+ * który otworzy nowe okno, a resztę - logger_close(). */
+
+#define LICZBA_SLOTOW_LIMITOW 128
+
+/* ========== STAN MIEJSCA WYWOŁANIA (static w makrze LOG_*) ========== */
+typedef struct MiejsceLogu {
+    const char *plik;
+    int linia;
+    const char *format;
+
+    atomic_int rozwiazane;              /* Reguły dopasowane (raz na proces) */
+    int poziom;
+    unsigned limit_na_sekunde;          /* 0 = bez limitu */
+    unsigned procent;                   /* 100 = każdy wpis */
+    struct SlotLimitu *slot;            /* NULL = brak reguły, wpis zawsze przechodzi */
+    struct MiejsceLogu *nastepne;       /* Lista do podsumowania przy zamknięciu */
+} MiejsceLogu;
+
+/* Niezerowe, gdy KOLEJ_LOG_LIMITY zawiera regułę dla tego procesu */
+extern int logger_limity_aktywne;
+
+void log_limity_wczytaj(void);
+bool log_limity_przepusc(MiejsceLogu *miejsce, int poziom);
+void log_limity_podsumuj(void);
+
+/* Usuwa tablice limity_*.tab wszystkich ról tej instancji */
+void log_limity_wyczysc(void);
+
+#endif
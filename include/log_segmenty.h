@@ -0,0 +1,47 @@
+#ifndef LOG_SEGMENTY_H
+#define LOG_SEGMENTY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+/* ========== LOG W SEGMENTACH MAPOWANYCH W PAMIĘCI ========== */
+/* Wiele procesów dopisuje do wspólnego logu bez flock() i bez write():
+ * miejsce rezerwowane jest atomowym fetch-add na wspólnym offsecie
+ * (plik sterujący <baza>.ctl), a wpis kopiowany memcpy() do segmentu
+ * <baza>.NNNN.log wcześniej przydzielonego przez fallocate().
+ * Każdy pisarz trzyma flock(LOCK_SH) na .ctl - ostatni przycina ogon. */
+
+#define LOG_SEGMENTY_MAGIA     0x4B4C5347u   /* "KLSG" */
+#define LOG_SEGMENTY_WERSJA    1
+#define DOMYSLNY_ROZMIAR_SEGMENTU (4u * 1024u * 1024u)
+
+/* ========== NAGŁÓWEK WSPÓŁDZIELONY (plik .ctl) ========== */
+typedef struct {
+    _Atomic uint32_t magia;             /* Ustawiana na końcu inicjalizacji */
+    uint32_t wersja;
+    uint64_t rozmiar_segmentu;
+    _Atomic uint64_t pozycja;           /* Globalny offset przez wszystkie segmenty */
+} NaglowekSegmentow;
+
+/* ========== UCHWYT PROCESU ========== */
+typedef struct {
+    char baza[240];                     /* Ścieżka bez rozszerzenia */
+    int fd_ctl;
+    NaglowekSegmentow *naglowek;
+    uint64_t rozmiar_segmentu;
+    int64_t numer_mapy;                 /* Numer zmapowanego segmentu, -1 = brak */
+    char *mapa;
+} LogSegmentowy;
+
+int log_segmenty_otworz(LogSegmentowy *log, const char *sciezka, uint64_t rozmiar_segmentu);
+int log_segmenty_zapisz(LogSegmentowy *log, const char *tekst, size_t dlugosc);
+void log_segmenty_zamknij(LogSegmentowy *log);
+void log_segmenty_przytnij(const char *sciezka);
+
+/* Scala zamknięte segmenty do <baza>.log.<znacznik> według progu rozmiaru
+ * i wieku (jak rotacja zwykłego logu); 1 = utworzono archiwum cel */
+int log_segmenty_rotuj(const char *sciezka, uint64_t prog_bajtow, long prog_wieku_s,
+                       long karencja_s, char *cel, size_t rozmiar_celu);
+
+#endif
@@ -4,6 +4,7 @@
 #include <stdio.h>
 #include <time.h>
 #include "types.h"
+#include "log_limity.h"
 
 /* ========== POZIOMY LOGOWANIA ========== */
 typedef enum {
@@ -13,24 +14,63 @@ typedef enum {
     LOG_ERROR = 3
 } PoziomLogu;
 
+/* ========== MINIMALNY POZIOM W CZASIE KOMPILACJI ========== */
+/* Makra poniżej tego poziomu znikają z kodu (np. make LOG_MIN=3) */
+#ifndef LOG_POZIOM_MIN
+#define LOG_POZIOM_MIN 0
+#endif
+
+/* ========== PRÓG W CZASIE WYKONANIA ========== */
+/* Czytany raz w logger_init() ze zmiennej środowiskowej KOLEJ_LOG_POZIOM
+ * (DEBUG/INFO/WARN/ERROR lub 0-3). Sprawdzany przed formatowaniem. */
+extern int logger_prog;
+
 /* ========== FUNKCJE LOGOWANIA ========== */
 void logger_init(const char *nazwa_pliku);
 void logger_close(void);
 void logger_log(PoziomLogu poziom, const char *format, ...);
 
 /* ========== ASYNCHRONICZNE LOGOWANIE (pthread_cond_*) ========== */
+/* Po logger_start_async() logger_log() formatuje do bufora wątku, a wątek
+ * zapisujący zrzuca wiele wpisów jednym writev(). pojemnosc <= 0 oznacza
+ * KOLEJ_LOG_POJEMNOSC lub wartość domyślną. logger_close() opróżnia bufory. */
 void logger_log_async(const char *wiadomosc);
-void logger_start_async(void);
+void logger_start_async(int pojemnosc);
 void logger_stop_async(void);
+void logger_statystyki_async(unsigned long *porzucone, unsigned long *zablokowane);
+
+/* ========== LOG W SEGMENTACH mmap() (log_segmenty.h) ========== */
+/* Jak logger_init(), ale wpisy trafiają memcpy() do wspólnych segmentów
+ * <nazwa bez .log>.NNNN.log zamiast write() + flock(). KOLEJ_LOG_SEGMENTY=0
+ * wraca do zwykłego pliku, KOLEJ_LOG_SEGMENT_KB ustala rozmiar segmentu. */
+void logger_init_segmenty(const char *nazwa_pliku);
+
+/* Wątek rotacji tego procesu scala też zamknięte segmenty logu nazwa_pliku
+ * (te same progi KOLEJ_LOG_ROTACJA_MB/S i kompresja); NULL wyłącza */
+void logger_rotuj_segmenty(const char *nazwa_pliku);
 
 /* ========== MAKRA DLA WYGODY ========== */
-#define LOG_D(fmt, ...) logger_log(LOG_DEBUG, fmt, ##__VA_ARGS__)
-#define LOG_I(fmt, ...) logger_log(LOG_INFO, fmt, ##__VA_ARGS__)
-#define LOG_W(fmt, ...) logger_log(LOG_WARN, fmt, ##__VA_ARGS__)
-#define LOG_E(fmt, ...) logger_log(LOG_ERROR, fmt, ##__VA_ARGS__)
+/* Stały warunek (poziom < LOG_POZIOM_MIN) kompilator usuwa razem z wywołaniem,
+ * a argumenty nadal są sprawdzane pod kątem typów. Każde miejsce wywołania
+ * ma własny stan limitów (log_limity.h), sprawdzany tylko dla DEBUG/INFO
+ * i tylko gdy KOLEJ_LOG_LIMITY zawiera regułę dla procesu. */
+#define LOG_NA_POZIOMIE(poziom, fmt, ...) \
+    do { \
+        if ((poziom) >= LOG_POZIOM_MIN && (int)(poziom) >= logger_prog) { \
+            static MiejsceLogu miejsce_logu_ = { \
+                .plik = __FILE__, .linia = __LINE__, .format = fmt }; \
+            if ((poziom) >= LOG_WARN || !logger_limity_aktywne || \
+                log_limity_przepusc(&miejsce_logu_, (poziom))) \
+                logger_log((poziom), fmt, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+#define LOG_D(fmt, ...) LOG_NA_POZIOMIE(LOG_DEBUG, fmt, ##__VA_ARGS__)
+#define LOG_I(fmt, ...) LOG_NA_POZIOMIE(LOG_INFO, fmt, ##__VA_ARGS__)
+#define LOG_W(fmt, ...) LOG_NA_POZIOMIE(LOG_WARN, fmt, ##__VA_ARGS__)
+#define LOG_E(fmt, ...) LOG_NA_POZIOMIE(LOG_ERROR, fmt, ##__VA_ARGS__)
 
-/* ========== REJESTROWANIE I RAPORT ========== */
+/* ========== REJESTROWANIE ========== */
 void logger_rejestruj_przejscie(int bilet_id, int turysta_id, int bramka, int zjazd);
-void generuj_raport(StanWspoldzielony *stan, const char *plik_wyjsciowy);
 
 #endif
\ No newline at end of file
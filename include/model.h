@@ -0,0 +1,79 @@
+#ifndef MODEL_H
+#define MODEL_H
+
+#include "types.h"
+
+/* ========== ANALITYCZNY MODEL PRZEPUSTOWOŚCI ========== */
+/* Przybliżenie kolei siecią kolejek M/G/c (Erlang C z poprawką
+ * Allena-Cunneena na zmienność obsługi), liczone w mikrosekundach
+ * z tej samej konfiguracji co symulacja. Etapy, przez które przechodzi
+ * jeden zjazd:
+ *
+ *   kasa       c = kasjerzy, obsługa czas_sprzedazy_ms + pół OKRES_KASJERA_MS
+ *   stacja     c = max_osob_na_stacji bez rezerwy VIP (konfiguracja_miejsca_vip)
+ *              na linię; miejsce zajęte od bramki
+ *              do końca trasy (peron, krzesełko, jazda, trasa rowerzysty)
+ *   bramki     c = bramki_wejsciowe bez pasa VIP, obsługa CZAS_BRAMKI_US
+ *   peron      pracownik1: jedna prośba na OKRES_PRACOWNIKA1_MS
+ *   krzeselka  c = krzeselka na linię, obsługa - jazda do wykrycia
+ *              przyjazdu przez pracownika2; rodzina na krzesełko, ale
+ *              dzieci dołączają do opiekuna dopiero w jego następnym cyklu
+ *
+ * Turyści przychodzą jak main (-a, PROCENT_GRUP_Z_DZIECMI) aż do -n, bilet
+ * kupują raz, zjazdów robią tyle, ile pozwala typ biletu, czas cyklu
+ * i PROCENT_KONCA_DNIA - czas cyklu zależy od czekania, więc model
+ * iteruje do punktu stałego. Napływ traktowany jest jak proces Poissona.
+ *
+ * Przybliżenie do przesiewania tysięcy konfiguracji; przeglad -p
+ * uruchamia symulację i podaje błąd modelu na każdym etapie. */
+
+#define CZAS_BRAMKI_US 10           /* Semafory bramki i licznik stacji */
+
+typedef enum {
+    ETAP_KASA = 0,
+    ETAP_STACJA,
+    ETAP_BRAMKI,
+    ETAP_PERON,
+    ETAP_KRZESELKA,
+    LICZBA_ETAPOW
+} EtapModelu;
+
+/* Czekania w µs; MODEL_NASYCONY - obciążenie >= 1, kolejka rośnie */
+#define MODEL_NASYCONY (-1.0)
+
+typedef struct {
+    double zgloszen_na_s;       /* Na linię dla etapów linii, jak serwery */
+    int serwery;
+    double obsluga_us;
+    double obciazenie;          /* rho = lambda * S / c */
+    double czekanie_us;         /* Średnie Wq */
+    double czekanie_p99_us;     /* Ogon wykładniczy Erlanga C */
+    double zjazdow_max_na_s;    /* Przepustowość etapu w zjazdach */
+} EtapPrzewidywania;
+
+typedef struct {
+    double turystow_na_s;
+    double zjazdow_na_turyste;
+    double osob_na_krzeselko;
+    EtapPrzewidywania etapy[LICZBA_ETAPOW];
+    EtapModelu waskie_gardlo;   /* Największe obciążenie */
+
+    /* Wielkości mierzone przez symulację (wynik_przebiegu.txt) */
+    double osob_na_godzine;
+    double zjazdow_na_godzine;
+    double czekanie_bilet_us;           /* Kasa: Wq + S */
+    double czekanie_bilet_p99_us;
+    double czekanie_bramka_us;          /* Stacja + bramki */
+    double czekanie_krzeselko_us;       /* Peron + krzesełka */
+    double czekanie_krzeselko_p99_us;
+    double oblozenie_krzeselek;
+} PrzewidywanieModelu;
+
+/* turystow jak main -n, grup_na_sekunde jak -a (0 = domyślny napływ),
+ * czas_s jak -t. 0 lub -1 (parametry poza zakresem) */
+int model_przewiduj(const KonfiguracjaKolei *k, int turystow, int grup_na_sekunde,
+                    int czas_s, PrzewidywanieModelu *p);
+
+const char *model_nazwa_etapu(EtapModelu etap);
+
+#endif
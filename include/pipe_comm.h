@@ -7,10 +7,12 @@
 #include <unistd.h>
 
 /* ========== NAZWY ŁĄCZY NAZWANYCH (FIFO) ========== */
-#define FIFO_KASJER_REQUEST  "/tmp/kolej_kasjer_req"
-#define FIFO_KASJER_RESPONSE "/tmp/kolej_kasjer_resp"
-#define FIFO_PRACOWNIK_SYNC  "/tmp/kolej_prac_sync"
-#define FIFO_RAPORT          "/tmp/kolej_raport"
+/* Pliki w /tmp z przedrostkiem instancji (instancja.h):
+ * /tmp/kolej_kasjer_req lub /tmp/kolej_<n>_kasjer_req */
+#define FIFO_KASJER_REQUEST  "kasjer_req"
+#define FIFO_KASJER_RESPONSE "kasjer_resp"
+#define FIFO_PRACOWNIK_SYNC  "prac_sync"
+#define FIFO_RAPORT          "raport"
 
 /* ========== STRUKTURA DLA PIPE ========== */
 typedef struct {
@@ -0,0 +1,59 @@
+#ifndef POLITYKA_H
+#define POLITYKA_H
+
+#include "types.h"
+
+/* ========== POLITYKA SZEREGOWANIA RÓL ========== */
+/* Reguły z KOLEJ_POLITYKA, oddzielone średnikami:
+ *     <rola>:<klucz>=<wartość>[:<klucz>=<wartość>...]
+ * np. "pracownik:cpu=0:fifo=10;turysta:cpu=1-3:nice=10". Role: kasjer,
+ * pracownik (obaj pracownicy wszystkich linii), turysta, monitor (wątki
+ * monitora i statystyk w main). Klucze:
+ *
+ *   cpu=<lista>   rdzenie, np. 0,2-3             sched_setaffinity
+ *   nice=<n>      -20..19                        setpriority
+ *   fifo=<p>      priorytet SCHED_FIFO 1..99     sched_setscheduler
+ *
+ * main wczytuje reguły raz, a proces potomny stosuje je po fork(), przed
+ * exec() - ustawienia przechodzą przez exec. Bez uprawnień do SCHED_FIFO
+ * (ani ujemnego nice) proces zostaje przy SCHED_OTHER z ostrzeżeniem.
+ * KOLEJ_LINIE_CPU (linie.h) zawęża potem rdzenie pracowników do rdzenia
+ * ich linii. */
+
+typedef enum {
+    ROLA_KASJER = 0,
+    ROLA_PRACOWNIK,
+    ROLA_TURYSTA,
+    ROLA_MONITOR,
+    LICZBA_ROL
+} RolaProcesu;
+
+/* Wczytuje KOLEJ_POLITYKA; 0 lub -1 (niepoprawna reguła, opis na stderr) */
+int polityka_wczytaj(void);
+
+/* Stosuje politykę roli do wywołującego wątku (po fork() - całego procesu).
+ * 0 - zastosowana lub brak reguły, -1 - błąd affinity/nice */
+int polityka_zastosuj(RolaProcesu rola);
+
+/* ========== POMIAR OPÓŹNIEŃ PĘTLI ========== */
+/* Pracownik przed blokującym czekaniem zapisuje czas, po nim dodaje do
+ * histogramu linii spóźnienie względem zadanego limitu - czas od
+ * wygaśnięcia limitu do ponownego przydziału procesora. */
+
+long czas_monotoniczny_us(void);
+
+static inline int histogram_kubelek(long us) {
+    if (us <= 0) return 0;
+    int k = 64 - __builtin_clzl((unsigned long)us);
+    return (k < LICZBA_KUBELKOW_OPOZNIEN) ? k : LICZBA_KUBELKOW_OPOZNIEN - 1;
+}
+
+void histogram_dodaj(HistogramOpoznien *h, long us);
+
+/* Dolicza kubełki h do kubelki[LICZBA_KUBELKOW_OPOZNIEN] */
+void histogram_sumuj(const HistogramOpoznien *h, unsigned long *kubelki);
+
+/* Górna granica kubełka (µs), w którym wypada percentyl; 0 - pusty */
+long histogram_percentyl(const unsigned long *kubelki, double procent);
+
+#endif
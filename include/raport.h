@@ -0,0 +1,93 @@
+#ifndef RAPORT_H
+#define RAPORT_H
+
+#include <stdint.h>
+#include "types.h"
+
+/* ========== RAPORT DZIENNY ========== */
+/* Sekcje per typ biletu, per bramka i per godzina to migawka agregatów
+ * na żywo (agregaty.h) - O(liczba agregatów). Rejestr przeglądany jest
+ * raz (rosnąco po czasie) tylko dla tabeli wpisów i agregatów per bilet
+ * (tablica haszująca z adresowaniem otwartym).
+ * Pamięć zależy od liczby biletów, nie wpisów - i ma górną granicę
+ * KOLEJ_RAPORT_MAX_BILETOW (domyślnie 2^20); zjazdy biletów spoza tablicy
+ * trafiają do jednego wiersza zbiorczego.
+ *
+ * KOLEJ_RAPORT_FORMAT - lista formatów rozdzielona przecinkami (domyślnie
+ * "tekst"): tekst (.txt), csv (.csv), jsonl (.jsonl), bin (.bin). Rozszerzenie
+ * plik_wyjsciowy zastępowane jest rozszerzeniem formatu. Każdy format to
+ * jeden przebieg do dużego bufora wyjściowego.
+ *
+ * KOLEJ_RAPORT_WIERSZE - ile pierwszych wpisów rejestru wypisać w tabeli
+ * (-1 = wszystkie; domyślnie 100 dla tekstu, wszystkie dla pozostałych).
+ *
+ * KOLEJ_RAPORT_MMAP=1 - wyjście przez mmap() pliku powiększanego
+ * ftruncate() + mremap() zamiast porcji 1MB zapisywanych przez io_uring
+ * (duże rejestry: bez kopiowania porcji i bez osobnych buforów). */
+
+void generuj_raport(StanWspoldzielony *stan, const char *plik_wyjsciowy);
+
+/* ========== FORMATY MASZYNOWE ========== */
+/* csv, jsonl i bin to ten sam ciąg rekordów RekordRaportu. Pola nieobecne
+ * w rekordzie (bit w pola = 0) są w CSV puste, a w JSON pominięte.
+ * Ostatni rekord to REKORD_KONIEC z liczbą poprzednich w przejscia -
+ * jego brak oznacza ucięty plik.
+ *
+ * CSV: nagłówek "rekord,czas,bramka,typ_biletu,bilet_id,turysta_id,zjazd,
+ *      przejscia,sprzedaze,przychod,pierwszy,ostatni,linia"; czasy jako sekundy epoki.
+ * bin: NaglowekRaportuBin, potem rekordy w kolejności zapisu (little-endian). */
+typedef enum {
+    REKORD_PODSUMOWANIE = 1,        /* czas wygenerowania, zjazd = zjazdy krzesełek */
+    REKORD_TYP,                     /* typ_biletu (0 = nieznany) */
+    REKORD_BRAMKA,
+    REKORD_GODZINA,                 /* z bramką: przejścia bramki; bez: sumy godziny */
+    REKORD_PRZEJSCIE,               /* wpis rejestru */
+    REKORD_BILET,                   /* przejscia = zjazdy biletu */
+    REKORD_POZOSTALE_BILETY,        /* bilety ponad KOLEJ_RAPORT_MAX_BILETOW */
+    REKORD_KONIEC
+} RodzajRekordu;
+
+#define POLE_CZAS           (1u << 0)
+#define POLE_BRAMKA         (1u << 1)
+#define POLE_TYP_BILETU     (1u << 2)
+#define POLE_BILET_ID       (1u << 3)
+#define POLE_TURYSTA_ID     (1u << 4)
+#define POLE_ZJAZD          (1u << 5)
+#define POLE_PRZEJSCIA      (1u << 6)
+#define POLE_SPRZEDAZE      (1u << 7)
+#define POLE_PRZYCHOD       (1u << 8)
+#define POLE_PIERWSZY       (1u << 9)
+#define POLE_OSTATNI        (1u << 10)
+#define POLE_LINIA          (1u << 11)
+
+typedef struct {
+    uint32_t rodzaj;                /* RodzajRekordu */
+    uint32_t pola;                  /* POLE_* obecne w rekordzie */
+    int64_t czas;
+    int32_t bramka;
+    int32_t typ_biletu;
+    int32_t bilet_id;
+    int32_t turysta_id;
+    int32_t zjazd;
+    int32_t linia;
+    uint64_t przejscia;
+    uint64_t sprzedaze;
+    uint64_t przychod;              /* zł */
+    int64_t pierwszy;
+    int64_t ostatni;
+} RekordRaportu;
+
+_Static_assert(sizeof(RekordRaportu) == 80, "RekordRaportu nie może mieć dopełnienia");
+
+#define RAPORT_BIN_MAGIA    0x42504152u   /* "RAPB" */
+#define RAPORT_BIN_WERSJA   2
+
+typedef struct {
+    uint32_t magia;
+    uint32_t wersja;
+    uint32_t rozmiar_rekordu;
+    uint32_t zarezerwowane;
+    int64_t utworzono;
+} NaglowekRaportuBin;
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef REJESTR_H
+#define REJESTR_H
+
+#include "types.h"
+
+/* ========== REJESTR PRZEJŚĆ W SEGMENTACH ========== */
+/* Każda bramka wejściowa każdej linii dopisuje do własnego shardu
+ * (linia * MAX_BRAMEK_WEJSCIOWYCH + bramka); shard to ciąg
+ * segmentów pamięci współdzielonej SysV tworzonych na żądanie
+ * (identyfikatory w stan->shardy_rejestru). Rozmiary pierwszych segmentów
+ * rosną geometrycznie, dalsze mają stały górny rozmiar, więc
+ * indeks -> (segment, pozycja) to O(1).
+ *
+ * Dopisanie nie używa semafora: miejsce rezerwuje atomic_fetch_add na
+ * liczniku shardu, a wpis staje się widoczny po zapisie flagi slotu
+ * z semantyką release. Brakujący segment tworzy ten, kto pierwszy go
+ * potrzebuje (CAS na katalogu; przegrany usuwa swój segment). */
+
+/* Zwraca 0 lub -1 (brak miejsca / błąd shmget). Pierwszy błąd zamyka shard:
+ * kolejne przejścia przez tę bramkę są tylko liczone w
+ * stan->odrzucone_wpisy_rejestru */
+int rejestr_dopisz(StanWspoldzielony *stan, const WpisRejestru *wpis);
+
+/* ========== ODCZYT STRUMIENIOWY ========== */
+/* Scala shardy rosnąco po czasie (przy remisie - niższa linia,
+ * potem niższy numer bramki).
+ * Shard jest uporządkowany, bo bramkę przechodzi jeden turysta naraz;
+ * wyjątkiem jest chwila między zwolnieniem bramki a rezerwacją slotu,
+ * co przy czasie z dokładnością do sekundy praktycznie nie występuje.
+ * Obejmuje wpisy zarezerwowane w chwili rozpoczęcia. Slot w trakcie zapisu
+ * czytelnik chwilę odczekuje; slot oznaczony przez pisarza jako porzucony
+ * pomija od razu, a inny nieopublikowany - po limicie czasu (pisarz zginął
+ * między rezerwacją a publikacją). */
+typedef struct {
+    int indeks;
+    int koniec;
+    const WpisRejestru *glowa;      /* Następny wpis shardu lub NULL */
+} StrumienShardu;
+
+typedef struct {
+    StanWspoldzielony *stan;
+    StrumienShardu shardy[LICZBA_SHARDOW_REJESTRU];
+    int indeks;                     /* Liczba zwróconych wpisów */
+    int pominiete;                  /* Porzucone i nieopublikowane sloty */
+    long poczatek_ms;               /* CLOCK_MONOTONIC utworzenia iteratora */
+} IteratorRejestru;
+
+void rejestr_iterator(IteratorRejestru *it, StanWspoldzielony *stan);
+const WpisRejestru *rejestr_nastepny(IteratorRejestru *it);
+
+/* ========== SPRZĄTANIE ========== */
+/* Odłącza segmenty w procesie i (usun = true) oznacza je do usunięcia */
+void rejestr_odlacz(StanWspoldzielony *stan, bool usun);
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef REJESTR_PLIK_H
+#define REJESTR_PLIK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "types.h"
+
+/* ========== KOLUMNOWY PLIK REJESTRU ========== */
+/* Rejestr z końca dnia zapisany kolumnami (wiersze rosnąco po czasie):
+ *
+ *   [nagłówek][bilet_id i32][turysta_id i32][czas i64][linia i32][bramka i32]
+ *   [zjazd i32][typ_biletu i32][indeks bilet_id][indeks turysta_id]
+ *
+ * Indeks to pary (klucz, wiersz) posortowane po kluczu i wierszu -
+ * wyszukiwanie binarne zamiast przeglądania całych kolumn. Przesunięcia
+ * sekcji są wyrównane do 8 bajtów, plik czyta się przez mmap(). */
+
+#define REJESTR_PLIK_MAGIA   0x4A45524Bu   /* "KREJ" */
+#define REJESTR_PLIK_WERSJA  3
+
+typedef enum {
+    KOL_BILET = 0,
+    KOL_TURYSTA,
+    KOL_CZAS,
+    KOL_LINIA,
+    KOL_BRAMKA,
+    KOL_ZJAZD,
+    KOL_TYP,
+    LICZBA_KOLUMN_REJESTRU
+} KolumnaRejestru;
+
+typedef struct {
+    uint64_t offset;
+    uint32_t rozmiar_elementu;
+    uint32_t zarezerwowane;
+    int64_t min;
+    int64_t max;
+} OpisKolumny;
+
+typedef struct {
+    int32_t klucz;
+    uint32_t wiersz;
+} WpisIndeksu;
+
+typedef struct {
+    uint32_t magia;
+    uint32_t wersja;
+    uint64_t liczba_wierszy;
+    int64_t utworzono;
+    OpisKolumny kolumny[LICZBA_KOLUMN_REJESTRU];
+    uint64_t offset_indeksu_bilet;
+    uint64_t offset_indeksu_turysta;
+} NaglowekRejestruPliku;
+
+/* ========== ZAPIS (main, przed usunięciem zasobów) ========== */
+int rejestr_zapisz_plik(StanWspoldzielony *stan, const char *sciezka);
+
+/* ========== ODCZYT ========== */
+typedef struct {
+    void *mapa;
+    size_t rozmiar;
+    const NaglowekRejestruPliku *naglowek;
+    const int32_t *bilet;
+    const int32_t *turysta;
+    const int64_t *czas;
+    const int32_t *linia;
+    const int32_t *bramka;
+    const int32_t *zjazd;
+    const int32_t *typ;
+    const WpisIndeksu *indeks_bilet;
+    const WpisIndeksu *indeks_turysta;
+} RejestrPlik;
+
+int rejestr_plik_otworz(RejestrPlik *r, const char *sciezka);
+void rejestr_plik_zamknij(RejestrPlik *r);
+
+/* Zakres [*od, *do) indeksu z danym kluczem; zwraca liczbę wierszy */
+size_t rejestr_plik_szukaj(const WpisIndeksu *indeks, size_t n, int32_t klucz,
+                           size_t *od, size_t *do_);
+
+#endif
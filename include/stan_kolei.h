@@ -0,0 +1,97 @@
+#ifndef STAN_KOLEI_H
+#define STAN_KOLEI_H
+
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "types.h"
+
+/* ========== SEQLOCK NA FLAGACH STANU ========== */
+/* Piszący flagi (main, pracownicy - zawsze pod SEM_IDX_STAN, więc jeden
+ * naraz) otacza zmiany stan_zapis_poczatek() / stan_zapis_koniec() - dwa
+ * zwiększenia licznika sekwencji, bez dodatkowych wywołań systemowych:
+ *
+ *   sem_czekaj_sysv(sem_id, SEM_IDX_STAN);
+ *   stan_zapis_poczatek(stan);
+ *   STAN_USTAW(stan, kolej_zatrzymana[linia], true);
+ *   stan_zapis_koniec(stan);
+ *   sem_sygnalizuj_sysv(sem_id, SEM_IDX_STAN);
+ *
+ * Czytelnik (monitor, statystyki, pętla zamykania main) bierze spójną
+ * migawkę stan_migawka() bez semafora: kopiuje flagi i powtarza, jeśli
+ * sekwencja była nieparzysta albo zmieniła się w trakcie kopiowania.
+ * Pojedynczą flagę (np. godziny_pracy w pętli turysty) wystarczy czytać
+ * STAN_CZYTAJ - jest atomowa sama w sobie. */
+
+#define STAN_CZYTAJ(stan, pole) \
+    atomic_load_explicit(&(stan)->kolej.pole, memory_order_acquire)
+
+/* Tylko między stan_zapis_poczatek() i stan_zapis_koniec() */
+#define STAN_USTAW(stan, pole, wartosc) \
+    atomic_store_explicit(&(stan)->kolej.pole, (wartosc), memory_order_relaxed)
+
+/* Parzystość wymuszana, nie przełączana: piszący zabity w trakcie zapisu
+ * zostawia nieparzystą sekwencję, którą następny zapis naprawia */
+static inline void stan_zapis_poczatek(StanWspoldzielony *stan) {
+    unsigned s = atomic_load_explicit(&stan->kolej.sekwencja, memory_order_relaxed);
+    atomic_store_explicit(&stan->kolej.sekwencja, (s + 1) | 1u, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
+
+static inline void stan_zapis_koniec(StanWspoldzielony *stan) {
+    unsigned s = atomic_load_explicit(&stan->kolej.sekwencja, memory_order_relaxed);
+    atomic_store_explicit(&stan->kolej.sekwencja, (s + 1) & ~1u, memory_order_release);
+}
+
+/* ========== LICZNIKI W SHARDACH ========== */
+/* Liczniki osób, krzesełek, zjazdów i biletów nie są pod SEM_IDX_STAN:
+ * każdy piszący zwiększa własny shard (stan->liczniki, osobne linie cache)
+ * jednym atomic_fetch_add, a czytelnik sumuje shardy. Kasjer i pracownicy
+ * mają po shardzie, turyści dzielą LICZBA_SHARDOW_TURYSTOW shardów po id.
+ * Każda linia ma własny komplet shardów; bilety kasjer liczy w linii 0.
+ *
+ * Przejście (stacja -> peron, krzesełko -> zjazd) to najpierw +1 w celu,
+ * potem -1 w źródle, a stan_migawka() sumuje źródło przed celem - osoba
+ * w trakcie przejścia może być policzona podwójnie, ale nigdy zgubiona
+ * (pętla zamykania main nie zobaczy fałszywego zera). */
+
+static inline int shard_turysty(int turysta_id) {
+    return SHARD_TURYSCI + (int)((unsigned)turysta_id % LICZBA_SHARDOW_TURYSTOW);
+}
+
+static inline void licznik_dodaj(StanWspoldzielony *stan, int linia, int shard,
+                                 Licznik licznik, int delta) {
+    atomic_fetch_add_explicit(&stan->liczniki[linia][shard].wartosc[licznik], delta,
+                              memory_order_release);
+}
+
+/* Jedna osoba/krzesełko z licznika z do licznika do_ */
+static inline void licznik_przenies(StanWspoldzielony *stan, int linia, int shard,
+                                    Licznik z, Licznik do_) {
+    licznik_dodaj(stan, linia, shard, do_, 1);
+    licznik_dodaj(stan, linia, shard, z, -1);
+}
+
+/* Suma shardów jednej linii / wszystkich linii */
+int licznik_linii(const StanWspoldzielony *stan, int linia, Licznik licznik);
+int licznik_suma(const StanWspoldzielony *stan, Licznik licznik);
+
+/* ========== MIGAWKA ========== */
+typedef struct {
+    bool kolej_aktywna;
+    bool kolej_zatrzymana;      /* Którakolwiek linia */
+    bool godziny_pracy;
+    int liczba_osob_na_stacji;
+    int liczba_osob_na_peronie;
+    int liczba_aktywnych_krzeselek;
+    int laczna_liczba_zjazdow;
+    int liczba_sprzedanych_biletow;
+} MigawkaStanu;
+
+/* Flagi spójne (seqlock), liczniki zsumowane w kolejności źródło -> cel.
+ * Zwraca liczbę ponowień (0 = pierwsza kopia flag była spójna). Po
+ * MAX_PONOWIEN_MIGAWKI (piszący zabity w trakcie zapisu i brak następnego)
+ * zwraca ostatnią kopię - każda flaga z osobna jest poprawna. */
+#define MAX_PONOWIEN_MIGAWKI 100000
+unsigned stan_migawka(const StanWspoldzielony *stan, MigawkaStanu *m);
+
+#endif
@@ -2,8 +2,11 @@
 #define TYPES_H
 
 #include <sys/types.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <time.h>
 #include <stdbool.h>
+#include <stdatomic.h>
 #include "config.h"
 
 /* ========== TYPY OSÓB ========== */
@@ -44,6 +47,18 @@ typedef enum {
     MSG_KONIEC_DNIA = 13
 } TypKomunikatu;
 
+/* mtype komunikatu do pracowników linii; linia 0 zachowuje typy 1-13 */
+#define MTYPE_NA_LINIE 100
+#define MTYPE_LINII(linia, typ) ((long)(linia) * MTYPE_NA_LINIE + (typ))
+
+/* mq_kasa: kasjer odbiera msgrcv(-MTYPE_BILET) - najmniejszy mtype
+ * pierwszy, więc prośby VIP przed zwykłymi. Bilet wraca z mtype powyżej
+ * próśb (jak MSG_KRZESLO_GOTOWE w mq_krzesla), inaczej turysta #1 i #2
+ * odbieraliby cudze prośby, a kasjer ich bilety */
+#define MTYPE_BILET_VIP 1
+#define MTYPE_BILET 2
+#define MTYPE_BILET_DLA(id) ((long)(id) + 10000)
+
 /* ========== STRUKTURA BILETU ========== */
 typedef struct {
     int id;
@@ -71,13 +86,14 @@ typedef struct {
     Bilet bilet;
     StatusTurysty status;
     int liczba_zjazdow;
+    int linia;                  /* Linia bieżącego zjazdu (linie.h) */
 } Turysta;
 
 /* ========== STRUKTURA KRZESEŁKA ========== */
 typedef struct {
     int id;
     bool aktywne;
-    int pasazerowie[POJEMNOSC_KRZESELKA];   /* ID turystów */
+    int pasazerowie[MAX_POJEMNOSC_KRZESELKA];   /* ID turystów */
     int liczba_pasazerow;
     int liczba_rowerzystow;
     time_t czas_wyjazdu;
@@ -96,52 +112,252 @@ typedef struct {
     int bilet_id;
     int turysta_id;
     time_t czas;
+    int linia;
     int numer_bramki;
     int numer_zjazdu;
+    int typ_biletu;             /* BILET_* */
 } WpisRejestru;
 
-/* ========== MAKSYMALNA LICZBA WPISÓW W REJESTRZE ========== */
-#define MAX_WPISOW_REJESTRU 2000
+/* ========== SEGMENTY REJESTRU (rejestr.h) ========== */
+/* Każda bramka wejściowa każdej linii ma własny shard rejestru
+ * (shard = linia * MAX_BRAMEK_WEJSCIOWYCH + bramka). Segment k shardu mieści
+ * POJEMNOSC_SEGMENTU_REJESTRU << k wpisów dla k < ROSNACE_SEGMENTY_REJESTRU,
+ * a dalsze po MAX_POJEMNOSC_SEGMENTU_REJESTRU (~2,5 MB - daleko poniżej
+ * domyślnego shmmax); segment powstaje dopiero, gdy poprzednie są pełne.
+ * Razem ~3,8 mln wpisów na shard */
+#define POJEMNOSC_SEGMENTU_REJESTRU 1024
+#define ROSNACE_SEGMENTY_REJESTRU   7
+#define MAX_POJEMNOSC_SEGMENTU_REJESTRU \
+    (POJEMNOSC_SEGMENTU_REJESTRU << (ROSNACE_SEGMENTY_REJESTRU - 1))
+#define MAX_SEGMENTOW_REJESTRU      64
+#define LICZBA_SHARDOW_REJESTRU     (MAX_LINII * MAX_BRAMEK_WEJSCIOWYCH)
+#define MAX_PORZUCONYCH_REJESTRU    8
 
-/* ========== STAN WSPÓŁDZIELONY ========== */
+/* shm_id czytane przy każdym dopisaniu, zmieniane raz na segment;
+ * zarezerwowane zwiększa każde przejście przez bramkę - osobna linia.
+ * porzucone: indeksy (+ 1) slotów, których pisarz nie zdołał wypełnić;
+ * zamkniety: shard bez miejsca (shmget/shmat zawiodło albo koniec segmentów)
+ * nie przyjmuje już wpisów */
 typedef struct {
-    /* Flagi systemowe */
-    bool kolej_aktywna;
-    bool kolej_zatrzymana;
-    bool godziny_pracy;
-    time_t czas_startu;
-    
-    /* Liczniki */
-    int liczba_osob_na_stacji;
-    int liczba_osob_na_peronie;
-    int liczba_aktywnych_krzeselek;
-    int nastepny_turysta_id;
-    int nastepny_bilet_id;
-    
-    /* Pracownicy */
-    pid_t pid_pracownik1;
+    atomic_int shm_id[MAX_SEGMENTOW_REJESTRU];  /* shm_id + 1, 0 = brak segmentu */
+    atomic_int porzucone[MAX_PORZUCONYCH_REJESTRU];
+    atomic_bool zamkniety;
+    _Alignas(ROZMIAR_LINII_CACHE)
+    atomic_int zarezerwowane;                   /* Następny wolny indeks shardu */
+} KatalogRejestru;
+
+/* ========== AGREGATY NA ŻYWO (agregaty.h) ========== */
+/* Kubełek k obejmuje godzinę [poczatek + k*3600, poczatek + (k+1)*3600);
+ * tablice bramek na MAX_BRAMEK_WEJSCIOWYCH, używane pierwsze
+ * konfiguracja.bramki_wejsciowe */
+#define MAX_GODZIN_AGREGATOW 48
+
+typedef struct {
+    atomic_ulong przejscia[MAX_BRAMEK_WEJSCIOWYCH];
+    atomic_ulong sprzedaze;
+    atomic_ulong przychod;                      /* zł */
+} GodzinaAgregatow;
+
+typedef struct {
+    int64_t poczatek;                           /* Pełna godzina lokalna kubełka 0 */
+    atomic_ulong zjazdy_per_typ[LICZBA_TYPOW_BILETOW];
+    atomic_ulong przejscia_per_bramka[MAX_BRAMEK_WEJSCIOWYCH];
+    atomic_ulong sprzedaze_per_typ[LICZBA_TYPOW_BILETOW];
+    atomic_ulong przychod_per_typ[LICZBA_TYPOW_BILETOW];
+    atomic_ulong nieznany_typ;                  /* Zdarzenia z typem spoza BILET_* */
+    atomic_ulong poza_godzinami;                /* Zdarzenia spoza kubełków godzin */
+    GodzinaAgregatow godziny[MAX_GODZIN_AGREGATOW];
+} AgregatyLive;
+
+/* ========== FLAGI POD SEQLOCKIEM (stan_kolei.h) ========== */
+typedef struct {
+    atomic_uint sekwencja;                      /* Nieparzysta = zapis w toku */
+    atomic_bool kolej_aktywna;
+    atomic_bool kolej_zatrzymana[MAX_LINII];    /* Każda linia zatrzymywana osobno */
+    atomic_bool godziny_pracy;
+} StanKolei;
+
+/* ========== LICZNIKI W SHARDACH PISZĄCYCH (stan_kolei.h) ========== */
+typedef enum {
+    LICZNIK_STACJA = 0,                         /* Osoby na stacji dolnej */
+    LICZNIK_PERON,                              /* Osoby na peronie */
+    LICZNIK_KRZESELKA,                          /* Aktywne krzesełka */
+    LICZNIK_ZJAZDY,                             /* Zakończone zjazdy krzesełek */
+    LICZNIK_BILETY,                             /* Sprzedane bilety */
+    LICZBA_LICZNIKOW
+} Licznik;
+
+/* Shard na rolę; turyści dzielą LICZBA_SHARDOW_TURYSTOW shardów po id */
+typedef enum {
+    SHARD_KASJER = 0,
+    SHARD_PRACOWNIK1,
+    SHARD_PRACOWNIK2,
+    SHARD_TURYSCI,
+    LICZBA_SHARDOW_LICZNIKOW = SHARD_TURYSCI + LICZBA_SHARDOW_TURYSTOW
+} ShardLicznikow;
+
+/* Każdy shard na własnej linii cache - piszący z różnych shardów
+ * nie unieważniają sobie nawzajem linii */
+typedef struct {
+    _Alignas(ROZMIAR_LINII_CACHE) atomic_int wartosc[LICZBA_LICZNIKOW];
+} LicznikiShardu;
+
+/* ========== HISTOGRAM OPÓŹNIEŃ (polityka.h) ========== */
+/* Kubełek k > 0: opóźnienie w [2^(k-1), 2^k) µs, kubełek 0: poniżej 1 µs,
+ * ostatni zbiera wszystko od ~18 min */
+#define LICZBA_KUBELKOW_OPOZNIEN 32
+
+typedef struct {
+    atomic_ulong kubelki[LICZBA_KUBELKOW_OPOZNIEN];
+    atomic_ulong maks_us;
+    atomic_ulong suma_us;                       /* Średnia dla modelu (model.h) */
+} HistogramOpoznien;
+
+/* ========== LINIA KOLEI ========== */
+/* Pola jednej linii pod jej własnym mutexem SEM_LINII(linia, SEM_IDX_LINIA),
+ * więc pracownicy różnych linii nie czekają na siebie nawzajem. Krzesełka
+ * i bramki linii mają rozmiar z konfiguracji i leżą za StanWspoldzielony
+ * (konfiguracja.h: linia_krzeselka(), linia_bramki()) */
+typedef struct {
+    /* Pracownicy i krzesełka */
+    _Alignas(ROZMIAR_LINII_CACHE) pid_t pid_pracownik1;
     pid_t pid_pracownik2;
     bool pracownik1_gotowy;
     bool pracownik2_gotowy;
     int kto_zatrzymal;          /* 1 lub 2, 0 = nikt */
+    int nastepne_krzeselko_idx;
     
-    /* Bramki */
-    Bramka bramki_wejsciowe[LICZBA_BRAMEK_WEJSCIOWYCH];
-    Bramka bramki_peronowe[LICZBA_BRAMEK_PERONOWYCH];
+    /* Spóźnienia pętli obu pracowników - bez mutexu, atomowo */
+    _Alignas(ROZMIAR_LINII_CACHE) HistogramOpoznien opoznienia;
+} Linia;
+
+/* ========== POMIARY OBSŁUGI ========== */
+/* Czekanie turystów i zapełnienie krzesełek całego ośrodka - main zapisuje
+ * je na koniec w wynik_przebiegu.txt (przeglad.c). Bez mutexu, atomowo */
+typedef struct {
+    _Alignas(ROZMIAR_LINII_CACHE) HistogramOpoznien czekanie_bilet;      /* Prośba -> bilet */
+    _Alignas(ROZMIAR_LINII_CACHE) HistogramOpoznien czekanie_bramka;     /* Limit stacji i bramka */
+    _Alignas(ROZMIAR_LINII_CACHE) HistogramOpoznien czekanie_krzeselko;  /* Prośba o peron -> krzesełko */
+    /* Zjazd od kasy (albo bramki, gdy bilet ważny) do krzesełka, osobno VIP */
+    _Alignas(ROZMIAR_LINII_CACHE) HistogramOpoznien obsluga_vip;
+    _Alignas(ROZMIAR_LINII_CACHE) HistogramOpoznien obsluga_zwykla;
     
-    /* Krzesełka */
-    Krzeselko krzeselka[MAX_AKTYWNYCH_KRZESELEK];
-    int nastepne_krzeselko_idx;
+    /* pracownik1 przy wysłaniu krzesełka */
+    _Alignas(ROZMIAR_LINII_CACHE) atomic_long krzeselka_wyslane;
+    atomic_long osoby_wyslane;
+    atomic_long miejsca_zajete;                 /* Rowerzysta zajmuje dwa */
+} PomiaryObslugi;
+
+/* ========== KONFIGURACJA CZASU WYKONANIA (konfiguracja.h) ========== */
+/* Ustalana przez main przed utworzeniem segmentu, potem tylko do odczytu */
+typedef struct {
+    int linie;                  /* 1..MAX_LINII */
+    int krzeselka;              /* Krzesełka w ruchu na linię (semafor KRZESELKA) */
+    int krzeselka_lacznie;      /* Tylko do opisu - wszystkie krzesełka linii */
+    int pojemnosc_krzeselka;    /* Miejsca; rowerzysta zajmuje dwa */
+    int max_rowerzystow;        /* Rowerzystów na krzesełku */
+    int bramki_wejsciowe;
+    int bramki_peronowe;
+    int max_osob_na_stacji;
+    int kasjerzy;               /* Procesy kasjera = okienka SEM_IDX_KASA */
+    int czas_sprzedazy_ms;      /* Obsługa klienta przy okienku */
+    int procent_vip;            /* Szansa na VIP przy wejściu turysty */
+    int czas_trasy[3];          /* T1..T3, s */
+    int czas_tk[3];             /* Ważność TK1..TK3, s */
+} KonfiguracjaKolei;
+
+/* Przesunięcia tablic linii od początku segmentu (adresy odwzorowania
+ * różnią się między procesami); 0 = linia poza konfiguracja.linie */
+typedef struct {
+    uint32_t krzeselka;         /* Krzeselko[konfiguracja.krzeselka] */
+    uint32_t bramki;            /* Bramka[wejściowe + peronowe] */
+} PrzesunieciaLinii;
+
+/* ========== NAGŁÓWEK UKŁADU STANU ========== */
+/* Proces dołączający do segmentu sprawdza nagłówek - binarka zbudowana
+ * z innym układem StanWspoldzielony nie czyta cudzych pól.
+ * STAN_WERSJA_UKLADU zwiększać przy każdej zmianie układu. */
+#define STAN_MAGIA          0x4E54534Bu   /* "KSTN" */
+#define STAN_WERSJA_UKLADU  10
+
+typedef struct {
+    uint32_t magia;
+    uint32_t wersja;
+    uint32_t rozmiar;                           /* Segment z tablicami linii */
+    uint32_t rozmiar_linii;                     /* ROZMIAR_LINII_CACHE */
+} NaglowekStanu;
+
+/* ========== STAN WSPÓŁDZIELONY ========== */
+/* Regiony zaczynają się od nowej linii cache i grupują pola według tego,
+ * kto je pisze - zapis w jednym regionie nie unieważnia linii czytanych
+ * w pętlach przez inne procesy:
+ *
+ *   naglowek, konfiguracja, tablice          pierwsza strona, PROT_READ po
+ *                                            inicjalizacji (konfiguracja.h)
+ *   czas_startu, dziennik_shm_id             stałe po starcie
+ *   kolej                                    flagi, zmieniane rzadko
+ *   liczniki                                 shard na piszącego w linii
+ *   identyfikatory                           kasjer, main (SEM_IDX_STAN)
+ *   linie                                    pracownicy linii (SEM_IDX_LINIA)
+ *   rejestr                                  każde przejście
+ *   agregaty                                 każde przejście i sprzedaż
+ *   pomiary                                  turyści i pracownik1
+ *
+ * Za strukturą - tablice linii o rozmiarach z konfiguracji. */
+#define ROZMIAR_STRONY_STANU 4096
+
+typedef struct {
+    /* Tylko do odczytu po inicjalizacji */
+    _Alignas(ROZMIAR_STRONY_STANU) NaglowekStanu naglowek;
+    KonfiguracjaKolei konfiguracja;
+    PrzesunieciaLinii tablice[MAX_LINII];
     
-    /* Statystyki */
-    int laczna_liczba_zjazdow;
-    int liczba_sprzedanych_biletow;
+    /* Stałe po starcie */
+    _Alignas(ROZMIAR_STRONY_STANU) time_t czas_startu;
+    atomic_int dziennik_shm_id;                 /* shm_id + 1, 0 = dziennik wyłączony */
+    
+    /* Flagi i liczniki czytane bez blokad (stan_kolei.h) */
+    _Alignas(ROZMIAR_LINII_CACHE) StanKolei kolej;
+    LicznikiShardu liczniki[MAX_LINII][LICZBA_SHARDOW_LICZNIKOW];
+    
+    /* Identyfikatory */
+    _Alignas(ROZMIAR_LINII_CACHE) int nastepny_turysta_id;
+    int nastepny_bilet_id;
     
-    /* Rejestr przejść */
-    WpisRejestru rejestr[MAX_WPISOW_REJESTRU];
-    int liczba_wpisow_rejestru;
+    /* Linie - pracownicy i opóźnienia */
+    _Alignas(ROZMIAR_LINII_CACHE) Linia linie[MAX_LINII];
+    
+    /* Rejestr przejść - shardy bramek w osobnych segmentach SysV */
+    _Alignas(ROZMIAR_LINII_CACHE) KatalogRejestru shardy_rejestru[LICZBA_SHARDOW_REJESTRU];
+    _Alignas(ROZMIAR_LINII_CACHE) atomic_int liczba_wpisow_rejestru;  /* Opublikowane we wszystkich shardach */
+    atomic_int odrzucone_wpisy_rejestru;        /* Przejścia, których rejestr nie przyjął */
+    
+    /* Agregaty raportu aktualizowane przy każdym przejściu i sprzedaży */
+    _Alignas(ROZMIAR_LINII_CACHE) AgregatyLive agregaty;
+    
+    /* Czekanie turystów i zapełnienie krzesełek */
+    _Alignas(ROZMIAR_LINII_CACHE) PomiaryObslugi pomiary;
 } StanWspoldzielony;
 
+#define NA_POCZATKU_LINII(pole) \
+    (offsetof(StanWspoldzielony, pole) % ROZMIAR_LINII_CACHE == 0)
+
+_Static_assert(sizeof(LicznikiShardu) == ROZMIAR_LINII_CACHE,
+               "Shard liczników musi zajmować dokładnie jedną linię cache");
+_Static_assert(offsetof(KatalogRejestru, zarezerwowane) % ROZMIAR_LINII_CACHE == 0,
+               "Licznik rezerwacji shardu rejestru musi mieć własną linię cache");
+_Static_assert(offsetof(StanWspoldzielony, czas_startu) == ROZMIAR_STRONY_STANU,
+               "Pola tylko do odczytu muszą zajmować dokładnie pierwszą stronę");
+_Static_assert(NA_POCZATKU_LINII(naglowek) && NA_POCZATKU_LINII(kolej) &&
+               NA_POCZATKU_LINII(liczniki) && NA_POCZATKU_LINII(nastepny_turysta_id) &&
+               NA_POCZATKU_LINII(linie) && NA_POCZATKU_LINII(shardy_rejestru) &&
+               NA_POCZATKU_LINII(liczba_wpisow_rejestru) && NA_POCZATKU_LINII(agregaty),
+               "Region StanWspoldzielony nie zaczyna się od linii cache");
+_Static_assert(sizeof(Linia) % ROZMIAR_LINII_CACHE == 0,
+               "Linia musi kończyć się na granicy linii cache");
+_Static_assert(sizeof(StanWspoldzielony) % ROZMIAR_LINII_CACHE == 0,
+               "StanWspoldzielony musi kończyć się na granicy linii cache");
+
 /* ========== KOMUNIKAT IPC ========== */
 typedef struct {
     long mtype;                 /* Typ komunikatu (wymagane przez System V) */
@@ -0,0 +1,89 @@
+#ifndef ZAPIS_IO_H
+#define ZAPIS_IO_H
+
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <stdbool.h>
+
+/* ========== WARSTWA ZAPISU PLIKÓW (io_uring / write) ========== */
+/* Zapisy są dokładane do partii i wysyłane jednym io_uring_enter().
+ * Gdy io_uring jest niedostępny (albo KOLEJ_IO_URING=0) każda operacja
+ * wykonywana jest od razu zwykłym write()/pwrite()/writev()/fsync(). */
+
+/* Wywoływane po zakończeniu operacji (wynik jak z write(): bajty lub -errno).
+ * Krótki zapis bufora jest dokańczany (ponowne SQE / pętla write()) i
+ * zgłaszany raz, łącznie; zapis, który nie posunął się dalej, to -EIO.
+ * Krótki zapis wektora zgłasza liczbę bajtów i błąd -EIO partii. */
+typedef void (*ZakonczenieIO)(void *dane, int wynik);
+
+/* Operacja w locie - indeks w tablicy to user_data jej SQE */
+typedef struct {
+    int rodzaj;                     /* IORING_OP_WRITE / WRITEV / FSYNC */
+    int fd;
+    const char *bufor;
+    size_t dlugosc;                 /* Łącznie (bufor lub suma wektora) */
+    size_t zapisano;
+    off_t offset;                   /* < 0 = bieżąca pozycja / O_APPEND */
+    void *dane;
+} OperacjaIO;
+
+/* ========== KONTEKST WARSTWY (jeden na wątek) ========== */
+typedef struct {
+    int fd_ring;                    /* -1 = tryb synchroniczny */
+    unsigned glebokosc;
+
+    /* Kolejka zgłoszeń (SQ) */
+    unsigned *sq_glowa;
+    unsigned *sq_ogon;
+    unsigned *sq_maska;
+    unsigned *sq_tablica;
+    struct io_uring_sqe *sqe;
+
+    /* Kolejka zakończeń (CQ) */
+    unsigned *cq_glowa;
+    unsigned *cq_ogon;
+    unsigned *cq_maska;
+    struct io_uring_cqe *cqe;
+
+    void *mapa_sq;
+    void *mapa_cq;
+    void *mapa_sqe;
+    size_t rozmiar_sq;
+    size_t rozmiar_cq;
+    size_t rozmiar_sqe;
+
+    unsigned do_wyslania;           /* Przygotowane, jeszcze nie wysłane */
+    unsigned w_locie;               /* Wysłane, bez zakończenia */
+    int pierwszy_blad;              /* Pierwszy błąd z zakończeń (-errno) */
+    ZakonczenieIO po_zakonczeniu;   /* Opcjonalne */
+
+    OperacjaIO *operacje;           /* glebokosc wpisów */
+    unsigned *wolne;                /* Stos wolnych indeksów operacje[] */
+    unsigned liczba_wolnych;
+    int fd_fsync;                   /* fsync partii (-1 = brak) */
+    bool fsync_tylko_dane;
+    bool dokonczono;                /* Zapis dokończony po fsync partii */
+
+    unsigned long liczba_wywolan;   /* Wywołania systemowe zapisu/wysyłki */
+} KontekstIO;
+
+/* ========== INICJALIZACJA / ZAMKNIĘCIE ========== */
+int io_inicjalizuj(KontekstIO *io, unsigned glebokosc, ZakonczenieIO po_zakonczeniu);
+void io_zamknij(KontekstIO *io);
+bool io_uring_aktywny(const KontekstIO *io);
+
+/* ========== DOKŁADANIE OPERACJI DO PARTII ========== */
+/* offset < 0 = bieżąca pozycja / O_APPEND. Bufor musi żyć do zakończenia. */
+int io_dodaj_zapis(KontekstIO *io, int fd, const void *bufor, size_t dlugosc,
+                   off_t offset, void *dane);
+int io_dodaj_zapis_wektor(KontekstIO *io, int fd, const struct iovec *iov,
+                          int liczba, void *dane);
+/* fsync po wszystkich wcześniejszych operacjach kontekstu */
+int io_dodaj_fsync(KontekstIO *io, int fd, bool tylko_dane, void *dane);
+
+/* ========== WYSYŁANIE I ZBIERANIE ========== */
+int io_wyslij(KontekstIO *io);                  /* Bez czekania */
+int io_zbierz(KontekstIO *io);                  /* Nieblokujące zebranie zakończeń */
+int io_czekaj_wszystkie(KontekstIO *io);        /* Wyślij i czekaj na wszystkie */
+
+#endif
@@ -0,0 +1,164 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include "agregaty.h"
+
+const char *const nazwy_typow_biletow[LICZBA_TYPOW_BILETOW] = {
+    "jednorazowy", "czasowy TK1", "czasowy TK2", "czasowy TK3", "dzienny"
+};
+
+/* ========== INICJALIZACJA ========== */
+void agregaty_inicjalizuj(AgregatyLive *a, time_t czas) {
+    struct tm tm_info;
+    localtime_r(&czas, &tm_info);
+    tm_info.tm_min = 0;
+    tm_info.tm_sec = 0;
+    a->poczatek = (int64_t)mktime(&tm_info);
+}
+
+/* Kubełek godziny lub NULL, gdy czas poza zakresem */
+static GodzinaAgregatow *godzina(AgregatyLive *a, time_t czas) {
+    int64_t roznica = (int64_t)czas - a->poczatek;
+    if (roznica < 0 || roznica >= (int64_t)MAX_GODZIN_AGREGATOW * 3600) {
+        atomic_fetch_add_explicit(&a->poza_godzinami, 1, memory_order_relaxed);
+        return NULL;
+    }
+    return &a->godziny[roznica / 3600];
+}
+
+/* ========== AKTUALIZACJA ========== */
+void agregaty_przejscie(StanWspoldzielony *stan, const WpisRejestru *wpis) {
+    AgregatyLive *a = &stan->agregaty;
+    int typ = wpis->typ_biletu - BILET_JEDNORAZOWY;
+    int bramka = wpis->numer_bramki;
+
+    if (typ >= 0 && typ < LICZBA_TYPOW_BILETOW) {
+        atomic_fetch_add_explicit(&a->zjazdy_per_typ[typ], 1, memory_order_relaxed);
+    } else {
+        atomic_fetch_add_explicit(&a->nieznany_typ, 1, memory_order_relaxed);
+    }
+
+    if (bramka < 0 || bramka >= MAX_BRAMEK_WEJSCIOWYCH) return;
+    atomic_fetch_add_explicit(&a->przejscia_per_bramka[bramka], 1, memory_order_relaxed);
+
+    GodzinaAgregatow *h = godzina(a, wpis->czas);
+    if (h != NULL) {
+        atomic_fetch_add_explicit(&h->przejscia[bramka], 1, memory_order_relaxed);
+    }
+}
+
+void agregaty_sprzedaz(StanWspoldzielony *stan, int typ_biletu, int cena, time_t czas) {
+    AgregatyLive *a = &stan->agregaty;
+    int typ = typ_biletu - BILET_JEDNORAZOWY;
+
+    if (typ >= 0 && typ < LICZBA_TYPOW_BILETOW) {
+        atomic_fetch_add_explicit(&a->sprzedaze_per_typ[typ], 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&a->przychod_per_typ[typ], (unsigned long)cena,
+                                  memory_order_relaxed);
+    } else {
+        atomic_fetch_add_explicit(&a->nieznany_typ, 1, memory_order_relaxed);
+    }
+
+    GodzinaAgregatow *h = godzina(a, czas);
+    if (h != NULL) {
+        atomic_fetch_add_explicit(&h->sprzedaze, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&h->przychod, (unsigned long)cena, memory_order_relaxed);
+    }
+}
+
+/* ========== MIGAWKA ========== */
+#define CZYTAJ(x) atomic_load_explicit(&(x), memory_order_relaxed)
+
+void agregaty_migawka(const StanWspoldzielony *stan, MigawkaAgregatow *m) {
+    const AgregatyLive *a = &stan->agregaty;
+    memset(m, 0, sizeof(MigawkaAgregatow));
+    m->poczatek = a->poczatek;
+    m->liczba_bramek = stan->konfiguracja.bramki_wejsciowe;
+
+    for (int t = 0; t < LICZBA_TYPOW_BILETOW; t++) {
+        m->zjazdy_per_typ[t] = CZYTAJ(a->zjazdy_per_typ[t]);
+        m->sprzedaze_per_typ[t] = CZYTAJ(a->sprzedaze_per_typ[t]);
+        m->przychod_per_typ[t] = CZYTAJ(a->przychod_per_typ[t]);
+        m->zjazdy += m->zjazdy_per_typ[t];
+        m->sprzedaze += m->sprzedaze_per_typ[t];
+        m->przychod += m->przychod_per_typ[t];
+    }
+    for (int b = 0; b < m->liczba_bramek; b++) {
+        m->przejscia_per_bramka[b] = CZYTAJ(a->przejscia_per_bramka[b]);
+    }
+    m->nieznany_typ = CZYTAJ(a->nieznany_typ);
+    m->poza_godzinami = CZYTAJ(a->poza_godzinami);
+
+    for (int g = 0; g < MAX_GODZIN_AGREGATOW; g++) {
+        const GodzinaAgregatow *h = &a->godziny[g];
+        GodzinaMigawki *mh = &m->godziny[g];
+        for (int b = 0; b < m->liczba_bramek; b++) {
+            mh->przejscia[b] = CZYTAJ(h->przejscia[b]);
+            mh->razem += mh->przejscia[b];
+        }
+        mh->sprzedaze = CZYTAJ(h->sprzedaze);
+        mh->przychod = CZYTAJ(h->przychod);
+        if (mh->razem > 0 || mh->sprzedaze > 0) m->liczba_godzin = g + 1;
+    }
+}
+
+/* ========== TEKST MIGAWKI ========== */
+typedef struct {
+    char *bufor;
+    size_t rozmiar;
+    size_t dlugosc;
+} Tekst;
+
+static void dopisz(Tekst *t, const char *format, ...) {
+    if (t->dlugosc + 1 >= t->rozmiar) return;
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(t->bufor + t->dlugosc, t->rozmiar - t->dlugosc, format, args);
+    va_end(args);
+    if (len > 0) {
+        t->dlugosc += ((size_t)len < t->rozmiar - t->dlugosc) ? (size_t)len
+                                                              : t->rozmiar - t->dlugosc - 1;
+    }
+}
+
+size_t agregaty_formatuj(const MigawkaAgregatow *m, char *bufor, size_t rozmiar) {
+    Tekst t = { bufor, rozmiar, 0 };
+    if (rozmiar == 0) return 0;
+    bufor[0] = '\0';
+
+    dopisz(&t, "Per typ biletu:       zjazdy  sprzedane   przychód\n");
+    for (int i = 0; i < LICZBA_TYPOW_BILETOW; i++) {
+        dopisz(&t, "- %-16s %10lu %10lu %10lu\n", nazwy_typow_biletow[i],
+               m->zjazdy_per_typ[i], m->sprzedaze_per_typ[i], m->przychod_per_typ[i]);
+    }
+    dopisz(&t, "- %-16s %10lu %10lu %10lu\n", "razem", m->zjazdy, m->sprzedaze, m->przychod);
+    dopisz(&t, "- %-16s %10lu\n", "nieznany typ", m->nieznany_typ);
+
+    dopisz(&t, "Per bramka:\n");
+    for (int b = 0; b < m->liczba_bramek; b++) {
+        dopisz(&t, "- Bramka %d: %10lu\n", b, m->przejscia_per_bramka[b]);
+    }
+
+    dopisz(&t, "Per godzina:     ");
+    for (int b = 0; b < m->liczba_bramek; b++) {
+        dopisz(&t, "      B%-3d", b);
+    }
+    dopisz(&t, "     razem sprzedane   przychód\n");
+    for (int g = 0; g < m->liczba_godzin; g++) {
+        const GodzinaMigawki *h = &m->godziny[g];
+        time_t czas = (time_t)(m->poczatek + (int64_t)g * 3600);
+        struct tm tm_info;
+        localtime_r(&czas, &tm_info);
+        char godzina_str[32];
+        strftime(godzina_str, sizeof(godzina_str), "%Y-%m-%d %H:00", &tm_info);
+
+        dopisz(&t, "%-17s", godzina_str);
+        for (int b = 0; b < m->liczba_bramek; b++) {
+            dopisz(&t, "%10lu", h->przejscia[b]);
+        }
+        dopisz(&t, "%10lu %9lu %10lu\n", h->razem, h->sprzedaze, h->przychod);
+    }
+    dopisz(&t, "Poza zakresem godzin: %10lu\n", m->poza_godzinami);
+
+    return t.dlugosc;
+}
@@ -0,0 +1,408 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <pthread.h>
+#include "analiza.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ANALIZA_X86 1
+#endif
+
+/* Dzielenie przez 3600 mnożeniem: floor(x / 3600) == (x * M) >> 43
+ * dla 0 <= x < 2^31, M = ceil(2^43 / 3600) */
+#define MNOZNIK_GODZINY 2443359173ull
+#define PRZESUNIECIE_GODZINY 43
+
+/* Liczniki 32-bitowe w rejestrach opróżniane co tyle iteracji */
+#define BLOK_LICZNIKOW (1u << 30)
+
+/* ========== WERSJE SKALARNE ========== */
+static void histogram_i32_skalar(const int32_t *k, size_t n, int32_t min, int liczba,
+                                 uint64_t *wynik) {
+    for (size_t i = 0; i < n; i++) {
+        uint32_t d = (uint32_t)(k[i] - min);
+        if (d < (uint32_t)liczba) wynik[d]++;
+    }
+}
+
+static void histogram_godzin_skalar(const int64_t *czas, size_t n, int64_t poczatek, int liczba,
+                                    uint64_t *wynik) {
+    int64_t gora = (int64_t)liczba * 3600;
+    for (size_t i = 0; i < n; i++) {
+        int64_t d = czas[i] - poczatek;
+        if (d >= 0 && d < gora) wynik[d / 3600]++;
+    }
+}
+
+static void min_max_skalar(const int64_t *k, size_t n, int64_t *min, int64_t *max) {
+    int64_t mn = k[0], mx = k[0];
+    for (size_t i = 1; i < n; i++) {
+        if (k[i] < mn) mn = k[i];
+        if (k[i] > mx) mx = k[i];
+    }
+    *min = mn;
+    *max = mx;
+}
+
+static size_t serie_skalar(const WpisIndeksu *idx, size_t n, uint32_t *poczatki) {
+    if (n == 0) return 0;
+    size_t s = 0;
+    poczatki[s++] = 0;
+    for (size_t i = 1; i < n; i++) {
+        if (idx[i].klucz != idx[i - 1].klucz) poczatki[s++] = (uint32_t)i;
+    }
+    return s;
+}
+
+#ifdef ANALIZA_X86
+/* ========== WERSJE SSE4.2 ========== */
+__attribute__((target("sse4.2"), always_inline))
+static inline size_t histogram_i32_sse_rdzen(const int32_t *k, size_t n, int32_t min,
+                                             const int liczba, uint64_t *wynik) {
+    __m128i licz[16], wart[16];
+    for (int j = 0; j < liczba; j++) {
+        licz[j] = _mm_setzero_si128();
+        wart[j] = _mm_set1_epi32(min + j);
+    }
+
+    size_t i = 0;
+    while (i + 4 <= n) {
+        size_t koniec = (n - i) / 4 < BLOK_LICZNIKOW ? n - (n - i) % 4 : i + 4 * (size_t)BLOK_LICZNIKOW;
+        for (; i < koniec; i += 4) {
+            __m128i v = _mm_loadu_si128((const __m128i *)(k + i));
+            for (int j = 0; j < liczba; j++) {
+                licz[j] = _mm_sub_epi32(licz[j], _mm_cmpeq_epi32(v, wart[j]));
+            }
+        }
+        for (int j = 0; j < liczba; j++) {
+            uint32_t t[4];
+            _mm_storeu_si128((__m128i *)t, licz[j]);
+            wynik[j] += (uint64_t)t[0] + t[1] + t[2] + t[3];
+            licz[j] = _mm_setzero_si128();
+        }
+    }
+    return i;
+}
+
+__attribute__((target("sse4.2")))
+static void histogram_i32_sse(const int32_t *k, size_t n, int32_t min, int liczba,
+                              uint64_t *wynik) {
+    size_t i;
+    switch (liczba) {
+        case 1:  i = histogram_i32_sse_rdzen(k, n, min, 1, wynik); break;
+        case 2:  i = histogram_i32_sse_rdzen(k, n, min, 2, wynik); break;
+        case 3:  i = histogram_i32_sse_rdzen(k, n, min, 3, wynik); break;
+        case 4:  i = histogram_i32_sse_rdzen(k, n, min, 4, wynik); break;
+        case 5:  i = histogram_i32_sse_rdzen(k, n, min, 5, wynik); break;
+        case 6:  i = histogram_i32_sse_rdzen(k, n, min, 6, wynik); break;
+        case 7:  i = histogram_i32_sse_rdzen(k, n, min, 7, wynik); break;
+        case 8:  i = histogram_i32_sse_rdzen(k, n, min, 8, wynik); break;
+        default: i = histogram_i32_sse_rdzen(k, n, min, liczba, wynik); break;
+    }
+    histogram_i32_skalar(k + i, n - i, min, liczba, wynik);
+}
+
+__attribute__((target("sse4.2")))
+static void histogram_godzin_sse(const int64_t *czas, size_t n, int64_t poczatek, int liczba,
+                                 uint64_t *wynik) {
+    const __m128i p = _mm_set1_epi64x(poczatek);
+    const __m128i gora = _mm_set1_epi64x((int64_t)liczba * 3600);
+    const __m128i minus_jeden = _mm_set1_epi64x(-1);
+    const __m128i mnoznik = _mm_set1_epi64x((long long)MNOZNIK_GODZINY);
+    const __m128i poza = _mm_set1_epi64x(liczba);
+
+    /* Kubełek liczba = "poza zakresem", żeby nie rozgałęziać pętli */
+    uint64_t *lok = calloc((size_t)liczba + 1, sizeof(uint64_t));
+    if (lok == NULL) {
+        histogram_godzin_skalar(czas, n, poczatek, liczba, wynik);
+        return;
+    }
+
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128i d = _mm_sub_epi64(_mm_loadu_si128((const __m128i *)(czas + i)), p);
+        __m128i ok = _mm_and_si128(_mm_cmpgt_epi64(d, minus_jeden), _mm_cmpgt_epi64(gora, d));
+        __m128i q = _mm_srli_epi64(_mm_mul_epu32(d, mnoznik), PRZESUNIECIE_GODZINY);
+        q = _mm_blendv_epi8(poza, q, ok);
+
+        uint64_t t[2];
+        _mm_storeu_si128((__m128i *)t, q);
+        lok[t[0]]++;
+        lok[t[1]]++;
+    }
+    for (int j = 0; j < liczba; j++) wynik[j] += lok[j];
+    free(lok);
+    histogram_godzin_skalar(czas + i, n - i, poczatek, liczba, wynik);
+}
+
+__attribute__((target("sse4.2")))
+static void min_max_sse(const int64_t *k, size_t n, int64_t *min, int64_t *max) {
+    __m128i mn = _mm_set1_epi64x(k[0]), mx = mn;
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(k + i));
+        mn = _mm_blendv_epi8(mn, v, _mm_cmpgt_epi64(mn, v));
+        mx = _mm_blendv_epi8(mx, v, _mm_cmpgt_epi64(v, mx));
+    }
+
+    int64_t a[2], b[2];
+    _mm_storeu_si128((__m128i *)a, mn);
+    _mm_storeu_si128((__m128i *)b, mx);
+    *min = (a[0] < a[1]) ? a[0] : a[1];
+    *max = (b[0] > b[1]) ? b[0] : b[1];
+    for (; i < n; i++) {
+        if (k[i] < *min) *min = k[i];
+        if (k[i] > *max) *max = k[i];
+    }
+}
+
+/* Klucze 4 kolejnych wpisów indeksu (co drugie int32) */
+__attribute__((target("sse4.2")))
+static inline __m128i klucze4(const WpisIndeksu *w) {
+    __m128 a = _mm_castsi128_ps(_mm_loadu_si128((const __m128i *)w));
+    __m128 b = _mm_castsi128_ps(_mm_loadu_si128((const __m128i *)(w + 2)));
+    return _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+}
+
+__attribute__((target("sse4.2")))
+static size_t serie_sse(const WpisIndeksu *idx, size_t n, uint32_t *poczatki) {
+    if (n == 0) return 0;
+    size_t s = 0;
+    poczatki[s++] = 0;
+
+    size_t i = 1;
+    for (; i + 4 <= n; i += 4) {
+        __m128i rowne = _mm_cmpeq_epi32(klucze4(idx + i), klucze4(idx + i - 1));
+        unsigned granice = ~(unsigned)_mm_movemask_ps(_mm_castsi128_ps(rowne)) & 0xF;
+        while (granice) {
+            poczatki[s++] = (uint32_t)(i + __builtin_ctz(granice));
+            granice &= granice - 1;
+        }
+    }
+    for (; i < n; i++) {
+        if (idx[i].klucz != idx[i - 1].klucz) poczatki[s++] = (uint32_t)i;
+    }
+    return s;
+}
+
+/* ========== WERSJE AVX2 ========== */
+/* Rdzeń z liczbą wartości jako stałą - po wklejeniu liczniki zostają w rejestrach */
+__attribute__((target("avx2"), always_inline))
+static inline size_t histogram_i32_avx2_rdzen(const int32_t *k, size_t n, int32_t min,
+                                              const int liczba, uint64_t *wynik) {
+    __m256i licz[16], wart[16];
+    for (int j = 0; j < liczba; j++) {
+        licz[j] = _mm256_setzero_si256();
+        wart[j] = _mm256_set1_epi32(min + j);
+    }
+
+    size_t i = 0;
+    while (i + 8 <= n) {
+        size_t koniec = (n - i) / 8 < BLOK_LICZNIKOW ? n - (n - i) % 8 : i + 8 * (size_t)BLOK_LICZNIKOW;
+        for (; i < koniec; i += 8) {
+            __m256i v = _mm256_loadu_si256((const __m256i *)(k + i));
+            for (int j = 0; j < liczba; j++) {
+                licz[j] = _mm256_sub_epi32(licz[j], _mm256_cmpeq_epi32(v, wart[j]));
+            }
+        }
+        for (int j = 0; j < liczba; j++) {
+            uint32_t t[8];
+            _mm256_storeu_si256((__m256i *)t, licz[j]);
+            wynik[j] += (uint64_t)t[0] + t[1] + t[2] + t[3] + t[4] + t[5] + t[6] + t[7];
+            licz[j] = _mm256_setzero_si256();
+        }
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static void histogram_i32_avx2(const int32_t *k, size_t n, int32_t min, int liczba,
+                               uint64_t *wynik) {
+    size_t i;
+    switch (liczba) {
+        case 1:  i = histogram_i32_avx2_rdzen(k, n, min, 1, wynik); break;
+        case 2:  i = histogram_i32_avx2_rdzen(k, n, min, 2, wynik); break;
+        case 3:  i = histogram_i32_avx2_rdzen(k, n, min, 3, wynik); break;
+        case 4:  i = histogram_i32_avx2_rdzen(k, n, min, 4, wynik); break;
+        case 5:  i = histogram_i32_avx2_rdzen(k, n, min, 5, wynik); break;
+        case 6:  i = histogram_i32_avx2_rdzen(k, n, min, 6, wynik); break;
+        case 7:  i = histogram_i32_avx2_rdzen(k, n, min, 7, wynik); break;
+        case 8:  i = histogram_i32_avx2_rdzen(k, n, min, 8, wynik); break;
+        default: i = histogram_i32_avx2_rdzen(k, n, min, liczba, wynik); break;
+    }
+    histogram_i32_skalar(k + i, n - i, min, liczba, wynik);
+}
+
+__attribute__((target("avx2")))
+static void histogram_godzin_avx2(const int64_t *czas, size_t n, int64_t poczatek, int liczba,
+                                  uint64_t *wynik) {
+    const __m256i p = _mm256_set1_epi64x(poczatek);
+    const __m256i gora = _mm256_set1_epi64x((int64_t)liczba * 3600);
+    const __m256i minus_jeden = _mm256_set1_epi64x(-1);
+    const __m256i mnoznik = _mm256_set1_epi64x((long long)MNOZNIK_GODZINY);
+    const __m256i poza = _mm256_set1_epi64x(liczba);
+
+    uint64_t *lok = calloc((size_t)liczba + 1, sizeof(uint64_t));
+    if (lok == NULL) {
+        histogram_godzin_skalar(czas, n, poczatek, liczba, wynik);
+        return;
+    }
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i d = _mm256_sub_epi64(_mm256_loadu_si256((const __m256i *)(czas + i)), p);
+        __m256i ok = _mm256_and_si256(_mm256_cmpgt_epi64(d, minus_jeden),
+                                      _mm256_cmpgt_epi64(gora, d));
+        __m256i q = _mm256_srli_epi64(_mm256_mul_epu32(d, mnoznik), PRZESUNIECIE_GODZINY);
+        q = _mm256_blendv_epi8(poza, q, ok);
+
+        uint64_t t[4];
+        _mm256_storeu_si256((__m256i *)t, q);
+        lok[t[0]]++;
+        lok[t[1]]++;
+        lok[t[2]]++;
+        lok[t[3]]++;
+    }
+    for (int j = 0; j < liczba; j++) wynik[j] += lok[j];
+    free(lok);
+    histogram_godzin_skalar(czas + i, n - i, poczatek, liczba, wynik);
+}
+
+__attribute__((target("avx2")))
+static void min_max_avx2(const int64_t *k, size_t n, int64_t *min, int64_t *max) {
+    __m256i mn = _mm256_set1_epi64x(k[0]), mx = mn;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(k + i));
+        mn = _mm256_blendv_epi8(mn, v, _mm256_cmpgt_epi64(mn, v));
+        mx = _mm256_blendv_epi8(mx, v, _mm256_cmpgt_epi64(v, mx));
+    }
+
+    int64_t a[4], b[4];
+    _mm256_storeu_si256((__m256i *)a, mn);
+    _mm256_storeu_si256((__m256i *)b, mx);
+    *min = a[0];
+    *max = b[0];
+    for (int j = 1; j < 4; j++) {
+        if (a[j] < *min) *min = a[j];
+        if (b[j] > *max) *max = b[j];
+    }
+    for (; i < n; i++) {
+        if (k[i] < *min) *min = k[i];
+        if (k[i] > *max) *max = k[i];
+    }
+}
+
+/* Klucze 8 kolejnych wpisów: shuffle w obrębie połówek, potem zamiana środkowych 64 bitów */
+__attribute__((target("avx2")))
+static inline __m256i klucze8(const WpisIndeksu *w) {
+    __m256 a = _mm256_castsi256_ps(_mm256_loadu_si256((const __m256i *)w));
+    __m256 b = _mm256_castsi256_ps(_mm256_loadu_si256((const __m256i *)(w + 4)));
+    __m256i k = _mm256_castps_si256(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+    return _mm256_permute4x64_epi64(k, _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+__attribute__((target("avx2")))
+static size_t serie_avx2(const WpisIndeksu *idx, size_t n, uint32_t *poczatki) {
+    if (n == 0) return 0;
+    size_t s = 0;
+    poczatki[s++] = 0;
+
+    size_t i = 1;
+    for (; i + 8 <= n; i += 8) {
+        __m256i rowne = _mm256_cmpeq_epi32(klucze8(idx + i), klucze8(idx + i - 1));
+        unsigned granice = ~(unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(rowne)) & 0xFF;
+        while (granice) {
+            poczatki[s++] = (uint32_t)(i + __builtin_ctz(granice));
+            granice &= granice - 1;
+        }
+    }
+    for (; i < n; i++) {
+        if (idx[i].klucz != idx[i - 1].klucz) poczatki[s++] = (uint32_t)i;
+    }
+    return s;
+}
+#endif
+
+/* ========== WYBÓR WERSJI W CZASIE DZIAŁANIA ========== */
+typedef struct {
+    void (*histogram_i32)(const int32_t *, size_t, int32_t, int, uint64_t *);
+    void (*histogram_godzin)(const int64_t *, size_t, int64_t, int, uint64_t *);
+    void (*min_max)(const int64_t *, size_t, int64_t *, int64_t *);
+    size_t (*serie)(const WpisIndeksu *, size_t, uint32_t *);
+} JadraAnalizy;
+
+static const JadraAnalizy jadra[LICZBA_POZIOMOW_SIMD] = {
+    [SIMD_SKALAR] = { histogram_i32_skalar, histogram_godzin_skalar, min_max_skalar, serie_skalar },
+#ifdef ANALIZA_X86
+    [SIMD_SSE]    = { histogram_i32_sse, histogram_godzin_sse, min_max_sse, serie_sse },
+    [SIMD_AVX2]   = { histogram_i32_avx2, histogram_godzin_avx2, min_max_avx2, serie_avx2 },
+#endif
+};
+
+static const char *nazwy_poziomow[LICZBA_POZIOMOW_SIMD] = { "skalar", "sse", "avx2" };
+
+static PoziomSimd poziom_max = SIMD_SKALAR;     /* Co obsługuje procesor */
+static PoziomSimd poziom = SIMD_SKALAR;         /* Co jest używane */
+static pthread_once_t wykryto = PTHREAD_ONCE_INIT;
+
+static void wykryj_poziom(void) {
+#ifdef ANALIZA_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        poziom_max = SIMD_AVX2;
+    } else if (__builtin_cpu_supports("sse4.2")) {
+        poziom_max = SIMD_SSE;
+    }
+#endif
+    poziom = poziom_max;
+
+    const char *wymus = getenv("KOLEJ_SIMD");
+    if (wymus != NULL) {
+        for (int p = 0; p < LICZBA_POZIOMOW_SIMD; p++) {
+            if (strcasecmp(wymus, nazwy_poziomow[p]) == 0 && (PoziomSimd)p <= poziom_max) {
+                poziom = (PoziomSimd)p;
+            }
+        }
+    }
+}
+
+PoziomSimd analiza_poziom(void) {
+    pthread_once(&wykryto, wykryj_poziom);
+    return poziom;
+}
+
+PoziomSimd analiza_ustaw_poziom(PoziomSimd nowy) {
+    pthread_once(&wykryto, wykryj_poziom);
+    poziom = (nowy < poziom_max) ? nowy : poziom_max;
+    return poziom;
+}
+
+const char *analiza_nazwa_poziomu(PoziomSimd p) {
+    return (p < LICZBA_POZIOMOW_SIMD) ? nazwy_poziomow[p] : "?";
+}
+
+/* ========== API ========== */
+void analiza_histogram_i32(const int32_t *kolumna, size_t n, int32_t min, int liczba,
+                           uint64_t *wynik) {
+    if (liczba > 16) {
+        histogram_i32_skalar(kolumna, n, min, liczba, wynik);
+        return;
+    }
+    jadra[analiza_poziom()].histogram_i32(kolumna, n, min, liczba, wynik);
+}
+
+void analiza_histogram_godzin(const int64_t *czas, size_t n, int64_t poczatek, int liczba,
+                              uint64_t *wynik) {
+    jadra[analiza_poziom()].histogram_godzin(czas, n, poczatek, liczba, wynik);
+}
+
+void analiza_min_max_i64(const int64_t *kolumna, size_t n, int64_t *min, int64_t *max) {
+    jadra[analiza_poziom()].min_max(kolumna, n, min, max);
+}
+
+size_t analiza_serie(const WpisIndeksu *indeks, size_t n, uint32_t *poczatki) {
+    return jadra[analiza_poziom()].serie(indeks, n, poczatki);
+}
@@ -0,0 +1,158 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "analiza.h"
+#include "config.h"
+
+/* ========== BENCHMARK JĄDER ANALIZY ========== */
+/* Syntetyczny dzień: n wierszy rosnąco po czasie przez 12 godzin, bramki
+ * i typy biletów losowe, ~n/4 biletów w indeksie. Każde jądro w każdej
+ * wersji obsługiwanej przez procesor: najlepszy z kilku przebiegów,
+ * wyniki porównywane z wersją skalarną.
+ *
+ * Użycie: bench_analiza [liczba_wierszy] (domyślnie 10 000 000) */
+
+#define POWTORZENIA 5
+#define GODZIN_DNIA 12
+
+typedef struct {
+    size_t n;
+    int32_t *bramka;
+    int32_t *typ;
+    int64_t *czas;
+    WpisIndeksu *indeks;
+    uint32_t *serie;
+} DaneTestowe;
+
+static double teraz_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int porownaj_indeks(const void *a, const void *b) {
+    const WpisIndeksu *x = a, *y = b;
+    if (x->klucz != y->klucz) return (x->klucz < y->klucz) ? -1 : 1;
+    return (x->wiersz < y->wiersz) ? -1 : (x->wiersz > y->wiersz);
+}
+
+static int przygotuj(DaneTestowe *d, size_t n) {
+    d->n = n;
+    d->bramka = malloc(n * sizeof(int32_t));
+    d->typ = malloc(n * sizeof(int32_t));
+    d->czas = malloc(n * sizeof(int64_t));
+    d->indeks = malloc(n * sizeof(WpisIndeksu));
+    d->serie = malloc(n * sizeof(uint32_t));
+    if (!d->bramka || !d->typ || !d->czas || !d->indeks || !d->serie) {
+        perror("malloc");
+        return -1;
+    }
+
+    srand(12345);
+    int64_t start = (int64_t)time(NULL) - GODZIN_DNIA * 3600;
+    int32_t biletow = (int32_t)(n / 4) + 1;
+    for (size_t i = 0; i < n; i++) {
+        d->bramka[i] = (rand() % 10 < 7) ? 0 : rand() % LICZBA_BRAMEK_WEJSCIOWYCH;
+        d->typ[i] = 1 + rand() % LICZBA_TYPOW_BILETOW;
+        d->czas[i] = start + (int64_t)((double)i / n * GODZIN_DNIA * 3600);
+        d->indeks[i].klucz = 1 + rand() % biletow;
+        d->indeks[i].wiersz = (uint32_t)i;
+    }
+    qsort(d->indeks, n, sizeof(WpisIndeksu), porownaj_indeks);
+    return 0;
+}
+
+/* ========== POMIAR JEDNEGO JĄDRA ========== */
+typedef enum { J_BRAMKI, J_TYPY, J_GODZINY, J_MIN_MAX, J_SERIE, LICZBA_JADER } Jadro;
+
+static const char *nazwy_jader[LICZBA_JADER] = {
+    "histogram bramek", "histogram typów", "histogram godzin", "min/max czasu", "serie biletów"
+};
+
+/* Uruchamia jądro i zwraca sumę kontrolną wyniku */
+static uint64_t uruchom(Jadro j, const DaneTestowe *d) {
+    uint64_t wynik[GODZIN_DNIA + 1] = {0};
+    uint64_t suma = 0;
+
+    switch (j) {
+        case J_BRAMKI:
+            analiza_histogram_i32(d->bramka, d->n, 0, LICZBA_BRAMEK_WEJSCIOWYCH, wynik);
+            for (int i = 0; i < LICZBA_BRAMEK_WEJSCIOWYCH; i++) suma = suma * 31 + wynik[i];
+            break;
+        case J_TYPY:
+            analiza_histogram_i32(d->typ, d->n, 1, LICZBA_TYPOW_BILETOW, wynik);
+            for (int i = 0; i < LICZBA_TYPOW_BILETOW; i++) suma = suma * 31 + wynik[i];
+            break;
+        case J_GODZINY:
+            analiza_histogram_godzin(d->czas, d->n, d->czas[0], GODZIN_DNIA + 1, wynik);
+            for (int i = 0; i <= GODZIN_DNIA; i++) suma = suma * 31 + wynik[i];
+            break;
+        case J_MIN_MAX: {
+            int64_t mn, mx;
+            analiza_min_max_i64(d->czas, d->n, &mn, &mx);
+            suma = (uint64_t)mn * 31 + (uint64_t)mx;
+            break;
+        }
+        case J_SERIE: {
+            size_t s = analiza_serie(d->indeks, d->n, d->serie);
+            suma = s;
+            for (size_t i = 0; i < s; i += s / 64 + 1) suma = suma * 31 + d->serie[i];
+            break;
+        }
+        default:
+            break;
+    }
+    return suma;
+}
+
+int main(int argc, char *argv[]) {
+    size_t n = (argc > 1) ? strtoull(argv[1], NULL, 10) : 10000000;
+    if (n < 16) n = 16;
+
+    DaneTestowe d;
+    printf("Przygotowanie %zu wierszy...\n", n);
+    if (przygotuj(&d, n) == -1) return 1;
+
+    PoziomSimd max = analiza_ustaw_poziom(SIMD_AVX2);
+    printf("Najwyższa wersja na tym procesorze: %s\n\n", analiza_nazwa_poziomu(max));
+    printf("%-18s %-8s %14s %10s  %s\n", "Jądro", "Wersja", "Wierszy/s", "Przyspiesz.", "Wynik");
+
+    int bledy = 0;
+    for (int j = 0; j < LICZBA_JADER; j++) {
+        uint64_t wzorzec = 0;
+        double czas_skalar = 0;
+
+        for (int p = SIMD_SKALAR; p <= (int)max; p++) {
+            analiza_ustaw_poziom((PoziomSimd)p);
+            double najlepszy = 1e30;
+            uint64_t suma = 0;
+            for (int r = 0; r < POWTORZENIA; r++) {
+                double t0 = teraz_s();
+                suma = uruchom((Jadro)j, &d);
+                double t = teraz_s() - t0;
+                if (t < najlepszy) najlepszy = t;
+            }
+
+            if (p == SIMD_SKALAR) {
+                wzorzec = suma;
+                czas_skalar = najlepszy;
+            }
+            bool zgodny = (suma == wzorzec);
+            if (!zgodny) bledy++;
+
+            printf("%-18s %-8s %14.0f %9.2fx  %s\n",
+                   (p == SIMD_SKALAR) ? nazwy_jader[j] : "",
+                   analiza_nazwa_poziomu((PoziomSimd)p),
+                   n / najlepszy, czas_skalar / najlepszy,
+                   zgodny ? "zgodny" : "NIEZGODNY ZE SKALARNYM");
+        }
+    }
+
+    free(d.bramka);
+    free(d.typ);
+    free(d.czas);
+    free(d.indeks);
+    free(d.serie);
+    return bledy ? 1 : 0;
+}
@@ -0,0 +1,261 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <sys/wait.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "types.h"
+
+/* ========== BENCHMARK UKŁADU STANU WSPÓŁDZIELONEGO ========== */
+/* Procesy piszące udają turystów przy bramce: licznik we własnym shardzie,
+ * rezerwacja w shardzie rejestru bramki i licznik wpisów rejestru. Proces
+ * czytający udaje pętlę main/monitora: flagi, id dziennika i katalog
+ * segmentów rejestru. Ten sam ruch idzie na dwa układy w segmencie SysV:
+ *
+ *   spakowany  - pola jak przed wyrównaniem regionów (jedno za drugim)
+ *   wyrownany  - StanWspoldzielony z types.h
+ *
+ * Wynik: ns na iterację piszącego, odczyty czytającego na sekundę i -
+ * jeśli jądro pozwala na perf_event_open - chybienia cache (HW) oraz
+ * migracje CPU (SW) wszystkich procesów.
+ *
+ * Użycie: bench_stan [piszacych] [iteracji_na_piszacego]
+ *         (domyślnie 4 i 5 000 000) */
+
+#define POWTORZENIA 3
+
+/* Pola gorących ścieżek ułożone jak przed wyrównaniem regionów */
+typedef struct {
+    atomic_uint sekwencja;
+    atomic_bool kolej_aktywna;
+    atomic_bool kolej_zatrzymana;
+    atomic_bool godziny_pracy;
+    atomic_int liczniki[LICZBA_SHARDOW_LICZNIKOW][LICZBA_LICZNIKOW];
+    int nastepny_turysta_id;
+    int nastepny_bilet_id;
+    struct {
+        atomic_int shm_id[MAX_SEGMENTOW_REJESTRU];
+        atomic_int zarezerwowane;
+    } shardy_rejestru[LICZBA_SHARDOW_REJESTRU];
+    atomic_int liczba_wpisow_rejestru;
+    atomic_int dziennik_shm_id;
+} UkladSpakowany;
+
+/* Wskaźniki do pól, na których pracują oba warianty */
+typedef struct {
+    atomic_uint *sekwencja;
+    atomic_bool *kolej_aktywna;
+    atomic_int *dziennik_shm_id;
+    atomic_int *licznik[LICZBA_SHARDOW_LICZNIKOW];
+    atomic_int *shm_id_rejestru[LICZBA_SHARDOW_REJESTRU];
+    atomic_int *zarezerwowane[LICZBA_SHARDOW_REJESTRU];
+    atomic_int *liczba_wpisow;
+} Pola;
+
+static void pola_spakowane(UkladSpakowany *u, Pola *p) {
+    p->sekwencja = &u->sekwencja;
+    p->kolej_aktywna = &u->kolej_aktywna;
+    p->dziennik_shm_id = &u->dziennik_shm_id;
+    for (int s = 0; s < LICZBA_SHARDOW_LICZNIKOW; s++) {
+        p->licznik[s] = &u->liczniki[s][LICZNIK_STACJA];
+    }
+    for (int b = 0; b < LICZBA_SHARDOW_REJESTRU; b++) {
+        p->shm_id_rejestru[b] = &u->shardy_rejestru[b].shm_id[0];
+        p->zarezerwowane[b] = &u->shardy_rejestru[b].zarezerwowane;
+    }
+    p->liczba_wpisow = &u->liczba_wpisow_rejestru;
+}
+
+static void pola_wyrownane(StanWspoldzielony *u, Pola *p) {
+    p->sekwencja = &u->kolej.sekwencja;
+    p->kolej_aktywna = &u->kolej.kolej_aktywna;
+    p->dziennik_shm_id = &u->dziennik_shm_id;
+    for (int s = 0; s < LICZBA_SHARDOW_LICZNIKOW; s++) {
+        p->licznik[s] = &u->liczniki[0][s].wartosc[LICZNIK_STACJA];
+    }
+    for (int b = 0; b < LICZBA_SHARDOW_REJESTRU; b++) {
+        p->shm_id_rejestru[b] = &u->shardy_rejestru[b].shm_id[0];
+        p->zarezerwowane[b] = &u->shardy_rejestru[b].zarezerwowane;
+    }
+    p->liczba_wpisow = &u->liczba_wpisow_rejestru;
+}
+
+static double teraz_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* ========== LICZNIKI PERF ========== */
+/* -1, gdy perf_event_open niedostępne (kontener, perf_event_paranoid) */
+static int otworz_perf(uint32_t typ, uint64_t zdarzenie) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = typ;
+    attr.config = zdarzenie;
+    attr.disabled = 1;
+    attr.inherit = 1;               /* Liczy też procesy potomne */
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static long long czytaj_perf(int fd) {
+    long long wartosc = -1;
+    if (fd < 0) return -1;
+    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    if (read(fd, &wartosc, sizeof(wartosc)) != sizeof(wartosc)) return -1;
+    return wartosc;
+}
+
+/* ========== PROCESY ========== */
+static void pisz(Pola *p, int nr, long iteracji) {
+    int shard = SHARD_TURYSCI + nr % LICZBA_SHARDOW_TURYSTOW;
+    int bramka = nr % LICZBA_SHARDOW_REJESTRU;  /* Shard (linia, bramka) */
+    for (long i = 0; i < iteracji; i++) {
+        atomic_fetch_add_explicit(p->licznik[shard], 1, memory_order_release);
+        atomic_fetch_add_explicit(p->zarezerwowane[bramka], 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(p->liczba_wpisow, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(p->licznik[shard], -1, memory_order_release);
+    }
+}
+
+/* Czyta do wyzerowania flagi przez rodzica; zwraca liczbę odczytów */
+static long czytaj(Pola *p) {
+    long odczytow = 0;
+    while (atomic_load_explicit(p->kolej_aktywna, memory_order_acquire)) {
+        atomic_load_explicit(p->sekwencja, memory_order_acquire);
+        atomic_load_explicit(p->dziennik_shm_id, memory_order_acquire);
+        for (int b = 0; b < LICZBA_SHARDOW_REJESTRU; b++) {
+            atomic_load_explicit(p->shm_id_rejestru[b], memory_order_acquire);
+        }
+        odczytow++;
+    }
+    return odczytow;
+}
+
+typedef struct {
+    double ns_na_iteracje;
+    double odczytow_na_s;
+    long long chybienia;
+    long long migracje;
+} Wynik;
+
+static int przebieg(Pola *p, int piszacych, long iteracji, atomic_long *odczyty, Wynik *w) {
+    int fd_chybienia = otworz_perf(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    int fd_migracje = otworz_perf(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS);
+
+    atomic_store(p->kolej_aktywna, true);
+    atomic_store(odczyty, 0);
+    if (fd_chybienia >= 0) ioctl(fd_chybienia, PERF_EVENT_IOC_ENABLE, 0);
+    if (fd_migracje >= 0) ioctl(fd_migracje, PERF_EVENT_IOC_ENABLE, 0);
+
+    pid_t czytelnik = fork();
+    if (czytelnik == -1) {
+        perror("fork");
+        return -1;
+    }
+    if (czytelnik == 0) {
+        atomic_store(odczyty, czytaj(p));
+        _exit(0);
+    }
+
+    double start = teraz_s();
+    for (int i = 0; i < piszacych; i++) {
+        pid_t pid = fork();
+        if (pid == -1) {
+            perror("fork");
+            break;
+        }
+        if (pid == 0) {
+            pisz(p, i, iteracji);
+            _exit(0);
+        }
+    }
+    for (int i = 0; i < piszacych; i++) wait(NULL);
+    double czas = teraz_s() - start;
+
+    atomic_store(p->kolej_aktywna, false);
+    waitpid(czytelnik, NULL, 0);
+
+    w->ns_na_iteracje = czas * 1e9 / ((double)iteracji * piszacych);
+    w->odczytow_na_s = (double)atomic_load(odczyty) / czas;
+    w->chybienia = czytaj_perf(fd_chybienia);
+    w->migracje = czytaj_perf(fd_migracje);
+    if (fd_chybienia >= 0) close(fd_chybienia);
+    if (fd_migracje >= 0) close(fd_migracje);
+    return 0;
+}
+
+static void wypisz(const char *nazwa, const Wynik *w, long iteracji, int piszacych) {
+    printf("%-10s %12.1f %14.0f", nazwa, w->ns_na_iteracje, w->odczytow_na_s);
+    if (w->chybienia >= 0) {
+        printf(" %14.3f", (double)w->chybienia / ((double)iteracji * piszacych));
+    } else {
+        printf(" %14s", "n/d");
+    }
+    if (w->migracje >= 0) {
+        printf(" %10lld\n", w->migracje);
+    } else {
+        printf(" %10s\n", "n/d");
+    }
+}
+
+/* ========== MAIN ========== */
+int main(int argc, char *argv[]) {
+    int piszacych = (argc > 1) ? atoi(argv[1]) : 4;
+    long iteracji = (argc > 2) ? atol(argv[2]) : 5000000L;
+    if (piszacych < 1 || iteracji < 1) {
+        fprintf(stderr, "Użycie: %s [piszacych] [iteracji_na_piszacego]\n", argv[0]);
+        return 1;
+    }
+
+    /* Oba układy w jednym segmencie, każdy od granicy strony */
+    size_t strona = (size_t)sysconf(_SC_PAGESIZE);
+    size_t przesuniecie = (sizeof(UkladSpakowany) + strona - 1) / strona * strona;
+    size_t rozmiar = przesuniecie + sizeof(StanWspoldzielony) + strona;
+    int shm_id = shmget(IPC_PRIVATE, rozmiar, IPC_CREAT | 0600);
+    if (shm_id == -1) {
+        perror("shmget");
+        return 1;
+    }
+    char *baza = shmat(shm_id, NULL, 0);
+    shmctl(shm_id, IPC_RMID, NULL);
+    if (baza == (void *)-1) {
+        perror("shmat");
+        return 1;
+    }
+    memset(baza, 0, rozmiar);
+
+    /* Licznik odczytów czytającego na końcu ostatniej strony */
+    atomic_long *odczyty = (atomic_long *)(baza + rozmiar - sizeof(atomic_long));
+
+    Pola spakowane, wyrownane;
+    pola_spakowane((UkladSpakowany *)baza, &spakowane);
+    pola_wyrownane((StanWspoldzielony *)(baza + przesuniecie), &wyrownane);
+
+    printf("Piszących: %d, iteracji: %ld, CPU: %ld, linia: %d B, StanWspoldzielony: %zu B\n",
+           piszacych, iteracji, sysconf(_SC_NPROCESSORS_ONLN), ROZMIAR_LINII_CACHE,
+           sizeof(StanWspoldzielony));
+    printf("%-10s %12s %14s %14s %10s\n", "układ", "ns/iterację", "odczytów/s",
+           "chybień/iter.", "migracje");
+
+    for (int r = 0; r < POWTORZENIA; r++) {
+        Wynik w;
+        if (przebieg(&spakowane, piszacych, iteracji, odczyty, &w) == 0) {
+            wypisz("spakowany", &w, iteracji, piszacych);
+        }
+        if (przebieg(&wyrownane, piszacych, iteracji, odczyty, &w) == 0) {
+            wypisz("wyrownany", &w, iteracji, piszacych);
+        }
+    }
+
+    shmdt(baza);
+    return 0;
+}
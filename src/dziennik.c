@@ -0,0 +1,518 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <pthread.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <sys/stat.h>
+#include "dziennik.h"
+#include "rejestr.h"
+#include "agregaty.h"
+#include "stan_kolei.h"
+#include "zapis_io.h"
+
+#define DOMYSLNE_OKNO_MS        10
+#define DOMYSLNA_PACZKA         256
+#define LIMIT_DZIURY_MS         1000    /* Po tym czasie niewypełniony slot jest pomijany */
+#define PROBY_ZAPISU            5       /* Zapisy partii przed uznaniem dziennika za uszkodzony */
+
+/* ========== PIERŚCIEŃ W PAMIĘCI WSPÓŁDZIELONEJ ========== */
+typedef struct {
+    WpisDziennika wpis;
+    atomic_ullong gotowy;           /* numer + 1 = wpis opublikowany (release) */
+} SlotDziennika;
+
+typedef struct {
+    atomic_ullong zarezerwowane;    /* Następny numer do rezerwacji */
+    atomic_ullong zwolnione;        /* Numery poniżej są już na dysku */
+    atomic_int pid_zapisujacego;    /* 0 = wątek zapisujący zatrzymany */
+    atomic_bool uszkodzony;         /* Partia nie trafiła na dysk - nowe wpisy odrzucane */
+    SlotDziennika sloty[POJEMNOSC_DZIENNIKA];
+} PierscienDziennika;
+
+/* Segment dołączony w tym procesie */
+static PierscienDziennika *pierscien_procesu = NULL;
+
+static PierscienDziennika *pierscien(StanWspoldzielony *stan) {
+    if (pierscien_procesu != NULL) {
+        return pierscien_procesu;
+    }
+
+    int id = atomic_load_explicit(&stan->dziennik_shm_id, memory_order_acquire);
+    if (id == 0) {
+        return NULL;
+    }
+
+    void *adres = shmat(id - 1, NULL, 0);
+    if (adres == (void *)-1) {
+        perror("shmat dziennik");
+        return NULL;
+    }
+    pierscien_procesu = adres;
+    return pierscien_procesu;
+}
+
+/* ========== SUMA KONTROLNA - FNV-1a ========== */
+static uint32_t suma_wpisu(const WpisDziennika *w) {
+    WpisDziennika kopia = *w;
+    kopia.suma = 0;
+
+    const unsigned char *b = (const unsigned char *)&kopia;
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < sizeof(kopia); i++) {
+        h ^= b[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static void spij_us(long us) {
+    struct timespec ts = { us / 1000000, (us % 1000000) * 1000 };
+    nanosleep(&ts, NULL);
+}
+
+static long teraz_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+/* ========== DOPISANIE - fetch-add + release ========== */
+static int dopisz(StanWspoldzielony *stan, WpisDziennika *w) {
+    if (atomic_load_explicit(&stan->dziennik_shm_id, memory_order_relaxed) == 0) {
+        return 0;                   /* Dziennik wyłączony */
+    }
+    PierscienDziennika *p = pierscien(stan);
+    if (p == NULL || atomic_load_explicit(&p->uszkodzony, memory_order_relaxed)) {
+        return -1;
+    }
+
+    uint64_t n = atomic_fetch_add_explicit(&p->zarezerwowane, 1, memory_order_relaxed);
+
+    /* Pełny pierścień - czekaj, aż wątek zapisujący utrwali starsze wpisy */
+    while (n - atomic_load_explicit(&p->zwolnione, memory_order_acquire) >= POJEMNOSC_DZIENNIKA) {
+        pid_t pid = atomic_load(&p->pid_zapisujacego);
+        if (pid == 0 || atomic_load(&p->uszkodzony) || (kill(pid, 0) == -1 && errno == ESRCH)) {
+            return -1;
+        }
+        spij_us(100);
+    }
+
+    w->numer = n;
+    w->suma = suma_wpisu(w);
+
+    SlotDziennika *s = &p->sloty[n % POJEMNOSC_DZIENNIKA];
+    s->wpis = *w;
+    atomic_store_explicit(&s->gotowy, n + 1, memory_order_release);
+    return 0;
+}
+
+int dziennik_przejscie(StanWspoldzielony *stan, const WpisRejestru *wpis) {
+    WpisDziennika w;
+    memset(&w, 0, sizeof(w));
+    w.typ = WPIS_PRZEJSCIE;
+    w.czas = (int64_t)wpis->czas;
+    w.bilet_id = wpis->bilet_id;
+    w.turysta_id = wpis->turysta_id;
+    w.przejscie.linia = wpis->linia;
+    w.przejscie.numer_bramki = wpis->numer_bramki;
+    w.przejscie.numer_zjazdu = wpis->numer_zjazdu;
+    w.przejscie.typ_biletu = wpis->typ_biletu;
+    return dopisz(stan, &w);
+}
+
+int dziennik_sprzedaz(StanWspoldzielony *stan, const Bilet *bilet, int cena) {
+    WpisDziennika w;
+    memset(&w, 0, sizeof(w));
+    w.typ = WPIS_SPRZEDAZ;
+    w.czas = (int64_t)bilet->czas_zakupu;
+    w.bilet_id = bilet->id;
+    w.turysta_id = bilet->wlasciciel_id;
+    w.sprzedaz.typ_biletu = bilet->typ;
+    w.sprzedaz.cena = cena;
+    return dopisz(stan, &w);
+}
+
+/* Jeden wpis na krzesełko - odtworzenie liczy z nich LICZNIK_ZJAZDY */
+int dziennik_zjazd(StanWspoldzielony *stan, int linia, int krzeselko, int pasazerowie) {
+    WpisDziennika w;
+    memset(&w, 0, sizeof(w));
+    w.typ = WPIS_ZJAZD;
+    w.czas = (int64_t)time(NULL);
+    w.zjazd.linia = linia;
+    w.zjazd.krzeselko = krzeselko;
+    w.zjazd.pasazerowie = pasazerowie;
+    return dopisz(stan, &w);
+}
+
+/* ========== WĄTEK ZAPISUJĄCY ========== */
+static struct {
+    PierscienDziennika *p;
+    int fd;
+    off_t offset;
+    uint64_t zapisane;              /* Następny numer do zebrania */
+    long dziura_od;                 /* Od kiedy czekamy na slot zapisane (0 = nie czekamy) */
+    WpisDziennika *bufor;
+    KontekstIO io;
+    pthread_t watek;
+    atomic_bool dziala;
+    long okno_ms;
+    unsigned paczka;
+    unsigned long partie;
+    unsigned long wpisy;
+    unsigned long pominiete;
+} zapis = { .fd = -1 };
+
+/* Pominięty slot zostaje w pliku jako WPIS_LUKA z jego numerem -
+ * odtworzenie wie, że w tym miejscu brakuje wpisu */
+static void wpisz_luke(WpisDziennika *w, uint64_t numer) {
+    memset(w, 0, sizeof(WpisDziennika));
+    w->typ = WPIS_LUKA;
+    w->numer = numer;
+    w->czas = (int64_t)time(NULL);
+    w->suma = suma_wpisu(w);
+    zapis.pominiete++;
+}
+
+/* Kopiuje ciągły zakres opublikowanych slotów do bufora */
+static unsigned zbierz(void) {
+    PierscienDziennika *p = zapis.p;
+    uint64_t koniec = atomic_load_explicit(&p->zarezerwowane, memory_order_acquire);
+    unsigned n = 0;
+
+    while (zapis.zapisane < koniec && n < POJEMNOSC_DZIENNIKA) {
+        SlotDziennika *s = &p->sloty[zapis.zapisane % POJEMNOSC_DZIENNIKA];
+        if (atomic_load_explicit(&s->gotowy, memory_order_acquire) != zapis.zapisane + 1) {
+            /* Piszący zarezerwował slot, ale go nie opublikował. Zwykle to
+             * chwila; proces zabity w tym miejscu zablokowałby dziennik. */
+            long teraz = teraz_ms();
+            if (zapis.dziura_od == 0) {
+                zapis.dziura_od = teraz;
+                break;
+            }
+            if (teraz - zapis.dziura_od < LIMIT_DZIURY_MS) {
+                break;
+            }
+            wpisz_luke(&zapis.bufor[n++], zapis.zapisane);
+            zapis.zapisane++;
+            zapis.dziura_od = 0;
+            continue;
+        }
+        zapis.dziura_od = 0;
+
+        zapis.bufor[n] = s->wpis;
+        if (zapis.bufor[n].suma != suma_wpisu(&zapis.bufor[n])) {
+            wpisz_luke(&zapis.bufor[n], zapis.zapisane);
+        }
+        n++;
+        zapis.zapisane++;
+    }
+    return n;
+}
+
+/* Jeden zapis i jedno fdatasync() na partię, potem zwolnienie slotów.
+ * Błąd: ta sama partia pod tym samym przesunięciem, do PROBY_ZAPISU razy;
+ * potem dziennik jest uszkodzony, a sloty partii nie wracają do puli */
+static int utrwal(unsigned n) {
+    if (n > 0) {
+        size_t dlugosc = (size_t)n * sizeof(WpisDziennika);
+        for (int proba = 1; ; proba++) {
+            io_dodaj_zapis(&zapis.io, zapis.fd, zapis.bufor, dlugosc, zapis.offset, NULL);
+            io_dodaj_fsync(&zapis.io, zapis.fd, true, NULL);
+            if (io_czekaj_wszystkie(&zapis.io) == 0) {
+                break;
+            }
+            perror("zapis dziennika");
+            if (proba == PROBY_ZAPISU) {
+                fprintf(stderr, "Dziennik: partia %lu niezapisana po %d próbach - "
+                        "kolejne wpisy odrzucane\n", zapis.partie + 1, PROBY_ZAPISU);
+                atomic_store(&zapis.p->uszkodzony, true);
+                atomic_store(&zapis.dziala, false);
+                return -1;
+            }
+            spij_us(10000L * proba);
+        }
+        zapis.offset += (off_t)dlugosc;
+        zapis.partie++;
+        zapis.wpisy += n;
+    }
+    atomic_store_explicit(&zapis.p->zwolnione, zapis.zapisane, memory_order_release);
+    return 0;
+}
+
+static void *watek_zapisujacy(void *arg) {
+    (void)arg;
+    long krok_us = (zapis.okno_ms < 1) ? 200 : 1000;
+
+    while (atomic_load(&zapis.dziala)) {
+        /* Czekaj na pełną paczkę albo koniec okna */
+        long start = teraz_ms();
+        while (atomic_load(&zapis.dziala)) {
+            uint64_t oczekujace = atomic_load(&zapis.p->zarezerwowane) - zapis.zapisane;
+            if (oczekujace >= zapis.paczka) break;
+            if (oczekujace > 0 && teraz_ms() - start >= zapis.okno_ms) break;
+            spij_us(krok_us);
+        }
+
+        uint64_t przed = zapis.zapisane;
+        unsigned n = zbierz();
+        if (zapis.zapisane != przed) {
+            utrwal(n);
+        }
+    }
+    return NULL;
+}
+
+int dziennik_uruchom(StanWspoldzielony *stan, const char *sciezka) {
+    const char *wlacz = getenv("KOLEJ_DZIENNIK");
+    if (wlacz != NULL && atoi(wlacz) == 0) {
+        return 0;
+    }
+
+    const char *ms = getenv("KOLEJ_DZIENNIK_MS");
+    const char *paczka = getenv("KOLEJ_DZIENNIK_PACZKA");
+    zapis.okno_ms = (ms != NULL) ? atol(ms) : DOMYSLNE_OKNO_MS;
+    if (zapis.okno_ms < 0) zapis.okno_ms = DOMYSLNE_OKNO_MS;
+    zapis.paczka = (paczka != NULL && atoi(paczka) > 0) ? (unsigned)atoi(paczka) : DOMYSLNA_PACZKA;
+    if (zapis.paczka > POJEMNOSC_DZIENNIKA) zapis.paczka = POJEMNOSC_DZIENNIKA;
+
+    /* Dziennik poprzedniego uruchomienia (np. przerwanego awarią) zostaje obok */
+    struct stat st;
+    if (stat(sciezka, &st) == 0 && st.st_size > (off_t)sizeof(NaglowekDziennika)) {
+        char poprzedni[300];
+        snprintf(poprzedni, sizeof(poprzedni), "%s.poprzedni", sciezka);
+        if (rename(sciezka, poprzedni) == -1) {
+            perror("rename dziennik");
+        }
+    }
+
+    zapis.fd = open(sciezka, O_CREAT | O_WRONLY | O_TRUNC, 0644);
+    if (zapis.fd == -1) {
+        perror("open dziennik");
+        return -1;
+    }
+
+    NaglowekDziennika nag = {
+        .magia = DZIENNIK_MAGIA,
+        .wersja = DZIENNIK_WERSJA,
+        .rozmiar_wpisu = sizeof(WpisDziennika),
+        .start = (int64_t)time(NULL)
+    };
+    if (pwrite(zapis.fd, &nag, sizeof(nag), 0) != (ssize_t)sizeof(nag) || fdatasync(zapis.fd) == -1) {
+        perror("nagłówek dziennika");
+        close(zapis.fd);
+        zapis.fd = -1;
+        return -1;
+    }
+    zapis.offset = sizeof(nag);
+
+    zapis.bufor = malloc(POJEMNOSC_DZIENNIKA * sizeof(WpisDziennika));
+    if (zapis.bufor == NULL) {
+        perror("malloc dziennik");
+        close(zapis.fd);
+        zapis.fd = -1;
+        return -1;
+    }
+
+    int id = shmget(IPC_PRIVATE, sizeof(PierscienDziennika), IPC_CREAT | 0660);
+    if (id == -1) {
+        perror("shmget dziennik");
+        free(zapis.bufor);
+        close(zapis.fd);
+        zapis.fd = -1;
+        return -1;
+    }
+    atomic_store_explicit(&stan->dziennik_shm_id, id + 1, memory_order_release);
+
+    zapis.p = pierscien(stan);
+    if (zapis.p == NULL) {
+        dziennik_odlacz(stan, true);
+        free(zapis.bufor);
+        close(zapis.fd);
+        zapis.fd = -1;
+        return -1;
+    }
+    atomic_store(&zapis.p->pid_zapisujacego, getpid());
+
+    /* Segment IPC_PRIVATE nie ma klucza, po którym clean-ipc by go znalazł.
+     * Oznaczony teraz zniknie po odłączeniu ostatniego procesu, a piszący
+     * uruchomieni później nadal dołączą go po identyfikatorze (Linux). */
+    if (shmctl(id, IPC_RMID, NULL) == -1) {
+        perror("shmctl IPC_RMID dziennik");
+    }
+
+    io_inicjalizuj(&zapis.io, 4, NULL);
+    atomic_store(&zapis.dziala, true);
+    if (pthread_create(&zapis.watek, NULL, watek_zapisujacy, NULL) != 0) {
+        perror("pthread_create dziennik");
+        atomic_store(&zapis.dziala, false);
+        io_zamknij(&zapis.io);
+        dziennik_odlacz(stan, true);
+        free(zapis.bufor);
+        close(zapis.fd);
+        zapis.fd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+void dziennik_zatrzymaj(void) {
+    if (zapis.fd == -1) {
+        return;
+    }
+
+    atomic_store(&zapis.dziala, false);
+    pthread_join(zapis.watek, NULL);
+
+    /* Reszta pierścienia - najwyżej do limitu dziury */
+    while (!atomic_load(&zapis.p->uszkodzony) &&
+           zapis.zapisane < atomic_load(&zapis.p->zarezerwowane)) {
+        uint64_t przed = zapis.zapisane;
+        unsigned n = zbierz();
+        if (zapis.zapisane == przed) {
+            spij_us(1000);
+            continue;
+        }
+        utrwal(n);
+    }
+
+    /* Uszkodzony dziennik zostaje bez WPIS_KONIEC - odtworzenie pokaże,
+     * że nie został zamknięty poprawnie */
+    if (!atomic_load(&zapis.p->uszkodzony)) {
+        WpisDziennika koniec;
+        memset(&koniec, 0, sizeof(koniec));
+        koniec.typ = WPIS_KONIEC;
+        koniec.numer = zapis.zapisane;
+        koniec.czas = (int64_t)time(NULL);
+        koniec.suma = suma_wpisu(&koniec);
+        zapis.bufor[0] = koniec;
+        if (utrwal(1) == 0) {
+            zapis.wpisy--;
+        }
+    }
+    atomic_store(&zapis.p->pid_zapisujacego, 0);
+
+    printf("Dziennik: %lu wpisów w %lu partiach (fdatasync), pominiętych: %lu%s\n",
+           zapis.wpisy, zapis.partie, zapis.pominiete,
+           atomic_load(&zapis.p->uszkodzony) ? ", USZKODZONY" : "");
+
+    io_zamknij(&zapis.io);
+    close(zapis.fd);
+    zapis.fd = -1;
+    free(zapis.bufor);
+    zapis.bufor = NULL;
+}
+
+/* ========== ODTWARZANIE ========== */
+int dziennik_odtworz(const char *sciezka, StanWspoldzielony *stan, WynikOdtworzenia *wynik) {
+    memset(wynik, 0, sizeof(WynikOdtworzenia));
+
+    int fd = open(sciezka, O_RDONLY);
+    if (fd == -1) {
+        perror("open dziennik");
+        return -1;
+    }
+
+    NaglowekDziennika nag;
+    if (read(fd, &nag, sizeof(nag)) != (ssize_t)sizeof(nag) ||
+        nag.magia != DZIENNIK_MAGIA || nag.wersja != DZIENNIK_WERSJA ||
+        nag.rozmiar_wpisu != sizeof(WpisDziennika)) {
+        fprintf(stderr, "%s: niepoprawny nagłówek dziennika\n", sciezka);
+        close(fd);
+        return -1;
+    }
+    agregaty_inicjalizuj(&stan->agregaty, (time_t)nag.start);   /* Godziny dnia z dziennika */
+
+    WpisDziennika bufor[256];
+    uint64_t poprzedni = 0;
+    bool pierwszy = true;
+    ssize_t przeczytane;
+
+    while ((przeczytane = read(fd, bufor, sizeof(bufor))) > 0) {
+        size_t n = (size_t)przeczytane / sizeof(WpisDziennika);
+        if ((size_t)przeczytane % sizeof(WpisDziennika) != 0) {
+            wynik->uciety_ogon = true;
+        }
+
+        for (size_t i = 0; i < n; i++) {
+            const WpisDziennika *w = &bufor[i];
+            /* Numery rosną; zły numer lub suma = niepełny zapis przed awarią */
+            if (w->suma != suma_wpisu(w) || (!pierwszy && w->numer < poprzedni)) {
+                wynik->uciety_ogon = true;
+                goto koniec;
+            }
+            pierwszy = false;
+            poprzedni = w->numer;
+
+            switch (w->typ) {
+                case WPIS_PRZEJSCIE: {
+                    WpisRejestru r = {
+                        .bilet_id = w->bilet_id,
+                        .turysta_id = w->turysta_id,
+                        .czas = (time_t)w->czas,
+                        .linia = w->przejscie.linia,
+                        .numer_bramki = w->przejscie.numer_bramki,
+                        .numer_zjazdu = w->przejscie.numer_zjazdu,
+                        .typ_biletu = w->przejscie.typ_biletu
+                    };
+                    rejestr_dopisz(stan, &r);
+                    agregaty_przejscie(stan, &r);
+                    wynik->przejscia++;
+                    break;
+                }
+                case WPIS_ZJAZD:
+                    /* Jak licznik_przenies() w pracowniku2 - zjazd to krzesełko */
+                    if (w->zjazd.linia >= 0 && w->zjazd.linia < MAX_LINII) {
+                        licznik_dodaj(stan, w->zjazd.linia, SHARD_PRACOWNIK2, LICZNIK_ZJAZDY, 1);
+                    }
+                    wynik->zjazdy++;
+                    break;
+                case WPIS_SPRZEDAZ:
+                    licznik_dodaj(stan, 0, SHARD_KASJER, LICZNIK_BILETY, 1);
+                    agregaty_sprzedaz(stan, w->sprzedaz.typ_biletu, w->sprzedaz.cena,
+                                      (time_t)w->czas);
+                    if (w->bilet_id >= stan->nastepny_bilet_id) {
+                        stan->nastepny_bilet_id = w->bilet_id + 1;
+                    }
+                    wynik->sprzedaze++;
+                    break;
+                case WPIS_LUKA:
+                    wynik->luki++;
+                    break;
+                case WPIS_KONIEC:
+                    wynik->zamkniety = true;
+                    goto koniec;
+            }
+        }
+        if ((size_t)przeczytane % sizeof(WpisDziennika) != 0) {
+            break;
+        }
+    }
+
+koniec:
+    close(fd);
+    return 0;
+}
+
+/* ========== SPRZĄTANIE ========== */
+void dziennik_odlacz(StanWspoldzielony *stan, bool usun) {
+    if (pierscien_procesu != NULL) {
+        shmdt(pierscien_procesu);
+        pierscien_procesu = NULL;
+    }
+
+    if (usun && stan != NULL) {
+        /* Zwykle już oznaczony w dziennik_uruchom() - po odłączeniu
+         * ostatniego procesu identyfikator przestaje istnieć */
+        int id = atomic_exchange(&stan->dziennik_shm_id, 0);
+        if (id != 0 && shmctl(id - 1, IPC_RMID, NULL) == -1 &&
+            errno != EINVAL && errno != EIDRM) {
+            perror("shmctl IPC_RMID dziennik");
+        }
+    }
+}
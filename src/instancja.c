@@ -0,0 +1,93 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <sys/ipc.h>
+#include <sys/stat.h>
+#include "instancja.h"
+
+#define KATALOG_LOGOW "logs"
+/* ftok() wpisuje proj w najstarszy bajt, a proj instancji 0 to litery
+ * ('A'..'S'); bajt 0x01 nie pokrywa się więc z żadnym kluczem instancji 0 */
+#define BAZA_KLUCZA   0x01000000
+
+/* ========== NUMER INSTANCJI ========== */
+int instancja_id(void) {
+    static int id = -2;             /* -2 = jeszcze nie czytano */
+    if (id != -2) return id;
+
+    const char *s = getenv("KOLEJ_INSTANCJA");
+    if (s == NULL || s[0] == '\0') {
+        id = 0;
+        return id;
+    }
+
+    char *koniec;
+    errno = 0;
+    long n = strtol(s, &koniec, 10);
+    if (errno != 0 || *koniec != '\0' || n < 0 || n > MAX_INSTANCJA) {
+        fprintf(stderr, "KOLEJ_INSTANCJA=%s: oczekiwano liczby 0-%d\n", s, MAX_INSTANCJA);
+        id = -1;
+        return id;
+    }
+    id = (int)n;
+    return id;
+}
+
+/* ========== KLUCZE SYSV ========== */
+key_t instancja_klucz(int proj) {
+    return instancja_klucz_dla(instancja_id(), proj);
+}
+
+key_t instancja_klucz_dla(int id, int proj) {
+    if (id < 0 || id > MAX_INSTANCJA) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (id == 0) {
+        return ftok("/tmp", proj);
+    }
+    return (key_t)(BAZA_KLUCZA | ((unsigned)id << 8) | (unsigned)(proj & 0xFF));
+}
+
+/* ========== NAZWY I ŚCIEŻKI ========== */
+const char *instancja_nazwa(const char *przedrostek, const char *nazwa,
+                            char *bufor, size_t rozmiar) {
+    return instancja_nazwa_dla(instancja_id(), przedrostek, nazwa, bufor, rozmiar);
+}
+
+const char *instancja_nazwa_dla(int id, const char *przedrostek, const char *nazwa,
+                                char *bufor, size_t rozmiar) {
+    if (id > 0) {
+        snprintf(bufor, rozmiar, "%skolej_%d_%s", przedrostek, id, nazwa);
+    } else {
+        snprintf(bufor, rozmiar, "%skolej_%s", przedrostek, nazwa);
+    }
+    return bufor;
+}
+
+const char *instancja_log(const char *plik, char *bufor, size_t rozmiar) {
+    int id = instancja_id();
+    if (id > 0) {
+        snprintf(bufor, rozmiar, KATALOG_LOGOW "/instancja_%d/%s", id, plik);
+    } else {
+        snprintf(bufor, rozmiar, KATALOG_LOGOW "/%s", plik);
+    }
+    return bufor;
+}
+
+int instancja_utworz_katalog_logow(void) {
+    if (mkdir(KATALOG_LOGOW, 0755) == -1 && errno != EEXIST) {
+        perror("mkdir logs");
+        return -1;
+    }
+    int id = instancja_id();
+    if (id > 0) {
+        char katalog[64];
+        snprintf(katalog, sizeof(katalog), KATALOG_LOGOW "/instancja_%d", id);
+        if (mkdir(katalog, 0755) == -1 && errno != EEXIST) {
+            perror("mkdir katalog instancji");
+            return -1;
+        }
+    }
+    return 0;
+}
@@ -4,10 +4,17 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <unistd.h>
 #include <time.h>
 #include "ipc_utils.h"
+#include "konfiguracja.h"
+#include "rejestr.h"
+#include "dziennik.h"
+#include "agregaty.h"
+#include "stan_kolei.h"
 #include "config.h"
+#include "instancja.h"
 
 /* ========== OPERACJE NA SEMAFORACH SYSTEM V ========== */
 
@@ -89,16 +96,16 @@ int sem_czekaj_timeout_sysv(int sem_id, int sem_num, int timeout_sec) {
 
 /* ========== INICJALIZACJA SEMAFORÓW SYSTEM V ========== */
 
-int inicjalizuj_semafory_sysv(SemaforySysV *sem) {
-    /* Generuj klucz używając ftok */
-    sem->klucz = ftok("/tmp", 'K');
+int inicjalizuj_semafory_sysv(SemaforySysV *sem, const KonfiguracjaKolei *k) {
+    /* Klucz w przestrzeni nazw instancji (instancja.h) */
+    sem->klucz = instancja_klucz('K');
     if (sem->klucz == -1) {
-        perror("ftok semafory");
+        perror("klucz semafory");
         return -1;
     }
     
-    /* Usuń stary zestaw jeśli istnieje */
-    int stary = semget(sem->klucz, LICZBA_SEMAFOROW, 0666);
+    /* Usuń stary zestaw jeśli istnieje (nsems 0 - także o innej liczbie semaforów) */
+    int stary = semget(sem->klucz, 0, 0666);
     if (stary != -1) {
         semctl(stary, 0, IPC_RMID);
     }
@@ -111,28 +118,34 @@ int inicjalizuj_semafory_sysv(SemaforySysV *sem) {
         return -1;
     }
     
-    /* Tablica wartości początkowych */
+    /* Tablica wartości początkowych - ten sam blok dla każdej linii;
+     * semafory bramek ponad konfigurację zostają zamknięte (0) */
     unsigned short wartosci[LICZBA_SEMAFOROW];
     
-    wartosci[SEM_IDX_STACJA_DOLNA] = MAX_OSOB_NA_STACJI;
-    wartosci[SEM_IDX_PERON] = 0;
-    wartosci[SEM_IDX_KRZESELKA] = MAX_AKTYWNYCH_KRZESELEK;
-    wartosci[SEM_IDX_KASA] = 1;
-    wartosci[SEM_IDX_REJESTR] = 1;
-    wartosci[SEM_IDX_STAN] = 1;
-    wartosci[SEM_IDX_PRACOWNIK1] = 0;
-    wartosci[SEM_IDX_PRACOWNIK2] = 0;
-    wartosci[SEM_IDX_SYNC] = 0;
-    wartosci[SEM_IDX_VIP] = 1;
-    
-    /* Bramki wejściowe - każda wolna (1) */
-    for (int i = 0; i < LICZBA_BRAMEK_WEJSCIOWYCH; i++) {
-        wartosci[SEM_IDX_BRAMKA_WEJ_BASE + i] = 1;
-    }
-    
-    /* Bramki peronowe - zamknięte (0) */
-    for (int i = 0; i < LICZBA_BRAMEK_PERONOWYCH; i++) {
-        wartosci[SEM_IDX_BRAMKA_PER_BASE + i] = 0;
+    for (int l = 0; l < MAX_LINII; l++) {
+        unsigned short *w = &wartosci[SEM_LINII(l, 0)];
+        
+        w[SEM_IDX_STACJA_DOLNA] = (unsigned short)(k->max_osob_na_stacji -
+                                                   konfiguracja_miejsca_vip(k));
+        w[SEM_IDX_PERON] = 0;
+        w[SEM_IDX_KRZESELKA] = (unsigned short)k->krzeselka;
+        w[SEM_IDX_KASA] = (unsigned short)k->kasjerzy;
+        w[SEM_IDX_STAN] = 1;
+        w[SEM_IDX_PRACOWNIK1] = 0;
+        w[SEM_IDX_PRACOWNIK2] = 0;
+        w[SEM_IDX_SYNC] = 0;
+        w[SEM_IDX_VIP] = (unsigned short)konfiguracja_miejsca_vip(k);
+        w[SEM_IDX_LINIA] = 1;
+        
+        /* Bramki wejściowe - każda wolna (1) */
+        for (int i = 0; i < MAX_BRAMEK_WEJSCIOWYCH; i++) {
+            w[SEM_IDX_BRAMKA_WEJ_BASE + i] = (i < k->bramki_wejsciowe) ? 1 : 0;
+        }
+        
+        /* Bramki peronowe - zamknięte (0) */
+        for (int i = 0; i < MAX_BRAMEK_PERONOWYCH; i++) {
+            w[SEM_IDX_BRAMKA_PER_BASE + i] = 0;
+        }
     }
     
     /* Ustaw wszystkie wartości za jednym razem */
@@ -151,9 +164,9 @@ int inicjalizuj_semafory_sysv(SemaforySysV *sem) {
 /* ========== ŁĄCZENIE Z SEMAFORAMI ========== */
 
 int polacz_semafory_sysv(SemaforySysV *sem) {
-    sem->klucz = ftok("/tmp", 'K');
+    sem->klucz = instancja_klucz('K');
     if (sem->klucz == -1) {
-        perror("ftok semafory (connect)");
+        perror("klucz semafory (connect)");
         return -1;
     }
     
@@ -177,25 +190,100 @@ void usun_semafory_sysv(SemaforySysV *sem) {
     }
 }
 
-/* ========== INICJALIZACJA PAMIĘCI WSPÓŁDZIELONEJ ========== */
+/* ========== BACKEND PAMIĘCI STANU ========== */
+
+#define ROZMIAR_STRONY_HUGETLB (2UL * 1024 * 1024)
+
+static bool env_rowne(const char *nazwa, const char *wartosc) {
+    const char *s = getenv(nazwa);
+    return s != NULL && strcmp(s, wartosc) == 0;
+}
+
+static BackendPamieci backend_z_env(void) {
+    const char *s = getenv("KOLEJ_SHM");
+    if (s == NULL || s[0] == '\0' || strcmp(s, "sysv") == 0) return PAMIEC_SYSV;
+    if (strcmp(s, "posix") == 0) return PAMIEC_POSIX;
+    if (strcmp(s, "memfd") == 0) return PAMIEC_MEMFD;
+    fprintf(stderr, "KOLEJ_SHM=%s: nieznany backend, używam sysv\n", s);
+    return PAMIEC_SYSV;
+}
+
+static size_t rozmiar_hugetlb(size_t rozmiar) {
+    return (rozmiar + ROZMIAR_STRONY_HUGETLB - 1) & ~(ROZMIAR_STRONY_HUGETLB - 1);
+}
 
-int inicjalizuj_pamiec_wspoldzielona(PamiecWspoldzielona *shm) {
-    /* Generuj klucz używając ftok */
-    shm->klucz = ftok("/tmp", 'S');
+/* posix/memfd: MAP_POPULATE - strony odwzorowane od razu, bez błędów
+ * stron przy pierwszym dotknięciu */
+static int odwzoruj_fd(PamiecWspoldzielona *shm) {
+    void *adres = mmap(NULL, shm->rozmiar, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, shm->fd, 0);
+    if (adres == MAP_FAILED) {
+        perror("mmap stanu");
+        return -1;
+    }
+    shm->stan = (StanWspoldzielony *)adres;
+    return 0;
+}
+
+/* Po dołączeniu w każdym procesie: porada THP i blokada w RAM */
+static void dostosuj_odwzorowanie(PamiecWspoldzielona *shm) {
+    if (env_rowne("KOLEJ_SHM_HUGE", "thp") &&
+        madvise(shm->stan, shm->rozmiar, MADV_HUGEPAGE) == -1) {
+        perror("madvise MADV_HUGEPAGE");
+    }
+    if (env_rowne("KOLEJ_SHM_MLOCK", "1") && mlock(shm->stan, shm->rozmiar) == -1) {
+        perror("mlock stanu");
+    }
+}
+
+static void odlacz_stan(PamiecWspoldzielona *shm) {
+    if (shm->stan == NULL) return;
+    if (shm->backend == PAMIEC_SYSV) {
+        shmdt(shm->stan);
+    } else {
+        munmap(shm->stan, shm->rozmiar);
+    }
+    shm->stan = NULL;
+}
+
+/* Nieudane dołączenie: odwzorowanie i deskryptor posix/memfd nie mogą
+ * zostać w procesie, który dalej działa (np. przeglad) */
+static void porzuc_polaczenie(PamiecWspoldzielona *shm) {
+    odlacz_stan(shm);
+    if (shm->fd != -1) {
+        close(shm->fd);
+        shm->fd = -1;
+    }
+}
+
+static int utworz_sysv(PamiecWspoldzielona *shm, size_t rozmiar) {
+    /* Klucz w przestrzeni nazw instancji (instancja.h) */
+    shm->klucz = instancja_klucz('S');
     if (shm->klucz == -1) {
-        perror("ftok shm");
+        perror("klucz shm");
         return -1;
     }
     
-    /* Usuń starą pamięć jeśli istnieje */
-    int stary = shmget(shm->klucz, sizeof(StanWspoldzielony), 0666);
+    /* Usuń starą pamięć jeśli istnieje (rozmiar 0 - także o innym rozmiarze) */
+    int stary = shmget(shm->klucz, 0, 0666);
     if (stary != -1) {
         shmctl(stary, IPC_RMID, NULL);
     }
     
     /* Utwórz nowy segment - uprawnienia 0660 */
-    shm->shm_id = shmget(shm->klucz, sizeof(StanWspoldzielony), 
-                          IPC_CREAT | IPC_EXCL | 0660);
+    shm->shm_id = -1;
+    if (env_rowne("KOLEJ_SHM_HUGE", "hugetlb")) {
+        shm->rozmiar = rozmiar_hugetlb(rozmiar);
+        shm->shm_id = shmget(shm->klucz, shm->rozmiar,
+                             IPC_CREAT | IPC_EXCL | SHM_HUGETLB | 0660);
+        if (shm->shm_id == -1) {
+            perror("shmget SHM_HUGETLB (zwykłe strony)");
+        }
+    }
+    if (shm->shm_id == -1) {
+        shm->rozmiar = rozmiar;
+        shm->shm_id = shmget(shm->klucz, shm->rozmiar, IPC_CREAT | IPC_EXCL | 0660);
+    }
     if (shm->shm_id == -1) {
         perror("shmget create");
         return -1;
@@ -205,81 +293,260 @@ int inicjalizuj_pamiec_wspoldzielona(PamiecWspoldzielona *shm) {
     shm->stan = (StanWspoldzielony *)shmat(shm->shm_id, NULL, 0);
     if (shm->stan == (void *)-1) {
         perror("shmat");
+        shm->stan = NULL;
         shmctl(shm->shm_id, IPC_RMID, NULL);
+        shm->shm_id = -1;
+        return -1;
+    }
+    return 0;
+}
+
+static int utworz_posix(PamiecWspoldzielona *shm, size_t rozmiar) {
+    char nazwa[64];
+    instancja_nazwa("/", "stan", nazwa, sizeof(nazwa));
+    shm_unlink(nazwa);
+    shm->fd = shm_open(nazwa, O_CREAT | O_EXCL | O_RDWR, 0660);
+    if (shm->fd == -1) {
+        perror("shm_open create");
+        return -1;
+    }
+    if (env_rowne("KOLEJ_SHM_HUGE", "hugetlb")) {
+        fprintf(stderr, "KOLEJ_SHM_HUGE=hugetlb wymaga memfd lub sysv - zwykłe strony\n");
+    }
+    shm->rozmiar = rozmiar;
+    if (ftruncate(shm->fd, (off_t)shm->rozmiar) == -1 || odwzoruj_fd(shm) == -1) {
+        perror("ftruncate/mmap stanu");
+        close(shm->fd);
+        shm_unlink(nazwa);
+        shm->fd = -1;
         return -1;
     }
+    return 0;
+}
+
+/* Deskryptor bez MFD_CLOEXEC - procesy potomne dziedziczą go przez exec()
+ * i znajdują w KOLEJ_SHM_FD */
+static int utworz_memfd(PamiecWspoldzielona *shm, size_t rozmiar) {
+    shm->fd = -1;
+    if (env_rowne("KOLEJ_SHM_HUGE", "hugetlb")) {
+        shm->rozmiar = rozmiar_hugetlb(rozmiar);
+        shm->fd = memfd_create("kolej_stan", MFD_HUGETLB);
+        if (shm->fd != -1 &&
+            (ftruncate(shm->fd, (off_t)shm->rozmiar) == -1 || odwzoruj_fd(shm) == -1)) {
+            close(shm->fd);
+            shm->fd = -1;
+        }
+        if (shm->fd == -1) {
+            fprintf(stderr, "memfd MFD_HUGETLB niedostępne - zwykłe strony\n");
+        }
+    }
+    if (shm->fd == -1) {
+        shm->rozmiar = rozmiar;
+        shm->fd = memfd_create("kolej_stan", 0);
+        if (shm->fd == -1) {
+            perror("memfd_create");
+            return -1;
+        }
+        if (ftruncate(shm->fd, (off_t)shm->rozmiar) == -1 || odwzoruj_fd(shm) == -1) {
+            perror("ftruncate/mmap stanu");
+            close(shm->fd);
+            shm->fd = -1;
+            return -1;
+        }
+    }
     
-    /* Inicjalizacja stanu początkowego */
-    memset(shm->stan, 0, sizeof(StanWspoldzielony));
+    char fd_str[16];
+    snprintf(fd_str, sizeof(fd_str), "%d", shm->fd);
+    setenv("KOLEJ_SHM_FD", fd_str, 1);
+    return 0;
+}
+
+/* ========== INICJALIZACJA PAMIĘCI WSPÓŁDZIELONEJ ========== */
+
+int inicjalizuj_pamiec_wspoldzielona(PamiecWspoldzielona *shm, const KonfiguracjaKolei *k) {
+    shm->backend = backend_z_env();
+    shm->shm_id = -1;
+    shm->fd = -1;
+    shm->stan = NULL;
     
-    shm->stan->kolej_aktywna = true;
-    shm->stan->kolej_zatrzymana = false;
-    shm->stan->godziny_pracy = true;
-    shm->stan->czas_startu = time(NULL);
-    shm->stan->nastepny_turysta_id = 1;
-    shm->stan->nastepny_bilet_id = 1;
+    /* StanWspoldzielony i tablice linii o rozmiarach z konfiguracji */
+    PrzesunieciaLinii tablice[MAX_LINII];
+    size_t rozmiar = konfiguracja_rozloz(k, tablice);
     
-    /* Inicjalizacja bramek */
-    for (int i = 0; i < LICZBA_BRAMEK_WEJSCIOWYCH; i++) {
-        shm->stan->bramki_wejsciowe[i].id = i;
-        shm->stan->bramki_wejsciowe[i].otwarta = true;
-        shm->stan->bramki_wejsciowe[i].aktualny_turysta_id = -1;
+    int wynik;
+    switch (shm->backend) {
+        case PAMIEC_POSIX: wynik = utworz_posix(shm, rozmiar); break;
+        case PAMIEC_MEMFD: wynik = utworz_memfd(shm, rozmiar); break;
+        default:           wynik = utworz_sysv(shm, rozmiar); break;
     }
-    
-    for (int i = 0; i < LICZBA_BRAMEK_PERONOWYCH; i++) {
-        shm->stan->bramki_peronowe[i].id = i;
-        shm->stan->bramki_peronowe[i].otwarta = false;
-        shm->stan->bramki_peronowe[i].aktualny_turysta_id = -1;
+    if (wynik == -1) {
+        return -1;
     }
+    dostosuj_odwzorowanie(shm);
+    
+    /* Inicjalizacja stanu początkowego */
+    memset(shm->stan, 0, rozmiar);
+    shm->stan->naglowek.magia = STAN_MAGIA;
+    shm->stan->naglowek.wersja = STAN_WERSJA_UKLADU;
+    shm->stan->naglowek.rozmiar = (uint32_t)rozmiar;
+    shm->stan->naglowek.rozmiar_linii = ROZMIAR_LINII_CACHE;
+    shm->stan->konfiguracja = *k;
+    memcpy(shm->stan->tablice, tablice, sizeof(tablice));
+    
+    STAN_USTAW(shm->stan, kolej_aktywna, true);
+    for (int l = 0; l < MAX_LINII; l++) {
+        STAN_USTAW(shm->stan, kolej_zatrzymana[l], false);
+    }
+    STAN_USTAW(shm->stan, godziny_pracy, true);
+    shm->stan->czas_startu = time(NULL);
+    agregaty_inicjalizuj(&shm->stan->agregaty, shm->stan->czas_startu);
+    shm->stan->nastepny_turysta_id = 1;
+    shm->stan->nastepny_bilet_id = 1;
     
-    /* Inicjalizacja krzesełek */
-    for (int i = 0; i < MAX_AKTYWNYCH_KRZESELEK; i++) {
-        shm->stan->krzeselka[i].id = i;
-        shm->stan->krzeselka[i].aktywne = false;
-        shm->stan->krzeselka[i].liczba_pasazerow = 0;
-        for (int j = 0; j < POJEMNOSC_KRZESELKA; j++) {
-            shm->stan->krzeselka[i].pasazerowie[j] = -1;
+    for (int l = 0; l < k->linie; l++) {
+        /* Inicjalizacja bramek - wejściowe, za nimi peronowe */
+        Bramka *bramki = linia_bramki(shm->stan, l);
+        for (int i = 0; i < k->bramki_wejsciowe + k->bramki_peronowe; i++) {
+            bool wejsciowa = (i < k->bramki_wejsciowe);
+            bramki[i].id = wejsciowa ? i : i - k->bramki_wejsciowe;
+            bramki[i].otwarta = wejsciowa;
+            bramki[i].aktualny_turysta_id = -1;
+        }
+        
+        /* Inicjalizacja krzesełek */
+        Krzeselko *krzeselka = linia_krzeselka(shm->stan, l);
+        for (int i = 0; i < k->krzeselka; i++) {
+            krzeselka[i].id = i;
+            krzeselka[i].aktywne = false;
+            krzeselka[i].liczba_pasazerow = 0;
+            for (int j = 0; j < MAX_POJEMNOSC_KRZESELKA; j++) {
+                krzeselka[i].pasazerowie[j] = -1;
+            }
         }
     }
     
+    /* Od tej chwili konfiguracja tylko do odczytu */
+    konfiguracja_zablokuj(shm->stan);
     return 0;
 }
 
 /* ========== ŁĄCZENIE Z PAMIĘCIĄ WSPÓŁDZIELONĄ ========== */
 
-int polacz_pamiec_wspoldzielona(PamiecWspoldzielona *shm) {
-    shm->klucz = ftok("/tmp", 'S');
+static int polacz_sysv(PamiecWspoldzielona *shm) {
+    shm->klucz = instancja_klucz('S');
     if (shm->klucz == -1) {
-        perror("ftok shm (connect)");
+        perror("klucz shm (connect)");
         return -1;
     }
     
-    shm->shm_id = shmget(shm->klucz, sizeof(StanWspoldzielony), 0660);
+    shm->shm_id = shmget(shm->klucz, 0, 0660);
     if (shm->shm_id == -1) {
         perror("shmget connect");
         return -1;
     }
     
+    struct shmid_ds info;
+    shm->rozmiar = (shmctl(shm->shm_id, IPC_STAT, &info) == 0) ? info.shm_segsz
+                                                               : sizeof(StanWspoldzielony);
+    
     shm->stan = (StanWspoldzielony *)shmat(shm->shm_id, NULL, 0);
     if (shm->stan == (void *)-1) {
         perror("shmat connect");
+        shm->stan = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+static int polacz_fd(PamiecWspoldzielona *shm) {
+    if (shm->backend == PAMIEC_POSIX) {
+        char nazwa[64];
+        shm->fd = shm_open(instancja_nazwa("/", "stan", nazwa, sizeof(nazwa)), O_RDWR, 0);
+        if (shm->fd == -1) {
+            perror("shm_open connect");
+            return -1;
+        }
+    } else {
+        const char *fd_str = getenv("KOLEJ_SHM_FD");
+        shm->fd = (fd_str != NULL) ? atoi(fd_str) : -1;
+        if (shm->fd < 0) {
+            fprintf(stderr, "KOLEJ_SHM=memfd bez KOLEJ_SHM_FD\n");
+            return -1;
+        }
+    }
+    
+    /* Rozmiar z deskryptora - memfd hugetlb jest zaokrąglony */
+    struct stat st;
+    if (fstat(shm->fd, &st) == -1) {
+        perror("fstat stanu");
+        return -1;
+    }
+    shm->rozmiar = (size_t)st.st_size;
+    if (shm->rozmiar < sizeof(StanWspoldzielony)) {
+        fprintf(stderr, "Segment stanu za mały (%zu B)\n", shm->rozmiar);
+        return -1;
+    }
+    return odwzoruj_fd(shm);
+}
+
+int polacz_pamiec_wspoldzielona(PamiecWspoldzielona *shm) {
+    shm->backend = backend_z_env();
+    shm->shm_id = -1;
+    shm->fd = -1;
+    shm->stan = NULL;
+    
+    int wynik = (shm->backend == PAMIEC_SYSV) ? polacz_sysv(shm) : polacz_fd(shm);
+    if (wynik == -1) {
+        porzuc_polaczenie(shm);
+        return -1;
+    }
+    
+    /* Segment utworzony przez binarkę z innym układem stanu; rozmiar
+     * musi się zgadzać z tablicami linii wyliczonymi z konfiguracji */
+    const NaglowekStanu *n = &shm->stan->naglowek;
+    if (n->magia != STAN_MAGIA || n->wersja != STAN_WERSJA_UKLADU ||
+        n->rozmiar_linii != ROZMIAR_LINII_CACHE) {
+        fprintf(stderr, "Niezgodny układ pamięci współdzielonej (wersja %u; oczekiwano %u)\n",
+                n->wersja, STAN_WERSJA_UKLADU);
+        porzuc_polaczenie(shm);
+        return -1;
+    }
+    PrzesunieciaLinii tablice[MAX_LINII];
+    size_t oczekiwany = konfiguracja_rozloz(&shm->stan->konfiguracja, tablice);
+    if (n->rozmiar != oczekiwany || n->rozmiar > shm->rozmiar ||
+        memcmp(tablice, shm->stan->tablice, sizeof(tablice)) != 0) {
+        fprintf(stderr, "Niezgodny rozmiar pamięci współdzielonej (%u B, odwzorowane %zu B; oczekiwano %zu B)\n",
+                n->rozmiar, shm->rozmiar, oczekiwany);
+        porzuc_polaczenie(shm);
         return -1;
     }
     
+    dostosuj_odwzorowanie(shm);
+    konfiguracja_zablokuj(shm->stan);
     return 0;
 }
 
 /* ========== USUWANIE PAMIĘCI WSPÓŁDZIELONEJ ========== */
 
 void usun_pamiec_wspoldzielona(PamiecWspoldzielona *shm) {
-    if (shm->stan && shm->stan != (void *)-1) {
-        shmdt(shm->stan);
-        shm->stan = NULL;
+    if (shm->stan) {
+        /* Segmenty rejestru znikają razem ze stanem */
+        rejestr_odlacz(shm->stan, true);
+        dziennik_odlacz(shm->stan, true);
+        odlacz_stan(shm);
     }
     if (shm->shm_id != -1) {
         shmctl(shm->shm_id, IPC_RMID, NULL);
         shm->shm_id = -1;
     }
+    if (shm->fd != -1) {
+        close(shm->fd);
+        shm->fd = -1;
+        if (shm->backend == PAMIEC_POSIX) {
+            char nazwa[64];
+            shm_unlink(instancja_nazwa("/", "stan", nazwa, sizeof(nazwa)));
+        }
+    }
 }
 
 /* ========== INICJALIZACJA KOLEJEK ========== */
@@ -289,42 +556,42 @@ int inicjalizuj_kolejki(KolejkiKomunikatow *mq) {
     key_t klucz;
     int stary;
     
-    klucz = ftok("/tmp", 'A');
+    klucz = instancja_klucz('A');
     stary = msgget(klucz, 0666);
     if (stary != -1) msgctl(stary, IPC_RMID, NULL);
     
-    klucz = ftok("/tmp", 'B');
+    klucz = instancja_klucz('B');
     stary = msgget(klucz, 0666);
     if (stary != -1) msgctl(stary, IPC_RMID, NULL);
     
-    klucz = ftok("/tmp", 'C');
+    klucz = instancja_klucz('C');
     stary = msgget(klucz, 0666);
     if (stary != -1) msgctl(stary, IPC_RMID, NULL);
     
-    klucz = ftok("/tmp", 'D');
+    klucz = instancja_klucz('D');
     stary = msgget(klucz, 0666);
     if (stary != -1) msgctl(stary, IPC_RMID, NULL);
     
     /* Tworzenie nowych kolejek - uprawnienia 0660 */
-    mq->mq_kasa = msgget(ftok("/tmp", 'A'), IPC_CREAT | IPC_EXCL | 0660);
+    mq->mq_kasa = msgget(instancja_klucz('A'), IPC_CREAT | IPC_EXCL | 0660);
     if (mq->mq_kasa == -1) {
         perror("msgget kasa");
         return -1;
     }
     
-    mq->mq_bramki = msgget(ftok("/tmp", 'B'), IPC_CREAT | IPC_EXCL | 0660);
+    mq->mq_bramki = msgget(instancja_klucz('B'), IPC_CREAT | IPC_EXCL | 0660);
     if (mq->mq_bramki == -1) {
         perror("msgget bramki");
         return -1;
     }
     
-    mq->mq_pracownicy = msgget(ftok("/tmp", 'C'), IPC_CREAT | IPC_EXCL | 0660);
+    mq->mq_pracownicy = msgget(instancja_klucz('C'), IPC_CREAT | IPC_EXCL | 0660);
     if (mq->mq_pracownicy == -1) {
         perror("msgget pracownicy");
         return -1;
     }
     
-    mq->mq_krzesla = msgget(ftok("/tmp", 'D'), IPC_CREAT | IPC_EXCL | 0660);
+    mq->mq_krzesla = msgget(instancja_klucz('D'), IPC_CREAT | IPC_EXCL | 0660);
     if (mq->mq_krzesla == -1) {
         perror("msgget krzesla");
         return -1;
@@ -336,10 +603,10 @@ int inicjalizuj_kolejki(KolejkiKomunikatow *mq) {
 /* ========== ŁĄCZENIE Z KOLEJKAMI ========== */
 
 int polacz_kolejki(KolejkiKomunikatow *mq) {
-    mq->mq_kasa = msgget(ftok("/tmp", 'A'), 0660);
-    mq->mq_bramki = msgget(ftok("/tmp", 'B'), 0660);
-    mq->mq_pracownicy = msgget(ftok("/tmp", 'C'), 0660);
-    mq->mq_krzesla = msgget(ftok("/tmp", 'D'), 0660);
+    mq->mq_kasa = msgget(instancja_klucz('A'), 0660);
+    mq->mq_bramki = msgget(instancja_klucz('B'), 0660);
+    mq->mq_pracownicy = msgget(instancja_klucz('C'), 0660);
+    mq->mq_krzesla = msgget(instancja_klucz('D'), 0660);
     
     if (mq->mq_kasa == -1 || mq->mq_bramki == -1 || 
         mq->mq_pracownicy == -1 || mq->mq_krzesla == -1) {
@@ -361,7 +628,7 @@ void usun_kolejki(KolejkiKomunikatow *mq) {
 
 /* ========== FUNKCJE ZBIORCZE ========== */
 
-int inicjalizuj_wszystkie_zasoby(ZasobyIPC *zasoby) {
+int inicjalizuj_wszystkie_zasoby(ZasobyIPC *zasoby, const KonfiguracjaKolei *k) {
     memset(zasoby, 0, sizeof(ZasobyIPC));
     zasoby->sem.sem_id = -1;
     zasoby->shm.shm_id = -1;
@@ -370,12 +637,12 @@ int inicjalizuj_wszystkie_zasoby(ZasobyIPC *zasoby) {
     zasoby->mq.mq_pracownicy = -1;
     zasoby->mq.mq_krzesla = -1;
     
-    if (inicjalizuj_semafory_sysv(&zasoby->sem) == -1) {
+    if (inicjalizuj_semafory_sysv(&zasoby->sem, k) == -1) {
         fprintf(stderr, "Błąd inicjalizacji semaforów\n");
         return -1;
     }
     
-    if (inicjalizuj_pamiec_wspoldzielona(&zasoby->shm) == -1) {
+    if (inicjalizuj_pamiec_wspoldzielona(&zasoby->shm, k) == -1) {
         fprintf(stderr, "Błąd inicjalizacji pamięci współdzielonej\n");
         usun_semafory_sysv(&zasoby->sem);
         return -1;
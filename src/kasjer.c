@@ -9,10 +9,15 @@
 #include "types.h"
 #include "ipc_utils.h"
 #include "logger.h"
+#include "instancja.h"
+#include "dziennik.h"
+#include "stan_kolei.h"
+#include "agregaty.h"
 
 static volatile sig_atomic_t kasjer_dzialaj = 1;
 static ZasobyIPC kasjer_zasoby;
 static int zasoby_polaczone = 0;
+static int kasjer_nr = 0;           /* Okienko 0..konfiguracja.kasjerzy-1 */
 
 static void kasjer_obsluz_sygnal(int sig, siginfo_t *info, void *context) {
     (void)info; (void)context; (void)sig;
@@ -62,8 +67,8 @@ Bilet utworz_bilet(int typ, bool vip, int wlasciciel_id) {
     
     sem_czekaj_sysv(sem_id, SEM_IDX_STAN);
     bilet.id = stan->nastepny_bilet_id++;
-    stan->liczba_sprzedanych_biletow++;
     sem_sygnalizuj_sysv(sem_id, SEM_IDX_STAN);
+    licznik_dodaj(stan, 0, SHARD_KASJER, LICZNIK_BILETY, 1);
     
     bilet.typ = typ;
     bilet.czas_zakupu = time(NULL);
@@ -79,15 +84,15 @@ Bilet utworz_bilet(int typ, bool vip, int wlasciciel_id) {
             break;
         case BILET_CZASOWY_TK1:
             bilet.max_uzyc = -1;
-            bilet.czas_waznosci = bilet.czas_zakupu + CZAS_TK1;
+            bilet.czas_waznosci = bilet.czas_zakupu + stan->konfiguracja.czas_tk[0];
             break;
         case BILET_CZASOWY_TK2:
             bilet.max_uzyc = -1;
-            bilet.czas_waznosci = bilet.czas_zakupu + CZAS_TK2;
+            bilet.czas_waznosci = bilet.czas_zakupu + stan->konfiguracja.czas_tk[1];
             break;
         case BILET_CZASOWY_TK3:
             bilet.max_uzyc = -1;
-            bilet.czas_waznosci = bilet.czas_zakupu + CZAS_TK3;
+            bilet.czas_waznosci = bilet.czas_zakupu + stan->konfiguracja.czas_tk[2];
             break;
         case BILET_DZIENNY:
             bilet.max_uzyc = -1;
@@ -119,9 +124,14 @@ void obsluz_klienta(Komunikat *prosba) {
     
     LOG_I("KASJER: Wydaję bilet #%d, cena: %d zł", bilet.id, cena);
     
+    if (dziennik_sprzedaz(kasjer_zasoby.shm.stan, &bilet, cena) == -1) {
+        LOG_E("KASJER: Nie udało się zapisać sprzedaży biletu #%d w dzienniku", bilet.id);
+    }
+    agregaty_sprzedaz(kasjer_zasoby.shm.stan, bilet.typ, cena, bilet.czas_zakupu);
+    
     Komunikat odpowiedz;
     memset(&odpowiedz, 0, sizeof(Komunikat));
-    odpowiedz.mtype = turysta_id;
+    odpowiedz.mtype = MTYPE_BILET_DLA(turysta_id);
     odpowiedz.typ_komunikatu = MSG_BILET_WYDANY;
     odpowiedz.nadawca_id = 0;
     odpowiedz.dane[0] = bilet.id;
@@ -134,8 +144,19 @@ void obsluz_klienta(Komunikat *prosba) {
     wyslij_komunikat(kasjer_zasoby.mq.mq_kasa, &odpowiedz);
 }
 
+/* Obsługa klienta przy okienku; select() przerywa sygnał zakończenia */
+static void czas_sprzedazy(int ms) {
+    if (ms <= 0) return;
+    struct timeval tv;
+    tv.tv_sec = ms / 1000;
+    tv.tv_usec = (ms % 1000) * 1000;
+    select(0, NULL, NULL, NULL, &tv);
+}
+
 int main(int argc, char *argv[]) {
-    (void)argc; (void)argv;
+    if (argc > 1) {
+        kasjer_nr = atoi(argv[1]);
+    }
     
     kasjer_ustaw_sygnaly();
     
@@ -145,41 +166,44 @@ int main(int argc, char *argv[]) {
     }
     zasoby_polaczone = 1;
     
-    logger_init("logs/kasjer.log");
-    LOG_I("KASJER: Rozpoczynam pracę (PID: %d)", getpid());
+    char sciezka_logu[256];
+    logger_init(instancja_log("kasjer.log", sciezka_logu, sizeof(sciezka_logu)));
+    LOG_I("KASJER: Okienko %d - rozpoczynam pracę (PID: %d)", kasjer_nr, getpid());
     
     StanWspoldzielony *stan = kasjer_zasoby.shm.stan;
     int sem_id = kasjer_zasoby.sem.sem_id;
     
     while (kasjer_dzialaj) {
         /* Sprawdź stan kolei */
-        if (!stan->kolej_aktywna) {
+        if (!STAN_CZYTAJ(stan, kolej_aktywna)) {
             break;
         }
         
+        /* -MTYPE_BILET: najpierw prośby VIP (MTYPE_BILET_VIP), potem zwykłe */
         Komunikat prosba;
         int wynik = odbierz_komunikat_nieblokujaco(kasjer_zasoby.mq.mq_kasa, 
-                                                    &prosba, MSG_PROSBA_O_BILET);
+                                                    &prosba, -MTYPE_BILET);
         
         if (!kasjer_dzialaj) break;
         
         if (wynik > 0) {
             sem_czekaj_sysv(sem_id, SEM_IDX_KASA);
+            czas_sprzedazy(stan->konfiguracja.czas_sprzedazy_ms);
             if (kasjer_dzialaj) {
                 obsluz_klienta(&prosba);
             }
             sem_sygnalizuj_sysv(sem_id, SEM_IDX_KASA);
         } else if (wynik == 0) {
-            /* BLOKUJĄCE czekanie 10ms gdy brak komunikatów */
+            /* BLOKUJĄCE czekanie OKRES_KASJERA_MS gdy brak komunikatów */
             struct timeval tv;
             tv.tv_sec = 0;
-            tv.tv_usec = 10000;
+            tv.tv_usec = OKRES_KASJERA_MS * 1000;
             select(0, NULL, NULL, NULL, &tv);
         }
     }
     
-    LOG_I("KASJER: Kończę pracę. Sprzedano %d biletów.", 
-          stan->liczba_sprzedanych_biletow);
+    LOG_I("KASJER: Okienko %d kończy pracę. Sprzedano łącznie %d biletów.",
+          kasjer_nr, licznik_suma(stan, LICZNIK_BILETY));
     logger_close();
     
     return 0;
@@ -0,0 +1,192 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "konfiguracja.h"
+
+/* ========== WARTOŚCI DOMYŚLNE ========== */
+void konfiguracja_domyslna(KonfiguracjaKolei *k) {
+    memset(k, 0, sizeof(KonfiguracjaKolei));
+    k->linie = 1;
+    k->krzeselka = MAX_AKTYWNYCH_KRZESELEK;
+    k->krzeselka_lacznie = LICZBA_KRZESELEK;
+    k->pojemnosc_krzeselka = POJEMNOSC_KRZESELKA;
+    k->max_rowerzystow = MAX_ROWERZYSTOW_NA_KRZESELKU;
+    k->bramki_wejsciowe = LICZBA_BRAMEK_WEJSCIOWYCH;
+    k->bramki_peronowe = LICZBA_BRAMEK_PERONOWYCH;
+    k->max_osob_na_stacji = MAX_OSOB_NA_STACJI;
+    k->kasjerzy = LICZBA_KASJEROW;
+    k->czas_sprzedazy_ms = CZAS_SPRZEDAZY_MS;
+    k->procent_vip = PROCENT_VIP;
+    k->czas_trasy[0] = CZAS_TRASY_T1;
+    k->czas_trasy[1] = CZAS_TRASY_T2;
+    k->czas_trasy[2] = CZAS_TRASY_T3;
+    k->czas_tk[0] = CZAS_TK1;
+    k->czas_tk[1] = CZAS_TK2;
+    k->czas_tk[2] = CZAS_TK3;
+}
+
+/* ========== KLUCZE ========== */
+typedef struct {
+    const char *nazwa;
+    size_t przesuniecie;        /* Pole int w KonfiguracjaKolei */
+    int min;
+    int max;
+} KluczKonfiguracji;
+
+#define DOBA 86400
+#define KLUCZ(nazwa, pole, min, max) { nazwa, offsetof(KonfiguracjaKolei, pole), min, max }
+
+static const KluczKonfiguracji klucze[] = {
+    KLUCZ("linie",               linie,               1, MAX_LINII),
+    KLUCZ("krzeselka",           krzeselka,           1, MAX_KRZESELEK_LINII),
+    KLUCZ("krzeselka_lacznie",   krzeselka_lacznie,   1, 100 * MAX_KRZESELEK_LINII),
+    KLUCZ("pojemnosc_krzeselka", pojemnosc_krzeselka, 2, MAX_POJEMNOSC_KRZESELKA),
+    KLUCZ("max_rowerzystow",     max_rowerzystow,     1, MAX_POJEMNOSC_KRZESELKA / 2),
+    KLUCZ("bramki_wejsciowe",    bramki_wejsciowe,    1, MAX_BRAMEK_WEJSCIOWYCH),
+    KLUCZ("bramki_peronowe",     bramki_peronowe,     1, MAX_BRAMEK_PERONOWYCH),
+    KLUCZ("max_osob_na_stacji",  max_osob_na_stacji,  1, MAX_LIMIT_STACJI),
+    KLUCZ("kasjerzy",            kasjerzy,            1, MAX_KASJEROW),
+    KLUCZ("czas_sprzedazy_ms",   czas_sprzedazy_ms,   0, 60000),
+    KLUCZ("procent_vip",         procent_vip,         0, 100),
+    KLUCZ("czas_trasy_t1",       czas_trasy[0],       0, DOBA),
+    KLUCZ("czas_trasy_t2",       czas_trasy[1],       0, DOBA),
+    KLUCZ("czas_trasy_t3",       czas_trasy[2],       0, DOBA),
+    KLUCZ("czas_tk1",            czas_tk[0],          1, DOBA),
+    KLUCZ("czas_tk2",            czas_tk[1],          1, DOBA),
+    KLUCZ("czas_tk3",            czas_tk[2],          1, DOBA),
+};
+
+#define LICZBA_KLUCZY ((int)(sizeof(klucze) / sizeof(klucze[0])))
+
+int konfiguracja_ustaw(KonfiguracjaKolei *k, const char *klucz, const char *wartosc) {
+    for (int i = 0; i < LICZBA_KLUCZY; i++) {
+        const KluczKonfiguracji *opis = &klucze[i];
+        if (strcmp(klucz, opis->nazwa) != 0) continue;
+
+        char *koniec;
+        errno = 0;
+        long n = strtol(wartosc, &koniec, 10);
+        if (errno != 0 || koniec == wartosc || *koniec != '\0' ||
+            n < opis->min || n > opis->max) {
+            fprintf(stderr, "Konfiguracja %s=%s: oczekiwano liczby %d-%d\n",
+                    klucz, wartosc, opis->min, opis->max);
+            return -1;
+        }
+        *(int *)((char *)k + opis->przesuniecie) = (int)n;
+        return 0;
+    }
+    fprintf(stderr, "Konfiguracja: nieznany klucz '%s'\n", klucz);
+    return -1;
+}
+
+/* Tekst bez białych znaków na początku i końcu - modyfikuje bufor */
+static char *przytnij(char *s) {
+    while (isspace((unsigned char)*s)) s++;
+    char *koniec = s + strlen(s);
+    while (koniec > s && isspace((unsigned char)koniec[-1])) koniec--;
+    *koniec = '\0';
+    return s;
+}
+
+/* "klucz = wartość" - bufor modyfikowany */
+static int ustaw_wiersz(KonfiguracjaKolei *k, char *wiersz) {
+    char *rowna = strchr(wiersz, '=');
+    if (rowna == NULL) {
+        fprintf(stderr, "Konfiguracja: oczekiwano klucz=wartość, jest '%s'\n", wiersz);
+        return -1;
+    }
+    *rowna = '\0';
+    return konfiguracja_ustaw(k, przytnij(wiersz), przytnij(rowna + 1));
+}
+
+int konfiguracja_ustaw_pare(KonfiguracjaKolei *k, const char *para) {
+    char bufor[128];
+    if (strlen(para) >= sizeof(bufor)) {
+        fprintf(stderr, "Konfiguracja: za długie '%s'\n", para);
+        return -1;
+    }
+    strcpy(bufor, para);
+    return ustaw_wiersz(k, bufor);
+}
+
+/* ========== PLIK ========== */
+int konfiguracja_wczytaj_plik(KonfiguracjaKolei *k, const char *sciezka) {
+    FILE *f = fopen(sciezka, "r");
+    if (f == NULL) {
+        perror(sciezka);
+        return -1;
+    }
+
+    char wiersz[256];
+    int numer = 0;
+    int wynik = 0;
+    while (fgets(wiersz, sizeof(wiersz), f) != NULL) {
+        numer++;
+        char *komentarz = strchr(wiersz, '#');
+        if (komentarz != NULL) *komentarz = '\0';
+        char *tresc = przytnij(wiersz);
+        if (tresc[0] == '\0') continue;
+
+        if (ustaw_wiersz(k, tresc) == -1) {
+            fprintf(stderr, "%s:%d: błędny wiersz\n", sciezka, numer);
+            wynik = -1;
+            break;
+        }
+    }
+    fclose(f);
+    return wynik;
+}
+
+/* ========== ZALEŻNOŚCI ========== */
+int konfiguracja_sprawdz(const KonfiguracjaKolei *k) {
+    if (k->krzeselka_lacznie < k->krzeselka) {
+        fprintf(stderr, "Konfiguracja: krzeselka_lacznie (%d) < krzeselka (%d)\n",
+                k->krzeselka_lacznie, k->krzeselka);
+        return -1;
+    }
+    if (2 * k->max_rowerzystow > k->pojemnosc_krzeselka) {
+        fprintf(stderr, "Konfiguracja: %d rowerzystów nie mieści się na krzesełku %d-osobowym\n",
+                k->max_rowerzystow, k->pojemnosc_krzeselka);
+        return -1;
+    }
+    return 0;
+}
+
+/* ========== UKŁAD TABLIC LINII ========== */
+static size_t do_linii_cache(size_t n) {
+    return (n + ROZMIAR_LINII_CACHE - 1) & ~(size_t)(ROZMIAR_LINII_CACHE - 1);
+}
+
+/* Każda tablica od nowej linii cache - krzesełka jednej linii nie dzielą
+ * linii z bramkami ani z krzesełkami sąsiedniej linii */
+size_t konfiguracja_rozloz(const KonfiguracjaKolei *k, PrzesunieciaLinii tablice[MAX_LINII]) {
+    size_t koniec = sizeof(StanWspoldzielony);
+    memset(tablice, 0, MAX_LINII * sizeof(PrzesunieciaLinii));
+    for (int l = 0; l < k->linie; l++) {
+        tablice[l].krzeselka = (uint32_t)koniec;
+        koniec = do_linii_cache(koniec + (size_t)k->krzeselka * sizeof(Krzeselko));
+        tablice[l].bramki = (uint32_t)koniec;
+        koniec = do_linii_cache(koniec + (size_t)(k->bramki_wejsciowe + k->bramki_peronowe) *
+                                         sizeof(Bramka));
+    }
+    return koniec;
+}
+
+/* ========== OCHRONA PIERWSZEJ STRONY ========== */
+int konfiguracja_zablokuj(StanWspoldzielony *stan) {
+    long strona = sysconf(_SC_PAGESIZE);
+    if (strona <= 0 || ROZMIAR_STRONY_STANU % strona != 0) {
+        return 0;
+    }
+    if (mprotect(stan, ROZMIAR_STRONY_STANU, PROT_READ) == -1) {
+        /* EINVAL - odwzorowanie hugetlb nie dzieli się na zwykłe strony */
+        if (errno == EINVAL) return 0;
+        perror("mprotect konfiguracji");
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,112 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sched.h>
+#include "linie.h"
+#include "instancja.h"
+#include "stan_kolei.h"
+
+/* ========== LICZBA LINII ========== */
+int linie_liczba_z_env(void) {
+    const char *s = getenv("KOLEJ_LINIE");
+    if (s == NULL || s[0] == '\0') {
+        return 1;
+    }
+
+    char *koniec;
+    errno = 0;
+    long n = strtol(s, &koniec, 10);
+    if (errno != 0 || *koniec != '\0' || n < 1 || n > MAX_LINII) {
+        fprintf(stderr, "KOLEJ_LINIE=%s: oczekiwano liczby 1-%d\n", s, MAX_LINII);
+        return -1;
+    }
+    return (int)n;
+}
+
+int linia_z_argumentow(int argc, char *argv[]) {
+    if (argc < 2) {
+        return 0;
+    }
+
+    char *koniec;
+    errno = 0;
+    long n = strtol(argv[1], &koniec, 10);
+    if (errno != 0 || *koniec != '\0' || n < 0 || n >= MAX_LINII) {
+        fprintf(stderr, "%s: błędny numer linii '%s' (0-%d)\n", argv[0], argv[1],
+                MAX_LINII - 1);
+        return -1;
+    }
+    return (int)n;
+}
+
+/* ========== PRZYPIĘCIE DO RDZENIA ========== */
+int linia_przypnij_cpu(int linia) {
+    const char *s = getenv("KOLEJ_LINIE_CPU");
+    if (s == NULL || s[0] == '\0') {
+        return 0;
+    }
+
+    int rdzenie[MAX_LINII];
+    int liczba = 0;
+    const char *p = s;
+    while (*p != '\0' && liczba < MAX_LINII) {
+        char *koniec;
+        errno = 0;
+        long cpu = strtol(p, &koniec, 10);
+        if (errno != 0 || koniec == p || cpu < 0 || cpu >= CPU_SETSIZE ||
+            (*koniec != ',' && *koniec != '\0')) {
+            fprintf(stderr, "KOLEJ_LINIE_CPU=%s: oczekiwano listy rdzeni, np. 0,2\n", s);
+            return -1;
+        }
+        rdzenie[liczba++] = (int)cpu;
+        p = (*koniec == ',') ? koniec + 1 : koniec;
+    }
+    if (liczba == 0) {
+        return 0;
+    }
+
+    cpu_set_t zbior;
+    CPU_ZERO(&zbior);
+    CPU_SET(rdzenie[linia % liczba], &zbior);
+    if (sched_setaffinity(0, sizeof(zbior), &zbior) == -1) {
+        perror("sched_setaffinity");
+        return -1;
+    }
+    return 0;
+}
+
+/* ========== WYBÓR LINII ========== */
+/* Kolejka linii = osoby na stacji i peronie. Start od losowej linii, żeby
+ * przy równych kolejkach turyści nie wybierali zawsze linii 0. */
+int linia_wybierz(const StanWspoldzielony *stan) {
+    int liczba = stan->konfiguracja.linie;
+    if (liczba <= 1) {
+        return 0;
+    }
+
+    int start = rand() % liczba;
+    int najlepsza = start;
+    int najkrotsza = -1;
+    for (int i = 0; i < liczba; i++) {
+        int l = (start + i) % liczba;
+        int kolejka = licznik_linii(stan, l, LICZNIK_STACJA) +
+                      licznik_linii(stan, l, LICZNIK_PERON);
+        if (najkrotsza == -1 || kolejka < najkrotsza) {
+            najkrotsza = kolejka;
+            najlepsza = l;
+        }
+    }
+    return najlepsza;
+}
+
+/* ========== LOGI ========== */
+const char *linia_log(const char *rola, int linia, char *bufor, size_t rozmiar) {
+    char plik[64];
+    if (linia == 0) {
+        snprintf(plik, sizeof(plik), "%s.log", rola);
+    } else {
+        snprintf(plik, sizeof(plik), "%s_linia%d.log", rola, linia);
+    }
+    return instancja_log(plik, bufor, rozmiar);
+}
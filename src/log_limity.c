@@ -0,0 +1,339 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "log_limity.h"
+#include "logger.h"
+#include "instancja.h"
+
+#define MAX_REGUL_LIMITOW 16
+#define OKRES_PODSUMOWANIA_S 5     /* Najwyżej jedna linia podsumowania na miejsce */
+#define PRZEDROSTEK_TABLICY  "limity_"
+#define ROZSZERZENIE_TABLICY ".tab"
+#define DLUGOSC_PLIKU_SLOTU  48    /* Końcówka __FILE__ w slocie */
+
+enum { SLOT_WOLNY = 0, SLOT_ZAJMOWANY, SLOT_GOTOWY };
+
+/* ========== WSPÓLNY SLOT MIEJSCA WYWOŁANIA ========== */
+typedef struct SlotLimitu {
+    atomic_int stan;                    /* SLOT_*; tożsamość czytana po SLOT_GOTOWY */
+    unsigned klucz;                     /* Skrót plik:linia */
+    int linia;
+    char plik[DLUGOSC_PLIKU_SLOTU];     /* Końcówka ścieżki (klucz bywa wspólny) */
+    atomic_long okno;                   /* Sekunda bieżącego okna */
+    atomic_uint w_oknie;                /* Wpisy przepuszczone w oknie */
+    atomic_ulong pominiete;             /* Od ostatniego podsumowania */
+    atomic_long podsumowanie;           /* Sekunda ostatniego podsumowania */
+} SlotLimitu;
+
+typedef struct {
+    char rola[32];
+    int poziom;
+    unsigned limit_na_sekunde;
+    unsigned procent;
+} RegulaLimitu;
+
+int logger_limity_aktywne = 0;
+
+static RegulaLimitu reguly[MAX_REGUL_LIMITOW];
+static int liczba_regul = 0;
+
+static pthread_mutex_t mutex_limitow = PTHREAD_MUTEX_INITIALIZER;
+static SlotLimitu *tablica_slotow = NULL;
+static MiejsceLogu *lista_miejsc = NULL;
+
+static __thread uint32_t ziarno_losowania = 0;
+
+/* ========== ROLA PROCESU ========== */
+/* Nazwa programu bez katalogu (bin/turysta -> "turysta") */
+static const char *rola_procesu(void) {
+    return program_invocation_short_name;
+}
+
+/* ========== PARSOWANIE KOLEJ_LOG_LIMITY ========== */
+static int parsuj_regule(const char *tekst, RegulaLimitu *r) {
+    const char *kropka = strchr(tekst, '.');
+    const char *rowna = strchr(tekst, '=');
+    if (kropka == NULL || rowna == NULL || kropka > rowna ||
+        (size_t)(kropka - tekst) >= sizeof(r->rola)) {
+        return -1;
+    }
+
+    memset(r, 0, sizeof(RegulaLimitu));
+    memcpy(r->rola, tekst, kropka - tekst);
+    r->procent = 100;
+
+    size_t dl_poziomu = rowna - kropka - 1;
+    if (dl_poziomu == 5 && strncasecmp(kropka + 1, "DEBUG", 5) == 0) {
+        r->poziom = LOG_DEBUG;
+    } else if (dl_poziomu == 4 && strncasecmp(kropka + 1, "INFO", 4) == 0) {
+        r->poziom = LOG_INFO;
+    } else {
+        /* WARN i ERROR nigdy nie są ograniczane */
+        return -1;
+    }
+
+    /* <N>/s, <P>% lub <N>/s:<P>% */
+    const char *p = rowna + 1;
+    while (*p != '\0') {
+        char *koniec;
+        unsigned long wartosc = strtoul(p, &koniec, 10);
+        if (koniec == p) return -1;
+
+        if (strncmp(koniec, "/s", 2) == 0) {
+            r->limit_na_sekunde = (unsigned)wartosc;
+            p = koniec + 2;
+        } else if (*koniec == '%' && wartosc <= 100) {
+            r->procent = (unsigned)wartosc;
+            p = koniec + 1;
+        } else {
+            return -1;
+        }
+
+        if (*p == ':') p++;
+    }
+    return 0;
+}
+
+void log_limity_wczytaj(void) {
+    liczba_regul = 0;
+    logger_limity_aktywne = 0;
+
+    const char *wartosc = getenv("KOLEJ_LOG_LIMITY");
+    if (wartosc == NULL || *wartosc == '\0') return;
+
+    char kopia[512];
+    snprintf(kopia, sizeof(kopia), "%s", wartosc);
+
+    char *zapis;
+    for (char *tok = strtok_r(kopia, ",", &zapis); tok != NULL;
+         tok = strtok_r(NULL, ",", &zapis)) {
+        if (liczba_regul >= MAX_REGUL_LIMITOW) break;
+
+        RegulaLimitu *r = &reguly[liczba_regul];
+        if (parsuj_regule(tok, r) == -1) {
+            fprintf(stderr, "KOLEJ_LOG_LIMITY: niepoprawna reguła '%s'\n", tok);
+            continue;
+        }
+        liczba_regul++;
+
+        if (strcmp(r->rola, "*") == 0 || strcmp(r->rola, rola_procesu()) == 0) {
+            logger_limity_aktywne = 1;
+        }
+    }
+}
+
+/* ========== TABLICA SLOTÓW ROLI (MAP_SHARED) ========== */
+static SlotLimitu *mapuj_tablice(void) {
+    size_t rozmiar = sizeof(SlotLimitu) * LICZBA_SLOTOW_LIMITOW;
+    char nazwa[64], sciezka[128];
+    snprintf(nazwa, sizeof(nazwa), PRZEDROSTEK_TABLICY "%s" ROZSZERZENIE_TABLICY,
+             rola_procesu());
+    instancja_log(nazwa, sciezka, sizeof(sciezka));
+
+    /* Plik wypełniony zerami to poprawna, pusta tablica */
+    int fd = open(sciezka, O_CREAT | O_RDWR, 0660);
+    if (fd != -1) {
+        struct stat st;
+        if (fstat(fd, &st) == 0 &&
+            (st.st_size >= (off_t)rozmiar || ftruncate(fd, rozmiar) == 0)) {
+            void *mapa = mmap(NULL, rozmiar, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            close(fd);
+            if (mapa != MAP_FAILED) return mapa;
+        } else {
+            close(fd);
+        }
+    }
+
+    /* Bez pliku limit działa tylko w obrębie procesu */
+    perror("log_limity: tablica współdzielona");
+    return calloc(LICZBA_SLOTOW_LIMITOW, sizeof(SlotLimitu));
+}
+
+/* Końcówka ścieżki mieszcząca się w slocie (z '\0') */
+static const char *koncowka_pliku(const char *plik) {
+    size_t dl = strlen(plik);
+    return (dl < DLUGOSC_PLIKU_SLOTU) ? plik : plik + dl - (DLUGOSC_PLIKU_SLOTU - 1);
+}
+
+/* Ten sam slot w każdym procesie roli: start od skrótu FNV-1a pliku i linii,
+ * sondowanie liniowe, dopóki tożsamość slotu nie zgadza się z miejscem */
+static SlotLimitu *znajdz_slot(const MiejsceLogu *m) {
+    const char *plik = koncowka_pliku(m->plik);
+    uint32_t h = 2166136261u;
+    for (const char *c = m->plik; *c; c++) {
+        h = (h ^ (unsigned char)*c) * 16777619u;
+    }
+    h = (h ^ (uint32_t)m->linia) * 16777619u;
+
+    for (unsigned i = 0; i < LICZBA_SLOTOW_LIMITOW; i++) {
+        SlotLimitu *s = &tablica_slotow[(h + i) % LICZBA_SLOTOW_LIMITOW];
+        int stan = atomic_load_explicit(&s->stan, memory_order_acquire);
+        if (stan == SLOT_WOLNY) {
+            int oczekiwany = SLOT_WOLNY;
+            if (atomic_compare_exchange_strong(&s->stan, &oczekiwany, SLOT_ZAJMOWANY)) {
+                s->klucz = h;
+                s->linia = m->linia;
+                snprintf(s->plik, sizeof(s->plik), "%s", plik);
+                atomic_store_explicit(&s->stan, SLOT_GOTOWY, memory_order_release);
+                return s;
+            }
+        }
+        /* Inny proces właśnie wpisuje tożsamość - kilka instrukcji; slot
+         * porzucony przez zabity proces zostaje pominięty */
+        for (int n = 0; n < 1000 &&
+             atomic_load_explicit(&s->stan, memory_order_acquire) != SLOT_GOTOWY; n++) {
+            sched_yield();
+        }
+        if (atomic_load_explicit(&s->stan, memory_order_acquire) != SLOT_GOTOWY) continue;
+        if (s->klucz == h && s->linia == m->linia &&
+            strncmp(s->plik, plik, sizeof(s->plik)) == 0) {
+            return s;
+        }
+    }
+    return NULL;
+}
+
+/* ========== DOPASOWANIE REGUŁY (RAZ NA MIEJSCE W PROCESIE) ========== */
+static void rozwiaz_miejsce(MiejsceLogu *m, int poziom) {
+    pthread_mutex_lock(&mutex_limitow);
+
+    if (!atomic_load(&m->rozwiazane)) {
+        const RegulaLimitu *pasujaca = NULL;
+        for (int i = 0; i < liczba_regul; i++) {
+            if (reguly[i].poziom == poziom &&
+                (strcmp(reguly[i].rola, "*") == 0 ||
+                 strcmp(reguly[i].rola, rola_procesu()) == 0)) {
+                pasujaca = &reguly[i];
+            }
+        }
+
+        if (pasujaca != NULL) {
+            if (tablica_slotow == NULL) {
+                tablica_slotow = mapuj_tablice();
+            }
+            m->poziom = poziom;
+            m->limit_na_sekunde = pasujaca->limit_na_sekunde;
+            m->procent = pasujaca->procent;
+            m->slot = (tablica_slotow != NULL) ? znajdz_slot(m) : NULL;
+            if (m->slot != NULL) {
+                m->nastepne = lista_miejsc;
+                lista_miejsc = m;
+            }
+        }
+        atomic_store_explicit(&m->rozwiazane, 1, memory_order_release);
+    }
+
+    pthread_mutex_unlock(&mutex_limitow);
+}
+
+/* ========== PODSUMOWANIE POMINIĘTYCH ========== */
+static void zglos_pominiete(const MiejsceLogu *m) {
+    unsigned long n = atomic_exchange(&m->slot->pominiete, 0);
+    if (n > 0) {
+        /* Bezpośrednio logger_log() - podsumowanie nie podlega limitom */
+        logger_log(m->poziom, "LOGGER: Pominięto %lu wpisów z %s:%d \"%s\"",
+                   n, m->plik, m->linia, m->format);
+    }
+}
+
+static uint32_t losuj(void) {
+    if (ziarno_losowania == 0) {
+        ziarno_losowania = (uint32_t)getpid() * 2654435761u ^
+                           (uint32_t)(uintptr_t)&ziarno_losowania;
+        if (ziarno_losowania == 0) ziarno_losowania = 1;
+    }
+    /* xorshift32 */
+    uint32_t x = ziarno_losowania;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    ziarno_losowania = x;
+    return x;
+}
+
+/* ========== DECYZJA: ZAPISAĆ CZY POMINĄĆ ========== */
+bool log_limity_przepusc(MiejsceLogu *m, int poziom) {
+    if (!atomic_load_explicit(&m->rozwiazane, memory_order_acquire)) {
+        rozwiaz_miejsce(m, poziom);
+    }
+
+    SlotLimitu *s = m->slot;
+    if (s == NULL) return true;
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    long teraz = (long)ts.tv_sec;
+
+    /* Pierwszy wpis w nowej sekundzie otwiera okno; co OKRES_PODSUMOWANIA_S
+     * ten sam wpis pisze też podsumowanie pominiętych */
+    long okno = atomic_load_explicit(&s->okno, memory_order_relaxed);
+    if (okno != teraz && atomic_compare_exchange_strong(&s->okno, &okno, teraz)) {
+        atomic_store(&s->w_oknie, 0);
+
+        long ostatnie = atomic_load(&s->podsumowanie);
+        if (teraz - ostatnie >= OKRES_PODSUMOWANIA_S &&
+            atomic_compare_exchange_strong(&s->podsumowanie, &ostatnie, teraz)) {
+            zglos_pominiete(m);
+        }
+    }
+
+    if (m->limit_na_sekunde > 0 &&
+        atomic_fetch_add_explicit(&s->w_oknie, 1, memory_order_relaxed) >= m->limit_na_sekunde) {
+        atomic_fetch_add_explicit(&s->pominiete, 1, memory_order_relaxed);
+        return false;
+    }
+
+    if (m->procent < 100 && losuj() % 100 >= m->procent) {
+        atomic_fetch_add_explicit(&s->pominiete, 1, memory_order_relaxed);
+        return false;
+    }
+
+    return true;
+}
+
+/* Wywoływane z logger_close() - zgłasza pominięcia z niezamkniętych okien */
+void log_limity_podsumuj(void) {
+    pthread_mutex_lock(&mutex_limitow);
+    for (MiejsceLogu *m = lista_miejsc; m != NULL; m = m->nastepne) {
+        zglos_pominiete(m);
+    }
+    pthread_mutex_unlock(&mutex_limitow);
+}
+
+/* ========== USUNIĘCIE TABLIC RÓL ========== */
+/* Wywoływane przez main przed startem procesów i przy sprzątaniu - okna
+ * i liczniki pominiętych nie przechodzą do następnego przebiegu */
+void log_limity_wyczysc(void) {
+    char katalog[128];
+    instancja_log("", katalog, sizeof(katalog));
+
+    DIR *dir = opendir(katalog);
+    if (dir == NULL) return;
+
+    struct dirent *wpis;
+    while ((wpis = readdir(dir)) != NULL) {
+        size_t dl = strlen(wpis->d_name);
+        size_t dl_roz = strlen(ROZSZERZENIE_TABLICY);
+        if (strncmp(wpis->d_name, PRZEDROSTEK_TABLICY, strlen(PRZEDROSTEK_TABLICY)) != 0 ||
+            dl <= dl_roz || strcmp(wpis->d_name + dl - dl_roz, ROZSZERZENIE_TABLICY) != 0) {
+            continue;
+        }
+        char sciezka[384];
+        instancja_log(wpis->d_name, sciezka, sizeof(sciezka));
+        if (unlink(sciezka) == -1 && errno != ENOENT) {
+            perror("log_limity: unlink tablicy");
+        }
+    }
+    closedir(dir);
+}
@@ -0,0 +1,399 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "log_segmenty.h"
+
+/* ========== NAZWY PLIKÓW ========== */
+static void sciezka_segmentu(const LogSegmentowy *log, uint64_t numer,
+                             char *bufor, size_t rozmiar) {
+    snprintf(bufor, rozmiar, "%s.%04llu.log", log->baza, (unsigned long long)numer);
+}
+
+/* Baza = ścieżka bez końcowego ".log" */
+static void baza_sciezki(const char *sciezka, char *baza, size_t rozmiar) {
+    snprintf(baza, rozmiar, "%s", sciezka);
+    size_t dl = strlen(baza);
+    if (dl > 4 && strcmp(baza + dl - 4, ".log") == 0) {
+        baza[dl - 4] = '\0';
+    }
+}
+
+/* ========== PRZYDZIAŁ MIEJSCA - fallocate() ========== */
+/* Idempotentne: kolejne procesy mapujące ten sam segment nic nie zmieniają */
+static int przydziel_segment(int fd, uint64_t rozmiar) {
+    if (fallocate(fd, 0, 0, (off_t)rozmiar) == 0) {
+        return 0;
+    }
+    /* System plików bez fallocate() (np. starszy tmpfs) - wystarczy ftruncate */
+    if (errno == EOPNOTSUPP || errno == ENOSYS) {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && (uint64_t)st.st_size >= rozmiar) return 0;
+        return ftruncate(fd, (off_t)rozmiar);
+    }
+    return -1;
+}
+
+/* ========== MAPOWANIE SEGMENTU ========== */
+/* Proces trzyma zmapowany jeden segment; przejście na kolejny zwalnia poprzedni */
+static char *mapuj_segment(LogSegmentowy *log, uint64_t numer) {
+    if (log->numer_mapy == (int64_t)numer) {
+        return log->mapa;
+    }
+
+    if (log->mapa != NULL) {
+        munmap(log->mapa, log->rozmiar_segmentu);
+        log->mapa = NULL;
+        log->numer_mapy = -1;
+    }
+
+    char sciezka[300];
+    sciezka_segmentu(log, numer, sciezka, sizeof(sciezka));
+
+    int fd = open(sciezka, O_CREAT | O_RDWR, 0640);
+    if (fd == -1) {
+        perror("open segment logu");
+        return NULL;
+    }
+
+    if (przydziel_segment(fd, log->rozmiar_segmentu) == -1) {
+        perror("fallocate segment logu");
+        close(fd);
+        return NULL;
+    }
+
+    char *mapa = mmap(NULL, log->rozmiar_segmentu, PROT_READ | PROT_WRITE,
+                      MAP_SHARED, fd, 0);
+    close(fd);  /* Mapowanie pozostaje ważne po zamknięciu deskryptora */
+    if (mapa == MAP_FAILED) {
+        perror("mmap segment logu");
+        return NULL;
+    }
+
+    log->mapa = mapa;
+    log->numer_mapy = (int64_t)numer;
+    return mapa;
+}
+
+/* ========== UZGODNIENIE POZYCJI Z PLIKIEM SEGMENTU ========== */
+/* Po zamknięciu ostatniego pisarza bieżący segment ma dokładnie
+ * pozycja % rozmiar_segmentu bajtów (przytnij_ogon). Inny rozmiar znaczy,
+ * że log obcięto albo utworzono od nowa, a .ctl został z poprzedniego
+ * uruchomienia - pisanie od starej pozycji zostawiłoby dziurę z zer.
+ * Pozycja przechodzi wtedy na rzeczywisty koniec pliku. Wymaga LOCK_EX. */
+static void uzgodnij_pozycje(LogSegmentowy *log) {
+    uint64_t r = log->rozmiar_segmentu;
+    uint64_t poz = atomic_load(&log->naglowek->pozycja);
+    uint64_t numer = poz / r;
+
+    char sciezka[300];
+    sciezka_segmentu(log, numer, sciezka, sizeof(sciezka));
+    struct stat st;
+    uint64_t rozmiar = (stat(sciezka, &st) == 0) ? (uint64_t)st.st_size : 0;
+    if (rozmiar == poz % r) return;
+
+    /* Pełny segment - pisanie od następnego */
+    atomic_store(&log->naglowek->pozycja, (rozmiar >= r) ? (numer + 1) * r : numer * r + rozmiar);
+}
+
+/* ========== OTWARCIE / UTWORZENIE PLIKU STERUJĄCEGO ========== */
+int log_segmenty_otworz(LogSegmentowy *log, const char *sciezka, uint64_t rozmiar_segmentu) {
+    memset(log, 0, sizeof(LogSegmentowy));
+    log->fd_ctl = -1;
+    log->numer_mapy = -1;
+
+    baza_sciezki(sciezka, log->baza, sizeof(log->baza));
+
+    char sciezka_ctl[300];
+    snprintf(sciezka_ctl, sizeof(sciezka_ctl), "%s.ctl", log->baza);
+
+    log->fd_ctl = open(sciezka_ctl, O_CREAT | O_RDWR, 0640);
+    if (log->fd_ctl == -1) {
+        perror("open log .ctl");
+        return -1;
+    }
+
+    /* Pisarz trzyma LOCK_SH do zamknięcia; jądro zdejmuje go także po
+     * zabiciu procesu, więc liczba pisarzy nie może się "rozjechać".
+     * LOCK_SH nie czeka na innych pisarzy - tylko na trwające przycinanie. */
+    flock(log->fd_ctl, LOCK_SH);
+
+    struct stat st;
+    if (fstat(log->fd_ctl, &st) == -1) {
+        perror("fstat log .ctl");
+        close(log->fd_ctl);
+        return -1;
+    }
+
+    if (st.st_size < (off_t)sizeof(NaglowekSegmentow)) {
+        /* Nowy plik sterujący - inicjalizacja na wyłączność. Zamiana
+         * LOCK_SH -> LOCK_EX zwalnia najpierw LOCK_SH, więc dwóch
+         * zakładających się nie zakleszczy */
+        flock(log->fd_ctl, LOCK_EX);
+        if (fstat(log->fd_ctl, &st) == -1 ||
+            (st.st_size < (off_t)sizeof(NaglowekSegmentow) &&
+             ftruncate(log->fd_ctl, sizeof(NaglowekSegmentow)) == -1)) {
+            perror("ftruncate log .ctl");
+            close(log->fd_ctl);
+            return -1;
+        }
+    }
+
+    log->naglowek = mmap(NULL, sizeof(NaglowekSegmentow), PROT_READ | PROT_WRITE,
+                         MAP_SHARED, log->fd_ctl, 0);
+    if (log->naglowek == MAP_FAILED) {
+        perror("mmap log .ctl");
+        log->naglowek = NULL;
+        close(log->fd_ctl);
+        return -1;
+    }
+
+    NaglowekSegmentow *n = log->naglowek;
+    if (atomic_load(&n->magia) != LOG_SEGMENTY_MAGIA || n->wersja != LOG_SEGMENTY_WERSJA) {
+        flock(log->fd_ctl, LOCK_EX);
+        /* Pod LOCK_EX ponownie - ktoś mógł zdążyć przed nami */
+        if (atomic_load(&n->magia) != LOG_SEGMENTY_MAGIA || n->wersja != LOG_SEGMENTY_WERSJA) {
+            n->wersja = LOG_SEGMENTY_WERSJA;
+            n->rozmiar_segmentu = (rozmiar_segmentu > 0) ? rozmiar_segmentu
+                                                         : DOMYSLNY_ROZMIAR_SEGMENTU;
+            atomic_store(&n->pozycja, 0);
+            atomic_store(&n->magia, LOG_SEGMENTY_MAGIA);
+        }
+    }
+
+    /* Rozmiar segmentu ustala twórca pliku .ctl - pozostali się dostosowują */
+    log->rozmiar_segmentu = n->rozmiar_segmentu;
+
+    /* Pierwszy pisarz (nikt inny nie trzyma .ctl) sprawdza, czy pozycja
+     * pasuje do pliku segmentu */
+    if (flock(log->fd_ctl, LOCK_EX | LOCK_NB) == 0) {
+        uzgodnij_pozycje(log);
+    }
+
+    /* Powrót do LOCK_SH (bez zmian, jeśli inicjalizacja nie była potrzebna) */
+    flock(log->fd_ctl, LOCK_SH);
+    return 0;
+}
+
+/* ========== DOPISANIE WPISU - fetch-add + memcpy() ========== */
+int log_segmenty_zapisz(LogSegmentowy *log, const char *tekst, size_t dlugosc) {
+    uint64_t r = log->rozmiar_segmentu;
+    if (log->naglowek == NULL || dlugosc == 0 || dlugosc >= r) return -1;
+
+    while (1) {
+        uint64_t poz = atomic_fetch_add(&log->naglowek->pozycja, dlugosc);
+        uint64_t numer = poz / r;
+        uint64_t offset = poz % r;
+
+        char *mapa = mapuj_segment(log, numer);
+        if (mapa == NULL) return -1;
+
+        if (offset + dlugosc <= r) {
+            memcpy(mapa + offset, tekst, dlugosc);
+            return 0;
+        }
+
+        /* Wpis przekracza koniec segmentu - tylko ten jeden pisarz trafia na
+         * granicę, więc on wypełnia zarezerwowany obszar po obu jej stronach
+         * (spacje + '\n') i rezerwuje od nowa */
+        memset(mapa + offset, ' ', r - offset - 1);
+        mapa[r - 1] = '\n';
+
+        uint64_t nadmiar = offset + dlugosc - r;     /* >= 1 */
+        mapa = mapuj_segment(log, numer + 1);
+        if (mapa == NULL) return -1;
+        memset(mapa, ' ', nadmiar - 1);
+        mapa[nadmiar - 1] = '\n';
+    }
+}
+
+/* ========== PRZYCINANIE OGONA ========== */
+/* Wymaga LOCK_EX na .ctl - bez czekania uda się tylko, gdy nikt nie pisze */
+static void przytnij_ogon(const LogSegmentowy *log) {
+    if (flock(log->fd_ctl, LOCK_EX | LOCK_NB) == -1) return;
+
+    /* Nikt już nie pisze - przytnij niezapisaną (wyzerowaną) część */
+    uint64_t poz = atomic_load(&log->naglowek->pozycja);
+    char sciezka[300];
+    sciezka_segmentu(log, poz / log->rozmiar_segmentu, sciezka, sizeof(sciezka));
+    int fd = open(sciezka, O_WRONLY);
+    if (fd != -1) {
+        if (ftruncate(fd, (off_t)(poz % log->rozmiar_segmentu)) == -1) {
+            perror("ftruncate segment logu");
+        }
+        close(fd);
+    }
+    flock(log->fd_ctl, LOCK_UN);
+}
+
+/* ========== ZAMKNIĘCIE - OSTATNI PISARZ PRZYCINA OGON ========== */
+void log_segmenty_zamknij(LogSegmentowy *log) {
+    if (log->mapa != NULL) {
+        munmap(log->mapa, log->rozmiar_segmentu);
+        log->mapa = NULL;
+        log->numer_mapy = -1;
+    }
+    if (log->naglowek == NULL) return;
+
+    flock(log->fd_ctl, LOCK_UN);
+    przytnij_ogon(log);
+
+    munmap(log->naglowek, sizeof(NaglowekSegmentow));
+    log->naglowek = NULL;
+    close(log->fd_ctl);
+    log->fd_ctl = -1;
+}
+
+/* ========== PRZYCIĘCIE Z ZEWNĄTRZ ========== */
+/* Dla procesu, który sam nie pisze (main po zakończeniu turystów) -
+ * pisarz zabity przed log_segmenty_zamknij() zostawiłby pełny segment */
+void log_segmenty_przytnij(const char *sciezka) {
+    char baza[240];
+    baza_sciezki(sciezka, baza, sizeof(baza));
+
+    char sciezka_ctl[300];
+    snprintf(sciezka_ctl, sizeof(sciezka_ctl), "%s.ctl", baza);
+    int fd_ctl = open(sciezka_ctl, O_RDWR);
+    if (fd_ctl == -1) return;       /* Nikt nie pisał segmentami */
+
+    NaglowekSegmentow *n = mmap(NULL, sizeof(NaglowekSegmentow), PROT_READ | PROT_WRITE,
+                                MAP_SHARED, fd_ctl, 0);
+    if (n != MAP_FAILED) {
+        if (atomic_load(&n->magia) == LOG_SEGMENTY_MAGIA) {
+            LogSegmentowy log = {
+                .fd_ctl = fd_ctl,
+                .naglowek = n,
+                .rozmiar_segmentu = n->rozmiar_segmentu
+            };
+            snprintf(log.baza, sizeof(log.baza), "%s", baza);
+            przytnij_ogon(&log);
+        }
+        munmap(n, sizeof(NaglowekSegmentow));
+    }
+    close(fd_ctl);
+}
+
+/* ========== DOPISANIE SEGMENTU DO ARCHIWUM ========== */
+static int dopisz_plik(int fd_celu, const char *sciezka) {
+    int fd = open(sciezka, O_RDONLY);
+    if (fd == -1) return -1;
+
+    char bufor[65536];
+    ssize_t n;
+    while ((n = read(fd, bufor, sizeof(bufor))) != 0) {
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            close(fd);
+            return -1;
+        }
+        for (ssize_t zapisano = 0; zapisano < n; ) {
+            ssize_t w = write(fd_celu, bufor + zapisano, (size_t)(n - zapisano));
+            if (w == -1) {
+                if (errno == EINTR) continue;
+                close(fd);
+                return -1;
+            }
+            zapisano += w;
+        }
+    }
+    close(fd);
+    return 0;
+}
+
+/* ========== ROTACJA ZAMKNIĘTYCH SEGMENTÓW ========== */
+/* Segment przed bieżącym (pozycja / rozmiar_segmentu) nie dostanie już nowych
+ * rezerwacji; po karencji nie pisze do niego też nikt spóźniony. Takie
+ * segmenty (od najstarszego istniejącego, bez przerw) są scalane do
+ * <baza>.log.<znacznik>, gdy razem mają prog_bajtow albo najstarszy z nich
+ * prog_wieku_s sekund (0 = warunek wyłączony). Scalone segmenty są usuwane.
+ * Zwraca 1 i ścieżkę archiwum w cel, 0 gdy nie było czego rotować, -1 przy błędzie. */
+int log_segmenty_rotuj(const char *sciezka, uint64_t prog_bajtow, long prog_wieku_s,
+                       long karencja_s, char *cel, size_t rozmiar_celu) {
+    char baza[240];
+    baza_sciezki(sciezka, baza, sizeof(baza));
+
+    char sciezka_ctl[300];
+    snprintf(sciezka_ctl, sizeof(sciezka_ctl), "%s.ctl", baza);
+    int fd_ctl = open(sciezka_ctl, O_RDONLY);
+    if (fd_ctl == -1) return 0;     /* Nikt jeszcze nie pisał segmentami */
+
+    NaglowekSegmentow *n = mmap(NULL, sizeof(NaglowekSegmentow), PROT_READ,
+                                MAP_SHARED, fd_ctl, 0);
+    close(fd_ctl);
+    if (n == MAP_FAILED) return -1;
+
+    uint64_t biezacy = 0, rozmiar_segmentu = 0;
+    if (atomic_load(&n->magia) == LOG_SEGMENTY_MAGIA && n->rozmiar_segmentu > 0) {
+        rozmiar_segmentu = n->rozmiar_segmentu;
+        biezacy = atomic_load(&n->pozycja) / rozmiar_segmentu;
+    }
+    munmap(n, sizeof(NaglowekSegmentow));
+    if (biezacy == 0) return 0;
+
+    LogSegmentowy log = { .rozmiar_segmentu = rozmiar_segmentu };
+    snprintf(log.baza, sizeof(log.baza), "%s", baza);
+
+    /* Najstarszy istniejący segment - wcześniejsze trafiły już do archiwów */
+    char sciezka_seg[300];
+    struct stat st;
+    uint64_t pierwszy = 0;
+    for (; pierwszy < biezacy; pierwszy++) {
+        sciezka_segmentu(&log, pierwszy, sciezka_seg, sizeof(sciezka_seg));
+        if (stat(sciezka_seg, &st) == 0) break;
+    }
+
+    time_t teraz = time(NULL);
+    time_t najstarszy = teraz;
+    uint64_t suma = 0, ostatni = pierwszy;
+    for (; ostatni < biezacy; ostatni++) {
+        sciezka_segmentu(&log, ostatni, sciezka_seg, sizeof(sciezka_seg));
+        if (stat(sciezka_seg, &st) == -1 || teraz - st.st_mtime < karencja_s) break;
+        if (st.st_mtime < najstarszy) najstarszy = st.st_mtime;
+        suma += (uint64_t)st.st_size;
+    }
+    if (ostatni == pierwszy) return 0;
+
+    int za_duze = prog_bajtow > 0 && suma >= prog_bajtow;
+    int za_stare = prog_wieku_s > 0 && teraz - najstarszy >= prog_wieku_s;
+    if (!za_duze && !za_stare) return 0;
+
+    struct tm tm_info;
+    localtime_r(&teraz, &tm_info);
+    char znacznik[32];
+    strftime(znacznik, sizeof(znacznik), "%Y%m%d-%H%M%S", &tm_info);
+
+    snprintf(cel, rozmiar_celu, "%s.log.%s", baza, znacznik);
+    int fd_celu = open(cel, O_CREAT | O_EXCL | O_WRONLY, 0640);
+    for (int k = 1; fd_celu == -1 && errno == EEXIST; k++) {
+        snprintf(cel, rozmiar_celu, "%s.log.%s-%d", baza, znacznik, k);
+        fd_celu = open(cel, O_CREAT | O_EXCL | O_WRONLY, 0640);
+    }
+    if (fd_celu == -1) {
+        perror("open archiwum segmentów");
+        return -1;
+    }
+
+    for (uint64_t s = pierwszy; s < ostatni; s++) {
+        sciezka_segmentu(&log, s, sciezka_seg, sizeof(sciezka_seg));
+        if (dopisz_plik(fd_celu, sciezka_seg) == -1) {
+            /* Segmenty zostają - następny obrót spróbuje od nowa */
+            perror("scalanie segmentów logu");
+            close(fd_celu);
+            unlink(cel);
+            return -1;
+        }
+    }
+    close(fd_celu);
+
+    for (uint64_t s = pierwszy; s < ostatni; s++) {
+        sciezka_segmentu(&log, s, sciezka_seg, sizeof(sciezka_seg));
+        unlink(sciezka_seg);
+    }
+    return 1;
+}
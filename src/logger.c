@@ -1,35 +1,79 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <stdarg.h>
+#include <stdatomic.h>
 #include <time.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <sys/file.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <pthread.h>
 #include <errno.h>
+#include <spawn.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
 #include "logger.h"
 #include "types.h"
+#include "zapis_io.h"
+#include "log_segmenty.h"
 
 /* Deskryptor pliku logu (systemowy, nie FILE*) */
 static int fd_logu = -1;
 static pthread_mutex_t mutex_logu = PTHREAD_MUTEX_INITIALIZER;
 static char nazwa_pliku_logu[256] = {0};
 
+/* Ujście segmentowe - aktywne po udanym logger_init_segmenty() */
+static LogSegmentowy log_segmentowy;
+static int segmenty_aktywne = 0;
+
+/* Próg poziomu logowania (domyślnie wszystko, nadpisywany w logger_init) */
+int logger_prog = LOG_DEBUG;
+
 /* ========== ZMIENNE WARUNKOWE PTHREAD ========== */
-/* Używane do synchronizacji bufora logów */
+/* Budzenie wątku zapisującego, gdy bufor któregoś wątku się zapełnia */
 static pthread_cond_t cond_bufor_gotowy = PTHREAD_COND_INITIALIZER;
 static pthread_mutex_t mutex_bufor = PTHREAD_MUTEX_INITIALIZER;
 
-/* Bufor asynchroniczny dla logów */
-#define ROZMIAR_BUFORA_LOGOW 100
-static char bufor_logow[ROZMIAR_BUFORA_LOGOW][512];
-static int glowa_bufora = 0;
-static int ogon_bufora = 0;
-static volatile int bufor_aktywny = 0;
+/* ========== BUFORY ASYNCHRONICZNE PER WĄTEK ========== */
+/* Każdy wątek formatuje wpisy do własnego pierścienia (jeden producent,
+ * jeden konsument), więc logowanie nie wymaga żadnej blokady. */
+#define ROZMIAR_WPISU_ASYNC       512
+#define DOMYSLNA_POJEMNOSC_ASYNC  1024
+#define MAX_WPISOW_NA_WRITEV      64
+#define INTERWAL_ZAPISU_MS        20
+#define MAX_PROB_PRZY_PELNYM      200   /* ~20ms oczekiwania zanim porzucimy wpis */
+
+typedef struct {
+    int dlugosc;
+    char tekst[ROZMIAR_WPISU_ASYNC];
+} WpisAsync;
+
+typedef struct BuforWatku {
+    atomic_ulong glowa;                 /* Zapisywane tylko przez właściciela */
+    atomic_ulong ogon;                  /* Zapisywane tylko przez wątek zapisujący */
+    unsigned long pojemnosc;            /* Potęga dwójki */
+    WpisAsync *wpisy;
+    struct BuforWatku *nastepny;
+} BuforWatku;
+
+static _Atomic(BuforWatku *) lista_buforow = NULL;
+static __thread BuforWatku *bufor_watku = NULL;
+static __thread unsigned pokolenie_watku = 0;
+static atomic_uint pokolenie_async = 0;
+static atomic_int bufor_aktywny = 0;
+static atomic_int aktywni_producenci = 0;   /* Wątki między rezerwacją a publikacją */
+static atomic_int koniec_zapisu = 0;        /* Sygnał końcowego opróżnienia */
+static unsigned long pojemnosc_async = DOMYSLNA_POJEMNOSC_ASYNC;
+static atomic_ulong licznik_porzuconych = 0;
+static atomic_ulong licznik_zablokowan = 0;
 static pthread_t watek_zapisujacy;
 
+/* Kontekst io_uring wątku zapisującego (tylko ten wątek go używa) */
+static KontekstIO io_logu;
+
 /* Konwersja poziomu na tekst */
 static const char *poziom_do_tekstu(PoziomLogu poziom) {
     switch (poziom) {
@@ -41,87 +85,629 @@ static const char *poziom_do_tekstu(PoziomLogu poziom) {
     }
 }
 
+/* ========== ODCZYT PROGU ZE ŚRODOWISKA ========== */
+/* Akceptuje nazwę poziomu lub jego numer; nieznana wartość nie zmienia progu */
+static void wczytaj_prog_logowania(void) {
+    const char *wartosc = getenv("KOLEJ_LOG_POZIOM");
+    if (wartosc == NULL || *wartosc == '\0') return;
+    
+    if (strcasecmp(wartosc, "DEBUG") == 0 || strcmp(wartosc, "0") == 0) {
+        logger_prog = LOG_DEBUG;
+    } else if (strcasecmp(wartosc, "INFO") == 0 || strcmp(wartosc, "1") == 0) {
+        logger_prog = LOG_INFO;
+    } else if (strcasecmp(wartosc, "WARN") == 0 || strcmp(wartosc, "2") == 0) {
+        logger_prog = LOG_WARN;
+    } else if (strcasecmp(wartosc, "ERROR") == 0 || strcmp(wartosc, "3") == 0) {
+        logger_prog = LOG_ERROR;
+    } else {
+        fprintf(stderr, "KOLEJ_LOG_POZIOM: nieznany poziom '%s'\n", wartosc);
+    }
+}
+
+/* ========== FORMATOWANIE WPISU ========== */
+/* Nagłówek + treść + '\n'; zwraca długość (zawsze < rozmiar) */
+static int formatuj_wpis(char *bufor, size_t rozmiar, PoziomLogu poziom,
+                         const char *format, va_list args) {
+    time_t teraz = time(NULL);
+    struct tm tm_info;
+    localtime_r(&teraz, &tm_info);
+    char bufor_czasu[32];
+    strftime(bufor_czasu, sizeof(bufor_czasu), "%H:%M:%S", &tm_info);
+    
+    int offset = snprintf(bufor, rozmiar, "[%s][%s][PID:%5d] ",
+                          bufor_czasu, poziom_do_tekstu(poziom), getpid());
+    
+    int tresc = vsnprintf(bufor + offset, rozmiar - offset - 1, format, args);
+    if (tresc > 0) {
+        offset += tresc;
+    }
+    /* vsnprintf mógł obciąć treść - zostaw miejsce na newline */
+    if (offset > (int)rozmiar - 2) {
+        offset = (int)rozmiar - 2;
+    }
+    
+    bufor[offset++] = '\n';
+    bufor[offset] = '\0';
+    return offset;
+}
+
+/* Zakończenie operacji io_uring - zapamiętaj liczbę zapisanych bajtów */
+static void zapamietaj_wynik(void *dane, int wynik) {
+    if (dane != NULL) *(int *)dane = wynik;
+}
+
+/* ========== ZAPIS PEŁNEGO WEKTORA - io_uring LUB SYSTEMOWE writev() ========== */
+static void zapisz_wektor(int fd, struct iovec *iov, int liczba) {
+    if (io_uring_aktywny(&io_logu)) {
+        /* Jedno io_uring_enter() zamiast writev() + 2x flock(); O_APPEND
+         * gwarantuje, że partia nie przeplecie się z wpisami innych procesów */
+        size_t lacznie = 0;
+        for (int i = 0; i < liczba; i++) lacznie += iov[i].iov_len;
+        
+        int wynik = -1;
+        if (io_dodaj_zapis_wektor(&io_logu, fd, iov, liczba, &wynik) == 0 &&
+            io_czekaj_wszystkie(&io_logu) == 0 && (size_t)wynik == lacznie) {
+            return;
+        }
+        /* Niepełny zapis - dokończ synchronicznie od miejsca przerwania */
+        size_t napisano = (wynik > 0) ? (size_t)wynik : 0;
+        while (liczba > 0 && napisano >= iov->iov_len) {
+            napisano -= iov->iov_len;
+            iov++;
+            liczba--;
+        }
+        if (liczba > 0) {
+            iov->iov_base = (char *)iov->iov_base + napisano;
+            iov->iov_len -= napisano;
+        }
+    }
+    
+    flock(fd, LOCK_EX);
+    while (liczba > 0) {
+        ssize_t napisano = writev(fd, iov, liczba);
+        if (napisano == -1) {
+            if (errno == EINTR) continue;
+            perror("writev log");
+            break;
+        }
+        /* Pomiń w całości zapisane elementy, dopasuj częściowy */
+        while (liczba > 0 && (size_t)napisano >= iov->iov_len) {
+            napisano -= iov->iov_len;
+            iov++;
+            liczba--;
+        }
+        if (liczba > 0) {
+            iov->iov_base = (char *)iov->iov_base + napisano;
+            iov->iov_len -= napisano;
+        }
+    }
+    flock(fd, LOCK_UN);
+}
+
+/* ========== OPRÓŻNIENIE BUFORÓW WSZYSTKICH WĄTKÓW ========== */
+/* Zbiera do MAX_WPISOW_NA_WRITEV wpisów (z wielu wątków) na jedno writev().
+ * Zwraca liczbę zapisanych wpisów. */
+static unsigned long oproznij_bufory(void) {
+    struct iovec iov[MAX_WPISOW_NA_WRITEV];
+    BuforWatku *do_przesuniecia[MAX_WPISOW_NA_WRITEV];
+    unsigned long nowy_ogon[MAX_WPISOW_NA_WRITEV];
+    int liczba_iov = 0, liczba_buforow = 0;
+    unsigned long lacznie = 0;
+    
+    int fd = (fd_logu != -1) ? fd_logu : STDERR_FILENO;
+    
+    for (BuforWatku *b = atomic_load(&lista_buforow); b != NULL; b = b->nastepny) {
+        unsigned long ogon = atomic_load_explicit(&b->ogon, memory_order_relaxed);
+        unsigned long glowa = atomic_load_explicit(&b->glowa, memory_order_acquire);
+        
+        while (ogon != glowa) {
+            WpisAsync *w = &b->wpisy[ogon & (b->pojemnosc - 1)];
+            iov[liczba_iov].iov_base = w->tekst;
+            iov[liczba_iov].iov_len = w->dlugosc;
+            liczba_iov++;
+            ogon++;
+            
+            if (liczba_iov == MAX_WPISOW_NA_WRITEV) {
+                do_przesuniecia[liczba_buforow] = b;
+                nowy_ogon[liczba_buforow++] = ogon;
+                
+                zapisz_wektor(fd, iov, liczba_iov);
+                for (int i = 0; i < liczba_buforow; i++) {
+                    atomic_store_explicit(&do_przesuniecia[i]->ogon, nowy_ogon[i],
+                                          memory_order_release);
+                }
+                lacznie += liczba_iov;
+                liczba_iov = 0;
+                liczba_buforow = 0;
+            }
+        }
+        
+        /* Resztę wpisów tego bufora zapisze kolejne writev() */
+        if (liczba_iov > 0 && (liczba_buforow == 0 ||
+                               do_przesuniecia[liczba_buforow - 1] != b)) {
+            do_przesuniecia[liczba_buforow] = b;
+            nowy_ogon[liczba_buforow++] = ogon;
+        }
+    }
+    
+    if (liczba_iov > 0) {
+        zapisz_wektor(fd, iov, liczba_iov);
+        for (int i = 0; i < liczba_buforow; i++) {
+            atomic_store_explicit(&do_przesuniecia[i]->ogon, nowy_ogon[i],
+                                  memory_order_release);
+        }
+        lacznie += liczba_iov;
+    }
+    
+    return lacznie;
+}
+
 /* ========== WĄTEK ZAPISUJĄCY LOGI ASYNCHRONICZNIE ========== */
-/* Demonstracja użycia pthread_cond_wait() i pthread_cond_signal() */
+/* Budzi się co INTERWAL_ZAPISU_MS albo na sygnał producenta (pthread_cond_timedwait) */
 static void *watek_zapis_logow(void *arg) {
     (void)arg;
     
-    while (bufor_aktywny) {
-        pthread_mutex_lock(&mutex_bufor);
+    /* Brak io_uring - zapisz_wektor() użyje writev() */
+    io_inicjalizuj(&io_logu, 8, zapamietaj_wynik);
+    
+    while (1) {
+        int koniec = atomic_load(&koniec_zapisu);
+        unsigned long zapisane = oproznij_bufory();
         
-        /* Czekaj na dane w buforze używając pthread_cond_wait() */
-        while (glowa_bufora == ogon_bufora && bufor_aktywny) {
-            /* pthread_cond_wait() - atomowo zwalnia mutex i czeka na sygnał */
-            pthread_cond_wait(&cond_bufor_gotowy, &mutex_bufor);
+        if (koniec) {
+            /* logger_stop_async() odczekał już wszystkich producentów -
+             * po tym opróżnieniu nic nowego nie zostanie opublikowane */
+            while (oproznij_bufory() > 0) {}
+            break;
         }
         
-        /* Przetwórz wszystkie wpisy w buforze */
-        while (glowa_bufora != ogon_bufora && bufor_aktywny) {
-            char *wpis = bufor_logow[ogon_bufora];
-            ogon_bufora = (ogon_bufora + 1) % ROZMIAR_BUFORA_LOGOW;
-            
-            pthread_mutex_unlock(&mutex_bufor);
-            
-            /* Zapisz do pliku */
-            if (fd_logu != -1) {
-                flock(fd_logu, LOCK_EX);
-                write(fd_logu, wpis, strlen(wpis));
-                flock(fd_logu, LOCK_UN);
+        if (zapisane == 0) {
+            struct timespec ts;
+            clock_gettime(CLOCK_REALTIME, &ts);
+            ts.tv_nsec += INTERWAL_ZAPISU_MS * 1000000L;
+            if (ts.tv_nsec >= 1000000000L) {
+                ts.tv_sec += 1;
+                ts.tv_nsec -= 1000000000L;
             }
             
             pthread_mutex_lock(&mutex_bufor);
+            if (!atomic_load(&koniec_zapisu)) {
+                pthread_cond_timedwait(&cond_bufor_gotowy, &mutex_bufor, &ts);
+            }
+            pthread_mutex_unlock(&mutex_bufor);
         }
-        
-        pthread_mutex_unlock(&mutex_bufor);
     }
     
+    io_zamknij(&io_logu);
     pthread_exit(NULL);
 }
 
-/* ========== ASYNCHRONICZNE LOGOWANIE Z pthread_cond_signal() ========== */
-void logger_log_async(const char *wiadomosc) {
-    if (!bufor_aktywny) return;
+/* ========== BUFOR BIEŻĄCEGO WĄTKU ========== */
+/* Tworzony przy pierwszym wpisie i dołączany do listy bez blokady (CAS) */
+static BuforWatku *pobierz_bufor_watku(void) {
+    unsigned pokolenie = atomic_load(&pokolenie_async);
+    if (bufor_watku != NULL && pokolenie_watku == pokolenie) {
+        return bufor_watku;
+    }
     
-    pthread_mutex_lock(&mutex_bufor);
+    BuforWatku *b = calloc(1, sizeof(BuforWatku));
+    if (b == NULL) return NULL;
+    b->pojemnosc = pojemnosc_async;
+    b->wpisy = malloc(b->pojemnosc * sizeof(WpisAsync));
+    if (b->wpisy == NULL) {
+        free(b);
+        return NULL;
+    }
     
-    /* Dodaj do bufora */
-    int nastepny = (glowa_bufora + 1) % ROZMIAR_BUFORA_LOGOW;
-    if (nastepny != ogon_bufora) {  /* Sprawdź czy jest miejsce */
-        strncpy(bufor_logow[glowa_bufora], wiadomosc, 511);
-        bufor_logow[glowa_bufora][511] = '\0';
-        glowa_bufora = nastepny;
-        
-        /* Sygnalizuj wątek zapisujący używając pthread_cond_signal() */
+    BuforWatku *glowa_listy = atomic_load(&lista_buforow);
+    do {
+        b->nastepny = glowa_listy;
+    } while (!atomic_compare_exchange_weak(&lista_buforow, &glowa_listy, b));
+    
+    bufor_watku = b;
+    pokolenie_watku = pokolenie;
+    return b;
+}
+
+/* ========== REZERWACJA MIEJSCA W PIERŚCIENIU ========== */
+/* Przy pełnym buforze budzi wątek zapisujący i chwilę czeka (licznik
+ * zablokowań); jeśli miejsce się nie zwolni - wpis jest porzucany. */
+static WpisAsync *zarezerwuj_wpis(BuforWatku **bufor) {
+    BuforWatku *b = pobierz_bufor_watku();
+    if (b == NULL) {
+        atomic_fetch_add(&licznik_porzuconych, 1);
+        return NULL;
+    }
+    
+    unsigned long glowa = atomic_load_explicit(&b->glowa, memory_order_relaxed);
+    if (glowa - atomic_load_explicit(&b->ogon, memory_order_acquire) >= b->pojemnosc) {
+        atomic_fetch_add(&licznik_zablokowan, 1);
+        for (int proba = 0; proba < MAX_PROB_PRZY_PELNYM; proba++) {
+            pthread_cond_signal(&cond_bufor_gotowy);
+            struct timespec ts = {0, 100000};  /* 100us */
+            nanosleep(&ts, NULL);
+            if (glowa - atomic_load_explicit(&b->ogon, memory_order_acquire) < b->pojemnosc) {
+                break;
+            }
+        }
+        if (glowa - atomic_load_explicit(&b->ogon, memory_order_acquire) >= b->pojemnosc) {
+            atomic_fetch_add(&licznik_porzuconych, 1);
+            return NULL;
+        }
+    }
+    
+    *bufor = b;
+    return &b->wpisy[glowa & (b->pojemnosc - 1)];
+}
+
+/* ========== PUBLIKACJA WPISU ========== */
+static void opublikuj_wpis(BuforWatku *b) {
+    unsigned long glowa = atomic_load_explicit(&b->glowa, memory_order_relaxed) + 1;
+    atomic_store_explicit(&b->glowa, glowa, memory_order_release);
+    
+    /* Obudź wątek zapisujący dopiero przy połowie pojemności */
+    if (glowa - atomic_load_explicit(&b->ogon, memory_order_relaxed) == b->pojemnosc / 2) {
         pthread_cond_signal(&cond_bufor_gotowy);
     }
+}
+
+/* ========== WEJŚCIE / WYJŚCIE PRODUCENTA ========== */
+/* Licznik zwiększany PRZED sprawdzeniem flagi: logger_stop_async() zeruje
+ * flagę i dopiero potem czeka na licznik, więc (seq_cst) albo producent
+ * zobaczy wyłączony tryb, albo stop zobaczy producenta i na niego poczeka. */
+static int wejdz_producent(void) {
+    atomic_fetch_add(&aktywni_producenci, 1);
+    if (atomic_load(&bufor_aktywny)) return 1;
+    atomic_fetch_sub(&aktywni_producenci, 1);
+    return 0;
+}
+
+static void wyjdz_producent(void) {
+    atomic_fetch_sub(&aktywni_producenci, 1);
+}
+
+/* ========== ASYNCHRONICZNE LOGOWANIE GOTOWEGO TEKSTU ========== */
+void logger_log_async(const char *wiadomosc) {
+    if (!wejdz_producent()) return;
     
-    pthread_mutex_unlock(&mutex_bufor);
+    BuforWatku *b;
+    WpisAsync *w = zarezerwuj_wpis(&b);
+    if (w == NULL) {
+        wyjdz_producent();
+        return;
+    }
+    
+    size_t dlugosc = strlen(wiadomosc);
+    if (dlugosc > ROZMIAR_WPISU_ASYNC - 1) {
+        dlugosc = ROZMIAR_WPISU_ASYNC - 1;
+    }
+    memcpy(w->tekst, wiadomosc, dlugosc);
+    w->dlugosc = (int)dlugosc;
+    opublikuj_wpis(b);
+    wyjdz_producent();
+}
+
+/* Proces potomny po fork() nie ma wątku zapisującego - loguj synchronicznie */
+static void wylacz_async_w_potomku(void) {
+    atomic_store(&bufor_aktywny, 0);
 }
 
 /* ========== URUCHOMIENIE ASYNCHRONICZNEGO LOGOWANIA ========== */
-void logger_start_async(void) {
-    bufor_aktywny = 1;
+/* pojemnosc <= 0: zmienna KOLEJ_LOG_POJEMNOSC lub DOMYSLNA_POJEMNOSC_ASYNC */
+void logger_start_async(int pojemnosc) {
+    static int atfork_zarejestrowany = 0;
+    
+    if (atomic_load(&bufor_aktywny)) return;
+    if (!atfork_zarejestrowany) {
+        pthread_atfork(NULL, NULL, wylacz_async_w_potomku);
+        atfork_zarejestrowany = 1;
+    }
+    
+    if (pojemnosc <= 0) {
+        const char *env = getenv("KOLEJ_LOG_POJEMNOSC");
+        pojemnosc = (env != NULL) ? atoi(env) : DOMYSLNA_POJEMNOSC_ASYNC;
+        if (pojemnosc <= 0) pojemnosc = DOMYSLNA_POJEMNOSC_ASYNC;
+    }
+    
+    /* Zaokrąglij w górę do potęgi dwójki (indeksowanie maską) */
+    unsigned long p = 2;
+    while (p < (unsigned long)pojemnosc) p <<= 1;
+    pojemnosc_async = p;
+    
+    atomic_fetch_add(&pokolenie_async, 1);
+    atomic_store(&licznik_porzuconych, 0);
+    atomic_store(&licznik_zablokowan, 0);
+    atomic_store(&koniec_zapisu, 0);
+    atomic_store(&bufor_aktywny, 1);
+    
     if (pthread_create(&watek_zapisujacy, NULL, watek_zapis_logow, NULL) != 0) {
         perror("pthread_create logger");
-        bufor_aktywny = 0;
+        atomic_store(&bufor_aktywny, 0);
     }
 }
 
 /* ========== ZATRZYMANIE ASYNCHRONICZNEGO LOGOWANIA ========== */
+/* Nowi producenci przechodzą na zapis synchroniczny; ci w trakcie wpisu są
+ * odczekiwani, zanim wątek zapisujący wykona ostatnie opróżnienie */
 void logger_stop_async(void) {
-    if (!bufor_aktywny) return;
+    if (!atomic_load(&bufor_aktywny)) return;
+    
+    atomic_store(&bufor_aktywny, 0);
+    
+    /* Producent przy pełnym buforze czeka do ~20ms - wątek zapisujący
+     * nadal działa, więc zwolni mu miejsce */
+    while (atomic_load(&aktywni_producenci) > 0) {
+        pthread_cond_signal(&cond_bufor_gotowy);
+        struct timespec ts = {0, 100000};  /* 100us */
+        nanosleep(&ts, NULL);
+    }
     
     pthread_mutex_lock(&mutex_bufor);
-    bufor_aktywny = 0;
+    atomic_store(&koniec_zapisu, 1);
     /* Użycie pthread_cond_broadcast() - budzi WSZYSTKIE czekające wątki */
     pthread_cond_broadcast(&cond_bufor_gotowy);
     pthread_mutex_unlock(&mutex_bufor);
     
     pthread_join(watek_zapisujacy, NULL);
+    
+    /* Nowe pokolenie unieważnia wskaźniki bufor_watku innych wątków (są
+     * porównywane z pokoleniem przed dereferencją), więc pierścienie można
+     * bezpiecznie zwolnić */
+    atomic_fetch_add(&pokolenie_async, 1);
+    BuforWatku *b = atomic_exchange(&lista_buforow, NULL);
+    while (b != NULL) {
+        BuforWatku *nastepny = b->nastepny;
+        free(b->wpisy);
+        free(b);
+        b = nastepny;
+    }
+}
+
+/* ========== STATYSTYKI TRYBU ASYNCHRONICZNEGO ========== */
+void logger_statystyki_async(unsigned long *porzucone, unsigned long *zablokowane) {
+    if (porzucone) *porzucone = atomic_load(&licznik_porzuconych);
+    if (zablokowane) *zablokowane = atomic_load(&licznik_zablokowan);
+}
+
+/* ========== ROTACJA LOGU I KOMPRESJA W TLE ========== */
+/* Wątek o niskim priorytecie co OKRES_ROTACJI_MS sprawdza rozmiar i wiek
+ * pliku. Przy rotacji: rename() na <nazwa>.RRRRMMDD-GGMMSS, open() nowego
+ * pliku i dup2() na fd_logu - piszący nie czekają, ich write() trafia
+ * atomowo do starego albo nowego pliku. Inne procesy piszące do tego
+ * samego logu wykrywają zmianę i-węzła i same otwierają nowy plik.
+ * KOLEJ_LOG_ROTACJA_MB (domyślnie 64, 0 = wyłączona), KOLEJ_LOG_ROTACJA_S
+ * (wiek pliku, domyślnie 0 = bez limitu), KOLEJ_LOG_KOMPRESJA (program,
+ * domyślnie gzip, 0 = bez kompresji). Ten sam wątek rotuje zamknięte
+ * segmenty logu zgłoszonego przez logger_rotuj_segmenty(). */
+#define OKRES_ROTACJI_MS          1000
+#define KARENCJA_KOMPRESJI_S      2     /* Inne procesy zdążą przełączyć deskryptor */
+#define MAX_DO_KOMPRESJI          16
+#define DOMYSLNA_ROTACJA_MB       64
+
+typedef struct {
+    char sciezka[300];
+    time_t od_kiedy;
+} DoKompresji;
+
+static pthread_t watek_rotacji;
+static atomic_int rotacja_aktywna = 0;
+static pthread_mutex_t mutex_rotacji = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond_rotacji = PTHREAD_COND_INITIALIZER;
+static off_t rotacja_rozmiar = 0;
+static long rotacja_wiek_s = 0;
+static char kompresor[64] = "gzip";
+static time_t czas_otwarcia_logu = 0;
+static DoKompresji kolejka_kompresji[MAX_DO_KOMPRESJI];
+static int liczba_do_kompresji = 0;
+static char sciezka_segmentow[300] = {0};   /* Chroniona mutex_rotacji */
+
+/* Zwraca 1, gdy rotacja ma działać dla bieżącego pliku */
+static int wczytaj_ustawienia_rotacji(void) {
+    const char *mb = getenv("KOLEJ_LOG_ROTACJA_MB");
+    const char *sek = getenv("KOLEJ_LOG_ROTACJA_S");
+    const char *komp = getenv("KOLEJ_LOG_KOMPRESJA");
+    
+    rotacja_rozmiar = (off_t)((mb != NULL) ? atol(mb) : DOMYSLNA_ROTACJA_MB) * 1024 * 1024;
+    rotacja_wiek_s = (sek != NULL) ? atol(sek) : 0;
+    if (komp != NULL) {
+        snprintf(kompresor, sizeof(kompresor), "%s", komp);
+    }
+    
+    return rotacja_rozmiar > 0 || rotacja_wiek_s > 0;
+}
+
+/* Otwiera bieżącą ścieżkę logu i podmienia ją pod fd_logu */
+static void otworz_log_ponownie(void) {
+    int nowy = open(nazwa_pliku_logu, O_CREAT | O_WRONLY | O_APPEND, 0640);
+    if (nowy == -1) {
+        perror("open log (rotacja)");
+        return;
+    }
+    if (dup2(nowy, fd_logu) == -1) {
+        perror("dup2 log (rotacja)");
+    }
+    close(nowy);
+    czas_otwarcia_logu = time(NULL);
+}
+
+static void kompresuj_plik(const char *sciezka, int czekaj) {
+    char *argumenty[] = { kompresor, "-q", "-f", (char *)sciezka, NULL };
+    pid_t pid;
+    
+    /* Proces potomny dziedziczy nice wątku rotacji */
+    int blad = posix_spawnp(&pid, kompresor, NULL, NULL, argumenty, environ);
+    if (blad != 0) {
+        fprintf(stderr, "LOGGER: nie można uruchomić '%s': %s\n", kompresor, strerror(blad));
+        return;
+    }
+    if (czekaj) {
+        /* Przy SIGCHLD = SIG_IGN (main) waitpid() kończy się ECHILD po wyjściu */
+        waitpid(pid, NULL, 0);
+    }
+}
+
+static void dodaj_do_kompresji(const char *sciezka, time_t teraz) {
+    if (strcmp(kompresor, "0") != 0 && liczba_do_kompresji < MAX_DO_KOMPRESJI) {
+        DoKompresji *k = &kolejka_kompresji[liczba_do_kompresji++];
+        snprintf(k->sciezka, sizeof(k->sciezka), "%s", sciezka);
+        k->od_kiedy = teraz;
+    }
+}
+
+/* wszystkie = 1: bez karencji i bez czekania (zamykanie loggera) */
+static void kompresuj_oczekujace(int wszystkie) {
+    time_t teraz = time(NULL);
+    int i = 0;
+    while (i < liczba_do_kompresji) {
+        DoKompresji *k = &kolejka_kompresji[i];
+        if (!wszystkie && teraz - k->od_kiedy < KARENCJA_KOMPRESJI_S) {
+            i++;
+            continue;
+        }
+        kompresuj_plik(k->sciezka, !wszystkie);
+        kolejka_kompresji[i] = kolejka_kompresji[--liczba_do_kompresji];
+    }
+}
+
+static void sprawdz_rotacje(void) {
+    struct stat st_fd, st_plik;
+    if (fstat(fd_logu, &st_fd) == -1) return;
+    
+    /* Inny proces już przeniósł plik - przełącz się na nowy */
+    if (stat(nazwa_pliku_logu, &st_plik) == -1 ||
+        st_plik.st_ino != st_fd.st_ino || st_plik.st_dev != st_fd.st_dev) {
+        otworz_log_ponownie();
+        return;
+    }
+    
+    int za_duzy = rotacja_rozmiar > 0 && st_fd.st_size >= rotacja_rozmiar;
+    int za_stary = rotacja_wiek_s > 0 && st_fd.st_size > 0 &&
+                   time(NULL) - czas_otwarcia_logu >= rotacja_wiek_s;
+    if (!za_duzy && !za_stary) return;
+    
+    /* Jeden rotujący naraz; kto nie dostanie blokady, spróbuje przy kolejnym obrocie */
+    char sciezka_blokady[300];
+    snprintf(sciezka_blokady, sizeof(sciezka_blokady), "%s.lock", nazwa_pliku_logu);
+    int fd_blokady = open(sciezka_blokady, O_CREAT | O_RDWR, 0640);
+    if (fd_blokady == -1) return;
+    
+    if (flock(fd_blokady, LOCK_EX | LOCK_NB) == 0) {
+        /* Pod blokadą ponownie: może ktoś zdążył przed nami */
+        if (stat(nazwa_pliku_logu, &st_plik) == 0 && st_plik.st_ino == st_fd.st_ino) {
+            time_t teraz = time(NULL);
+            struct tm tm_info;
+            localtime_r(&teraz, &tm_info);
+            char znacznik[32];
+            strftime(znacznik, sizeof(znacznik), "%Y%m%d-%H%M%S", &tm_info);
+            
+            char cel[300];
+            snprintf(cel, sizeof(cel), "%s.%s", nazwa_pliku_logu, znacznik);
+            for (int n = 1; access(cel, F_OK) == 0; n++) {
+                snprintf(cel, sizeof(cel), "%s.%s-%d", nazwa_pliku_logu, znacznik, n);
+            }
+            
+            if (rename(nazwa_pliku_logu, cel) == 0) {
+                dodaj_do_kompresji(cel, teraz);
+            } else {
+                perror("rename log (rotacja)");
+            }
+        }
+        otworz_log_ponownie();
+        flock(fd_blokady, LOCK_UN);
+    }
+    close(fd_blokady);
+}
+
+/* Segmenty są niezmienne, gdy offset je minie - archiwum jest od razu
+ * zamknięte, ale kompresja i tak czeka KARENCJA_KOMPRESJI_S */
+static void sprawdz_rotacje_segmentow(const char *sciezka) {
+    if (sciezka[0] == '\0') return;
+    
+    char cel[300];
+    if (log_segmenty_rotuj(sciezka, (uint64_t)rotacja_rozmiar, rotacja_wiek_s,
+                           KARENCJA_KOMPRESJI_S, cel, sizeof(cel)) == 1) {
+        dodaj_do_kompresji(cel, time(NULL));
+    }
+}
+
+static void *watek_rotacji_logow(void *arg) {
+    (void)arg;
+    
+    /* Najniższy priorytet dla wątku (nice jest per wątek w Linuksie) */
+    setpriority(PRIO_PROCESS, gettid(), 19);
+    
+    pthread_mutex_lock(&mutex_rotacji);
+    while (atomic_load(&rotacja_aktywna)) {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_sec += OKRES_ROTACJI_MS / 1000;
+        pthread_cond_timedwait(&cond_rotacji, &mutex_rotacji, &ts);
+        if (!atomic_load(&rotacja_aktywna)) break;
+        
+        char segmenty[sizeof(sciezka_segmentow)];
+        memcpy(segmenty, sciezka_segmentow, sizeof(segmenty));
+        pthread_mutex_unlock(&mutex_rotacji);
+        sprawdz_rotacje();
+        sprawdz_rotacje_segmentow(segmenty);
+        kompresuj_oczekujace(0);
+        pthread_mutex_lock(&mutex_rotacji);
+    }
+    pthread_mutex_unlock(&mutex_rotacji);
+    
+    /* Pozostałe pliki kompresują się dalej bez nas */
+    kompresuj_oczekujace(1);
+    pthread_exit(NULL);
+}
+
+/* Proces potomny po fork() nie ma wątku rotacji */
+static void wylacz_rotacje_w_potomku(void) {
+    atomic_store(&rotacja_aktywna, 0);
+}
+
+static void uruchom_rotacje(void) {
+    static int atfork_zarejestrowany = 0;
+    
+    if (!wczytaj_ustawienia_rotacji()) return;
+    if (!atfork_zarejestrowany) {
+        pthread_atfork(NULL, NULL, wylacz_rotacje_w_potomku);
+        atfork_zarejestrowany = 1;
+    }
+    
+    czas_otwarcia_logu = time(NULL);
+    atomic_store(&rotacja_aktywna, 1);
+    if (pthread_create(&watek_rotacji, NULL, watek_rotacji_logow, NULL) != 0) {
+        perror("pthread_create rotacja logu");
+        atomic_store(&rotacja_aktywna, 0);
+    }
+}
+
+/* ========== ROTACJA SEGMENTÓW INNYCH PROCESÓW ========== */
+/* Piszący segmentami (turyści) żyją krótko - zamknięte segmenty rotuje
+ * wątek rotacji długo żyjącego procesu (main) */
+void logger_rotuj_segmenty(const char *sciezka) {
+    pthread_mutex_lock(&mutex_rotacji);
+    snprintf(sciezka_segmentow, sizeof(sciezka_segmentow), "%s",
+             (sciezka != NULL) ? sciezka : "");
+    pthread_mutex_unlock(&mutex_rotacji);
+}
+
+static void zatrzymaj_rotacje(void) {
+    if (!atomic_load(&rotacja_aktywna)) return;
+    
+    pthread_mutex_lock(&mutex_rotacji);
+    atomic_store(&rotacja_aktywna, 0);
+    pthread_cond_signal(&cond_rotacji);
+    pthread_mutex_unlock(&mutex_rotacji);
+    
+    pthread_join(watek_rotacji, NULL);
 }
 
 /* ========== INICJALIZACJA LOGGERA - SYSTEMOWE open() ========== */
 void logger_init(const char *nazwa_pliku) {
+    wczytaj_prog_logowania();
+    log_limity_wczytaj();
+    zatrzymaj_rotacje();
+    
     pthread_mutex_lock(&mutex_logu);
     
     /* Zamknij poprzedni plik */
@@ -143,6 +729,7 @@ void logger_init(const char *nazwa_pliku) {
             fd_logu = STDERR_FILENO;
         } else {
             strncpy(nazwa_pliku_logu, nazwa_pliku, sizeof(nazwa_pliku_logu) - 1);
+            uruchom_rotacje();
         }
     } else {
         fd_logu = STDERR_FILENO;
@@ -151,13 +738,64 @@ void logger_init(const char *nazwa_pliku) {
     pthread_mutex_unlock(&mutex_logu);
 }
 
+/* ========== INICJALIZACJA UJŚCIA SEGMENTOWEGO - mmap() ========== */
+void logger_init_segmenty(const char *nazwa_pliku) {
+    const char *wlacz = getenv("KOLEJ_LOG_SEGMENTY");
+    if (nazwa_pliku == NULL || (wlacz != NULL && atoi(wlacz) == 0)) {
+        logger_init(nazwa_pliku);
+        return;
+    }
+
+    uint64_t rozmiar = 0;     /* 0 = DOMYSLNY_ROZMIAR_SEGMENTU */
+    const char *kb = getenv("KOLEJ_LOG_SEGMENT_KB");
+    if (kb != NULL && atol(kb) > 0) {
+        rozmiar = (uint64_t)atol(kb) * 1024u;
+    }
+
+    /* Próg poziomu i fallback na stderr jak w zwykłym logger_init() */
+    logger_init(NULL);
+
+    pthread_mutex_lock(&mutex_logu);
+    if (log_segmenty_otworz(&log_segmentowy, nazwa_pliku, rozmiar) == 0) {
+        segmenty_aktywne = 1;
+        strncpy(nazwa_pliku_logu, nazwa_pliku, sizeof(nazwa_pliku_logu) - 1);
+    }
+    pthread_mutex_unlock(&mutex_logu);
+
+    if (!segmenty_aktywne) {
+        logger_init(nazwa_pliku);
+    }
+}
+
 /* ========== ZAMKNIĘCIE LOGGERA - SYSTEMOWE close() ========== */
 void logger_close(void) {
+    /* Pominięte przez limity, zanim bufory zostaną opróżnione */
+    log_limity_podsumuj();
+    
+    /* Tryb asynchroniczny: gwarantowane opróżnienie buforów przed zamknięciem */
+    if (atomic_load(&bufor_aktywny)) {
+        logger_stop_async();
+        
+        unsigned long porzucone, zablokowane;
+        logger_statystyki_async(&porzucone, &zablokowane);
+        if (porzucone > 0 || zablokowane > 0) {
+            LOG_W("LOGGER: Tryb async - porzucono %lu wpisów, zablokowano %lu razy",
+                  porzucone, zablokowane);
+        }
+    }
+    
+    zatrzymaj_rotacje();
+    
     pthread_mutex_lock(&mutex_logu);
     
+    if (segmenty_aktywne) {
+        log_segmenty_zamknij(&log_segmentowy);
+        segmenty_aktywne = 0;
+    }
+    
     if (fd_logu != -1 && fd_logu != STDERR_FILENO) {
-        /* Synchronizuj dane z dyskiem przed zamknięciem */
-        fsync(fd_logu);
+        /* Bez fsync() - dane są już w pamięci podręcznej jądra, a trwałość
+         * logu nie jest warta blokowania końca każdego procesu */
         close(fd_logu);
         fd_logu = -1;
     }
@@ -167,8 +805,42 @@ void logger_close(void) {
 
 /* ========== GŁÓWNA FUNKCJA LOGOWANIA - SYSTEMOWE write() ========== */
 void logger_log(PoziomLogu poziom, const char *format, ...) {
+    /* Odrzuć przed blokadą i formatowaniem */
+    if ((int)poziom < logger_prog) return;
+    
+    va_list args;
+    
+    /* Tryb asynchroniczny - formatowanie prosto do bufora wątku, bez blokad */
+    if (atomic_load_explicit(&bufor_aktywny, memory_order_relaxed) &&
+        wejdz_producent()) {
+        BuforWatku *b;
+        WpisAsync *w = zarezerwuj_wpis(&b);
+        if (w != NULL) {
+            va_start(args, format);
+            w->dlugosc = formatuj_wpis(w->tekst, sizeof(w->tekst), poziom, format, args);
+            va_end(args);
+            opublikuj_wpis(b);
+        }
+        wyjdz_producent();
+        return;
+    }
+    
     pthread_mutex_lock(&mutex_logu);
     
+    /* Ujście segmentowe - rezerwacja fetch-add i memcpy(), bez flock() i write() */
+    if (segmenty_aktywne) {
+        char bufor[1024];
+        va_start(args, format);
+        int dlugosc = formatuj_wpis(bufor, sizeof(bufor), poziom, format, args);
+        va_end(args);
+        
+        if (log_segmenty_zapisz(&log_segmentowy, bufor, dlugosc) == -1) {
+            perror("log_segmenty_zapisz");
+        }
+        pthread_mutex_unlock(&mutex_logu);
+        return;
+    }
+    
     int fd = (fd_logu != -1) ? fd_logu : STDERR_FILENO;
     
     /* Blokada pliku dla wielu procesów */
@@ -176,32 +848,10 @@ void logger_log(PoziomLogu poziom, const char *format, ...) {
     
     /* Przygotuj bufor */
     char bufor[1024];
-    int offset = 0;
-    
-    /* Timestamp */
-    time_t teraz = time(NULL);
-    struct tm *tm_info = localtime(&teraz);
-    char bufor_czasu[32];
-    strftime(bufor_czasu, sizeof(bufor_czasu), "%H:%M:%S", tm_info);
-    
-    /* Nagłówek */
-    offset = snprintf(bufor, sizeof(bufor), "[%s][%s][PID:%5d] ", 
-                      bufor_czasu, 
-                      poziom_do_tekstu(poziom), 
-                      getpid());
-    
-    /* Treść - formatowanie zmiennej liczby argumentów */
-    va_list args;
     va_start(args, format);
-    offset += vsnprintf(bufor + offset, sizeof(bufor) - offset - 2, format, args);
+    int offset = formatuj_wpis(bufor, sizeof(bufor), poziom, format, args);
     va_end(args);
     
-    /* Dodaj newline */
-    if (offset < (int)sizeof(bufor) - 1) {
-        bufor[offset++] = '\n';
-        bufor[offset] = '\0';
-    }
-    
     /* Zapisz używając systemowego write() */
     ssize_t napisano = write(fd, bufor, offset);
     if (napisano == -1) {
@@ -218,111 +868,3 @@ void logger_rejestruj_przejscie(int bilet_id, int turysta_id, int bramka, int zj
     LOG_I("REJESTR: Bilet #%d, Turysta #%d, Bramka %d, Zjazd #%d",
           bilet_id, turysta_id, bramka, zjazd);
 }
-
-/* ========== GENEROWANIE RAPORTU - SYSTEMOWE creat(), write() ========== */
-void generuj_raport(StanWspoldzielony *stan, const char *plik_wyjsciowy) {
-    /* Utwórz plik używając creat() - równoważne open() z O_CREAT|O_WRONLY|O_TRUNC */
-    int fd = creat(plik_wyjsciowy, 0644);
-    if (fd == -1) {
-        perror("creat raport");
-        return;
-    }
-    
-    char bufor[4096];
-    int len;
-    
-    /* Nagłówek raportu */
-    time_t teraz = time(NULL);
-    struct tm *tm_info = localtime(&teraz);
-    char bufor_daty[64];
-    strftime(bufor_daty, sizeof(bufor_daty), "%Y-%m-%d %H:%M:%S", tm_info);
-    
-    len = snprintf(bufor, sizeof(bufor),
-        "╔══════════════════════════════════════════════════════════════╗\n"
-        "║              RAPORT DZIENNY - KOLEJ LINOWA                   ║\n"
-        "╠══════════════════════════════════════════════════════════════╣\n"
-        "║ Data wygenerowania: %-40s ║\n"
-        "╠══════════════════════════════════════════════════════════════╣\n"
-        "║                     STATYSTYKI OGÓLNE                        ║\n"
-        "╠══════════════════════════════════════════════════════════════╣\n"
-        "║ Łączna liczba zjazdów:          %-28d ║\n"
-        "║ Sprzedanych biletów:            %-28d ║\n"
-        "║ Wpisów w rejestrze:             %-28d ║\n"
-        "╠══════════════════════════════════════════════════════════════╣\n",
-        bufor_daty,
-        stan->laczna_liczba_zjazdow,
-        stan->liczba_sprzedanych_biletow,
-        stan->liczba_wpisow_rejestru);
-    
-    write(fd, bufor, len);
-    
-    /* Rejestr przejść */
-    len = snprintf(bufor, sizeof(bufor),
-        "║                    REJESTR PRZEJŚĆ                           ║\n"
-        "╠══════════════════════════════════════════════════════════════╣\n"
-        "║ ID Biletu │ ID Turysty │ Bramka │ Zjazd │      Czas          ║\n"
-        "╠───────────┼────────────┼────────┼───────┼────────────────────╣\n");
-    write(fd, bufor, len);
-    
-    int max_wpisow = (stan->liczba_wpisow_rejestru < 100) ? 
-                      stan->liczba_wpisow_rejestru : 100;
-    
-    for (int i = 0; i < max_wpisow; i++) {
-        WpisRejestru *wpis = &stan->rejestr[i];
-        struct tm *tm_wpis = localtime(&wpis->czas);
-        char czas_wpis[32];
-        strftime(czas_wpis, sizeof(czas_wpis), "%H:%M:%S", tm_wpis);
-        
-        len = snprintf(bufor, sizeof(bufor),
-            "║ %9d │ %10d │ %6d │ %5d │ %18s ║\n",
-            wpis->bilet_id, wpis->turysta_id, wpis->numer_bramki, 
-            wpis->numer_zjazdu, czas_wpis);
-        write(fd, bufor, len);
-    }
-    
-    if (stan->liczba_wpisow_rejestru > 100) {
-        len = snprintf(bufor, sizeof(bufor),
-            "║ ... i %d więcej wpisów                                        ║\n",
-            stan->liczba_wpisow_rejestru - 100);
-        write(fd, bufor, len);
-    }
-    
-    len = snprintf(bufor, sizeof(bufor),
-        "╚══════════════════════════════════════════════════════════════╝\n");
-    write(fd, bufor, len);
-    
-    /* Podsumowanie per bilet */
-    len = snprintf(bufor, sizeof(bufor),
-        "\n╔══════════════════════════════════════════════════════════════╗\n"
-        "║              PODSUMOWANIE ZJAZDÓW PER BILET                  ║\n"
-        "╠══════════════════════════════════════════════════════════════╣\n");
-    write(fd, bufor, len);
-    
-    /* Zlicz zjazdy per bilet */
-    int zjazdy_per_bilet[1000] = {0};
-    for (int i = 0; i < stan->liczba_wpisow_rejestru && i < MAX_WPISOW_REJESTRU; i++) {
-        int bid = stan->rejestr[i].bilet_id;
-        if (bid > 0 && bid < 1000) {
-            zjazdy_per_bilet[bid]++;
-        }
-    }
-    
-    for (int i = 1; i < 1000; i++) {
-        if (zjazdy_per_bilet[i] > 0) {
-            len = snprintf(bufor, sizeof(bufor),
-                "║ Bilet #%-4d: %-3d zjazdów                                      ║\n",
-                i, zjazdy_per_bilet[i]);
-            write(fd, bufor, len);
-        }
-    }
-    
-    len = snprintf(bufor, sizeof(bufor),
-        "╚══════════════════════════════════════════════════════════════╝\n");
-    write(fd, bufor, len);
-    
-    /* Synchronizuj i zamknij */
-    fsync(fd);
-    close(fd);
-    
-    printf("Raport zapisany do: %s\n", plik_wyjsciowy);
-}
\ No newline at end of file
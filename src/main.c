@@ -16,13 +16,31 @@
 #include "ipc_utils.h"
 #include "pipe_comm.h"
 #include "logger.h"
+#include "zapis_io.h"
+#include "log_segmenty.h"
+#include "rejestr_plik.h"
+#include "rejestr.h"
+#include "dziennik.h"
+#include "raport.h"
+#include "agregaty.h"
+#include "stan_kolei.h"
+#include "instancja.h"
+#include "linie.h"
+#include "polityka.h"
+#include "konfiguracja.h"
 
 /* Zmienne globalne */
 static ZasobyIPC zasoby;
-static pid_t pid_kasjer = 0;
-static pid_t pid_pracownik1 = 0;
-static pid_t pid_pracownik2 = 0;
-static pid_t pidy_turystow[200];
+static pid_t pidy_kasjerow[MAX_KASJEROW];
+static pid_t pidy_pracownik1[MAX_LINII];
+static pid_t pidy_pracownik2[MAX_LINII];
+static int liczba_linii = 1;
+static KonfiguracjaKolei konfiguracja;  /* konfiguracja.h - zapisywana w segmencie stanu */
+#define MAX_NADPISAN 32
+static const char *nadpisania[MAX_NADPISAN];    /* -o klucz=wartość, po kolei */
+static int liczba_nadpisan = 0;
+static int grup_na_sekunde = 0;         /* -a; 0 = grupa co sekundę z p. PROCENT_GRUPY_NA_SEKUNDE */
+static pid_t pidy_turystow[MAX_TURYSTOW];
 static int liczba_turystow = 0;
 static volatile sig_atomic_t zakonczenie = 0;
 
@@ -43,15 +61,38 @@ static pthread_mutex_t mutex_monitor = PTHREAD_MUTEX_INITIALIZER;
 static pthread_cond_t cond_monitor = PTHREAD_COND_INITIALIZER;
 
 /* ========== WĄTEK STATYSTYK (używa pthread_detach i pthread_cond_timedwait) ========== */
+/* Czeka na zapis migawki i podmienia plik; nieudany zapis zostawia poprzednią */
+static void zakoncz_migawke(KontekstIO *io, int fd, const char *tymczasowy, const char *sciezka) {
+    int blad = io_czekaj_wszystkie(io);
+    close(fd);
+    if (blad != 0 || rename(tymczasowy, sciezka) == -1) {
+        unlink(tymczasowy);
+    }
+}
+
 void *watek_statystyk_funkcja(void *arg) {
     (void)arg;
     StanWspoldzielony *stan = zasoby.shm.stan;
 
     /* Odłącz wątek - nie wymaga join() */
     pthread_detach(pthread_self());
+    polityka_zastosuj(ROLA_MONITOR);
     LOG_I("STATYSTYKI: Wątek statystyk odłączony (pthread_detach)");
 
-    while (monitor_aktywny && stan->kolej_aktywna) {
+    /* Co sekundę migawka do <plik>.tmp przez io_uring, a po zakończeniu
+     * zapisu rename() na miejsce - czytelnik widzi zawsze jedną całą
+     * migawkę, nigdy ogona poprzedniej, dłuższej.
+     * Pełny raport z agregatów (agregaty.h), bez przeglądania rejestru */
+    KontekstIO io;
+    io_inicjalizuj(&io, 4, NULL);
+    static char buf[8192];
+    static MigawkaAgregatow migawka;
+    char sciezka[256], tymczasowy[300];
+    instancja_log("statystyki_live.txt", sciezka, sizeof(sciezka));
+    snprintf(tymczasowy, sizeof(tymczasowy), "%s.tmp", sciezka);
+    int fd = -1;                                /* Migawka w locie */
+
+    while (monitor_aktywny && STAN_CZYTAJ(stan, kolej_aktywna)) {
         /* BLOKUJĄCE czekanie z timeoutem 1 sekunda - pthread_cond_timedwait() */
         struct timespec ts;
         clock_gettime(CLOCK_REALTIME, &ts);
@@ -60,27 +101,40 @@ void *watek_statystyk_funkcja(void *arg) {
         pthread_mutex_lock(&mutex_statystyki);
         pthread_cond_timedwait(&cond_statystyki, &mutex_statystyki, &ts);
 
-        /* Po obudzeniu - zapisz statystyki */
+        /* Po obudzeniu - zapisz statystyki (poprzedni zapis wciąż w locie: pomiń) */
         licznik_przetworzen++;
-        int fd = open("logs/statystyki_live.txt", O_CREAT | O_WRONLY | O_TRUNC, 0644);
-        if (fd != -1) {
-            char buf[256];
-            int len = snprintf(buf, sizeof(buf),
-                "Statystyki (iteracja %d):\n"
-                "- Osoby na stacji: %d\n"
-                "- Zjazdy: %d\n"
-                "- Bilety: %d\n",
-                licznik_przetworzen,
-                stan->liczba_osob_na_stacji,
-                stan->laczna_liczba_zjazdow,
-                stan->liczba_sprzedanych_biletow);
-            write(fd, buf, len);
-            close(fd);
+        if (io_zbierz(&io) == 0) {
+            if (fd != -1) {
+                zakoncz_migawke(&io, fd, tymczasowy, sciezka);
+            }
+            fd = open(tymczasowy, O_CREAT | O_WRONLY | O_TRUNC, 0644);
+            if (fd != -1) {
+                MigawkaStanu m;
+                stan_migawka(stan, &m);
+                int len = snprintf(buf, sizeof(buf),
+                    "Statystyki (iteracja %8d):\n"
+                    "- Osoby na stacji: %8d\n"
+                    "- Zjazdy: %8d\n"
+                    "- Bilety: %8d\n",
+                    licznik_przetworzen,
+                    m.liczba_osob_na_stacji,
+                    m.laczna_liczba_zjazdow,
+                    m.liczba_sprzedanych_biletow);
+                agregaty_migawka(stan, &migawka);
+                len += (int)agregaty_formatuj(&migawka, buf + len, sizeof(buf) - (size_t)len);
+                io_dodaj_zapis(&io, fd, buf, len, 0, NULL);
+                io_wyslij(&io);
+            }
         }
 
         pthread_mutex_unlock(&mutex_statystyki);
     }
 
+    if (fd != -1) {
+        zakoncz_migawke(&io, fd, tymczasowy, sciezka);
+    }
+    io_zamknij(&io);
+
     LOG_I("STATYSTYKI: Wątek zakończony (był odłączony, nie wymaga join)");
     return NULL;
 }
@@ -91,8 +145,9 @@ void *watek_monitor_funkcja(void *arg) {
     StanWspoldzielony *stan = zasoby.shm.stan;
 
     LOG_I("MONITOR: Wątek monitorowania uruchomiony");
+    polityka_zastosuj(ROLA_MONITOR);
 
-    while (monitor_aktywny && stan->kolej_aktywna) {
+    while (monitor_aktywny && STAN_CZYTAJ(stan, kolej_aktywna)) {
         /* Sprawdź czy jest komunikat przez pipe */
         KomunikatPipe msg;
         int wynik = odbierz_z_fifo_nieblokujaco(pipe_monitor.fd_read, &msg);
@@ -101,14 +156,16 @@ void *watek_monitor_funkcja(void *arg) {
             LOG_D("MONITOR: Otrzymano komunikat typu %d", msg.typ);
         }
 
-        /* Wyświetl stan */
+        /* Wyświetl stan - spójna migawka, bez semafora */
+        MigawkaStanu m;
+        stan_migawka(stan, &m);
         printf("\r[Czas: %3ld s] Stacja: %2d | Peron: %2d | Krzesełka: %2d | Zjazdy: %3d | Bilety: %3d   ",
                time(NULL) - stan->czas_startu,
-               stan->liczba_osob_na_stacji,
-               stan->liczba_osob_na_peronie,
-               stan->liczba_aktywnych_krzeselek,
-               stan->laczna_liczba_zjazdow,
-               stan->liczba_sprzedanych_biletow);
+               m.liczba_osob_na_stacji,
+               m.liczba_osob_na_peronie,
+               m.liczba_aktywnych_krzeselek,
+               m.laczna_liczba_zjazdow,
+               m.liczba_sprzedanych_biletow);
         fflush(stdout);
 
         /* BLOKUJĄCE czekanie z timeoutem 500ms - pthread_cond_timedwait() */
@@ -160,27 +217,33 @@ void ustaw_obsluge_sygnalow(void) {
 }
 
 /* ========== URUCHAMIANIE PROCESÓW Z exec() ========== */
-void uruchom_kasjer(void) {
-    pid_kasjer = fork();
+void uruchom_kasjer(int nr) {
+    char arg_nr[16];
+    snprintf(arg_nr, sizeof(arg_nr), "%d", nr);
     
-    if (pid_kasjer == -1) {
+    pidy_kasjerow[nr] = fork();
+    
+    if (pidy_kasjerow[nr] == -1) {
         perror("fork kasjer");
         return;
     }
     
-    if (pid_kasjer == 0) {
-        execl("./bin/kasjer", "kasjer", NULL);
+    if (pidy_kasjerow[nr] == 0) {
+        polityka_zastosuj(ROLA_KASJER);
+        execl("./bin/kasjer", "kasjer", arg_nr, NULL);
         perror("execl kasjer");
         _exit(1);
     }
     
-    LOG_I("MAIN: Uruchomiono kasjera (PID: %d)", pid_kasjer);
+    LOG_I("MAIN: Uruchomiono kasjera %d (PID: %d)", nr, pidy_kasjerow[nr]);
 }
 
-void uruchom_pracownika(int numer) {
-    pid_t *pid = (numer == 1) ? &pid_pracownik1 : &pid_pracownik2;
+void uruchom_pracownika(int numer, int linia) {
+    pid_t *pid = (numer == 1) ? &pidy_pracownik1[linia] : &pidy_pracownik2[linia];
     const char *nazwa = (numer == 1) ? "./bin/pracownik1" : "./bin/pracownik2";
     const char *arg = (numer == 1) ? "pracownik1" : "pracownik2";
+    char arg_linia[16];
+    snprintf(arg_linia, sizeof(arg_linia), "%d", linia);
     
     *pid = fork();
     
@@ -190,15 +253,16 @@ void uruchom_pracownika(int numer) {
     }
     
     if (*pid == 0) {
-        execl(nazwa, arg, NULL);
+        polityka_zastosuj(ROLA_PRACOWNIK);
+        execl(nazwa, arg, arg_linia, NULL);
         perror("execl pracownik");
         _exit(1);
     }
     
-    LOG_I("MAIN: Uruchomiono pracownika%d (PID: %d)", numer, *pid);
+    LOG_I("MAIN: Uruchomiono pracownika%d linii %d (PID: %d)", numer, linia, *pid);
 }
 
-void uruchom_turystę(int id, int wiek, int opiekun) {
+void uruchom_turystę(int id, int wiek, int opiekun, int dzieci) {
     pid_t pid = fork();
     
     if (pid == -1) {
@@ -209,7 +273,9 @@ void uruchom_turystę(int id, int wiek, int opiekun) {
     if (pid == 0) {
         /* ========== UŻYCIE dup2() - przekierowanie stderr do pliku ========== */
         /* Wszyscy turysci piszą błędy do wspólnego pliku */
-        int fd_err = open("logs/wszyscy_turysci_stderr.log", O_CREAT | O_WRONLY | O_APPEND, 0644);
+        char sciezka[256];
+        int fd_err = open(instancja_log("wszyscy_turysci_stderr.log", sciezka, sizeof(sciezka)),
+                          O_CREAT | O_WRONLY | O_APPEND, 0644);
         if (fd_err != -1) {
             /* dup2() duplikuje deskryptor fd_err na STDERR_FILENO */
             if (dup2(fd_err, STDERR_FILENO) == -1) {
@@ -218,17 +284,19 @@ void uruchom_turystę(int id, int wiek, int opiekun) {
             close(fd_err);  /* Zamknij oryginalny, stderr teraz wskazuje na plik */
         }
         
-        char arg_id[16], arg_wiek[16], arg_opiekun[16];
+        char arg_id[16], arg_wiek[16], arg_opiekun[16], arg_dzieci[16];
         snprintf(arg_id, sizeof(arg_id), "%d", id);
         snprintf(arg_wiek, sizeof(arg_wiek), "%d", wiek);
         snprintf(arg_opiekun, sizeof(arg_opiekun), "%d", opiekun);
+        snprintf(arg_dzieci, sizeof(arg_dzieci), "%d", dzieci);
         
-        execl("./bin/turysta", "turysta", arg_id, arg_wiek, arg_opiekun, NULL);
+        polityka_zastosuj(ROLA_TURYSTA);
+        execl("./bin/turysta", "turysta", arg_id, arg_wiek, arg_opiekun, arg_dzieci, NULL);
         perror("execl turysta");
         _exit(1);
     }
     
-    if (liczba_turystow < 200) {
+    if (liczba_turystow < MAX_TURYSTOW) {
         pidy_turystow[liczba_turystow++] = pid;
     }
     LOG_D("MAIN: Uruchomiono turystę #%d (PID: %d, wiek: %d)", id, pid, wiek);
@@ -240,20 +308,20 @@ void generuj_grupe(int *id) {
     int wiek_dorosly = 20 + (rand() % 50);
     
     int dzieci = 0;
-    if (rand() % 100 < 25) {
+    if (rand() % 100 < PROCENT_GRUP_Z_DZIECMI) {
         dzieci = 1 + (rand() % MAX_DZIECI_POD_OPIEKA);
     }
     
     LOG_I("MAIN: Generuję turystę #%d (wiek: %d) z %d dziećmi",
           dorosly_id, wiek_dorosly, dzieci);
     
-    uruchom_turystę(dorosly_id, wiek_dorosly, -1);
+    uruchom_turystę(dorosly_id, wiek_dorosly, -1, dzieci);
     
     for (int i = 0; i < dzieci; i++) {
         int dziecko_id = (*id)++;
         int wiek_dziecka = WIEK_MIN_DZIECKO + 
                            (rand() % (WIEK_DZIECKO_OPIEKA - WIEK_MIN_DZIECKO));
-        uruchom_turystę(dziecko_id, wiek_dziecka, dorosly_id);
+        uruchom_turystę(dziecko_id, wiek_dziecka, dorosly_id, 0);
     }
 }
 
@@ -274,9 +342,13 @@ void zatrzymaj_i_czekaj_na_procesy(void) {
     }
     
     /* Wyślij SIGTERM do pracowników i kasjera */
-    if (pid_pracownik1 > 0) kill(pid_pracownik1, SIGTERM);
-    if (pid_pracownik2 > 0) kill(pid_pracownik2, SIGTERM);
-    if (pid_kasjer > 0) kill(pid_kasjer, SIGTERM);
+    for (int l = 0; l < liczba_linii; l++) {
+        if (pidy_pracownik1[l] > 0) kill(pidy_pracownik1[l], SIGTERM);
+        if (pidy_pracownik2[l] > 0) kill(pidy_pracownik2[l], SIGTERM);
+    }
+    for (int i = 0; i < konfiguracja.kasjerzy; i++) {
+        if (pidy_kasjerow[i] > 0) kill(pidy_kasjerow[i], SIGTERM);
+    }
     
     printf("Oczekiwanie na zakończenie procesów potomnych...\n");
 
@@ -315,9 +387,13 @@ void zatrzymaj_i_czekaj_na_procesy(void) {
                 kill(pidy_turystow[i], SIGKILL);
             }
         }
-        if (pid_pracownik1 > 0) kill(pid_pracownik1, SIGKILL);
-        if (pid_pracownik2 > 0) kill(pid_pracownik2, SIGKILL);
-        if (pid_kasjer > 0) kill(pid_kasjer, SIGKILL);
+        for (int l = 0; l < liczba_linii; l++) {
+            if (pidy_pracownik1[l] > 0) kill(pidy_pracownik1[l], SIGKILL);
+            if (pidy_pracownik2[l] > 0) kill(pidy_pracownik2[l], SIGKILL);
+        }
+        for (int i = 0; i < konfiguracja.kasjerzy; i++) {
+            if (pidy_kasjerow[i] > 0) kill(pidy_kasjerow[i], SIGKILL);
+        }
         
         /* Zbierz pozostałe */
         while (waitpid(-1, NULL, WNOHANG) > 0) {
@@ -340,12 +416,14 @@ void wyswietl_banner(int czas_symulacji) {
     printf("                    Symulacja Systemu                          \n");
     printf("---------------------------------------------------------------\n");
     printf("\n");
-    printf("  Krzesełka: %2d aktywnych / %2d łącznie                        \n",
-           MAX_AKTYWNYCH_KRZESELEK, LICZBA_KRZESELEK);
-    printf("  Bramki wejściowe: %d    Bramki peronowe: %d                   \n",
-           LICZBA_BRAMEK_WEJSCIOWYCH, LICZBA_BRAMEK_PERONOWYCH);
-    printf("  Max osób na stacji: %2d                                       \n",
-           MAX_OSOB_NA_STACJI);
+    printf("  Krzesełka: %2d aktywnych / %2d łącznie, %d-osobowe           \n",
+           konfiguracja.krzeselka, konfiguracja.krzeselka_lacznie,
+           konfiguracja.pojemnosc_krzeselka);
+    printf("  Bramki wejściowe: %d    Bramki peronowe: %d    VIP: %d%%        \n",
+           konfiguracja.bramki_wejsciowe, konfiguracja.bramki_peronowe,
+           konfiguracja.procent_vip);
+    printf("  Max osób na stacji: %2d    Linie: %d    Kasjerzy: %d           \n",
+           konfiguracja.max_osob_na_stacji, liczba_linii, konfiguracja.kasjerzy);
     if (czas_symulacji == -1) {
         printf("  Czas symulacji: NIESKOŃCZONY (Ctrl+C aby zakończyć)          \n");
     } else {
@@ -357,12 +435,8 @@ void wyswietl_banner(int czas_symulacji) {
 
 /* ========== TWORZENIE KATALOGU LOGS ========== */
 void utworz_katalog_logs(void) {
-    struct stat st = {0};
-    if (stat("logs", &st) == -1) {
-        if (mkdir("logs", 0755) == -1) {
-            perror("mkdir logs");
-        }
-    }
+    /* logs/ i katalog instancji (instancja.h) */
+    instancja_utworz_katalog_logow();
 }
 
 /* ========== UŻYCIE popen() - sprawdzenie zasobów IPC ========== */
@@ -467,9 +541,11 @@ int zapytaj_o_czas_dzialania(void) {
 }
 
 /* ========== WALIDACJA PARAMETRÓW ========== */
-int waliduj_parametry(int argc, char *argv[], int *czas_symulacji, int *max_turystow) {
+int waliduj_parametry(int argc, char *argv[], int *czas_symulacji, int *max_turystow,
+                       const char **dziennik) {
     *czas_symulacji = -1;  /* Domyślnie: pytaj użytkownika */
     *max_turystow = 100;
+    *dziennik = NULL;
 
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "-t") == 0) {
@@ -508,21 +584,132 @@ int waliduj_parametry(int argc, char *argv[], int *czas_symulacji, int *max_tury
                 return -1;
             }
 
-            if (n < 1 || n > 500) {
-                fprintf(stderr, "BŁĄD: Liczba turystów musi być między 1 a 500 (podano: %d)\n", n);
+            if (n < 1 || n > MAX_TURYSTOW) {
+                fprintf(stderr, "BŁĄD: Liczba turystów musi być między 1 a %d (podano: %d)\n",
+                        MAX_TURYSTOW, n);
                 return -1;
             }
 
             *max_turystow = n;
             i++;
 
+        } else if (strcmp(argv[i], "-r") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "BŁĄD: Brak pliku po parametrze -r\n");
+                fprintf(stderr, "Użyj: -r <plik_dziennika>\n");
+                return -1;
+            }
+            *dziennik = argv[i + 1];
+            i++;
+
+        } else if (strcmp(argv[i], "-f") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "BŁĄD: Brak listy formatów po parametrze -f\n");
+                fprintf(stderr, "Użyj: -f tekst,csv,jsonl,bin\n");
+                return -1;
+            }
+            /* Czytane przez generuj_raport() (raport.h) */
+            setenv("KOLEJ_RAPORT_FORMAT", argv[i + 1], 1);
+            i++;
+
+        } else if (strcmp(argv[i], "-i") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "BŁĄD: Brak numeru po parametrze -i\n");
+                fprintf(stderr, "Użyj: -i <instancja>\n");
+                return -1;
+            }
+            int n;
+            if (parsuj_liczbe(argv[i + 1], &n) != 0 || n < 0 || n > MAX_INSTANCJA) {
+                fprintf(stderr, "BŁĄD: Instancja musi być liczbą 0-%d (podano: '%s')\n",
+                        MAX_INSTANCJA, argv[i + 1]);
+                return -1;
+            }
+            /* Dziedziczone przez procesy potomne (instancja.h) */
+            setenv("KOLEJ_INSTANCJA", argv[i + 1], 1);
+            i++;
+
+        } else if (strcmp(argv[i], "-l") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "BŁĄD: Brak liczby po parametrze -l\n");
+                fprintf(stderr, "Użyj: -l <liczba_linii>\n");
+                return -1;
+            }
+            int n;
+            if (parsuj_liczbe(argv[i + 1], &n) != 0 || n < 1 || n > MAX_LINII) {
+                fprintf(stderr, "BŁĄD: Liczba linii musi być liczbą 1-%d (podano: '%s')\n",
+                        MAX_LINII, argv[i + 1]);
+                return -1;
+            }
+            /* Czytane przez linie_liczba_z_env() (linie.h) */
+            setenv("KOLEJ_LINIE", argv[i + 1], 1);
+            i++;
+
+        } else if (strcmp(argv[i], "-c") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "BŁĄD: Brak pliku po parametrze -c\n");
+                fprintf(stderr, "Użyj: -c <plik_konfiguracji>\n");
+                return -1;
+            }
+            /* Czytane przez zbuduj_konfiguracje() */
+            setenv("KOLEJ_KONFIG", argv[i + 1], 1);
+            i++;
+
+        } else if (strcmp(argv[i], "-o") == 0) {
+            if (i + 1 >= argc || strchr(argv[i + 1], '=') == NULL) {
+                fprintf(stderr, "BŁĄD: Brak pary klucz=wartość po parametrze -o\n");
+                fprintf(stderr, "Użyj: -o krzeselka=48\n");
+                return -1;
+            }
+            if (liczba_nadpisan >= MAX_NADPISAN) {
+                fprintf(stderr, "BŁĄD: Za dużo parametrów -o (max %d)\n", MAX_NADPISAN);
+                return -1;
+            }
+            nadpisania[liczba_nadpisan++] = argv[i + 1];
+            i++;
+
+        } else if (strcmp(argv[i], "-a") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "BŁĄD: Brak liczby po parametrze -a\n");
+                fprintf(stderr, "Użyj: -a <grup_na_sekunde>\n");
+                return -1;
+            }
+            int n;
+            if (parsuj_liczbe(argv[i + 1], &n) != 0 || n < 1 || n > MAX_GRUP_NA_SEKUNDE) {
+                fprintf(stderr, "BŁĄD: Napływ musi być liczbą 1-%d grup/s (podano: '%s')\n",
+                        MAX_GRUP_NA_SEKUNDE, argv[i + 1]);
+                return -1;
+            }
+            grup_na_sekunde = n;
+            i++;
+
         } else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-            printf("Użycie: %s [-t czas] [-n liczba_turystow]\n", argv[0]);
+            printf("Użycie: %s [-i instancja] [-c plik] [-o klucz=wartość]... [-l linie]"
+                   " [-t czas] [-n liczba_turystow] [-a grupy] [-f formaty]"
+                   " | -r dziennik [-f formaty]\n", argv[0]);
             printf("\n");
             printf("Parametry:\n");
             printf("  -t czas    Czas symulacji w sekundach (0 = nieskończoność)\n");
             printf("             Jeśli nie podano, program zapyta interaktywnie\n");
             printf("  -n liczba  Max liczba turystów (1-500, domyślnie 100)\n");
+            printf("  -a grupy   Napływ: grup turystów na sekundę (1-100; domyślnie\n");
+            printf("             jedna grupa co sekundę z prawdopodobieństwem %d%%)\n",
+                   PROCENT_GRUPY_NA_SEKUNDE);
+            printf("  -l linie   Liczba linii ośrodka 1-%d (jak KOLEJ_LINIE, domyślnie 1);\n",
+                   MAX_LINII);
+            printf("             KOLEJ_LINIE_CPU=0,1,... przypina pracowników linii do rdzeni\n");
+            printf("  -c plik    Konfiguracja kolei \"klucz = wartość\" (jak KOLEJ_KONFIG)\n");
+            printf("  -o k=w     Nadpisuje klucz konfiguracji (po pliku), np. -o krzeselka=48;\n");
+            printf("             klucze: krzeselka, krzeselka_lacznie, pojemnosc_krzeselka,\n");
+            printf("             max_rowerzystow, bramki_wejsciowe, bramki_peronowe,\n");
+            printf("             max_osob_na_stacji, kasjerzy, czas_sprzedazy_ms, procent_vip,\n");
+            printf("             czas_trasy_t1..t3, czas_tk1..tk3, linie\n");
+            printf("  KOLEJ_POLITYKA=<reguły>  rdzenie/nice/SCHED_FIFO ról, np.\n");
+            printf("             \"pracownik:cpu=0:fifo=10;turysta:cpu=1-3:nice=10\"\n");
+            printf("  -r plik    Bez symulacji - raport odtworzony z dziennika\n");
+            printf("  -f lista   Formaty raportu: tekst,csv,jsonl,bin (domyślnie tekst)\n");
+            printf("  -i numer   Instancja 0-%d: własne klucze IPC, FIFO i logs/instancja_<n>/\n",
+                   MAX_INSTANCJA);
+            printf("             (jak KOLEJ_INSTANCJA; pozwala na równoległe symulacje)\n");
             printf("  -h         Wyświetl tę pomoc\n");
             printf("\n");
             printf("Przykłady:\n");
@@ -530,6 +717,7 @@ int waliduj_parametry(int argc, char *argv[], int *czas_symulacji, int *max_tury
             printf("  %s -t 60        - symulacja przez 60 sekund\n", argv[0]);
             printf("  %s -t 0         - symulacja w nieskończoność\n", argv[0]);
             printf("  %s -t 120 -n 50 - 120 sekund, max 50 turystów\n", argv[0]);
+            printf("  %s -t 60 -o krzeselka=18 -o max_osob_na_stacji=20\n", argv[0]);
             return 1;
 
         } else {
@@ -542,15 +730,228 @@ int waliduj_parametry(int argc, char *argv[], int *czas_symulacji, int *max_tury
     return 0;
 }
 
+/* ========== KONFIGURACJA KOLEI ========== */
+/* config.h -> plik KOLEJ_KONFIG (-c) -> -o -> KOLEJ_LINIE (-l); konfiguracja.h */
+int zbuduj_konfiguracje(void) {
+    konfiguracja_domyslna(&konfiguracja);
+
+    const char *plik = getenv("KOLEJ_KONFIG");
+    if (plik != NULL && plik[0] != '\0' &&
+        konfiguracja_wczytaj_plik(&konfiguracja, plik) == -1) {
+        return -1;
+    }
+    for (int i = 0; i < liczba_nadpisan; i++) {
+        if (konfiguracja_ustaw_pare(&konfiguracja, nadpisania[i]) == -1) {
+            return -1;
+        }
+    }
+
+    const char *linie = getenv("KOLEJ_LINIE");
+    if (linie != NULL && linie[0] != '\0') {
+        konfiguracja.linie = linie_liczba_z_env();
+        if (konfiguracja.linie < 0) {
+            return -1;
+        }
+    }
+    if (konfiguracja_sprawdz(&konfiguracja) == -1) {
+        return -1;
+    }
+    liczba_linii = konfiguracja.linie;
+    return 0;
+}
+
+/* ========== ODTWORZENIE DNIA Z DZIENNIKA ========== */
+/* Stan budowany lokalnie (segmenty rejestru tworzy rejestr_dopisz);
+ * bramki raportu z bieżącej konfiguracji */
+int odtworz_z_dziennika(const char *plik) {
+    StanWspoldzielony *stan = aligned_alloc(_Alignof(StanWspoldzielony),
+                                            sizeof(StanWspoldzielony));
+    if (stan == NULL) {
+        perror("aligned_alloc");
+        return 1;
+    }
+    memset(stan, 0, sizeof(StanWspoldzielony));
+    stan->konfiguracja = konfiguracja;
+    stan->nastepny_bilet_id = 1;
+
+    WynikOdtworzenia wynik;
+    if (dziennik_odtworz(plik, stan, &wynik) == -1) {
+        free(stan);
+        return 1;
+    }
+
+    printf("Dziennik %s: %lu przejść, %lu zjazdów, %lu sprzedaży, %s%s\n", plik,
+           wynik.przejscia, wynik.zjazdy, wynik.sprzedaze,
+           wynik.zamkniety ? "zamknięty poprawnie" : "BEZ ZAMKNIĘCIA (awaria?)",
+           wynik.uciety_ogon ? ", ucięty ostatni zapis" : "");
+    if (wynik.luki > 0) {
+        printf("  Luki w dzienniku: %lu (wpisy utracone przed zapisem)\n", wynik.luki);
+    }
+
+    utworz_katalog_logs();
+    char sciezka[256];
+    generuj_raport(stan, instancja_log("raport_odtworzony.txt", sciezka, sizeof(sciezka)));
+    if (rejestr_zapisz_plik(stan, instancja_log("rejestr_odtworzony.kol", sciezka,
+                                                sizeof(sciezka))) == 0) {
+        printf("Rejestr kolumnowy zapisany do: %s\n", sciezka);
+    }
+
+    rejestr_odlacz(stan, true);
+    free(stan);
+    return 0;
+}
+
+/* ========== OPÓŹNIENIA PĘTLI PRACOWNIKÓW ========== */
+/* Granica kubełka ponad maksimum nic nie mówi - obcięta do maksimum */
+static unsigned long percentyl_obciety(const unsigned long *kubelki, unsigned long maks,
+                                       double procent) {
+    unsigned long p = (unsigned long)histogram_percentyl(kubelki, procent);
+    return (p > maks) ? maks : p;
+}
+
+/* Histogramy wszystkich linii razem; wartości to górne granice kubełków */
+void wypisz_opoznienia_pracownikow(const StanWspoldzielony *stan) {
+    unsigned long kubelki[LICZBA_KUBELKOW_OPOZNIEN] = {0};
+    unsigned long maks = 0;
+    unsigned long probek = 0;
+    for (int l = 0; l < liczba_linii; l++) {
+        const HistogramOpoznien *h = &stan->linie[l].opoznienia;
+        histogram_sumuj(h, kubelki);
+        unsigned long m = atomic_load_explicit(&h->maks_us, memory_order_relaxed);
+        if (m > maks) maks = m;
+    }
+    for (int k = 0; k < LICZBA_KUBELKOW_OPOZNIEN; k++) probek += kubelki[k];
+
+    const double procenty[] = {50.0, 99.0, 99.9};
+    unsigned long p[3];
+    for (int i = 0; i < 3; i++) {
+        p[i] = percentyl_obciety(kubelki, maks, procenty[i]);
+    }
+
+    printf("  Spóźnienie pętli pracowników (%lu wybudzeń):\n", probek);
+    printf("    p50 <= %lu us, p99 <= %lu us, p99.9 <= %lu us, max %lu us\n",
+           p[0], p[1], p[2], maks);
+}
+
+/* ========== POMIARY OBSŁUGI ========== */
+typedef struct {
+    unsigned long probek;
+    unsigned long srednia_us;
+    unsigned long p50_us;
+    unsigned long p99_us;
+    unsigned long maks_us;
+} PercentyleCzekania;
+
+static void percentyle_czekania(const HistogramOpoznien *h, PercentyleCzekania *p) {
+    unsigned long kubelki[LICZBA_KUBELKOW_OPOZNIEN] = {0};
+    histogram_sumuj(h, kubelki);
+    p->probek = 0;
+    for (int k = 0; k < LICZBA_KUBELKOW_OPOZNIEN; k++) p->probek += kubelki[k];
+    p->maks_us = atomic_load_explicit(&h->maks_us, memory_order_relaxed);
+    p->srednia_us = (p->probek > 0)
+                    ? atomic_load_explicit(&h->suma_us, memory_order_relaxed) / p->probek : 0;
+    p->p50_us = percentyl_obciety(kubelki, p->maks_us, 50.0);
+    p->p99_us = percentyl_obciety(kubelki, p->maks_us, 99.0);
+}
+
+/* Zajęte miejsca na wysłanych krzesełkach; rowerzysta liczy się za dwa */
+static double oblozenie_krzeselek(const StanWspoldzielony *stan) {
+    long krzeselka = atomic_load(&stan->pomiary.krzeselka_wyslane);
+    if (krzeselka == 0) return 0.0;
+    return (double)atomic_load(&stan->pomiary.miejsca_zajete) /
+           ((double)krzeselka * konfiguracja.pojemnosc_krzeselka);
+}
+
+static void wypisz_czekanie(const char *nazwa, const HistogramOpoznien *h) {
+    PercentyleCzekania c;
+    percentyle_czekania(h, &c);
+    printf("  %s (%lu):\n", nazwa, c.probek);
+    printf("    średnio %lu us, p50 <= %lu us, p99 <= %lu us, max %lu us\n",
+           c.srednia_us, c.p50_us, c.p99_us, c.maks_us);
+}
+
+void wypisz_pomiary_obslugi(const StanWspoldzielony *stan) {
+    wypisz_czekanie("Czekanie na bilet", &stan->pomiary.czekanie_bilet);
+    wypisz_czekanie("Czekanie na stację i bramkę", &stan->pomiary.czekanie_bramka);
+    wypisz_czekanie("Czekanie na krzesełko od prośby o peron", &stan->pomiary.czekanie_krzeselko);
+    wypisz_czekanie("Zjazd VIP od kasy/bramki do krzesełka", &stan->pomiary.obsluga_vip);
+    wypisz_czekanie("Zjazd zwykły od kasy/bramki do krzesełka", &stan->pomiary.obsluga_zwykla);
+    printf("  Obłożenie krzesełek:       %-34.3f \n", oblozenie_krzeselek(stan));
+}
+
+/* ========== WYNIK PRZEBIEGU ========== */
+/* Wiersze klucz=wartość w katalogu logów instancji - czyta je przeglad
+ * (przeglad.c). Przepustowość na godzinę liczona od czasu godzin pracy */
+int zapisz_wynik_przebiegu(const StanWspoldzielony *stan, long czas_pracy_s, int turystow,
+                           const char *sciezka) {
+    FILE *f = fopen(sciezka, "w");
+    if (f == NULL) {
+        perror(sciezka);
+        return -1;
+    }
+
+    PercentyleCzekania bilet, bramka, krzeselko, vip, zwykla;
+    percentyle_czekania(&stan->pomiary.czekanie_bilet, &bilet);
+    percentyle_czekania(&stan->pomiary.czekanie_bramka, &bramka);
+    percentyle_czekania(&stan->pomiary.czekanie_krzeselko, &krzeselko);
+    percentyle_czekania(&stan->pomiary.obsluga_vip, &vip);
+    percentyle_czekania(&stan->pomiary.obsluga_zwykla, &zwykla);
+    long osoby = atomic_load(&stan->pomiary.osoby_wyslane);
+    int zjazdy = licznik_suma(stan, LICZNIK_ZJAZDY);
+    double godziny = (czas_pracy_s > 0) ? czas_pracy_s / 3600.0 : 0.0;
+
+    fprintf(f, "czas_pracy_s=%ld\n", czas_pracy_s);
+    fprintf(f, "turysci_wygenerowani=%d\n", turystow);
+    fprintf(f, "bilety=%d\n", licznik_suma(stan, LICZNIK_BILETY));
+    fprintf(f, "zjazdy=%d\n", zjazdy);
+    fprintf(f, "osoby=%ld\n", osoby);
+    fprintf(f, "zjazdow_na_godzine=%.1f\n", godziny > 0 ? zjazdy / godziny : 0.0);
+    fprintf(f, "osob_na_godzine=%.1f\n", godziny > 0 ? osoby / godziny : 0.0);
+    fprintf(f, "czekanie_bilet_srednia_us=%lu\n", bilet.srednia_us);
+    fprintf(f, "czekanie_bilet_p50_us=%lu\n", bilet.p50_us);
+    fprintf(f, "czekanie_bilet_p99_us=%lu\n", bilet.p99_us);
+    fprintf(f, "czekanie_bramka_srednia_us=%lu\n", bramka.srednia_us);
+    fprintf(f, "czekanie_bramka_p99_us=%lu\n", bramka.p99_us);
+    fprintf(f, "czekanie_krzeselko_srednia_us=%lu\n", krzeselko.srednia_us);
+    fprintf(f, "czekanie_krzeselko_p50_us=%lu\n", krzeselko.p50_us);
+    fprintf(f, "czekanie_krzeselko_p99_us=%lu\n", krzeselko.p99_us);
+    fprintf(f, "oblozenie_krzeselek=%.3f\n", oblozenie_krzeselek(stan));
+    fprintf(f, "zjazdy_vip=%lu\n", vip.probek);
+    fprintf(f, "obsluga_vip_srednia_us=%lu\n", vip.srednia_us);
+    fprintf(f, "obsluga_vip_p99_us=%lu\n", vip.p99_us);
+    fprintf(f, "obsluga_zwykla_srednia_us=%lu\n", zwykla.srednia_us);
+    fprintf(f, "obsluga_zwykla_p99_us=%lu\n", zwykla.p99_us);
+
+    if (fclose(f) == EOF) {
+        perror(sciezka);
+        return -1;
+    }
+    return 0;
+}
+
 /* ========== GŁÓWNA FUNKCJA PROGRAMU ========== */
 int main(int argc, char *argv[]) {
     int czas_symulacji, max_turystow;
+    const char *dziennik;
 
     /* Walidacja parametrów */
-    int wynik = waliduj_parametry(argc, argv, &czas_symulacji, &max_turystow);
+    int wynik = waliduj_parametry(argc, argv, &czas_symulacji, &max_turystow, &dziennik);
     if (wynik != 0) {
         return (wynik > 0) ? 0 : 1;
     }
+    if (instancja_id() < 0) {
+        return 1;
+    }
+    if (zbuduj_konfiguracje() == -1) {
+        return 1;
+    }
+    if (polityka_wczytaj() == -1) {
+        return 1;
+    }
+
+    if (dziennik != NULL) {
+        return odtworz_z_dziennika(dziennik);
+    }
 
     /* Jeśli czas nie podany przez argumenty - zapytaj użytkownika */
     if (czas_symulacji == -1) {
@@ -560,6 +961,7 @@ int main(int argc, char *argv[]) {
     /* Inicjalizacja */
     srand(time(NULL) ^ getpid());
     utworz_katalog_logs();
+    log_limity_wyczysc();       /* Okna limitów poprzedniego przebiegu */
     wyswietl_banner(czas_symulacji);
     
     /* Ustawienie obsługi sygnałów */
@@ -584,7 +986,7 @@ int main(int argc, char *argv[]) {
     }
     
     /* Inicjalizacja zasobów IPC */
-    if (inicjalizuj_wszystkie_zasoby(&zasoby) == -1) {
+    if (inicjalizuj_wszystkie_zasoby(&zasoby, &konfiguracja) == -1) {
         fprintf(stderr, "BŁĄD: Nie można zainicjalizować zasobów IPC\n");
         fprintf(stderr, "Spróbuj: make clean-ipc\n");
         usun_fifo_wszystkie();
@@ -595,8 +997,11 @@ int main(int argc, char *argv[]) {
     
     printf("Zasoby IPC zainicjalizowane pomyślnie.\n");
     
-    /* Inicjalizacja logowania */
-    logger_init("logs/main.log");
+    /* Inicjalizacja logowania - wątki main (monitor, statystyki) logują asynchronicznie */
+    char sciezka[256];
+    logger_init(instancja_log("main.log", sciezka, sizeof(sciezka)));
+    logger_rotuj_segmenty(instancja_log("wszyscy_turysci.log", sciezka, sizeof(sciezka)));
+    logger_start_async(0);
     LOG_I("=== ROZPOCZĘCIE SYMULACJI KOLEI LINOWEJ ===");
     if (czas_symulacji == -1) {
         LOG_I("Parametry: NIESKOŃCZONY czas, max %d turystów", max_turystow);
@@ -606,12 +1011,21 @@ int main(int argc, char *argv[]) {
     
     StanWspoldzielony *stan = zasoby.shm.stan;
     
+    /* Dziennik przed procesami - kasjer i turyści piszą od pierwszego wpisu */
+    if (dziennik_uruchom(stan, instancja_log("dziennik.bin", sciezka, sizeof(sciezka))) == -1) {
+        LOG_E("MAIN: Nie udało się uruchomić dziennika - brak trwałości rejestru");
+    }
+    
     printf("Uruchamianie procesów obsługi...\n");
 
     /* Uruchomienie procesów */
-    uruchom_kasjer();
-    uruchom_pracownika(1);
-    uruchom_pracownika(2);
+    for (int i = 0; i < konfiguracja.kasjerzy; i++) {
+        uruchom_kasjer(i);
+    }
+    for (int l = 0; l < liczba_linii; l++) {
+        uruchom_pracownika(1, l);
+        uruchom_pracownika(2, l);
+    }
     
     /* Uruchomienie wątku monitorowania */
     if (pthread_create(&watek_monitora, NULL, watek_monitor_funkcja, NULL) != 0) {
@@ -629,6 +1043,7 @@ int main(int argc, char *argv[]) {
     
     /* Główna pętla symulacji */
     time_t czas_start = time(NULL);
+    long czas_pracy_s = -1;     /* Do zamknięcia kolei (wynik przebiegu) */
     int nastepny_id = 1;
     time_t ostatni_turysta = 0;
     int tryb_nieskonczonosci = (czas_symulacji == -1);
@@ -640,16 +1055,22 @@ int main(int argc, char *argv[]) {
         /* Sprawdź koniec symulacji (tylko jeśli nie tryb nieskończony) */
         if (!tryb_nieskonczonosci && czas_dzialania >= czas_symulacji) {
             LOG_I("MAIN: Koniec godzin pracy kolei");
+            czas_pracy_s = (long)czas_dzialania;
 
             sem_czekaj_sysv(zasoby.sem.sem_id, SEM_IDX_STAN);
-            stan->godziny_pracy = false;
+            stan_zapis_poczatek(stan);
+            STAN_USTAW(stan, godziny_pracy, false);
+            stan_zapis_koniec(stan);
             sem_sygnalizuj_sysv(zasoby.sem.sem_id, SEM_IDX_STAN);
 
             printf("\n\nKolej zamknięta! Oczekiwanie na opuszczenie stacji...\n");
 
+            /* Stacja i peron z jednej migawki - przejście stacja -> peron
+             * nie pokaże chwilowego zera */
             int timeout = CZAS_WYLACZENIA_PO_ZAMKNIECIU;
-            while (timeout > 0 && (stan->liczba_osob_na_stacji > 0 ||
-                                    stan->liczba_osob_na_peronie > 0)) {
+            MigawkaStanu m;
+            while (timeout > 0 && (stan_migawka(stan, &m), m.liczba_osob_na_stacji > 0 ||
+                                                           m.liczba_osob_na_peronie > 0)) {
                 /* BLOKUJĄCE czekanie z timeoutem zamiast busy waiting */
                 struct timeval tv;
                 tv.tv_sec = 1;
@@ -659,16 +1080,23 @@ int main(int argc, char *argv[]) {
             }
 
             sem_czekaj_sysv(zasoby.sem.sem_id, SEM_IDX_STAN);
-            stan->kolej_aktywna = false;
+            stan_zapis_poczatek(stan);
+            STAN_USTAW(stan, kolej_aktywna, false);
+            stan_zapis_koniec(stan);
             sem_sygnalizuj_sysv(zasoby.sem.sem_id, SEM_IDX_STAN);
 
             break;
         }
         
         /* Generuj nowych turystów */
-        if (teraz - ostatni_turysta >= 1 && stan->godziny_pracy &&
+        if (teraz - ostatni_turysta >= 1 && STAN_CZYTAJ(stan, godziny_pracy) &&
             nastepny_id <= max_turystow) {
-            if (rand() % 100 < 70) {
+            if (grup_na_sekunde > 0) {
+                for (int g = 0; g < grup_na_sekunde && nastepny_id <= max_turystow; g++) {
+                    generuj_grupe(&nastepny_id);
+                }
+                ostatni_turysta = teraz;
+            } else if (rand() % 100 < PROCENT_GRUPY_NA_SEKUNDE) {
                 generuj_grupe(&nastepny_id);
                 ostatni_turysta = teraz;
             }
@@ -683,27 +1111,60 @@ int main(int argc, char *argv[]) {
     
     printf("\n\nZatrzymywanie symulacji...\n");
     LOG_I("MAIN: Zatrzymywanie symulacji");
+    if (czas_pracy_s < 0) {
+        czas_pracy_s = (long)(time(NULL) - czas_start);  /* Przerwana sygnałem */
+    }
     
     /* WAŻNE: Najpierw zatrzymaj i poczekaj na wszystkie procesy */
     zatrzymaj_i_czekaj_na_procesy();
     
+    /* Piszący zakończeni - utrwal resztę dziennika */
+    dziennik_zatrzymaj();
+    
     /* Generuj raport */
     printf("Generowanie raportu...\n");
-    generuj_raport(stan, "logs/raport_dzienny.txt");
+    generuj_raport(stan, instancja_log("raport_dzienny.txt", sciezka, sizeof(sciezka)));
+    
+    /* Rejestr znika razem z pamięcią współdzieloną - zapisz go kolumnowo */
+    if (rejestr_zapisz_plik(stan, instancja_log("rejestr_dzienny.kol", sciezka,
+                                                sizeof(sciezka))) == -1) {
+        LOG_E("MAIN: Nie udało się zapisać rejestru kolumnowego");
+    }
     
     /* Podsumowanie */
     printf("\n");
     printf("---------------------------------------------------------------\n");
     printf("                    PODSUMOWANIE DNIA                          \n");
-    printf("  Łączna liczba zjazdów:     %-34d \n", stan->laczna_liczba_zjazdow);
-    printf("  Sprzedanych biletów:       %-34d \n", stan->liczba_sprzedanych_biletow);
+    printf("  Łączna liczba zjazdów:     %-34d \n", licznik_suma(stan, LICZNIK_ZJAZDY));
+    printf("  Sprzedanych biletów:       %-34d \n", licznik_suma(stan, LICZNIK_BILETY));
     printf("  Wpisów w rejestrze:        %-34d \n", stan->liczba_wpisow_rejestru);
+    if (stan->odrzucone_wpisy_rejestru > 0) {
+        printf("  Odrzuconych przez rejestr: %-34d \n", stan->odrzucone_wpisy_rejestru);
+    }
+    if (liczba_linii > 1) {
+        for (int l = 0; l < liczba_linii; l++) {
+            printf("  Zjazdy linii %d:            %-34d \n", l,
+                   licznik_linii(stan, l, LICZNIK_ZJAZDY));
+        }
+    }
+    wypisz_pomiary_obslugi(stan);
+    wypisz_opoznienia_pracownikow(stan);
     printf("---------------------------------------------------------------\n");
+    
+    if (zapisz_wynik_przebiegu(stan, czas_pracy_s, nastepny_id - 1,
+                               instancja_log("wynik_przebiegu.txt", sciezka,
+                                             sizeof(sciezka))) == -1) {
+        LOG_E("MAIN: Nie udało się zapisać wyniku przebiegu");
+    }
     printf("\n");
     
     LOG_I(" ZAKOŃCZENIE SYMULACJI ");
     logger_close();         
     
+    /* Turyści zabici przed logger_close() nie przycięli wspólnego segmentu */
+    log_segmenty_przytnij(instancja_log("wszyscy_turysci.log", sciezka, sizeof(sciezka)));
+    log_limity_wyczysc();
+    
     /* DOPIERO TERAZ czyść zasoby IPC - po zakończeniu wszystkich procesów */
     printf("Czyszczenie zasobów IPC...\n");
     close(pipe_monitor.fd_read);
@@ -0,0 +1,203 @@
+#include <string.h>
+#include <math.h>
+#include "config.h"
+#include "model.h"
+#include "konfiguracja.h"
+
+#define ITERACJE_MODELU 100
+
+static const char *nazwy_etapow[LICZBA_ETAPOW] = {
+    "kasa", "stacja", "bramki", "peron", "krzeselka"
+};
+
+const char *model_nazwa_etapu(EtapModelu etap) {
+    return (etap >= 0 && etap < LICZBA_ETAPOW) ? nazwy_etapow[etap] : "?";
+}
+
+/* ========== KOLEJKA M/G/c ========== */
+/* Prawdopodobieństwo czekania M/M/c przy ruchu a = lambda * S (a < c);
+ * Erlang B rekurencyjnie po liczbie serwerów, bez silni */
+static double erlang_c(int c, double a) {
+    double b = 1.0;
+    for (int n = 1; n <= c; n++) {
+        b = a * b / (n + a * b);
+    }
+    double rho = a / c;
+    return b / (1.0 - rho * (1.0 - b));
+}
+
+/* Wq Erlanga C razy (ca^2 + cs^2) / 2 - napływ Poissona (ca^2 = 1),
+ * cs^2 = 0 dla obsługi o stałym czasie */
+static void etap_mgc(EtapPrzewidywania *e, double lambda, int c, double obsluga_us,
+                     double cs2) {
+    double s = obsluga_us / 1e6;
+    double a = lambda * s;
+
+    e->zgloszen_na_s = lambda;
+    e->serwery = c;
+    e->obsluga_us = obsluga_us;
+    e->obciazenie = a / c;
+    if (lambda <= 0.0 || s <= 0.0) {
+        e->czekanie_us = 0.0;
+        e->czekanie_p99_us = 0.0;
+        return;
+    }
+    if (e->obciazenie >= 1.0) {
+        e->czekanie_us = MODEL_NASYCONY;
+        e->czekanie_p99_us = MODEL_NASYCONY;
+        return;
+    }
+
+    double p_czekania = erlang_c(c, a);
+    double zmiennosc = (1.0 + cs2) / 2.0;
+    double nadmiar = c / s - lambda;            /* c*mu - lambda, 1/s */
+    e->czekanie_us = p_czekania / nadmiar * zmiennosc * 1e6;
+    /* P(Wq > t) = C * exp(-nadmiar * t) */
+    e->czekanie_p99_us = (p_czekania > 0.01)
+                         ? log(p_czekania / 0.01) / nadmiar * zmiennosc * 1e6 : 0.0;
+}
+
+/* Czekanie w s do czasu cyklu; nasycony etap liczony jako limit */
+static double czekanie_s(const EtapPrzewidywania *e, double limit_s) {
+    return (e->czekanie_us == MODEL_NASYCONY) ? limit_s : e->czekanie_us / 1e6;
+}
+
+/* ========== ZJAZDY NA TURYSTĘ ========== */
+/* k-ty zjazd wymaga ważnego biletu ((k-1) cykli od zakupu) i tego, że
+ * turysta nie wyszedł po żadnym z poprzednich (PROCENT_KONCA_DNIA) */
+static double zjazdow_na_bilet(double waznosc_s, double cykl_s) {
+    double q = 1.0 - PROCENT_KONCA_DNIA / 100.0;
+    double zjazdow_max = 1.0 + floor(waznosc_s / cykl_s);
+    return (1.0 - pow(q, zjazdow_max)) / (1.0 - q);
+}
+
+/* Typ biletu losowany równo (turysta.c); żaden bilet nie działa dłużej
+ * niż turyście zostało do zamknięcia */
+static double zjazdow_na_turyste(const KonfiguracjaKolei *k, double cykl_s, double pozostalo_s) {
+    double suma = 1.0;                          /* Jednorazowy */
+    for (int i = 0; i < 3; i++) {
+        suma += zjazdow_na_bilet(fmin(k->czas_tk[i], pozostalo_s), cykl_s);
+    }
+    suma += zjazdow_na_bilet(fmin(CZAS_ZAMKNIECIA, pozostalo_s), cykl_s);
+    return suma / LICZBA_TYPOW_BILETOW;
+}
+
+/* ========== MODEL ========== */
+int model_przewiduj(const KonfiguracjaKolei *k, int turystow, int grup_na_sekunde,
+                    int czas_s, PrzewidywanieModelu *p) {
+    if (k->linie < 1 || turystow < 1 || grup_na_sekunde < 0 || czas_s < 1) {
+        return -1;
+    }
+    memset(p, 0, sizeof(PrzewidywanieModelu));
+
+    /* Napływ jak main: grupa to dorosły i z PROCENT_GRUP_Z_DZIECMI
+     * 1..MAX_DZIECI_POD_OPIEKA dzieci; po -n turystach napływ ustaje */
+    double grupa = 1.0 + PROCENT_GRUP_Z_DZIECMI / 100.0 * (1 + MAX_DZIECI_POD_OPIEKA) / 2.0;
+    double grup_na_s = (grup_na_sekunde > 0) ? grup_na_sekunde
+                                             : PROCENT_GRUPY_NA_SEKUNDE / 100.0;
+    double okno_s = fmin(czas_s, turystow / (grup_na_s * grupa));
+    double lambda_t = fmin(grup_na_s * grupa, turystow / (double)czas_s);
+    double pozostalo_s = czas_s - okno_s / 2.0;
+
+    /* Rowerzystami bywają tylko dorośli - dzieci pod opieką mają < 12 lat */
+    double p_rower = PROCENT_ROWERZYSTOW / 100.0 / grupa;
+    double trasa_s = p_rower * (k->czas_trasy[0] + k->czas_trasy[1] + k->czas_trasy[2]) / 3.0;
+    double miejsc_na_osobe = 1.0 + p_rower;
+    double osob = fmin(grupa, k->pojemnosc_krzeselka / miejsc_na_osobe);
+    /* Dzieci kupują bilety po opiekunie - pracownik1 wysyła go, zanim
+     * dotrą ich prośby, i dzieci wsiadają z nim w jego następnym cyklu */
+    double udzial_dzieci = (grupa - 1.0) / grupa;
+
+    /* Ostatnia bramka to pas VIP (turysta.c) - zwykłym zostaje o jedną mniej */
+    int bramki_zwykle = (k->bramki_wejsciowe > 1) ? k->bramki_wejsciowe - 1 : 1;
+    int miejsca_zwykle = k->max_osob_na_stacji - konfiguracja_miejsca_vip(k);
+    double kasa_us = k->czas_sprzedazy_ms * 1000.0 + OKRES_KASJERA_MS * 1000.0 / 2.0;
+    double peron_us = OKRES_PRACOWNIKA1_MS * 1000.0;
+    /* Przyjazd wykrywany, gdy różnica time() osiągnie CZAS_JAZDY_KRZESELKA -
+     * średnio pół sekundy przed pełnym czasem - w pętli pracownika2 */
+    double krzeselko_us = (CZAS_JAZDY_KRZESELKA - 0.5) * 1e6 +
+                          OKRES_PRACOWNIKA2_MS * 1000.0 / 2.0;
+
+    EtapPrzewidywania *e = p->etapy;
+    double zjazdow = 1.0;
+    double stacja_us = 0.0;
+    for (int it = 0; it < ITERACJE_MODELU; it++) {
+        double lambda_linii = lambda_t * zjazdow / k->linie;
+
+        etap_mgc(&e[ETAP_KASA], lambda_t, k->kasjerzy, kasa_us, 0.0);
+        etap_mgc(&e[ETAP_PERON], lambda_linii, 1, peron_us, 0.0);
+        etap_mgc(&e[ETAP_KRZESELKA], lambda_linii / osob, k->krzeselka, krzeselko_us, 0.0);
+
+        /* Miejsce na stacji zwalnia dopiero koniec trasy */
+        stacja_us = (czekanie_s(&e[ETAP_PERON], czas_s) + peron_us / 1e6 +
+                     czekanie_s(&e[ETAP_KRZESELKA], czas_s) + CZAS_JAZDY_KRZESELKA +
+                     trasa_s) * 1e6;
+        etap_mgc(&e[ETAP_STACJA], lambda_linii, miejsca_zwykle, stacja_us, 1.0);
+        etap_mgc(&e[ETAP_BRAMKI], lambda_linii, bramki_zwykle, CZAS_BRAMKI_US, 0.0);
+
+        double cykl_s = czekanie_s(&e[ETAP_STACJA], czas_s) +
+                        czekanie_s(&e[ETAP_BRAMKI], czas_s) + stacja_us / 1e6;
+        double nowe = zjazdow_na_turyste(k, cykl_s, pozostalo_s);
+        if (fabs(nowe - zjazdow) < 1e-6) {
+            break;
+        }
+        /* Tłumienie - dłuższe czekanie to mniej zjazdów i odwrotnie */
+        zjazdow = (zjazdow + nowe) / 2.0;
+    }
+    p->turystow_na_s = lambda_t;
+    p->zjazdow_na_turyste = zjazdow;
+    p->osob_na_krzeselko = osob;
+
+    /* Przepustowość etapów w zjazdach (osobach) na sekundę */
+    e[ETAP_KASA].zjazdow_max_na_s = k->kasjerzy / (kasa_us / 1e6) * zjazdow;
+    /* Stacja i bramki jak w etap_mgc() wyżej - bez rezerwy i pasa VIP */
+    e[ETAP_STACJA].zjazdow_max_na_s = k->linie * miejsca_zwykle / (stacja_us / 1e6);
+    e[ETAP_BRAMKI].zjazdow_max_na_s = k->linie * bramki_zwykle / (CZAS_BRAMKI_US / 1e6);
+    e[ETAP_PERON].zjazdow_max_na_s = k->linie / (peron_us / 1e6);
+    e[ETAP_KRZESELKA].zjazdow_max_na_s = k->linie * k->krzeselka / (krzeselko_us / 1e6) * osob;
+
+    double zjazdow_na_s = lambda_t * zjazdow;
+    p->waskie_gardlo = ETAP_KASA;
+    for (int i = 0; i < LICZBA_ETAPOW; i++) {
+        zjazdow_na_s = fmin(zjazdow_na_s, e[i].zjazdow_max_na_s);
+        if (e[i].obciazenie > e[p->waskie_gardlo].obciazenie) {
+            p->waskie_gardlo = (EtapModelu)i;
+        }
+    }
+    p->osob_na_godzine = zjazdow_na_s * 3600.0;
+    p->zjazdow_na_godzine = zjazdow_na_s / osob * 3600.0;
+
+    /* Czekania tak, jak mierzy je turysta */
+    const EtapPrzewidywania *kasa = &e[ETAP_KASA];
+    const EtapPrzewidywania *stacja = &e[ETAP_STACJA];
+    const EtapPrzewidywania *bramki = &e[ETAP_BRAMKI];
+    const EtapPrzewidywania *peron = &e[ETAP_PERON];
+    const EtapPrzewidywania *krzeselka = &e[ETAP_KRZESELKA];
+
+    if (kasa->czekanie_us == MODEL_NASYCONY) {
+        p->czekanie_bilet_us = MODEL_NASYCONY;
+        p->czekanie_bilet_p99_us = MODEL_NASYCONY;
+    } else {
+        p->czekanie_bilet_us = kasa->czekanie_us + kasa_us;
+        p->czekanie_bilet_p99_us = kasa->czekanie_p99_us + kasa_us;
+    }
+    if (stacja->czekanie_us == MODEL_NASYCONY || bramki->czekanie_us == MODEL_NASYCONY) {
+        p->czekanie_bramka_us = MODEL_NASYCONY;
+    } else {
+        p->czekanie_bramka_us = stacja->czekanie_us + bramki->czekanie_us + CZAS_BRAMKI_US;
+    }
+    if (peron->czekanie_us == MODEL_NASYCONY || krzeselka->czekanie_us == MODEL_NASYCONY) {
+        p->czekanie_krzeselko_us = MODEL_NASYCONY;
+        p->czekanie_krzeselko_p99_us = MODEL_NASYCONY;
+    } else {
+        /* Dziecko czeka dodatkowo cykl opiekuna - jego czas na stacji */
+        p->czekanie_krzeselko_us = peron->czekanie_us + peron_us + krzeselka->czekanie_us +
+                                   udzial_dzieci * stacja_us;
+        /* Suma ogonów - górne oszacowanie p99 sumy */
+        p->czekanie_krzeselko_p99_us = peron->czekanie_p99_us + peron_us +
+                                       krzeselka->czekanie_p99_us +
+                                       ((udzial_dzieci > 0.01) ? stacja_us : 0.0);
+    }
+    p->oblozenie_krzeselek = fmin(1.0, osob * miejsc_na_osobe / k->pojemnosc_krzeselka);
+    return 0;
+}
@@ -6,33 +6,38 @@
 #include <sys/stat.h>
 #include <errno.h>
 #include "pipe_comm.h"
+#include "instancja.h"
+
+/* Ścieżka FIFO w /tmp tej instancji */
+#define SCIEZKA_FIFO(nazwa, bufor) instancja_nazwa("/tmp/", (nazwa), (bufor), sizeof(bufor))
 
 /* ========== TWORZENIE WSZYSTKICH FIFO ========== */
 int utworz_fifo_wszystkie(void) {
+    char sciezka[128];
     /* Usuń stare FIFO jeśli istnieją */
-    unlink(FIFO_KASJER_REQUEST);
-    unlink(FIFO_KASJER_RESPONSE);
-    unlink(FIFO_PRACOWNIK_SYNC);
-    unlink(FIFO_RAPORT);
+    unlink(SCIEZKA_FIFO(FIFO_KASJER_REQUEST, sciezka));
+    unlink(SCIEZKA_FIFO(FIFO_KASJER_RESPONSE, sciezka));
+    unlink(SCIEZKA_FIFO(FIFO_PRACOWNIK_SYNC, sciezka));
+    unlink(SCIEZKA_FIFO(FIFO_RAPORT, sciezka));
     
     /* Tworzenie łączy nazwanych z minimalnymi uprawnieniami */
     /* 0620 = właściciel: rw, grupa: w, inni: brak */
-    if (mkfifo(FIFO_KASJER_REQUEST, 0620) == -1 && errno != EEXIST) {
+    if (mkfifo(SCIEZKA_FIFO(FIFO_KASJER_REQUEST, sciezka), 0620) == -1 && errno != EEXIST) {
         perror("mkfifo kasjer_request");
         return -1;
     }
     
-    if (mkfifo(FIFO_KASJER_RESPONSE, 0640) == -1 && errno != EEXIST) {
+    if (mkfifo(SCIEZKA_FIFO(FIFO_KASJER_RESPONSE, sciezka), 0640) == -1 && errno != EEXIST) {
         perror("mkfifo kasjer_response");
         return -1;
     }
     
-    if (mkfifo(FIFO_PRACOWNIK_SYNC, 0660) == -1 && errno != EEXIST) {
+    if (mkfifo(SCIEZKA_FIFO(FIFO_PRACOWNIK_SYNC, sciezka), 0660) == -1 && errno != EEXIST) {
         perror("mkfifo pracownik_sync");
         return -1;
     }
     
-    if (mkfifo(FIFO_RAPORT, 0640) == -1 && errno != EEXIST) {
+    if (mkfifo(SCIEZKA_FIFO(FIFO_RAPORT, sciezka), 0640) == -1 && errno != EEXIST) {
         perror("mkfifo raport");
         return -1;
     }
@@ -42,22 +47,24 @@ int utworz_fifo_wszystkie(void) {
 
 /* ========== USUWANIE WSZYSTKICH FIFO ========== */
 void usun_fifo_wszystkie(void) {
-    unlink(FIFO_KASJER_REQUEST);
-    unlink(FIFO_KASJER_RESPONSE);
-    unlink(FIFO_PRACOWNIK_SYNC);
-    unlink(FIFO_RAPORT);
+    char sciezka[128];
+    unlink(SCIEZKA_FIFO(FIFO_KASJER_REQUEST, sciezka));
+    unlink(SCIEZKA_FIFO(FIFO_KASJER_RESPONSE, sciezka));
+    unlink(SCIEZKA_FIFO(FIFO_PRACOWNIK_SYNC, sciezka));
+    unlink(SCIEZKA_FIFO(FIFO_RAPORT, sciezka));
 }
 
 /* ========== OTWIERANIE FIFO - KASJER (SERWER) ========== */
 int otworz_fifo_kasjer_serwer(FifoKanaly *kanaly) {
+    char sciezka[128];
     /* Kasjer czyta prośby, pisze odpowiedzi */
-    kanaly->fd_kasjer_req = open(FIFO_KASJER_REQUEST, O_RDONLY | O_NONBLOCK);
+    kanaly->fd_kasjer_req = open(SCIEZKA_FIFO(FIFO_KASJER_REQUEST, sciezka), O_RDONLY | O_NONBLOCK);
     if (kanaly->fd_kasjer_req == -1) {
         perror("open fifo kasjer_req (serwer)");
         return -1;
     }
     
-    kanaly->fd_kasjer_resp = open(FIFO_KASJER_RESPONSE, O_WRONLY);
+    kanaly->fd_kasjer_resp = open(SCIEZKA_FIFO(FIFO_KASJER_RESPONSE, sciezka), O_WRONLY);
     if (kanaly->fd_kasjer_resp == -1) {
         perror("open fifo kasjer_resp (serwer)");
         close(kanaly->fd_kasjer_req);
@@ -72,14 +79,15 @@ int otworz_fifo_kasjer_serwer(FifoKanaly *kanaly) {
 
 /* ========== OTWIERANIE FIFO - TURYSTA (KLIENT) ========== */
 int otworz_fifo_kasjer_klient(FifoKanaly *kanaly) {
+    char sciezka[128];
     /* Turysta pisze prośby, czyta odpowiedzi */
-    kanaly->fd_kasjer_req = open(FIFO_KASJER_REQUEST, O_WRONLY);
+    kanaly->fd_kasjer_req = open(SCIEZKA_FIFO(FIFO_KASJER_REQUEST, sciezka), O_WRONLY);
     if (kanaly->fd_kasjer_req == -1) {
         perror("open fifo kasjer_req (klient)");
         return -1;
     }
     
-    kanaly->fd_kasjer_resp = open(FIFO_KASJER_RESPONSE, O_RDONLY);
+    kanaly->fd_kasjer_resp = open(SCIEZKA_FIFO(FIFO_KASJER_RESPONSE, sciezka), O_RDONLY);
     if (kanaly->fd_kasjer_resp == -1) {
         perror("open fifo kasjer_resp (klient)");
         close(kanaly->fd_kasjer_req);
@@ -94,16 +102,17 @@ int otworz_fifo_kasjer_klient(FifoKanaly *kanaly) {
 
 /* ========== OTWIERANIE FIFO - PRACOWNIK ========== */
 int otworz_fifo_pracownik(FifoKanaly *kanaly, int numer_pracownika) {
+    char sciezka[128];
     int flags = (numer_pracownika == 1) ? O_WRONLY : O_RDONLY;
     
-    kanaly->fd_prac_sync = open(FIFO_PRACOWNIK_SYNC, flags | O_NONBLOCK);
+    kanaly->fd_prac_sync = open(SCIEZKA_FIFO(FIFO_PRACOWNIK_SYNC, sciezka), flags | O_NONBLOCK);
     if (kanaly->fd_prac_sync == -1) {
         perror("open fifo prac_sync");
         return -1;
     }
     
     /* Pracownik może pisać do raportu */
-    kanaly->fd_raport = open(FIFO_RAPORT, O_WRONLY | O_NONBLOCK);
+    kanaly->fd_raport = open(SCIEZKA_FIFO(FIFO_RAPORT, sciezka), O_WRONLY | O_NONBLOCK);
     
     kanaly->fd_kasjer_req = -1;
     kanaly->fd_kasjer_resp = -1;
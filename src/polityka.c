@@ -0,0 +1,199 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include "polityka.h"
+
+/* ========== REGUŁY ========== */
+typedef struct {
+    bool ustawiona;
+    cpu_set_t cpu;              /* Pusty = bez zmiany rdzeni */
+    bool nice_ustawione;
+    int nice;
+    int fifo;                   /* 0 = SCHED_OTHER */
+} PolitykaRoli;
+
+static PolitykaRoli polityki[LICZBA_ROL];
+
+static const char *nazwy_rol[LICZBA_ROL] = {
+    [ROLA_KASJER] = "kasjer",
+    [ROLA_PRACOWNIK] = "pracownik",
+    [ROLA_TURYSTA] = "turysta",
+    [ROLA_MONITOR] = "monitor",
+};
+
+/* "0,2-3" */
+static int parsuj_cpu(const char *tekst, cpu_set_t *zbior) {
+    CPU_ZERO(zbior);
+    const char *p = tekst;
+    while (*p != '\0') {
+        char *koniec;
+        long od = strtol(p, &koniec, 10);
+        if (koniec == p || od < 0 || od >= CPU_SETSIZE) return -1;
+        long do_ = od;
+        if (*koniec == '-') {
+            p = koniec + 1;
+            do_ = strtol(p, &koniec, 10);
+            if (koniec == p || do_ < od || do_ >= CPU_SETSIZE) return -1;
+        }
+        for (long c = od; c <= do_; c++) CPU_SET((int)c, zbior);
+
+        if (*koniec == ',') {
+            p = koniec + 1;
+        } else if (*koniec == '\0') {
+            p = koniec;
+        } else {
+            return -1;
+        }
+    }
+    return CPU_COUNT(zbior) > 0 ? 0 : -1;
+}
+
+static int parsuj_liczbe_zakres(const char *tekst, int min, int max, int *wynik) {
+    char *koniec;
+    errno = 0;
+    long n = strtol(tekst, &koniec, 10);
+    if (errno != 0 || koniec == tekst || *koniec != '\0' || n < min || n > max) {
+        return -1;
+    }
+    *wynik = (int)n;
+    return 0;
+}
+
+/* "<rola>:<klucz>=<wartość>:..." - tekst modyfikowany */
+static int parsuj_regule(char *tekst) {
+    char *zapis;
+    char *rola = strtok_r(tekst, ":", &zapis);
+    if (rola == NULL) return -1;
+
+    int r;
+    for (r = 0; r < LICZBA_ROL; r++) {
+        if (strcmp(rola, nazwy_rol[r]) == 0) break;
+    }
+    if (r == LICZBA_ROL) return -1;
+
+    PolitykaRoli *p = &polityki[r];
+    p->ustawiona = true;
+
+    for (char *opcja = strtok_r(NULL, ":", &zapis); opcja != NULL;
+         opcja = strtok_r(NULL, ":", &zapis)) {
+        char *rowna = strchr(opcja, '=');
+        if (rowna == NULL) return -1;
+        *rowna = '\0';
+        const char *wartosc = rowna + 1;
+
+        if (strcmp(opcja, "cpu") == 0) {
+            if (parsuj_cpu(wartosc, &p->cpu) == -1) return -1;
+        } else if (strcmp(opcja, "nice") == 0) {
+            if (parsuj_liczbe_zakres(wartosc, -20, 19, &p->nice) == -1) return -1;
+            p->nice_ustawione = true;
+        } else if (strcmp(opcja, "fifo") == 0) {
+            if (parsuj_liczbe_zakres(wartosc, 1, 99, &p->fifo) == -1) return -1;
+        } else {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int polityka_wczytaj(void) {
+    memset(polityki, 0, sizeof(polityki));
+
+    const char *wartosc = getenv("KOLEJ_POLITYKA");
+    if (wartosc == NULL || *wartosc == '\0') return 0;
+
+    char kopia[512];
+    snprintf(kopia, sizeof(kopia), "%s", wartosc);
+
+    char *zapis;
+    for (char *tok = strtok_r(kopia, ";", &zapis); tok != NULL;
+         tok = strtok_r(NULL, ";", &zapis)) {
+        char regula[256];
+        snprintf(regula, sizeof(regula), "%s", tok);
+        if (parsuj_regule(tok) == -1) {
+            fprintf(stderr, "KOLEJ_POLITYKA: niepoprawna reguła '%s'\n", regula);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* ========== ZASTOSOWANIE ========== */
+int polityka_zastosuj(RolaProcesu rola) {
+    const PolitykaRoli *p = &polityki[rola];
+    if (!p->ustawiona) return 0;
+
+    int wynik = 0;
+
+    /* 0 = wywołujący wątek; przed exec() proces ma tylko jeden */
+    if (CPU_COUNT(&p->cpu) > 0 && sched_setaffinity(0, sizeof(cpu_set_t), &p->cpu) == -1) {
+        perror("polityka: sched_setaffinity");
+        wynik = -1;
+    }
+
+    /* Na Linuksie nice dotyczy wątku o danym tid */
+    if (p->nice_ustawione && setpriority(PRIO_PROCESS, (id_t)gettid(), p->nice) == -1) {
+        perror("polityka: setpriority");
+        wynik = -1;
+    }
+
+    if (p->fifo > 0) {
+        struct sched_param param = { .sched_priority = p->fifo };
+        if (sched_setscheduler(0, SCHED_FIFO, &param) == -1) {
+            if (errno == EPERM) {
+                fprintf(stderr, "polityka: brak uprawnień do SCHED_FIFO dla roli %s - "
+                        "zostaje SCHED_OTHER\n", nazwy_rol[rola]);
+            } else {
+                perror("polityka: sched_setscheduler");
+                wynik = -1;
+            }
+        }
+    }
+    return wynik;
+}
+
+/* ========== HISTOGRAM OPÓŹNIEŃ ========== */
+long czas_monotoniczny_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long)ts.tv_sec * 1000000L + ts.tv_nsec / 1000;
+}
+
+void histogram_dodaj(HistogramOpoznien *h, long us) {
+    atomic_fetch_add_explicit(&h->kubelki[histogram_kubelek(us)], 1, memory_order_relaxed);
+
+    unsigned long nowe = (us > 0) ? (unsigned long)us : 0;
+    atomic_fetch_add_explicit(&h->suma_us, nowe, memory_order_relaxed);
+    unsigned long maks = atomic_load_explicit(&h->maks_us, memory_order_relaxed);
+    while (nowe > maks &&
+           !atomic_compare_exchange_weak_explicit(&h->maks_us, &maks, nowe,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+    }
+}
+
+void histogram_sumuj(const HistogramOpoznien *h, unsigned long *kubelki) {
+    for (int k = 0; k < LICZBA_KUBELKOW_OPOZNIEN; k++) {
+        kubelki[k] += atomic_load_explicit(&h->kubelki[k], memory_order_relaxed);
+    }
+}
+
+long histogram_percentyl(const unsigned long *kubelki, double procent) {
+    unsigned long suma = 0;
+    for (int k = 0; k < LICZBA_KUBELKOW_OPOZNIEN; k++) suma += kubelki[k];
+    if (suma == 0) return 0;
+
+    /* Pierwszy kubełek, w którym skumulowana liczba osiąga procent próbek */
+    unsigned long prog = (unsigned long)((double)suma * procent / 100.0);
+    if (prog == 0) prog = 1;
+    unsigned long narastajaco = 0;
+    for (int k = 0; k < LICZBA_KUBELKOW_OPOZNIEN; k++) {
+        narastajaco += kubelki[k];
+        if (narastajaco >= prog) return 1L << k;
+    }
+    return 1L << (LICZBA_KUBELKOW_OPOZNIEN - 1);
+}
@@ -9,19 +9,32 @@
 #include "types.h"
 #include "ipc_utils.h"
 #include "logger.h"
+#include "instancja.h"
+#include "stan_kolei.h"
+#include "linie.h"
+#include "polityka.h"
+#include "konfiguracja.h"
 
 static volatile sig_atomic_t p1_dzialaj = 1;
 static volatile sig_atomic_t p1_kolej_zatrzymana = 0;
 static ZasobyIPC p1_zasoby;
+static int p1_linia = 0;
+
+/* Z konfiguracji (tylko do odczytu) - pobrane raz przy starcie */
+static Krzeselko *p1_krzeselka;
+static int p1_liczba_krzeselek;
+static int p1_pojemnosc;
+static int p1_max_rowerzystow;
 
 /* ========== ROZSZERZONA STRUKTURA GRUPY KRZESEŁKA ========== */
 typedef struct {
-    int osoby[POJEMNOSC_KRZESELKA];
-    int typy[POJEMNOSC_KRZESELKA];
-    int opiekunowie[POJEMNOSC_KRZESELKA];  /* ID opiekuna dla dzieci */
-    bool czy_dziecko[POJEMNOSC_KRZESELKA]; /* Czy to dziecko pod opieką */
+    int osoby[MAX_POJEMNOSC_KRZESELKA];
+    int typy[MAX_POJEMNOSC_KRZESELKA];
+    int opiekunowie[MAX_POJEMNOSC_KRZESELKA];  /* ID opiekuna dla dzieci */
+    bool czy_dziecko[MAX_POJEMNOSC_KRZESELKA]; /* Czy to dziecko pod opieką */
     int liczba;
     int liczba_rowerzystow;
+    int miejsca;                /* Pieszy 1, rowerzysta 2 */
     int liczba_dzieci;
 } GrupaKrzeselko;
 
@@ -33,6 +46,7 @@ typedef struct {
     int opiekun_id;       /* -1 jeśli dorosły lub dziecko bez opieki */
     int wiek;
     int liczba_dzieci;    /* Ile dzieci ten dorosły ma pod opieką (w kolejce) */
+    bool vip;             /* Przed zwykłymi, za wcześniejszymi VIP */
 } OczekujacyTurysta;
 
 #define MAX_OCZEKUJACYCH 200
@@ -81,7 +95,7 @@ void p1_ustaw_sygnaly(void) {
 
 void inicjalizuj_grupe(void) {
     memset(&aktualna_grupa, 0, sizeof(GrupaKrzeselko));
-    for (int i = 0; i < POJEMNOSC_KRZESELKA; i++) {
+    for (int i = 0; i < MAX_POJEMNOSC_KRZESELKA; i++) {
         aktualna_grupa.osoby[i] = -1;
         aktualna_grupa.typy[i] = -1;
         aktualna_grupa.opiekunowie[i] = -1;
@@ -123,18 +137,12 @@ int znajdz_opiekuna_w_kolejce(int opiekun_id) {
 
 /* ========== SPRAWDZENIE CZY TURYSTA MOŻE DOŁĄCZYĆ DO GRUPY ========== */
 bool moze_dolaczyc(OczekujacyTurysta *turysta) {
-    if (aktualna_grupa.liczba >= POJEMNOSC_KRZESELKA) return false;
-    
-    /* Sprawdzenie reguł dla rowerzystów */
-    if (turysta->typ == ROWERZYSTA) {
-        if (aktualna_grupa.liczba_rowerzystow >= MAX_ROWERZYSTOW_NA_KRZESELKU) return false;
-        if (aktualna_grupa.liczba_rowerzystow == 1 && 
-            (aktualna_grupa.liczba - aktualna_grupa.liczba_rowerzystow) > 1) return false;
-    } else {
-        if (aktualna_grupa.liczba_rowerzystow == 2) return false;
-        if (aktualna_grupa.liczba_rowerzystow == 1 && 
-            (aktualna_grupa.liczba - aktualna_grupa.liczba_rowerzystow) >= 2) return false;
-    }
+    /* Rowerzysta zajmuje dwa miejsca - przy 4 miejscach: 4 pieszych,
+     * rowerzysta i 2 pieszych albo 2 rowerzystów */
+    int miejsca = (turysta->typ == ROWERZYSTA) ? 2 : 1;
+    if (aktualna_grupa.miejsca + miejsca > p1_pojemnosc) return false;
+    if (turysta->typ == ROWERZYSTA &&
+        aktualna_grupa.liczba_rowerzystow >= p1_max_rowerzystow) return false;
     
     /* ========== LOGIKA DZIECI POD OPIEKĄ (4-8 LAT) ========== */
     if (turysta->dziecko_pod_opieka) {
@@ -175,9 +183,11 @@ void dodaj_do_grupy(OczekujacyTurysta *turysta) {
     aktualna_grupa.opiekunowie[idx] = turysta->opiekun_id;
     aktualna_grupa.czy_dziecko[idx] = turysta->dziecko_pod_opieka;
     aktualna_grupa.liczba++;
+    aktualna_grupa.miejsca++;
     
     if (turysta->typ == ROWERZYSTA) {
         aktualna_grupa.liczba_rowerzystow++;
+        aktualna_grupa.miejsca++;
     }
     if (turysta->dziecko_pod_opieka) {
         aktualna_grupa.liczba_dzieci++;
@@ -185,9 +195,9 @@ void dodaj_do_grupy(OczekujacyTurysta *turysta) {
 }
 
 bool grupa_pelna(void) {
-    if (aktualna_grupa.liczba >= POJEMNOSC_KRZESELKA) return true;
-    if (aktualna_grupa.liczba_rowerzystow >= MAX_ROWERZYSTOW_NA_KRZESELKU) return true;
-    if (aktualna_grupa.liczba_rowerzystow == 1 && aktualna_grupa.liczba >= 3) return true;
+    if (aktualna_grupa.miejsca >= p1_pojemnosc) return true;
+    if (aktualna_grupa.liczba_rowerzystow > 0 &&
+        aktualna_grupa.liczba_rowerzystow >= p1_max_rowerzystow) return true;
     return false;
 }
 
@@ -195,17 +205,18 @@ void wyslij_grupe_na_krzeselko(void) {
     if (aktualna_grupa.liczba == 0 || !p1_dzialaj) return;
     
     StanWspoldzielony *stan = p1_zasoby.shm.stan;
+    Linia *linia = &stan->linie[p1_linia];
     int sem_id = p1_zasoby.sem.sem_id;
     
-    sem_czekaj_sysv(sem_id, SEM_IDX_KRZESELKA);
+    sem_czekaj_sysv(sem_id, SEM_LINII(p1_linia, SEM_IDX_KRZESELKA));
     if (!p1_dzialaj) {
-        sem_sygnalizuj_sysv(sem_id, SEM_IDX_KRZESELKA);
+        sem_sygnalizuj_sysv(sem_id, SEM_LINII(p1_linia, SEM_IDX_KRZESELKA));
         return;
     }
     
-    sem_czekaj_sysv(sem_id, SEM_IDX_STAN);
-    int idx = stan->nastepne_krzeselko_idx;
-    Krzeselko *k = &stan->krzeselka[idx];
+    sem_czekaj_sysv(sem_id, SEM_LINII(p1_linia, SEM_IDX_LINIA));
+    int idx = linia->nastepne_krzeselko_idx;
+    Krzeselko *k = &p1_krzeselka[idx];
     
     k->aktywne = true;
     k->liczba_pasazerow = aktualna_grupa.liczba;
@@ -216,9 +227,14 @@ void wyslij_grupe_na_krzeselko(void) {
         k->pasazerowie[i] = aktualna_grupa.osoby[i];
     }
     
-    stan->nastepne_krzeselko_idx = (idx + 1) % MAX_AKTYWNYCH_KRZESELEK;
-    stan->liczba_aktywnych_krzeselek++;
-    sem_sygnalizuj_sysv(sem_id, SEM_IDX_STAN);
+    linia->nastepne_krzeselko_idx = (idx + 1) % p1_liczba_krzeselek;
+    sem_sygnalizuj_sysv(sem_id, SEM_LINII(p1_linia, SEM_IDX_LINIA));
+    licznik_dodaj(stan, p1_linia, SHARD_PRACOWNIK1, LICZNIK_KRZESELKA, 1);
+    atomic_fetch_add_explicit(&stan->pomiary.krzeselka_wyslane, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&stan->pomiary.osoby_wyslane, aktualna_grupa.liczba,
+                              memory_order_relaxed);
+    atomic_fetch_add_explicit(&stan->pomiary.miejsca_zajete, aktualna_grupa.miejsca,
+                              memory_order_relaxed);
     
     LOG_I("PRACOWNIK1: Wysyłam krzesełko #%d z %d osobami", idx, aktualna_grupa.liczba);
     
@@ -242,13 +258,17 @@ void p1_zatrzymaj_kolej(void) {
     
     LOG_W("PRACOWNIK1: ZATRZYMUJĘ KOLEJ!");
     
+    Linia *linia = &stan->linie[p1_linia];
+    
     sem_czekaj_sysv(sem_id, SEM_IDX_STAN);
-    stan->kolej_zatrzymana = true;
-    stan->kto_zatrzymal = 1;
+    stan_zapis_poczatek(stan);
+    STAN_USTAW(stan, kolej_zatrzymana[p1_linia], true);
+    stan_zapis_koniec(stan);
+    linia->kto_zatrzymal = 1;
     sem_sygnalizuj_sysv(sem_id, SEM_IDX_STAN);
     
-    if (stan->pid_pracownik2 > 0) {
-        kill(stan->pid_pracownik2, SIGUSR1);
+    if (linia->pid_pracownik2 > 0) {
+        kill(linia->pid_pracownik2, SIGUSR1);
     }
 }
 
@@ -256,66 +276,85 @@ void p1_wznow_kolej(void) {
     if (!p1_dzialaj) return;
     
     StanWspoldzielony *stan = p1_zasoby.shm.stan;
+    Linia *linia = &stan->linie[p1_linia];
     int sem_id = p1_zasoby.sem.sem_id;
     
     LOG_I("PRACOWNIK1: Wznawianie kolei...");
     
     Komunikat msg;
     memset(&msg, 0, sizeof(Komunikat));
-    msg.mtype = MSG_WZNOW_KOLEJ;
+    msg.mtype = MTYPE_LINII(p1_linia, MSG_WZNOW_KOLEJ);
     msg.nadawca_id = 1;
     msg.typ_komunikatu = MSG_WZNOW_KOLEJ;
     wyslij_komunikat(p1_zasoby.mq.mq_pracownicy, &msg);
     
-    sem_czekaj_sysv(sem_id, SEM_IDX_SYNC);
+    sem_czekaj_sysv(sem_id, SEM_LINII(p1_linia, SEM_IDX_SYNC));
     if (!p1_dzialaj) return;
     
     sem_czekaj_sysv(sem_id, SEM_IDX_STAN);
-    stan->kolej_zatrzymana = false;
-    stan->kto_zatrzymal = 0;
+    stan_zapis_poczatek(stan);
+    STAN_USTAW(stan, kolej_zatrzymana[p1_linia], false);
+    stan_zapis_koniec(stan);
+    linia->kto_zatrzymal = 0;
     p1_kolej_zatrzymana = 0;
     sem_sygnalizuj_sysv(sem_id, SEM_IDX_STAN);
     
     LOG_I("PRACOWNIK1: Kolej wznowiona!");
     
-    if (stan->pid_pracownik2 > 0) {
-        kill(stan->pid_pracownik2, SIGUSR2);
+    if (linia->pid_pracownik2 > 0) {
+        kill(linia->pid_pracownik2, SIGUSR2);
     }
 }
 
 int main(int argc, char *argv[]) {
-    (void)argc; (void)argv;
+    p1_linia = linia_z_argumentow(argc, argv);
+    if (p1_linia < 0) {
+        return 1;
+    }
     
     p1_ustaw_sygnaly();
+    linia_przypnij_cpu(p1_linia);
     
     if (polacz_z_zasobami(&p1_zasoby) == -1) {
         fprintf(stderr, "PRACOWNIK1: Nie można połączyć z zasobami IPC\n");
         return 1;
     }
     
-    logger_init("logs/pracownik1.log");
-    LOG_I("PRACOWNIK1: Rozpoczynam pracę (PID: %d)", getpid());
+    char sciezka_logu[256];
+    logger_init(linia_log("pracownik1", p1_linia, sciezka_logu, sizeof(sciezka_logu)));
+    LOG_I("PRACOWNIK1: Rozpoczynam pracę na linii %d (PID: %d)", p1_linia, getpid());
     
     StanWspoldzielony *stan = p1_zasoby.shm.stan;
     int sem_id = p1_zasoby.sem.sem_id;
     
-    sem_czekaj_sysv(sem_id, SEM_IDX_STAN);
-    stan->pid_pracownik1 = getpid();
-    stan->pracownik1_gotowy = true;
-    sem_sygnalizuj_sysv(sem_id, SEM_IDX_STAN);
+    const KonfiguracjaKolei *konf = &stan->konfiguracja;
+    if (p1_linia >= konf->linie) {
+        fprintf(stderr, "PRACOWNIK1: Linia %d poza konfiguracją (%d linii)\n", p1_linia, konf->linie);
+        return 1;
+    }
+    p1_krzeselka = linia_krzeselka(stan, p1_linia);
+    p1_liczba_krzeselek = konf->krzeselka;
+    p1_pojemnosc = konf->pojemnosc_krzeselka;
+    p1_max_rowerzystow = konf->max_rowerzystow;
+    
+    sem_czekaj_sysv(sem_id, SEM_LINII(p1_linia, SEM_IDX_LINIA));
+    stan->linie[p1_linia].pid_pracownik1 = getpid();
+    stan->linie[p1_linia].pracownik1_gotowy = true;
+    sem_sygnalizuj_sysv(sem_id, SEM_LINII(p1_linia, SEM_IDX_LINIA));
     
     inicjalizuj_grupe();
     
-    while (p1_dzialaj && stan->kolej_aktywna) {
+    while (p1_dzialaj && STAN_CZYTAJ(stan, kolej_aktywna)) {
         if (p1_kolej_zatrzymana) {
             /* BLOKUJĄCE czekanie na semaforze z timeoutem */
-            sem_czekaj_timeout_sysv(sem_id, SEM_IDX_PRACOWNIK1, 1);
+            sem_czekaj_timeout_sysv(sem_id, SEM_LINII(p1_linia, SEM_IDX_PRACOWNIK1), 1);
             continue;
         }
         
         Komunikat prosba;
         int wynik = odbierz_komunikat_nieblokujaco(p1_zasoby.mq.mq_pracownicy, 
-                                                    &prosba, MSG_PROSBA_O_PERON);
+                                                    &prosba,
+                                                    MTYPE_LINII(p1_linia, MSG_PROSBA_O_PERON));
         
         if (!p1_dzialaj) break;
         
@@ -325,29 +364,41 @@ int main(int argc, char *argv[]) {
             bool dziecko = (prosba.dane[1] != 0);
             int opiekun_id = prosba.dane[2];
             int wiek = prosba.dane[3];
+            bool vip = (prosba.dane[4] != 0);
             
-            LOG_I("PRACOWNIK1: Prośba od turysty #%d (wiek: %d, dziecko: %s, opiekun: %d)", 
-                  id, wiek, dziecko ? "TAK" : "NIE", opiekun_id);
+            LOG_I("PRACOWNIK1: Prośba od turysty #%d (wiek: %d, dziecko: %s, opiekun: %d%s)", 
+                  id, wiek, dziecko ? "TAK" : "NIE", opiekun_id, vip ? ", VIP" : "");
             
             if (liczba_oczekujacych < MAX_OCZEKUJACYCH) {
-                OczekujacyTurysta *t = &kolejka[liczba_oczekujacych];
+                /* VIP na początek kolejki, za wcześniejszymi VIP */
+                int miejsce = liczba_oczekujacych;
+                if (vip) {
+                    miejsce = 0;
+                    while (miejsce < liczba_oczekujacych && kolejka[miejsce].vip) miejsce++;
+                    memmove(&kolejka[miejsce + 1], &kolejka[miejsce],
+                            (size_t)(liczba_oczekujacych - miejsce) * sizeof(OczekujacyTurysta));
+                }
+                OczekujacyTurysta *t = &kolejka[miejsce];
                 t->id = id;
                 t->typ = typ;
                 t->dziecko_pod_opieka = dziecko;
                 t->opiekun_id = opiekun_id;
                 t->wiek = wiek;
                 t->liczba_dzieci = 0;
+                t->vip = vip;
                 liczba_oczekujacych++;
             }
         }
         
         /* Najpierw dodajemy dorosłych, potem ich dzieci */
+        bool dodano = false;
         for (int i = 0; i < liczba_oczekujacych && p1_dzialaj; ) {
             OczekujacyTurysta *turysta = &kolejka[i];
             
             if (moze_dolaczyc(turysta)) {
                 dodaj_do_grupy(turysta);
-                sem_sygnalizuj_sysv(sem_id, SEM_IDX_PERON);
+                dodano = true;
+                sem_sygnalizuj_sysv(sem_id, SEM_LINII(p1_linia, SEM_IDX_PERON));
                 
                 /* Usuń z kolejki */
                 for (int j = i; j < liczba_oczekujacych - 1; j++) {
@@ -361,25 +412,29 @@ int main(int argc, char *argv[]) {
             if (grupa_pelna()) wyslij_grupe_na_krzeselko();
         }
         
-        if (aktualna_grupa.liczba > 0 && liczba_oczekujacych == 0 && p1_dzialaj) {
-            /* Sprawdź ponownie bez usleep */
-            if (liczba_oczekujacych == 0 && aktualna_grupa.liczba > 0) {
-                wyslij_grupe_na_krzeselko();
-            }
+        /* Niepełna grupa odjeżdża, gdy nikt z kolejki nie dołączył - dzieci,
+         * których opiekun już odjechał, nie blokują jej do zapełnienia */
+        if (aktualna_grupa.liczba > 0 && (liczba_oczekujacych == 0 || !dodano) && p1_dzialaj) {
+            wyslij_grupe_na_krzeselko();
         }
         
         if (rand() % 2000 == 0 && !p1_kolej_zatrzymana && p1_dzialaj) {
             p1_zatrzymaj_kolej();
             /* BLOKUJĄCE czekanie z timeoutem 2 sekundy */
-            sem_czekaj_timeout_sysv(sem_id, SEM_IDX_SYNC, 2);
+            sem_czekaj_timeout_sysv(sem_id, SEM_LINII(p1_linia, SEM_IDX_SYNC), 2);
             if (p1_dzialaj) p1_wznow_kolej();
         }
 
-        /* BLOKUJĄCE czekanie 50ms zamiast busy waiting */
+        /* BLOKUJĄCE czekanie OKRES_PRACOWNIKA1_MS zamiast busy waiting;
+         * spóźnienie wybudzenia do histogramu linii (polityka.h) */
         struct timeval tv;
         tv.tv_sec = 0;
-        tv.tv_usec = 50000;
-        select(0, NULL, NULL, NULL, &tv);
+        tv.tv_usec = OKRES_PRACOWNIKA1_MS * 1000;
+        long przed_us = czas_monotoniczny_us();
+        if (select(0, NULL, NULL, NULL, &tv) == 0) {
+            histogram_dodaj(&stan->linie[p1_linia].opoznienia,
+                            czas_monotoniczny_us() - przed_us - OKRES_PRACOWNIKA1_MS * 1000);
+        }
     }
     
     if (aktualna_grupa.liczba > 0 && p1_dzialaj) {
@@ -9,10 +9,21 @@
 #include "types.h"
 #include "ipc_utils.h"
 #include "logger.h"
+#include "instancja.h"
+#include "stan_kolei.h"
+#include "linie.h"
+#include "polityka.h"
+#include "konfiguracja.h"
+#include "dziennik.h"
 
 static volatile sig_atomic_t p2_dzialaj = 1;
 static volatile sig_atomic_t p2_kolej_zatrzymana = 0;
 static ZasobyIPC p2_zasoby;
+static int p2_linia = 0;
+
+/* Z konfiguracji (tylko do odczytu) - pobrane raz przy starcie */
+static Krzeselko *p2_krzeselka;
+static int p2_liczba_krzeselek;
 
 static void p2_obsluz_zatrzymanie(int sig, siginfo_t *info, void *context) {
     (void)sig; (void)info; (void)context;
@@ -59,8 +70,8 @@ void obsluz_przyjazd_krzeselka(int krzeselko_id) {
     StanWspoldzielony *stan = p2_zasoby.shm.stan;
     int sem_id = p2_zasoby.sem.sem_id;
     
-    sem_czekaj_sysv(sem_id, SEM_IDX_STAN);
-    Krzeselko *k = &stan->krzeselka[krzeselko_id];
+    sem_czekaj_sysv(sem_id, SEM_LINII(p2_linia, SEM_IDX_LINIA));
+    Krzeselko *k = &p2_krzeselka[krzeselko_id];
     
     if (k->aktywne && k->liczba_pasazerow > 0) {
         LOG_I("PRACOWNIK2: Krzesełko #%d - %d pasażerów", krzeselko_id, k->liczba_pasazerow);
@@ -70,16 +81,19 @@ void obsluz_przyjazd_krzeselka(int krzeselko_id) {
             LOG_D("PRACOWNIK2: Turysta #%d -> wyjście %d", k->pasazerowie[i], wyjscie);
         }
         
+        if (dziennik_zjazd(stan, p2_linia, krzeselko_id, k->liczba_pasazerow) == -1) {
+            LOG_W("PRACOWNIK2: Zjazd krzesełka #%d nie trafił do dziennika", krzeselko_id);
+        }
+        
         k->aktywne = false;
         k->liczba_pasazerow = 0;
         k->liczba_rowerzystow = 0;
-        stan->liczba_aktywnych_krzeselek--;
-        stan->laczna_liczba_zjazdow++;
+        licznik_przenies(stan, p2_linia, SHARD_PRACOWNIK2, LICZNIK_KRZESELKA, LICZNIK_ZJAZDY);
         
-        sem_sygnalizuj_sysv(sem_id, SEM_IDX_STAN);
-        sem_sygnalizuj_sysv(sem_id, SEM_IDX_KRZESELKA);
+        sem_sygnalizuj_sysv(sem_id, SEM_LINII(p2_linia, SEM_IDX_LINIA));
+        sem_sygnalizuj_sysv(sem_id, SEM_LINII(p2_linia, SEM_IDX_KRZESELKA));
     } else {
-        sem_sygnalizuj_sysv(sem_id, SEM_IDX_STAN);
+        sem_sygnalizuj_sysv(sem_id, SEM_LINII(p2_linia, SEM_IDX_LINIA));
     }
 }
 
@@ -91,11 +105,11 @@ void p2_obsluz_wznowienie_komunikat(void) {
     
     LOG_I("PRACOWNIK2: Potwierdzam gotowość do wznowienia");
     
-    sem_czekaj_sysv(sem_id, SEM_IDX_STAN);
-    stan->pracownik2_gotowy = true;
-    sem_sygnalizuj_sysv(sem_id, SEM_IDX_STAN);
+    sem_czekaj_sysv(sem_id, SEM_LINII(p2_linia, SEM_IDX_LINIA));
+    stan->linie[p2_linia].pracownik2_gotowy = true;
+    sem_sygnalizuj_sysv(sem_id, SEM_LINII(p2_linia, SEM_IDX_LINIA));
     
-    sem_sygnalizuj_sysv(sem_id, SEM_IDX_SYNC);
+    sem_sygnalizuj_sysv(sem_id, SEM_LINII(p2_linia, SEM_IDX_SYNC));
 }
 
 void p2_zatrzymaj_kolej(void) {
@@ -106,101 +120,128 @@ void p2_zatrzymaj_kolej(void) {
     
     LOG_W("PRACOWNIK2: ZATRZYMUJĘ KOLEJ!");
     
+    Linia *linia = &stan->linie[p2_linia];
+    
     sem_czekaj_sysv(sem_id, SEM_IDX_STAN);
-    stan->kolej_zatrzymana = true;
-    stan->kto_zatrzymal = 2;
+    stan_zapis_poczatek(stan);
+    STAN_USTAW(stan, kolej_zatrzymana[p2_linia], true);
+    stan_zapis_koniec(stan);
+    linia->kto_zatrzymal = 2;
     sem_sygnalizuj_sysv(sem_id, SEM_IDX_STAN);
     
-    if (stan->pid_pracownik1 > 0) {
-        kill(stan->pid_pracownik1, SIGUSR1);
+    if (linia->pid_pracownik1 > 0) {
+        kill(linia->pid_pracownik1, SIGUSR1);
     }
 }
 
 int main(int argc, char *argv[]) {
-    (void)argc; (void)argv;
+    p2_linia = linia_z_argumentow(argc, argv);
+    if (p2_linia < 0) {
+        return 1;
+    }
     
     p2_ustaw_sygnaly();
+    linia_przypnij_cpu(p2_linia);
     
     if (polacz_z_zasobami(&p2_zasoby) == -1) {
         fprintf(stderr, "PRACOWNIK2: Nie można połączyć z zasobami IPC\n");
         return 1;
     }
     
-    logger_init("logs/pracownik2.log");
-    LOG_I("PRACOWNIK2: Rozpoczynam pracę (PID: %d)", getpid());
+    char sciezka_logu[256];
+    logger_init(linia_log("pracownik2", p2_linia, sciezka_logu, sizeof(sciezka_logu)));
+    LOG_I("PRACOWNIK2: Rozpoczynam pracę na linii %d (PID: %d)", p2_linia, getpid());
     
     StanWspoldzielony *stan = p2_zasoby.shm.stan;
+    Linia *linia = &stan->linie[p2_linia];
     int sem_id = p2_zasoby.sem.sem_id;
     
-    sem_czekaj_sysv(sem_id, SEM_IDX_STAN);
-    stan->pid_pracownik2 = getpid();
-    stan->pracownik2_gotowy = true;
-    sem_sygnalizuj_sysv(sem_id, SEM_IDX_STAN);
+    if (p2_linia >= stan->konfiguracja.linie) {
+        fprintf(stderr, "PRACOWNIK2: Linia %d poza konfiguracją (%d linii)\n", p2_linia,
+                stan->konfiguracja.linie);
+        return 1;
+    }
+    p2_krzeselka = linia_krzeselka(stan, p2_linia);
+    p2_liczba_krzeselek = stan->konfiguracja.krzeselka;
+    
+    sem_czekaj_sysv(sem_id, SEM_LINII(p2_linia, SEM_IDX_LINIA));
+    linia->pid_pracownik2 = getpid();
+    linia->pracownik2_gotowy = true;
+    sem_sygnalizuj_sysv(sem_id, SEM_LINII(p2_linia, SEM_IDX_LINIA));
     
-    while (p2_dzialaj && stan->kolej_aktywna) {
+    while (p2_dzialaj && STAN_CZYTAJ(stan, kolej_aktywna)) {
         if (p2_kolej_zatrzymana) {
             /* BLOKUJĄCE czekanie na semaforze z timeoutem */
-            sem_czekaj_timeout_sysv(sem_id, SEM_IDX_PRACOWNIK2, 1);
+            sem_czekaj_timeout_sysv(sem_id, SEM_LINII(p2_linia, SEM_IDX_PRACOWNIK2), 1);
             continue;
         }
         
         Komunikat msg;
         int wynik = odbierz_komunikat_nieblokujaco(p2_zasoby.mq.mq_pracownicy, 
-                                                    &msg, MSG_WZNOW_KOLEJ);
+                                                    &msg,
+                                                    MTYPE_LINII(p2_linia, MSG_WZNOW_KOLEJ));
         if (wynik > 0 && p2_dzialaj) {
             p2_obsluz_wznowienie_komunikat();
         }
         
         if (!p2_dzialaj) break;
         
-        sem_czekaj_sysv(sem_id, SEM_IDX_STAN);
+        sem_czekaj_sysv(sem_id, SEM_LINII(p2_linia, SEM_IDX_LINIA));
         time_t teraz = time(NULL);
-        for (int i = 0; i < MAX_AKTYWNYCH_KRZESELEK && p2_dzialaj; i++) {
-            Krzeselko *k = &stan->krzeselka[i];
+        for (int i = 0; i < p2_liczba_krzeselek && p2_dzialaj; i++) {
+            Krzeselko *k = &p2_krzeselka[i];
             if (k->aktywne && k->czas_wyjazdu > 0) {
                 int czas_jazdy = (int)(teraz - k->czas_wyjazdu);
-                if (czas_jazdy >= 2) {
-                    sem_sygnalizuj_sysv(sem_id, SEM_IDX_STAN);
+                if (czas_jazdy >= CZAS_JAZDY_KRZESELKA) {
+                    sem_sygnalizuj_sysv(sem_id, SEM_LINII(p2_linia, SEM_IDX_LINIA));
                     obsluz_przyjazd_krzeselka(i);
-                    sem_czekaj_sysv(sem_id, SEM_IDX_STAN);
+                    sem_czekaj_sysv(sem_id, SEM_LINII(p2_linia, SEM_IDX_LINIA));
                 }
             }
         }
-        sem_sygnalizuj_sysv(sem_id, SEM_IDX_STAN);
+        sem_sygnalizuj_sysv(sem_id, SEM_LINII(p2_linia, SEM_IDX_LINIA));
         
         if (rand() % 3000 == 0 && !p2_kolej_zatrzymana && p2_dzialaj) {
             p2_zatrzymaj_kolej();
 
             /* BLOKUJĄCE czekanie z timeoutem 2 sekundy */
-            sem_czekaj_timeout_sysv(sem_id, SEM_IDX_SYNC, 2);
+            sem_czekaj_timeout_sysv(sem_id, SEM_LINII(p2_linia, SEM_IDX_SYNC), 2);
 
             if (!p2_dzialaj) break;
             
             Komunikat wznow;
             memset(&wznow, 0, sizeof(Komunikat));
-            wznow.mtype = MSG_WZNOW_KOLEJ;
+            wznow.mtype = MTYPE_LINII(p2_linia, MSG_WZNOW_KOLEJ);
             wznow.nadawca_id = 2;
             wyslij_komunikat(p2_zasoby.mq.mq_pracownicy, &wznow);
             
-            sem_czekaj_sysv(sem_id, SEM_IDX_SYNC);
+            sem_czekaj_sysv(sem_id, SEM_LINII(p2_linia, SEM_IDX_SYNC));
             if (!p2_dzialaj) break;
             
             sem_czekaj_sysv(sem_id, SEM_IDX_STAN);
-            stan->kolej_zatrzymana = false;
+            stan_zapis_poczatek(stan);
+            STAN_USTAW(stan, kolej_zatrzymana[p2_linia], false);
+            stan_zapis_koniec(stan);
             p2_kolej_zatrzymana = 0;
             sem_sygnalizuj_sysv(sem_id, SEM_IDX_STAN);
             
             LOG_I("PRACOWNIK2: Kolej wznowiona");
         }
 
-        /* BLOKUJĄCE czekanie 100ms zamiast busy waiting */
+        /* BLOKUJĄCE czekanie OKRES_PRACOWNIKA2_MS zamiast busy waiting;
+         * spóźnienie wybudzenia do histogramu linii (polityka.h) */
         struct timeval tv;
         tv.tv_sec = 0;
-        tv.tv_usec = 100000;
-        select(0, NULL, NULL, NULL, &tv);
+        tv.tv_usec = OKRES_PRACOWNIKA2_MS * 1000;
+        long przed_us = czas_monotoniczny_us();
+        if (select(0, NULL, NULL, NULL, &tv) == 0) {
+            histogram_dodaj(&stan->linie[p2_linia].opoznienia,
+                            czas_monotoniczny_us() - przed_us - OKRES_PRACOWNIKA2_MS * 1000);
+        }
     }
     
-    LOG_I("PRACOWNIK2: Kończę pracę. Zjazdów: %d", stan->laczna_liczba_zjazdow);
+    LOG_I("PRACOWNIK2: Kończę pracę. Zjazdów linii %d: %d", p2_linia,
+          licznik_linii(stan, p2_linia, LICZNIK_ZJAZDY));
     logger_close();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,771 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <ftw.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/select.h>
+#include <sys/wait.h>
+#include <sys/mman.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <sys/sem.h>
+#include <sys/msg.h>
+#include "config.h"
+#include "types.h"
+#include "instancja.h"
+#include "konfiguracja.h"
+#include "model.h"
+#include "pipe_comm.h"
+
+/* ========== PRZEGLĄD PARAMETRÓW ========== */
+/* Uruchamia ./bin/main dla każdego punktu siatki parametrów - każdy
+ * przebieg w osobnej instancji (-i, instancja.h), do -j naraz - i zbiera
+ * wynik_przebiegu.txt przebiegów do jednego CSV (wiersz na przebieg, w
+ * kolejności zakończenia). Wymiar siatki to klucz=lista:
+ *
+ *   turysci=<lista>    main -n
+ *   naplyw=<lista>     main -a (grup/s)
+ *   <klucz>=<lista>    main -o <klucz>=... (konfiguracja.h), np.
+ *                      krzeselka, bramki_wejsciowe, kasjerzy, linie
+ *
+ * Lista to "10,20,40" albo "od:do:krok". Wartości sprawdzane przed
+ * pierwszym przebiegiem. Uruchamiać z katalogu projektu (main szuka
+ * ./bin/kasjer...). Katalog logów przebiegu jest usuwany po odczytaniu
+ * wyniku, chyba że -z. Przebiegi dziedziczą KOLEJ_KONFIG; KOLEJ_LINIE
+ * jest pomijane - liczba linii to wymiar linie=...
+ *
+ * Tryby (model.h):
+ *   -m   bez symulacji - tylko przewidywania modelu dla każdego punktu
+ *   -p   symulacja i model obok siebie oraz błąd modelu na etapach (%)
+ *
+ * Użycie: przeglad [-m | -p] [-t czas] [-j rownolegle] [-i instancja]
+ *                  [-w plik.csv] [-z] klucz=lista... */
+
+#define MAX_WYMIAROW 8
+#define MAX_WARTOSCI 64
+#define MAX_ROWNOLEGLYCH 256
+#define INSTANCJA_BAZOWA 2000
+/* Ponad czas symulacji: opuszczenie stacji i zbieranie procesów w main */
+#define ZAPAS_ZAKONCZENIA_S 120
+#define MAIN_PROGRAM "./bin/main"
+#define DOMYSLNIE_TURYSTOW 100      /* main bez -n */
+
+typedef struct {
+    const char *klucz;
+    int wartosci[MAX_WARTOSCI];
+    int liczba;
+} Wymiar;
+
+typedef struct {
+    pid_t pid;                  /* 0 = wolne miejsce */
+    long indeks;                /* Punkt siatki */
+    int instancja;
+    time_t start;
+    int przerwany;              /* Zabity po przekroczeniu czasu */
+} Przebieg;
+
+/* Kolumny wyniku w kolejności CSV - klucze wynik_przebiegu.txt (main.c) */
+static const char *kolumny_wyniku[] = {
+    "osob_na_godzine", "zjazdow_na_godzine", "czekanie_bilet_p99_us",
+    "czekanie_krzeselko_p99_us", "oblozenie_krzeselek", "turysci_wygenerowani", "bilety",
+    "zjazdy", "czekanie_bilet_p50_us", "czekanie_krzeselko_p50_us", "czas_pracy_s",
+    "czekanie_bilet_srednia_us", "czekanie_bramka_srednia_us", "czekanie_bramka_p99_us",
+    "czekanie_krzeselko_srednia_us", "zjazdy_vip", "obsluga_vip_srednia_us", "obsluga_vip_p99_us",
+    "obsluga_zwykla_srednia_us", "obsluga_zwykla_p99_us",
+};
+#define LICZBA_KOLUMN_WYNIKU ((int)(sizeof(kolumny_wyniku) / sizeof(kolumny_wyniku[0])))
+
+/* ========== BŁĄD MODELU ========== */
+/* Etap porównania: kolumna pomiaru z wynik_przebiegu.txt i pole
+ * przewidywania; błąd = (model - pomiar) / pomiar */
+typedef struct {
+    const char *nazwa;
+    const char *kolumna;
+    size_t pole;                /* double w PrzewidywanieModelu */
+} Porownanie;
+
+#define POROWNANIE(nazwa, kolumna, pole) { nazwa, kolumna, offsetof(PrzewidywanieModelu, pole) }
+
+static const Porownanie porownania[] = {
+    POROWNANIE("kasa",          "czekanie_bilet_srednia_us",     czekanie_bilet_us),
+    POROWNANIE("bramka",        "czekanie_bramka_srednia_us",    czekanie_bramka_us),
+    POROWNANIE("krzeselko",     "czekanie_krzeselko_srednia_us", czekanie_krzeselko_us),
+    POROWNANIE("przepustowosc", "osob_na_godzine",               osob_na_godzine),
+    POROWNANIE("oblozenie",     "oblozenie_krzeselek",           oblozenie_krzeselek),
+};
+#define LICZBA_POROWNAN ((int)(sizeof(porownania) / sizeof(porownania[0])))
+
+typedef enum {
+    TRYB_SYMULACJA = 0,
+    TRYB_MODEL,
+    TRYB_POROWNANIE
+} TrybPrzegladu;
+
+static TrybPrzegladu tryb = TRYB_SYMULACJA;
+/* Suma |błędu| i liczba porównań na etap - podsumowanie -p */
+static double suma_bledow[LICZBA_POROWNAN];
+static int liczba_bledow[LICZBA_POROWNAN];
+
+static Wymiar wymiary[MAX_WYMIAROW];
+static int liczba_wymiarow = 0;
+static volatile sig_atomic_t przerwij = 0;
+
+static void obsluz_sygnal(int sig) {
+    (void)sig;
+    przerwij = 1;
+}
+
+/* ========== SIATKA ========== */
+static int parsuj_int(const char *s, int *wynik) {
+    char *koniec;
+    errno = 0;
+    long n = strtol(s, &koniec, 10);
+    if (errno != 0 || koniec == s || *koniec != '\0' || n < 0 || n > 1000000) {
+        return -1;
+    }
+    *wynik = (int)n;
+    return 0;
+}
+
+static int dodaj_wartosc(Wymiar *w, int wartosc) {
+    if (w->liczba >= MAX_WARTOSCI) {
+        fprintf(stderr, "Wymiar %s: więcej niż %d wartości\n", w->klucz, MAX_WARTOSCI);
+        return -1;
+    }
+    w->wartosci[w->liczba++] = wartosc;
+    return 0;
+}
+
+/* Zakres jak dla main (-n, -a) albo konfiguracja_ustaw() na kopii roboczej */
+static int sprawdz_wartosc(const char *klucz, int wartosc) {
+    if (strcmp(klucz, "turysci") == 0) {
+        return (wartosc >= 1 && wartosc <= MAX_TURYSTOW) ? 0 : -1;
+    }
+    if (strcmp(klucz, "naplyw") == 0) {
+        return (wartosc >= 1 && wartosc <= MAX_GRUP_NA_SEKUNDE) ? 0 : -1;
+    }
+    KonfiguracjaKolei k;
+    char tekst[16];
+    konfiguracja_domyslna(&k);
+    snprintf(tekst, sizeof(tekst), "%d", wartosc);
+    return konfiguracja_ustaw(&k, klucz, tekst);
+}
+
+/* "klucz=10,20,40" lub "klucz=od:do:krok"; modyfikuje argument */
+static int dodaj_wymiar(char *arg) {
+    char *rowna = strchr(arg, '=');
+    if (rowna == NULL || rowna == arg) {
+        fprintf(stderr, "Oczekiwano klucz=lista, jest '%s'\n", arg);
+        return -1;
+    }
+    if (liczba_wymiarow >= MAX_WYMIAROW) {
+        fprintf(stderr, "Więcej niż %d wymiarów siatki\n", MAX_WYMIAROW);
+        return -1;
+    }
+    *rowna = '\0';
+    Wymiar *w = &wymiary[liczba_wymiarow];
+    w->klucz = arg;
+    w->liczba = 0;
+    for (int i = 0; i < liczba_wymiarow; i++) {
+        if (strcmp(wymiary[i].klucz, arg) == 0) {
+            fprintf(stderr, "Wymiar %s podany dwa razy\n", arg);
+            return -1;
+        }
+    }
+
+    char *lista = rowna + 1;
+    if (strchr(lista, ':') != NULL) {
+        int od, do_, krok;
+        char *c1 = strchr(lista, ':');
+        char *c2 = strchr(c1 + 1, ':');
+        if (c2 == NULL) {
+            fprintf(stderr, "Wymiar %s: zakres to od:do:krok\n", w->klucz);
+            return -1;
+        }
+        *c1 = '\0';
+        *c2 = '\0';
+        if (parsuj_int(lista, &od) == -1 || parsuj_int(c1 + 1, &do_) == -1 ||
+            parsuj_int(c2 + 1, &krok) == -1 || krok < 1 || do_ < od) {
+            fprintf(stderr, "Wymiar %s: niepoprawny zakres\n", w->klucz);
+            return -1;
+        }
+        for (int v = od; v <= do_; v += krok) {
+            if (dodaj_wartosc(w, v) == -1) return -1;
+        }
+    } else {
+        char *kontekst = NULL;
+        for (char *t = strtok_r(lista, ",", &kontekst); t != NULL;
+             t = strtok_r(NULL, ",", &kontekst)) {
+            int v;
+            if (parsuj_int(t, &v) == -1) {
+                fprintf(stderr, "Wymiar %s: '%s' nie jest liczbą\n", w->klucz, t);
+                return -1;
+            }
+            if (dodaj_wartosc(w, v) == -1) return -1;
+        }
+    }
+    if (w->liczba == 0) {
+        fprintf(stderr, "Wymiar %s: pusta lista\n", w->klucz);
+        return -1;
+    }
+    for (int i = 0; i < w->liczba; i++) {
+        if (sprawdz_wartosc(w->klucz, w->wartosci[i]) == -1) {
+            fprintf(stderr, "Wymiar %s: wartość %d poza zakresem\n", w->klucz, w->wartosci[i]);
+            return -1;
+        }
+    }
+    liczba_wymiarow++;
+    return 0;
+}
+
+/* Wartość wymiaru d w punkcie siatki indeks (ostatni wymiar zmienia się najszybciej) */
+static int wartosc_w_punkcie(long indeks, int d) {
+    for (int i = liczba_wymiarow - 1; i > d; i--) {
+        indeks /= wymiary[i].liczba;
+    }
+    return wymiary[d].wartosci[indeks % wymiary[d].liczba];
+}
+
+/* ========== MODEL ========== */
+/* Konfiguracja punktu składana jak w main: config.h -> KOLEJ_KONFIG
+ * (wczytany raz, w main) -> wymiary */
+static KonfiguracjaKolei konfiguracja_bazowa;
+
+static int przewiduj_punkt(long indeks, int czas, PrzewidywanieModelu *p) {
+    KonfiguracjaKolei k = konfiguracja_bazowa;
+    int turystow = DOMYSLNIE_TURYSTOW;
+    int grup_na_sekunde = 0;
+
+    for (int d = 0; d < liczba_wymiarow; d++) {
+        int v = wartosc_w_punkcie(indeks, d);
+        if (strcmp(wymiary[d].klucz, "turysci") == 0) {
+            turystow = v;
+        } else if (strcmp(wymiary[d].klucz, "naplyw") == 0) {
+            grup_na_sekunde = v;
+        } else {
+            char tekst[16];
+            snprintf(tekst, sizeof(tekst), "%d", v);
+            if (konfiguracja_ustaw(&k, wymiary[d].klucz, tekst) == -1) return -1;
+        }
+    }
+    if (konfiguracja_sprawdz(&k) == -1) return -1;
+    return model_przewiduj(&k, turystow, grup_na_sekunde, czas, p);
+}
+
+/* Kolumny przewidywania - pola double PrzewidywanieModelu */
+typedef struct {
+    const char *kolumna;
+    size_t pole;
+} KolumnaModelu;
+
+#define KOLUMNA_MODELU(kolumna, pole) { kolumna, offsetof(PrzewidywanieModelu, pole) }
+
+static const KolumnaModelu kolumny_modelu[] = {
+    KOLUMNA_MODELU("model_osob_na_godzine",           osob_na_godzine),
+    KOLUMNA_MODELU("model_zjazdow_na_godzine",        zjazdow_na_godzine),
+    KOLUMNA_MODELU("model_czekanie_bilet_us",         czekanie_bilet_us),
+    KOLUMNA_MODELU("model_czekanie_bilet_p99_us",     czekanie_bilet_p99_us),
+    KOLUMNA_MODELU("model_czekanie_bramka_us",        czekanie_bramka_us),
+    KOLUMNA_MODELU("model_czekanie_krzeselko_us",     czekanie_krzeselko_us),
+    KOLUMNA_MODELU("model_czekanie_krzeselko_p99_us", czekanie_krzeselko_p99_us),
+    KOLUMNA_MODELU("model_oblozenie_krzeselek",       oblozenie_krzeselek),
+    KOLUMNA_MODELU("model_zjazdow_na_turyste",        zjazdow_na_turyste),
+};
+#define LICZBA_KOLUMN_MODELU ((int)(sizeof(kolumny_modelu) / sizeof(kolumny_modelu[0])))
+
+static double pole_modelu(const PrzewidywanieModelu *p, size_t pole) {
+    return *(const double *)((const char *)p + pole);
+}
+
+static void naglowek_modelu(FILE *csv) {
+    for (int i = 0; i < LICZBA_KOLUMN_MODELU; i++) {
+        fprintf(csv, ",%s", kolumny_modelu[i].kolumna);
+    }
+    fprintf(csv, ",model_waskie_gardlo");
+    for (int e = 0; e < LICZBA_ETAPOW; e++) {
+        fprintf(csv, ",model_rho_%s", model_nazwa_etapu((EtapModelu)e));
+    }
+}
+
+/* Puste kolumny, gdy punkt nie daje się policzyć */
+static void zapisz_model(FILE *csv, const PrzewidywanieModelu *p) {
+    if (p == NULL) {
+        for (int i = 0; i < LICZBA_KOLUMN_MODELU + 1 + LICZBA_ETAPOW; i++) fprintf(csv, ",");
+        return;
+    }
+    for (int i = 0; i < LICZBA_KOLUMN_MODELU; i++) {
+        double v = pole_modelu(p, kolumny_modelu[i].pole);
+        if (v == MODEL_NASYCONY) {
+            fprintf(csv, ",nasycony");
+        } else {
+            fprintf(csv, ",%.*f", (v < 10.0) ? 3 : 0, v);
+        }
+    }
+    fprintf(csv, ",%s", model_nazwa_etapu(p->waskie_gardlo));
+    for (int e = 0; e < LICZBA_ETAPOW; e++) {
+        fprintf(csv, ",%.3f", p->etapy[e].obciazenie);
+    }
+}
+
+/* blad_<etap>_proc; puste bez pomiaru, przy zerowym pomiarze lub
+ * nasyconym etapie modelu */
+static void zapisz_bledy(FILE *csv, const PrzewidywanieModelu *p, int jest_wynik,
+                         char wartosci[][32]) {
+    for (int i = 0; i < LICZBA_POROWNAN; i++) {
+        const Porownanie *c = &porownania[i];
+        double pomiar = 0.0;
+        if (jest_wynik) {
+            for (int w = 0; w < LICZBA_KOLUMN_WYNIKU; w++) {
+                if (strcmp(kolumny_wyniku[w], c->kolumna) == 0 && wartosci[w][0] != '\0') {
+                    pomiar = strtod(wartosci[w], NULL);
+                }
+            }
+        }
+        double model = p ? pole_modelu(p, c->pole) : MODEL_NASYCONY;
+        if (pomiar <= 0.0 || model == MODEL_NASYCONY) {
+            fprintf(csv, ",");
+            continue;
+        }
+        double blad = (model - pomiar) / pomiar * 100.0;
+        fprintf(csv, ",%.1f", blad);
+        suma_bledow[i] += (blad < 0.0) ? -blad : blad;
+        liczba_bledow[i]++;
+    }
+}
+
+/* ========== PRZEBIEGI ========== */
+static pid_t uruchom_przebieg(long indeks, int instancja, int czas) {
+    /* Argumenty: -i -t [-n] [-a] i po -o na każdy klucz konfiguracji */
+    char teksty[MAX_WYMIAROW + 2][64];
+    char *argumenty[2 * MAX_WYMIAROW + 8];
+    int n = 0;
+
+    argumenty[n++] = "main";
+    snprintf(teksty[0], sizeof(teksty[0]), "%d", instancja);
+    argumenty[n++] = "-i";
+    argumenty[n++] = teksty[0];
+    snprintf(teksty[1], sizeof(teksty[1]), "%d", czas);
+    argumenty[n++] = "-t";
+    argumenty[n++] = teksty[1];
+    for (int d = 0; d < liczba_wymiarow; d++) {
+        char *tekst = teksty[d + 2];
+        int v = wartosc_w_punkcie(indeks, d);
+        if (strcmp(wymiary[d].klucz, "turysci") == 0) {
+            argumenty[n++] = "-n";
+            snprintf(tekst, 64, "%d", v);
+        } else if (strcmp(wymiary[d].klucz, "naplyw") == 0) {
+            argumenty[n++] = "-a";
+            snprintf(tekst, 64, "%d", v);
+        } else {
+            argumenty[n++] = "-o";
+            snprintf(tekst, 64, "%s=%d", wymiary[d].klucz, v);
+        }
+        argumenty[n++] = tekst;
+    }
+    argumenty[n] = NULL;
+
+    pid_t pid = fork();
+    if (pid == -1) {
+        perror("fork");
+        return -1;
+    }
+    if (pid == 0) {
+        /* Własna grupa procesów - przy przekroczeniu czasu zabijana cała,
+         * razem z turystami i pracownikami przebiegu */
+        setpgid(0, 0);
+        signal(SIGINT, SIG_DFL);
+        signal(SIGTERM, SIG_DFL);
+        int fd = open("/dev/null", O_RDWR);
+        if (fd != -1) {
+            dup2(fd, STDIN_FILENO);
+            dup2(fd, STDOUT_FILENO);
+            dup2(fd, STDERR_FILENO);
+            close(fd);
+        }
+        execv(MAIN_PROGRAM, argumenty);
+        _exit(127);
+    }
+    setpgid(pid, pid);
+    return pid;
+}
+
+static int usun_wpis(const char *sciezka, const struct stat *st, int flaga, struct FTW *ftw) {
+    (void)st; (void)flaga; (void)ftw;
+    if (remove(sciezka) == -1) perror(sciezka);
+    return 0;
+}
+
+/* ========== SPRZĄTANIE PO ZABITYM PRZEBIEGU ========== */
+/* Segmenty rejestru są IPC_PRIVATE - ich identyfikatory zna tylko stan */
+static void usun_segmenty_rejestru(const StanWspoldzielony *stan) {
+    if (stan->naglowek.magia != STAN_MAGIA || stan->naglowek.wersja != STAN_WERSJA_UKLADU) {
+        return;
+    }
+    for (int s = 0; s < LICZBA_SHARDOW_REJESTRU; s++) {
+        for (int k = 0; k < MAX_SEGMENTOW_REJESTRU; k++) {
+            int id = atomic_load(&stan->shardy_rejestru[s].shm_id[k]);
+            if (id > 0) shmctl(id - 1, IPC_RMID, NULL);
+        }
+    }
+    /* Pierścień dziennika main oznacza IPC_RMID zaraz po utworzeniu */
+}
+
+/* Po SIGKILL grupy nikt nie wykonał usun_wszystkie_zasoby(), a numeru
+ * instancji nie użyje już żaden przebieg - zasoby usuwa przeglad.
+ * Stan z memfd znika razem z procesami, jego segmentów rejestru nie da
+ * się już odnaleźć */
+static void usun_zasoby_instancji(int instancja) {
+    int id = shmget(instancja_klucz_dla(instancja, 'S'), 0, 0);
+    if (id != -1) {
+        void *stan = shmat(id, NULL, SHM_RDONLY);
+        if (stan != (void *)-1) {
+            usun_segmenty_rejestru(stan);
+            shmdt(stan);
+        }
+        shmctl(id, IPC_RMID, NULL);
+    }
+
+    char nazwa[64];
+    instancja_nazwa_dla(instancja, "/", "stan", nazwa, sizeof(nazwa));
+    int fd = shm_open(nazwa, O_RDONLY, 0);
+    if (fd != -1) {
+        void *stan = mmap(NULL, sizeof(StanWspoldzielony), PROT_READ, MAP_SHARED, fd, 0);
+        if (stan != MAP_FAILED) {
+            usun_segmenty_rejestru(stan);
+            munmap(stan, sizeof(StanWspoldzielony));
+        }
+        close(fd);
+        shm_unlink(nazwa);
+    }
+
+    id = semget(instancja_klucz_dla(instancja, 'K'), 0, 0);
+    if (id != -1) semctl(id, 0, IPC_RMID);
+
+    for (const char *proj = "ABCD"; *proj != '\0'; proj++) {
+        id = msgget(instancja_klucz_dla(instancja, *proj), 0);
+        if (id != -1) msgctl(id, IPC_RMID, NULL);
+    }
+
+    static const char *const fifo[] = {
+        FIFO_KASJER_REQUEST, FIFO_KASJER_RESPONSE, FIFO_PRACOWNIK_SYNC, FIFO_RAPORT
+    };
+    for (size_t i = 0; i < sizeof(fifo) / sizeof(fifo[0]); i++) {
+        char sciezka[128];
+        unlink(instancja_nazwa_dla(instancja, "/tmp/", fifo[i], sciezka, sizeof(sciezka)));
+    }
+}
+
+/* Wynik przebiegu: wartosci[LICZBA_KOLUMN_WYNIKU] jako tekst; 0 lub -1 */
+static int wczytaj_wynik(int instancja, char wartosci[][32]) {
+    char sciezka[256];
+    snprintf(sciezka, sizeof(sciezka), "logs/instancja_%d/wynik_przebiegu.txt", instancja);
+    FILE *f = fopen(sciezka, "r");
+    if (f == NULL) return -1;
+
+    for (int i = 0; i < LICZBA_KOLUMN_WYNIKU; i++) wartosci[i][0] = '\0';
+    char wiersz[128];
+    while (fgets(wiersz, sizeof(wiersz), f) != NULL) {
+        wiersz[strcspn(wiersz, "\n")] = '\0';
+        char *rowna = strchr(wiersz, '=');
+        if (rowna == NULL) continue;
+        *rowna = '\0';
+        for (int i = 0; i < LICZBA_KOLUMN_WYNIKU; i++) {
+            if (strcmp(wiersz, kolumny_wyniku[i]) == 0) {
+                snprintf(wartosci[i], 32, "%s", rowna + 1);
+            }
+        }
+    }
+    fclose(f);
+    return 0;
+}
+
+/* Nagłówek według trybu: wymiary, wynik symulacji, model, błędy, stan */
+static void zapisz_naglowek(FILE *csv) {
+    fprintf(csv, "przebieg");
+    for (int d = 0; d < liczba_wymiarow; d++) fprintf(csv, ",%s", wymiary[d].klucz);
+    if (tryb != TRYB_MODEL) {
+        for (int i = 0; i < LICZBA_KOLUMN_WYNIKU; i++) fprintf(csv, ",%s", kolumny_wyniku[i]);
+    }
+    if (tryb != TRYB_SYMULACJA) naglowek_modelu(csv);
+    if (tryb == TRYB_POROWNANIE) {
+        for (int i = 0; i < LICZBA_POROWNAN; i++) fprintf(csv, ",blad_%s_proc", porownania[i].nazwa);
+    }
+    if (tryb != TRYB_MODEL) fprintf(csv, ",stan");
+    fprintf(csv, "\n");
+    fflush(csv);
+}
+
+/* p == NULL - tryb -m, bez przebiegu */
+static void zapisz_wiersz(FILE *csv, long indeks, int czas, const Przebieg *p, int status) {
+    char wartosci[LICZBA_KOLUMN_WYNIKU][32];
+    const char *stan = "";
+    int jest_wynik = 0;
+
+    if (p != NULL) {
+        jest_wynik = (wczytaj_wynik(p->instancja, wartosci) == 0);
+        if (p->przerwany) {
+            stan = "limit_czasu";
+        } else if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            stan = "blad";
+        } else {
+            stan = jest_wynik ? "ok" : "brak_wyniku";
+        }
+    }
+
+    fprintf(csv, "%ld", indeks);
+    for (int d = 0; d < liczba_wymiarow; d++) {
+        fprintf(csv, ",%d", wartosc_w_punkcie(indeks, d));
+    }
+    if (tryb != TRYB_MODEL) {
+        for (int i = 0; i < LICZBA_KOLUMN_WYNIKU; i++) {
+            fprintf(csv, ",%s", jest_wynik ? wartosci[i] : "");
+        }
+    }
+    if (tryb != TRYB_SYMULACJA) {
+        PrzewidywanieModelu m;
+        int jest_model = (przewiduj_punkt(indeks, czas, &m) == 0);
+        zapisz_model(csv, jest_model ? &m : NULL);
+        if (tryb == TRYB_POROWNANIE) {
+            zapisz_bledy(csv, jest_model ? &m : NULL, jest_wynik, wartosci);
+        }
+    }
+    if (tryb != TRYB_MODEL) fprintf(csv, ",%s", stan);
+    fprintf(csv, "\n");
+    fflush(csv);
+}
+
+/* Średni |błąd| modelu na etap po wszystkich przebiegach (-p) */
+static void wypisz_bledy(void) {
+    printf("Błąd modelu (średni |model - pomiar| / pomiar):\n");
+    for (int i = 0; i < LICZBA_POROWNAN; i++) {
+        if (liczba_bledow[i] == 0) {
+            printf("  %-14s brak porównań\n", porownania[i].nazwa);
+        } else {
+            printf("  %-14s %6.1f%%  (%d przebiegów)\n", porownania[i].nazwa,
+                   suma_bledow[i] / liczba_bledow[i], liczba_bledow[i]);
+        }
+    }
+}
+
+/* ========== MAIN ========== */
+static void uzycie(const char *program) {
+    fprintf(stderr,
+            "Użycie: %s [-m | -p] [-t czas] [-j rownolegle] [-i instancja] [-w plik.csv]"
+            " [-z] klucz=lista...\n"
+            "  -m           Tylko model (model.h), bez symulacji\n"
+            "  -p           Symulacja i model, błąd modelu na etapach\n"
+            "  -t czas      Czas symulacji każdego przebiegu w s (domyślnie 30)\n"
+            "  -j n         Przebiegów naraz (domyślnie liczba rdzeni)\n"
+            "  -i n         Instancja pierwszego przebiegu (domyślnie %d)\n"
+            "  -w plik      CSV z wynikami (domyślnie logs/przeglad.csv)\n"
+            "  -z           Zostaw logs/instancja_<n>/ przebiegów\n"
+            "  klucz=lista  turysci, naplyw lub klucz konfiguracji (main -o);\n"
+            "               lista: 10,20,40 lub od:do:krok\n"
+            "Przykład: %s -t 60 turysci=100,300 krzeselka=18,36"
+            " bramki_wejsciowe=2,4 kasjerzy=1,2 naplyw=5,10\n"
+            "         %s -m turysci=100:500:100 kasjerzy=1,2,4 czas_sprzedazy_ms=0,200,500\n",
+            program, INSTANCJA_BAZOWA, program, program);
+}
+
+int main(int argc, char *argv[]) {
+    int czas = 30;
+    int rownolegle = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int instancja_bazowa = INSTANCJA_BAZOWA;
+    const char *plik_csv = "logs/przeglad.csv";
+    int zostaw_logi = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "mpt:j:i:w:zh")) != -1) {
+        switch (opt) {
+            case 'm':
+            case 'p':
+                if (tryb != TRYB_SYMULACJA) {
+                    fprintf(stderr, "-m i -p wykluczają się\n");
+                    return 1;
+                }
+                tryb = (opt == 'm') ? TRYB_MODEL : TRYB_POROWNANIE;
+                break;
+            case 't':
+                if (parsuj_int(optarg, &czas) == -1 || czas < 1) {
+                    fprintf(stderr, "-t: oczekiwano liczby sekund >= 1\n");
+                    return 1;
+                }
+                break;
+            case 'j':
+                if (parsuj_int(optarg, &rownolegle) == -1 || rownolegle < 1 ||
+                    rownolegle > MAX_ROWNOLEGLYCH) {
+                    fprintf(stderr, "-j: oczekiwano liczby 1-%d\n", MAX_ROWNOLEGLYCH);
+                    return 1;
+                }
+                break;
+            case 'i':
+                if (parsuj_int(optarg, &instancja_bazowa) == -1 || instancja_bazowa < 1 ||
+                    instancja_bazowa > MAX_INSTANCJA) {
+                    fprintf(stderr, "-i: oczekiwano liczby 1-%d\n", MAX_INSTANCJA);
+                    return 1;
+                }
+                break;
+            case 'w':
+                plik_csv = optarg;
+                break;
+            case 'z':
+                zostaw_logi = 1;
+                break;
+            default:
+                uzycie(argv[0]);
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+    if (rownolegle < 1) rownolegle = 1;
+    if (rownolegle > MAX_ROWNOLEGLYCH) rownolegle = MAX_ROWNOLEGLYCH;
+
+    for (int i = optind; i < argc; i++) {
+        if (dodaj_wymiar(argv[i]) == -1) return 1;
+    }
+
+    long punktow = 1;
+    for (int d = 0; d < liczba_wymiarow; d++) {
+        punktow *= wymiary[d].liczba;
+    }
+
+    /* Przebiegi dostają linie tylko z wymiaru linie=..., model tak samo */
+    unsetenv("KOLEJ_LINIE");
+    konfiguracja_domyslna(&konfiguracja_bazowa);
+    const char *plik_konfiguracji = getenv("KOLEJ_KONFIG");
+    if (plik_konfiguracji != NULL && plik_konfiguracji[0] != '\0' &&
+        konfiguracja_wczytaj_plik(&konfiguracja_bazowa, plik_konfiguracji) == -1) {
+        return 1;
+    }
+
+    if (tryb == TRYB_MODEL) {
+        if (instancja_utworz_katalog_logow() == -1) return 1;
+        FILE *csv = fopen(plik_csv, "w");
+        if (csv == NULL) {
+            perror(plik_csv);
+            return 1;
+        }
+        zapisz_naglowek(csv);
+        for (long i = 0; i < punktow; i++) {
+            zapisz_wiersz(csv, i, czas, NULL, 0);
+        }
+        fclose(csv);
+        printf("Model: %ld punktów (czas %d s) -> %s\n", punktow, czas, plik_csv);
+        return 0;
+    }
+
+    /* Przebieg i ma instancję bazowa + i - wszystkie muszą się zmieścić */
+    if (instancja_bazowa + punktow - 1 > MAX_INSTANCJA) {
+        fprintf(stderr, "%ld przebiegów nie mieści się w instancjach %d-%d\n",
+                punktow, instancja_bazowa, MAX_INSTANCJA);
+        return 1;
+    }
+    if (access(MAIN_PROGRAM, X_OK) == -1) {
+        perror(MAIN_PROGRAM " (uruchom z katalogu projektu po make)");
+        return 1;
+    }
+
+    if (instancja_utworz_katalog_logow() == -1) return 1;
+    FILE *csv = fopen(plik_csv, "w");
+    if (csv == NULL) {
+        perror(plik_csv);
+        return 1;
+    }
+    zapisz_naglowek(csv);
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = obsluz_sygnal;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    printf("Przegląd: %ld przebiegów po %d s, %d naraz -> %s\n",
+           punktow, czas, rownolegle, plik_csv);
+
+    static Przebieg przebiegi[MAX_ROWNOLEGLYCH];
+    long nastepny = 0;
+    long zakonczone = 0;
+    int aktywne = 0;
+    int przerwanie_wyslane = 0;
+
+    while (aktywne > 0 || (nastepny < punktow && !przerwij)) {
+        /* Uzupełnij wolne miejsca */
+        for (int s = 0; s < rownolegle && nastepny < punktow && !przerwij; s++) {
+            if (przebiegi[s].pid != 0) continue;
+            int instancja = instancja_bazowa + (int)nastepny;
+            pid_t pid = uruchom_przebieg(nastepny, instancja, czas);
+            if (pid == -1) break;
+            przebiegi[s] = (Przebieg){ pid, nastepny, instancja, time(NULL), 0 };
+            nastepny++;
+            aktywne++;
+        }
+
+        /* Ctrl+C - main w przebiegach kończy się jak po własnym SIGINT */
+        if (przerwij && !przerwanie_wyslane) {
+            printf("Przerwano - kończę %d uruchomionych przebiegów\n", aktywne);
+            for (int s = 0; s < rownolegle; s++) {
+                if (przebiegi[s].pid > 0) kill(przebiegi[s].pid, SIGINT);
+            }
+            przerwanie_wyslane = 1;
+        }
+
+        int status;
+        pid_t pid = waitpid(-1, &status, WNOHANG);
+        if (pid > 0) {
+            for (int s = 0; s < rownolegle; s++) {
+                Przebieg *p = &przebiegi[s];
+                if (p->pid != pid) continue;
+                zapisz_wiersz(csv, p->indeks, czas, p, status);
+                if (p->przerwany) {
+                    usun_zasoby_instancji(p->instancja);
+                }
+                if (!zostaw_logi) {
+                    char katalog[64];
+                    snprintf(katalog, sizeof(katalog), "logs/instancja_%d", p->instancja);
+                    nftw(katalog, usun_wpis, 16, FTW_DEPTH | FTW_PHYS);
+                }
+                zakonczone++;
+                printf("[%ld/%ld] przebieg %ld (instancja %d) zakończony po %lds\n",
+                       zakonczone, punktow, p->indeks, p->instancja,
+                       (long)(time(NULL) - p->start));
+                fflush(stdout);
+                p->pid = 0;
+                aktywne--;
+                break;
+            }
+            continue;
+        }
+        if (pid == -1 && errno != EINTR && errno != ECHILD) {
+            perror("waitpid");
+            break;
+        }
+
+        /* Zawieszony przebieg - cała grupa procesów; zasoby IPC instancji
+         * usuwa usun_zasoby_instancji() po zebraniu main */
+        time_t teraz = time(NULL);
+        for (int s = 0; s < rownolegle; s++) {
+            Przebieg *p = &przebiegi[s];
+            if (p->pid > 0 && !p->przerwany &&
+                teraz - p->start > czas + ZAPAS_ZAKONCZENIA_S) {
+                fprintf(stderr, "Przebieg %ld (instancja %d) przekroczył czas - SIGKILL\n",
+                        p->indeks, p->instancja);
+                kill(-p->pid, SIGKILL);
+                p->przerwany = 1;
+            }
+        }
+
+        struct timeval tv;
+        tv.tv_sec = 0;
+        tv.tv_usec = 200000;
+        select(0, NULL, NULL, NULL, &tv);
+    }
+
+    fclose(csv);
+    printf("Zakończono %ld z %ld przebiegów, wyniki: %s\n", zakonczone, punktow, plik_csv);
+    if (tryb == TRYB_POROWNANIE) wypisz_bledy();
+    return (zakonczone == punktow) ? 0 : 1;
+}
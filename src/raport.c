@@ -0,0 +1,778 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include "raport.h"
+#include "rejestr.h"
+#include "agregaty.h"
+#include "stan_kolei.h"
+#include "zapis_io.h"
+
+#define DOMYSLNIE_WIERSZY_REJESTRU  100
+#define DOMYSLNIE_MAX_BILETOW       (1 << 20)
+#define POCZATKOWA_POJEMNOSC_BILETOW 1024
+
+typedef enum {
+    FORMAT_TEKST,
+    FORMAT_CSV,
+    FORMAT_JSONL,
+    FORMAT_BIN,
+    LICZBA_FORMATOW
+} FormatRaportu;
+
+static const char *nazwy_formatow[LICZBA_FORMATOW] = { "tekst", "csv", "jsonl", "bin" };
+static const char *rozszerzenia_formatow[LICZBA_FORMATOW] = { ".txt", ".csv", ".jsonl", ".bin" };
+
+/* ========== BUFOROWANY ZAPIS RAPORTU ========== */
+/* Dwa tryby wyjścia, ten sam interfejs (raport_miejsce + raport_zatwierdz):
+ * - porcje 1MB: każda pełna porcja to jeden zapis pod jawnym offsetem,
+ *   a całość (z fsync) wysyłana jest partiami io_uring;
+ * - mmap: plik powiększany ftruncate() + mremap(), tekst formatowany wprost
+ *   do stron pliku; na końcu przycięty do faktycznej długości. */
+#define ROZMIAR_PORCJI_RAPORTU (1024 * 1024)
+#define MAX_DLUGOSC_LINII_RAPORTU 4096
+#define BAJTOW_NA_WIERSZ_SZACUNEK 128
+
+typedef struct {
+    size_t zajete;
+    char dane[ROZMIAR_PORCJI_RAPORTU];
+} PorcjaRaportu;
+
+typedef struct {
+    KontekstIO io;
+    int fd;
+    off_t pozycja;
+    PorcjaRaportu *biezaca;
+    char *mapa;                     /* != NULL - tryb mmap */
+    size_t pojemnosc_mapy;
+    bool blad;
+} ZapisRaportu;
+
+/* Porcja zwalniana dopiero po zakończeniu jej zapisu */
+static void zwolnij_porcje(void *dane, int wynik) {
+    (void)wynik;
+    free(dane);
+}
+
+static void raport_wyslij_porcje(ZapisRaportu *z) {
+    PorcjaRaportu *p = z->biezaca;
+    if (p == NULL || p->zajete == 0) return;
+
+    z->biezaca = NULL;
+    off_t offset = z->pozycja;
+    z->pozycja += p->zajete;
+    if (io_dodaj_zapis(&z->io, z->fd, p->dane, p->zajete, offset, p) == -1 &&
+        io_uring_aktywny(&z->io)) {
+        free(p);
+        z->blad = true;
+        return;
+    }
+    io_wyslij(&z->io);
+}
+
+static int raport_otworz(ZapisRaportu *z, const char *plik, size_t szacunek) {
+    memset(z, 0, sizeof(ZapisRaportu));
+    const char *env = getenv("KOLEJ_RAPORT_MMAP");
+    bool przez_mmap = (env != NULL && atoi(env) == 1);
+
+    /* Utwórz plik używając creat() - równoważne open() z O_CREAT|O_WRONLY|O_TRUNC;
+     * mmap(PROT_WRITE) wymaga deskryptora także do odczytu - wtedy O_RDWR */
+    z->fd = przez_mmap ? open(plik, O_CREAT | O_RDWR | O_TRUNC, 0644) : creat(plik, 0644);
+    if (z->fd == -1) {
+        perror("creat raport");
+        return -1;
+    }
+
+    if (przez_mmap) {
+        size_t rozmiar = (szacunek + 0xFFFFF) & ~(size_t)0xFFFFF;
+        if (ftruncate(z->fd, (off_t)rozmiar) == 0) {
+            void *mapa = mmap(NULL, rozmiar, PROT_READ | PROT_WRITE, MAP_SHARED, z->fd, 0);
+            if (mapa != MAP_FAILED) {
+                z->mapa = mapa;
+                z->pojemnosc_mapy = rozmiar;
+                return 0;
+            }
+        }
+        perror("mmap raport (zapis porcjami)");
+        if (ftruncate(z->fd, 0) == -1) perror("ftruncate raport");
+    }
+
+    io_inicjalizuj(&z->io, 16, zwolnij_porcje);
+    return 0;
+}
+
+/* Wskaźnik na co najmniej potrzeba wolnych bajtów lub NULL */
+static char *raport_miejsce(ZapisRaportu *z, size_t potrzeba) {
+    if (z->blad) return NULL;
+
+    if (z->mapa != NULL) {
+        size_t pozycja = (size_t)z->pozycja;
+        if (pozycja + potrzeba > z->pojemnosc_mapy) {
+            size_t nowa = z->pojemnosc_mapy * 2;
+            while (nowa < pozycja + potrzeba) nowa *= 2;
+            void *mapa = MAP_FAILED;
+            if (ftruncate(z->fd, (off_t)nowa) == 0) {
+                mapa = mremap(z->mapa, z->pojemnosc_mapy, nowa, MREMAP_MAYMOVE);
+            }
+            if (mapa == MAP_FAILED) {
+                perror("powiększenie mapy raportu");
+                z->blad = true;
+                return NULL;
+            }
+            z->mapa = mapa;
+            z->pojemnosc_mapy = nowa;
+        }
+        return z->mapa + pozycja;
+    }
+
+    if (z->biezaca != NULL && ROZMIAR_PORCJI_RAPORTU - z->biezaca->zajete < potrzeba) {
+        raport_wyslij_porcje(z);
+    }
+    if (z->biezaca == NULL) {
+        z->biezaca = malloc(sizeof(PorcjaRaportu));
+        if (z->biezaca == NULL) {
+            z->blad = true;
+            return NULL;
+        }
+        z->biezaca->zajete = 0;
+    }
+    return z->biezaca->dane + z->biezaca->zajete;
+}
+
+static void raport_zatwierdz(ZapisRaportu *z, size_t dlugosc) {
+    if (z->mapa != NULL) {
+        z->pozycja += (off_t)dlugosc;
+    } else {
+        z->biezaca->zajete += dlugosc;
+    }
+}
+
+static void raport_dopisz(ZapisRaportu *z, const char *format, ...) {
+    char *p = raport_miejsce(z, MAX_DLUGOSC_LINII_RAPORTU);
+    if (p == NULL) return;
+
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(p, MAX_DLUGOSC_LINII_RAPORTU, format, args);
+    va_end(args);
+
+    if (len > 0) {
+        raport_zatwierdz(z, (len < MAX_DLUGOSC_LINII_RAPORTU) ? (size_t)len
+                                                              : MAX_DLUGOSC_LINII_RAPORTU - 1);
+    }
+}
+
+/* Ostatnia porcja + fsync po wszystkich zapisach; -1 = raport niekompletny */
+static int raport_zamknij(ZapisRaportu *z) {
+    int wynik = z->blad ? -1 : 0;
+
+    if (z->mapa != NULL) {
+        if (munmap(z->mapa, z->pojemnosc_mapy) == -1) wynik = -1;
+        if (ftruncate(z->fd, z->pozycja) == -1 || fsync(z->fd) == -1) {
+            perror("zapis raportu");
+            wynik = -1;
+        }
+    } else {
+        raport_wyslij_porcje(z);
+        io_dodaj_fsync(&z->io, z->fd, false, NULL);
+        if (io_czekaj_wszystkie(&z->io) == -1) {
+            perror("zapis raportu");
+            wynik = -1;
+        }
+        io_zamknij(&z->io);
+    }
+
+    close(z->fd);
+    return wynik;
+}
+
+/* ========== AGREGATY PER BILET - ADRESOWANIE OTWARTE ========== */
+typedef struct {
+    int32_t bilet_id;
+    uint32_t zjazdy;                /* 0 = pusty slot */
+    int64_t pierwszy;
+    int64_t ostatni;
+} AgregatBiletu;
+
+typedef struct {
+    AgregatBiletu *sloty;
+    size_t pojemnosc;               /* Potęga dwójki */
+    size_t zajete;
+    size_t max_biletow;             /* Powyżej - tylko wiersz zbiorczy */
+    unsigned long poza_tablica;     /* Zjazdy biletów, które się nie zmieściły */
+} TablicaBiletow;
+
+static size_t hash_biletu(int32_t bilet_id, size_t pojemnosc) {
+    return ((uint32_t)bilet_id * 2654435761u) & (pojemnosc - 1);
+}
+
+static int tablica_inicjalizuj(TablicaBiletow *t, size_t max_biletow) {
+    memset(t, 0, sizeof(TablicaBiletow));
+    t->max_biletow = max_biletow;
+    t->pojemnosc = POCZATKOWA_POJEMNOSC_BILETOW;
+    t->sloty = calloc(t->pojemnosc, sizeof(AgregatBiletu));
+    if (t->sloty == NULL) {
+        perror("calloc tablica biletów");
+        return -1;
+    }
+    return 0;
+}
+
+static AgregatBiletu *tablica_szukaj(AgregatBiletu *sloty, size_t pojemnosc, int32_t bilet_id) {
+    size_t i = hash_biletu(bilet_id, pojemnosc);
+    while (sloty[i].zjazdy != 0 && sloty[i].bilet_id != bilet_id) {
+        i = (i + 1) & (pojemnosc - 1);
+    }
+    return &sloty[i];
+}
+
+/* Podwojenie przy zapełnieniu 70%; false = brak pamięci */
+static bool tablica_powieksz(TablicaBiletow *t) {
+    size_t nowa = t->pojemnosc * 2;
+    AgregatBiletu *sloty = calloc(nowa, sizeof(AgregatBiletu));
+    if (sloty == NULL) return false;
+
+    for (size_t i = 0; i < t->pojemnosc; i++) {
+        if (t->sloty[i].zjazdy != 0) {
+            *tablica_szukaj(sloty, nowa, t->sloty[i].bilet_id) = t->sloty[i];
+        }
+    }
+    free(t->sloty);
+    t->sloty = sloty;
+    t->pojemnosc = nowa;
+    return true;
+}
+
+static void tablica_dodaj(TablicaBiletow *t, int32_t bilet_id, int64_t czas) {
+    AgregatBiletu *a = tablica_szukaj(t->sloty, t->pojemnosc, bilet_id);
+    if (a->zjazdy == 0) {
+        if (t->zajete >= t->max_biletow) {
+            t->poza_tablica++;
+            return;
+        }
+        if ((t->zajete + 1) * 10 > t->pojemnosc * 7) {
+            if (!tablica_powieksz(t)) {
+                t->poza_tablica++;
+                return;
+            }
+            a = tablica_szukaj(t->sloty, t->pojemnosc, bilet_id);
+        }
+        a->bilet_id = bilet_id;
+        a->pierwszy = czas;
+        t->zajete++;
+    }
+    a->zjazdy++;
+    a->ostatni = czas;
+}
+
+static int porownaj_bilety(const void *a, const void *b) {
+    const AgregatBiletu *x = a, *y = b;
+    return (x->bilet_id > y->bilet_id) - (x->bilet_id < y->bilet_id);
+}
+
+/* Przesuwa zajęte sloty na początek i sortuje po bilet_id (w miejscu) */
+static void tablica_posortuj(TablicaBiletow *t) {
+    size_t n = 0;
+    for (size_t i = 0; i < t->pojemnosc; i++) {
+        if (t->sloty[i].zjazdy != 0) {
+            t->sloty[n++] = t->sloty[i];
+        }
+    }
+    qsort(t->sloty, n, sizeof(AgregatBiletu), porownaj_bilety);
+}
+
+/* ========== FORMAT TEKSTOWY ========== */
+static void raport_tekst(ZapisRaportu *z, StanWspoldzielony *stan, const MigawkaAgregatow *m,
+                         TablicaBiletow *bilety, long limit_wierszy) {
+    /* Nagłówek raportu */
+    time_t teraz = time(NULL);
+    struct tm *tm_info = localtime(&teraz);
+    char bufor_daty[64];
+    strftime(bufor_daty, sizeof(bufor_daty), "%Y-%m-%d %H:%M:%S", tm_info);
+    int liczba_wpisow = atomic_load(&stan->liczba_wpisow_rejestru);
+
+    raport_dopisz(z,
+        "╔══════════════════════════════════════════════════════════════╗\n"
+        "║              RAPORT DZIENNY - KOLEJ LINOWA                   ║\n"
+        "╠══════════════════════════════════════════════════════════════╣\n"
+        "║ Data wygenerowania: %-40s ║\n"
+        "╠══════════════════════════════════════════════════════════════╣\n"
+        "║                     STATYSTYKI OGÓLNE                        ║\n"
+        "╠══════════════════════════════════════════════════════════════╣\n"
+        "║ Łączna liczba zjazdów:          %-28d ║\n"
+        "║ Sprzedanych biletów:            %-28d ║\n"
+        "║ Wpisów w rejestrze:             %-28d ║\n"
+        "║ Odrzuconych przez rejestr:      %-28d ║\n"
+        "╠══════════════════════════════════════════════════════════════╣\n",
+        bufor_daty,
+        licznik_suma(stan, LICZNIK_ZJAZDY),
+        licznik_suma(stan, LICZNIK_BILETY),
+        liczba_wpisow,
+        atomic_load(&stan->odrzucone_wpisy_rejestru));
+
+    /* Rejestr przejść */
+    raport_dopisz(z,
+        "║                    REJESTR PRZEJŚĆ                           ║\n"
+        "╠══════════════════════════════════════════════════════════════╣\n"
+        "║ ID Biletu │ ID Turysty │ Linia │ Bramka │ Zjazd │    Czas    ║\n"
+        "╠───────────┼────────────┼───────┼────────┼───────┼────────────╣\n");
+
+    /* Jeden przebieg po segmentach rejestru - tabela i agregaty per bilet */
+    IteratorRejestru it;
+    rejestr_iterator(&it, stan);
+
+    const WpisRejestru *wpis;
+    while ((wpis = rejestr_nastepny(&it)) != NULL) {
+        tablica_dodaj(bilety, wpis->bilet_id, (int64_t)wpis->czas);
+
+        if (limit_wierszy >= 0 && it.indeks > limit_wierszy) continue;
+
+        struct tm tm_wpis;
+        localtime_r(&wpis->czas, &tm_wpis);
+        char czas_wpis[32];
+        strftime(czas_wpis, sizeof(czas_wpis), "%H:%M:%S", &tm_wpis);
+
+        raport_dopisz(z,
+            "║ %9d │ %10d │ %5d │ %6d │ %5d │ %10s ║\n",
+            wpis->bilet_id, wpis->turysta_id, wpis->linia, wpis->numer_bramki,
+            wpis->numer_zjazdu, czas_wpis);
+    }
+
+    if (limit_wierszy >= 0 && it.indeks > limit_wierszy) {
+        raport_dopisz(z,
+            "║ ... i %-8ld więcej wpisów                                 ║\n",
+            (long)it.indeks - limit_wierszy);
+    }
+
+    raport_dopisz(z,
+        "╚══════════════════════════════════════════════════════════════╝\n");
+
+    /* Per typ biletu */
+    raport_dopisz(z,
+        "\n╔══════════════════════════════════════════════════════════════╗\n"
+        "║                 ZJAZDY I SPRZEDAŻ PER TYP BILETU             ║\n"
+        "╠══════════════════════════════════════════════════════════════╣\n"
+        "║ Typ biletu      │   Przejścia │  Sprzedane │   Przychód (zł) ║\n"
+        "╠─────────────────┼─────────────┼────────────┼─────────────────╣\n");
+    for (int t = 0; t < LICZBA_TYPOW_BILETOW; t++) {
+        raport_dopisz(z,
+            "║ %-15s │ %11lu │ %10lu │ %15lu ║\n",
+            nazwy_typow_biletow[t], m->zjazdy_per_typ[t],
+            m->sprzedaze_per_typ[t], m->przychod_per_typ[t]);
+    }
+    raport_dopisz(z,
+        "╠─────────────────┼─────────────┼────────────┼─────────────────╣\n"
+        "║ %-15s │ %11lu │ %10lu │ %15lu ║\n",
+        "Razem", m->zjazdy, m->sprzedaze, m->przychod);
+    if (m->nieznany_typ > 0) {
+        raport_dopisz(z,
+            "║ Zdarzenia z nieznanym typem biletu: %-24lu ║\n", m->nieznany_typ);
+    }
+    raport_dopisz(z,
+        "╚══════════════════════════════════════════════════════════════╝\n");
+
+    /* Per bramka */
+    unsigned long przejscia = 0;
+    for (int b = 0; b < m->liczba_bramek; b++) {
+        przejscia += m->przejscia_per_bramka[b];
+    }
+    raport_dopisz(z,
+        "\n╔══════════════════════════════════════════════════════════════╗\n"
+        "║                 PRZEJŚCIA PER BRAMKA                         ║\n"
+        "╠══════════════════════════════════════════════════════════════╣\n");
+    for (int b = 0; b < m->liczba_bramek; b++) {
+        double procent = (przejscia > 0) ? 100.0 * m->przejscia_per_bramka[b] / przejscia : 0.0;
+        raport_dopisz(z,
+            "║ Bramka %d: %-10lu przejść (%5.1f%%)                        ║\n",
+            b, m->przejscia_per_bramka[b], procent);
+    }
+    raport_dopisz(z,
+        "╚══════════════════════════════════════════════════════════════╝\n");
+
+    /* Per godzina */
+    raport_dopisz(z,
+        "\n╔══════════════════════════════════════════════════════════════╗\n"
+        "║                 PRZEJŚCIA PER GODZINA                        ║\n"
+        "╠══════════════════════════════════════════════════════════════╣\n"
+        "║ Godzina         ");
+    for (int b = 0; b < m->liczba_bramek; b++) {
+        raport_dopisz(z, " │ B%-5d", b);
+    }
+    raport_dopisz(z, " │ Razem ║\n");
+    for (int g = 0; g < m->liczba_godzin; g++) {
+        const GodzinaMigawki *h = &m->godziny[g];
+        time_t t = (time_t)(m->poczatek + (int64_t)g * 3600);
+        struct tm tm_godz;
+        localtime_r(&t, &tm_godz);
+        char godzina[32];
+        strftime(godzina, sizeof(godzina), "%Y-%m-%d %H:00", &tm_godz);
+
+        raport_dopisz(z, "║ %-16s", godzina);
+        for (int b = 0; b < m->liczba_bramek; b++) {
+            raport_dopisz(z, " │ %6lu", h->przejscia[b]);
+        }
+        raport_dopisz(z, " │ %5lu ║\n", h->razem);
+    }
+    if (m->poza_godzinami > 0) {
+        raport_dopisz(z,
+            "║ Poza zakresem %d godzin: %-36lu ║\n",
+            MAX_GODZIN_AGREGATOW, m->poza_godzinami);
+    }
+    raport_dopisz(z,
+        "╚══════════════════════════════════════════════════════════════╝\n");
+
+    /* Sprzedaż per godzina */
+    raport_dopisz(z,
+        "\n╔══════════════════════════════════════════════════════════════╗\n"
+        "║                 SPRZEDAŻ PER GODZINA                         ║\n"
+        "╠══════════════════════════════════════════════════════════════╣\n");
+    for (int g = 0; g < m->liczba_godzin; g++) {
+        const GodzinaMigawki *h = &m->godziny[g];
+        time_t t = (time_t)(m->poczatek + (int64_t)g * 3600);
+        struct tm tm_godz;
+        localtime_r(&t, &tm_godz);
+        char godzina[32];
+        strftime(godzina, sizeof(godzina), "%Y-%m-%d %H:00", &tm_godz);
+
+        raport_dopisz(z,
+            "║ %-16s │ biletów: %-8lu │ przychód: %-8lu zł ║\n",
+            godzina, h->sprzedaze, h->przychod);
+    }
+    raport_dopisz(z,
+        "╚══════════════════════════════════════════════════════════════╝\n");
+
+    /* Podsumowanie per bilet - posortowane po numerze biletu */
+    tablica_posortuj(bilety);
+    raport_dopisz(z,
+        "\n╔══════════════════════════════════════════════════════════════╗\n"
+        "║              PODSUMOWANIE ZJAZDÓW PER BILET                  ║\n"
+        "╠══════════════════════════════════════════════════════════════╣\n"
+        "║ Biletów w rejestrze:            %-28zu ║\n"
+        "╠══════════════════════════════════════════════════════════════╣\n",
+        bilety->zajete);
+
+    for (size_t i = 0; i < bilety->zajete; i++) {
+        const AgregatBiletu *a = &bilety->sloty[i];
+        char pierwszy[16], ostatni[16];
+        time_t t1 = (time_t)a->pierwszy, t2 = (time_t)a->ostatni;
+        struct tm tm_czas;
+        strftime(pierwszy, sizeof(pierwszy), "%H:%M:%S", localtime_r(&t1, &tm_czas));
+        strftime(ostatni, sizeof(ostatni), "%H:%M:%S", localtime_r(&t2, &tm_czas));
+
+        raport_dopisz(z,
+            "║ Bilet #%-7d: %-5u zjazdów  (%s - %s)         ║\n",
+            a->bilet_id, a->zjazdy, pierwszy, ostatni);
+    }
+
+    if (bilety->poza_tablica > 0) {
+        raport_dopisz(z,
+            "║ Pozostałe bilety (limit %zu): %-10lu zjazdów              ║\n",
+            bilety->max_biletow, bilety->poza_tablica);
+    }
+
+    raport_dopisz(z,
+        "╚══════════════════════════════════════════════════════════════╝\n");
+}
+
+/* ========== FORMATY MASZYNOWE: RekordRaportu -> CSV / JSONL / bin ========== */
+static const char *nazwy_rekordow[] = {
+    [REKORD_PODSUMOWANIE] = "podsumowanie",
+    [REKORD_TYP] = "typ",
+    [REKORD_BRAMKA] = "bramka",
+    [REKORD_GODZINA] = "godzina",
+    [REKORD_PRZEJSCIE] = "przejscie",
+    [REKORD_BILET] = "bilet",
+    [REKORD_POZOSTALE_BILETY] = "pozostale_bilety",
+    [REKORD_KONIEC] = "koniec"
+};
+
+/* Kolejność pól = kolejność bitów POLE_* = kolumny CSV */
+#define LICZBA_POL_REKORDU 12
+static const char *nazwy_pol[LICZBA_POL_REKORDU] = {
+    "czas", "bramka", "typ_biletu", "bilet_id", "turysta_id", "zjazd",
+    "przejscia", "sprzedaze", "przychod", "pierwszy", "ostatni", "linia"
+};
+
+static int64_t wartosc_pola(const RekordRaportu *r, int pole) {
+    switch (pole) {
+        case 0:  return r->czas;
+        case 1:  return r->bramka;
+        case 2:  return r->typ_biletu;
+        case 3:  return r->bilet_id;
+        case 4:  return r->turysta_id;
+        case 5:  return r->zjazd;
+        case 6:  return (int64_t)r->przejscia;
+        case 7:  return (int64_t)r->sprzedaze;
+        case 8:  return (int64_t)r->przychod;
+        case 9:  return r->pierwszy;
+        case 10: return r->ostatni;
+        default: return r->linia;
+    }
+}
+
+/* Liczba dziesiętna bez printf - zwraca wskaźnik za ostatnią cyfrą */
+static char *zapisz_liczbe(char *p, int64_t v) {
+    char cyfry[20];
+    int n = 0;
+    uint64_t u = (v < 0) ? (uint64_t)0 - (uint64_t)v : (uint64_t)v;
+    if (v < 0) *p++ = '-';
+    do {
+        cyfry[n++] = (char)('0' + u % 10);
+        u /= 10;
+    } while (u != 0);
+    while (n > 0) *p++ = cyfry[--n];
+    return p;
+}
+
+static char *zapisz_tekst(char *p, const char *s) {
+    size_t n = strlen(s);
+    memcpy(p, s, n);
+    return p + n;
+}
+
+/* Najdłuższy wiersz CSV/JSON rekordu: nazwy + 12 liczb po <= 20 znaków */
+#define MAX_DLUGOSC_REKORDU 512
+
+static void raport_rekord(ZapisRaportu *z, FormatRaportu format, const RekordRaportu *r) {
+    if (format == FORMAT_BIN) {
+        char *p = raport_miejsce(z, sizeof(RekordRaportu));
+        if (p == NULL) return;
+        memcpy(p, r, sizeof(RekordRaportu));
+        raport_zatwierdz(z, sizeof(RekordRaportu));
+        return;
+    }
+
+    char *poczatek = raport_miejsce(z, MAX_DLUGOSC_REKORDU);
+    if (poczatek == NULL) return;
+    char *p = poczatek;
+
+    if (format == FORMAT_CSV) {
+        p = zapisz_tekst(p, nazwy_rekordow[r->rodzaj]);
+        for (int i = 0; i < LICZBA_POL_REKORDU; i++) {
+            *p++ = ',';
+            if (r->pola & (1u << i)) p = zapisz_liczbe(p, wartosc_pola(r, i));
+        }
+    } else {
+        p = zapisz_tekst(p, "{\"rekord\":\"");
+        p = zapisz_tekst(p, nazwy_rekordow[r->rodzaj]);
+        *p++ = '"';
+        for (int i = 0; i < LICZBA_POL_REKORDU; i++) {
+            if (!(r->pola & (1u << i))) continue;
+            *p++ = ',';
+            *p++ = '"';
+            p = zapisz_tekst(p, nazwy_pol[i]);
+            *p++ = '"';
+            *p++ = ':';
+            p = zapisz_liczbe(p, wartosc_pola(r, i));
+        }
+        *p++ = '}';
+    }
+    *p++ = '\n';
+    raport_zatwierdz(z, (size_t)(p - poczatek));
+}
+
+/* Wszystkie sekcje jako ciąg rekordów; jeden przebieg po rejestrze */
+static void raport_rekordy(ZapisRaportu *z, FormatRaportu format, StanWspoldzielony *stan,
+                           const MigawkaAgregatow *m, TablicaBiletow *bilety,
+                           long limit_wierszy) {
+    unsigned long liczba = 0;
+    RekordRaportu r;
+
+#define REKORD(rodzaj_, pola_) \
+    (memset(&r, 0, sizeof(r)), r.rodzaj = (rodzaj_), r.pola = (pola_))
+#define EMITUJ() (raport_rekord(z, format, &r), liczba++)
+
+    if (format == FORMAT_BIN) {
+        NaglowekRaportuBin nag = {
+            .magia = RAPORT_BIN_MAGIA,
+            .wersja = RAPORT_BIN_WERSJA,
+            .rozmiar_rekordu = sizeof(RekordRaportu),
+            .utworzono = (int64_t)time(NULL)
+        };
+        char *p = raport_miejsce(z, sizeof(nag));
+        if (p == NULL) return;
+        memcpy(p, &nag, sizeof(nag));
+        raport_zatwierdz(z, sizeof(nag));
+    } else if (format == FORMAT_CSV) {
+        raport_dopisz(z, "rekord");
+        for (int i = 0; i < LICZBA_POL_REKORDU; i++) raport_dopisz(z, ",%s", nazwy_pol[i]);
+        raport_dopisz(z, "\n");
+    }
+
+    REKORD(REKORD_PODSUMOWANIE, POLE_CZAS | POLE_ZJAZD | POLE_PRZEJSCIA |
+                                POLE_SPRZEDAZE | POLE_PRZYCHOD);
+    r.czas = (int64_t)time(NULL);
+    r.zjazd = licznik_suma(stan, LICZNIK_ZJAZDY);
+    r.przejscia = (uint64_t)atomic_load(&stan->liczba_wpisow_rejestru);
+    r.sprzedaze = (uint64_t)licznik_suma(stan, LICZNIK_BILETY);
+    r.przychod = m->przychod;
+    EMITUJ();
+
+    for (int t = 0; t < LICZBA_TYPOW_BILETOW; t++) {
+        REKORD(REKORD_TYP, POLE_TYP_BILETU | POLE_PRZEJSCIA | POLE_SPRZEDAZE | POLE_PRZYCHOD);
+        r.typ_biletu = BILET_JEDNORAZOWY + t;
+        r.przejscia = m->zjazdy_per_typ[t];
+        r.sprzedaze = m->sprzedaze_per_typ[t];
+        r.przychod = m->przychod_per_typ[t];
+        EMITUJ();
+    }
+    if (m->nieznany_typ > 0) {
+        REKORD(REKORD_TYP, POLE_TYP_BILETU | POLE_PRZEJSCIA);
+        r.przejscia = m->nieznany_typ;
+        EMITUJ();
+    }
+
+    for (int b = 0; b < m->liczba_bramek; b++) {
+        REKORD(REKORD_BRAMKA, POLE_BRAMKA | POLE_PRZEJSCIA);
+        r.bramka = b;
+        r.przejscia = m->przejscia_per_bramka[b];
+        EMITUJ();
+    }
+
+    for (int g = 0; g < m->liczba_godzin; g++) {
+        const GodzinaMigawki *h = &m->godziny[g];
+        int64_t czas = m->poczatek + (int64_t)g * 3600;
+        for (int b = 0; b < m->liczba_bramek; b++) {
+            REKORD(REKORD_GODZINA, POLE_CZAS | POLE_BRAMKA | POLE_PRZEJSCIA);
+            r.czas = czas;
+            r.bramka = b;
+            r.przejscia = h->przejscia[b];
+            EMITUJ();
+        }
+        REKORD(REKORD_GODZINA, POLE_CZAS | POLE_PRZEJSCIA | POLE_SPRZEDAZE | POLE_PRZYCHOD);
+        r.czas = czas;
+        r.przejscia = h->razem;
+        r.sprzedaze = h->sprzedaze;
+        r.przychod = h->przychod;
+        EMITUJ();
+    }
+
+    IteratorRejestru it;
+    rejestr_iterator(&it, stan);
+    const WpisRejestru *wpis;
+    while ((wpis = rejestr_nastepny(&it)) != NULL) {
+        tablica_dodaj(bilety, wpis->bilet_id, (int64_t)wpis->czas);
+        if (limit_wierszy >= 0 && it.indeks > limit_wierszy) continue;
+
+        REKORD(REKORD_PRZEJSCIE, POLE_CZAS | POLE_BRAMKA | POLE_TYP_BILETU | POLE_BILET_ID |
+                                 POLE_TURYSTA_ID | POLE_ZJAZD | POLE_LINIA);
+        r.czas = (int64_t)wpis->czas;
+        r.linia = wpis->linia;
+        r.bramka = wpis->numer_bramki;
+        r.typ_biletu = wpis->typ_biletu;
+        r.bilet_id = wpis->bilet_id;
+        r.turysta_id = wpis->turysta_id;
+        r.zjazd = wpis->numer_zjazdu;
+        EMITUJ();
+    }
+
+    tablica_posortuj(bilety);
+    for (size_t i = 0; i < bilety->zajete; i++) {
+        const AgregatBiletu *a = &bilety->sloty[i];
+        REKORD(REKORD_BILET, POLE_BILET_ID | POLE_PRZEJSCIA | POLE_PIERWSZY | POLE_OSTATNI);
+        r.bilet_id = a->bilet_id;
+        r.przejscia = a->zjazdy;
+        r.pierwszy = a->pierwszy;
+        r.ostatni = a->ostatni;
+        EMITUJ();
+    }
+    if (bilety->poza_tablica > 0) {
+        REKORD(REKORD_POZOSTALE_BILETY, POLE_PRZEJSCIA);
+        r.przejscia = bilety->poza_tablica;
+        EMITUJ();
+    }
+
+    REKORD(REKORD_KONIEC, POLE_PRZEJSCIA);
+    r.przejscia = liczba;
+    raport_rekord(z, format, &r);
+
+#undef EMITUJ
+#undef REKORD
+}
+
+/* ========== GENEROWANIE RAPORTU ========== */
+/* plik_wyjsciowy z rozszerzeniem formatu zamiast własnego */
+static void sciezka_formatu(char *wynik, size_t rozmiar, const char *plik, FormatRaportu f) {
+    const char *ukosnik = strrchr(plik, '/');
+    const char *kropka = strrchr(plik, '.');
+    int dlugosc = (kropka != NULL && (ukosnik == NULL || kropka > ukosnik))
+                      ? (int)(kropka - plik) : (int)strlen(plik);
+    snprintf(wynik, rozmiar, "%.*s%s", dlugosc, plik, rozszerzenia_formatow[f]);
+}
+
+static void generuj_format(StanWspoldzielony *stan, const MigawkaAgregatow *m,
+                           const char *plik_wyjsciowy, FormatRaportu format) {
+    const char *env = getenv("KOLEJ_RAPORT_WIERSZE");
+    long limit_wierszy = (env != NULL) ? atol(env)
+                       : (format == FORMAT_TEKST) ? DOMYSLNIE_WIERSZY_REJESTRU : -1;
+    env = getenv("KOLEJ_RAPORT_MAX_BILETOW");
+    size_t max_biletow = (env != NULL && atol(env) > 0) ? (size_t)atol(env)
+                                                        : DOMYSLNIE_MAX_BILETOW;
+
+    TablicaBiletow bilety;
+    if (tablica_inicjalizuj(&bilety, max_biletow) == -1) {
+        return;
+    }
+
+    char plik[512];
+    sciezka_formatu(plik, sizeof(plik), plik_wyjsciowy, format);
+
+    /* Szacunek tylko dla trybu mmap - plik i tak rośnie w razie potrzeby */
+    size_t wiersze = (size_t)atomic_load(&stan->liczba_wpisow_rejestru);
+    size_t szacunek = (2 * wiersze + (size_t)m->liczba_godzin * (size_t)(m->liczba_bramek + 1) +
+                       1024) * BAJTOW_NA_WIERSZ_SZACUNEK;
+
+    ZapisRaportu z;
+    if (raport_otworz(&z, plik, szacunek) == -1) {
+        free(bilety.sloty);
+        return;
+    }
+
+    if (format == FORMAT_TEKST) {
+        raport_tekst(&z, stan, m, &bilety, limit_wierszy);
+    } else {
+        raport_rekordy(&z, format, stan, m, &bilety, limit_wierszy);
+    }
+    free(bilety.sloty);
+
+    if (raport_zamknij(&z) == -1) {
+        fprintf(stderr, "Raport %s niekompletny\n", plik);
+        return;
+    }
+    printf("Raport zapisany do: %s\n", plik);
+}
+
+void generuj_raport(StanWspoldzielony *stan, const char *plik_wyjsciowy) {
+    const char *env = getenv("KOLEJ_RAPORT_FORMAT");
+    char formaty[128];
+    snprintf(formaty, sizeof(formaty), "%s", (env != NULL && *env) ? env : "tekst");
+
+    /* Sekcje per typ / bramka / godzina to migawka agregatów na żywo -
+     * jedna dla wszystkich formatów */
+    MigawkaAgregatow *m = malloc(sizeof(MigawkaAgregatow));
+    if (m == NULL) {
+        perror("malloc migawka agregatów");
+        return;
+    }
+    agregaty_migawka(stan, m);
+
+    char *zapis = NULL;
+    for (char *nazwa = strtok_r(formaty, ",", &zapis); nazwa != NULL;
+         nazwa = strtok_r(NULL, ",", &zapis)) {
+        int f = 0;
+        while (f < LICZBA_FORMATOW && strcmp(nazwa, nazwy_formatow[f]) != 0) f++;
+        if (f == LICZBA_FORMATOW) {
+            fprintf(stderr, "KOLEJ_RAPORT_FORMAT: nieznany format '%s' (tekst|csv|jsonl|bin)\n",
+                    nazwa);
+            continue;
+        }
+        generuj_format(stan, m, plik_wyjsciowy, (FormatRaportu)f);
+    }
+
+    free(m);
+}
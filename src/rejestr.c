@@ -0,0 +1,234 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include "rejestr.h"
+
+/* ========== SLOT W SEGMENCIE ========== */
+/* Nowy segment SysV jest wyzerowany, więc gotowy = 0 dla wszystkich slotów */
+typedef struct {
+    WpisRejestru wpis;
+    atomic_int gotowy;              /* 1 = wpis opublikowany (release) */
+} SlotRejestru;
+
+#define LIMIT_DZIURY_REJESTRU_MS 1000  /* Po tym czasie nieopublikowany slot jest pomijany */
+
+/* Segmenty dołączone w tym procesie (NULL = jeszcze nie) */
+static SlotRejestru *dolaczone[LICZBA_SHARDOW_REJESTRU][MAX_SEGMENTOW_REJESTRU];
+
+/* ========== GEOMETRIA SEGMENTÓW ========== */
+/* Wpisy w segmentach rosnących: C * (2^R - 1) */
+#define WPISY_ROSNACYCH (POJEMNOSC_SEGMENTU_REJESTRU * ((1 << ROSNACE_SEGMENTY_REJESTRU) - 1))
+
+static int pojemnosc_segmentu(int k) {
+    return (k < ROSNACE_SEGMENTY_REJESTRU) ? POJEMNOSC_SEGMENTU_REJESTRU << k
+                                           : MAX_POJEMNOSC_SEGMENTU_REJESTRU;
+}
+
+static int poczatek_segmentu(int k) {
+    if (k < ROSNACE_SEGMENTY_REJESTRU) {
+        return POJEMNOSC_SEGMENTU_REJESTRU * ((1 << k) - 1);
+    }
+    return WPISY_ROSNACYCH + (k - ROSNACE_SEGMENTY_REJESTRU) * MAX_POJEMNOSC_SEGMENTU_REJESTRU;
+}
+
+/* Segment zawierający indeks: floor(log2(indeks / C + 1)) wśród rosnących,
+ * dalej co MAX_POJEMNOSC_SEGMENTU_REJESTRU */
+static int segment_indeksu(int indeks) {
+    if (indeks >= WPISY_ROSNACYCH) {
+        return ROSNACE_SEGMENTY_REJESTRU +
+               (indeks - WPISY_ROSNACYCH) / MAX_POJEMNOSC_SEGMENTU_REJESTRU;
+    }
+    unsigned q = (unsigned)(indeks / POJEMNOSC_SEGMENTU_REJESTRU) + 1;
+    return 31 - __builtin_clz(q);
+}
+
+/* ========== DOŁĄCZANIE / TWORZENIE SEGMENTU ========== */
+static SlotRejestru *segment(StanWspoldzielony *stan, int shard, int k, bool utworz) {
+    if (dolaczone[shard][k] != NULL) {
+        return dolaczone[shard][k];
+    }
+
+    atomic_int *wpis_katalogu = &stan->shardy_rejestru[shard].shm_id[k];
+    int id = atomic_load_explicit(wpis_katalogu, memory_order_acquire);
+
+    if (id == 0) {
+        if (!utworz) return NULL;
+
+        size_t rozmiar = (size_t)pojemnosc_segmentu(k) * sizeof(SlotRejestru);
+        int nowy = shmget(IPC_PRIVATE, rozmiar, IPC_CREAT | 0660);
+        if (nowy == -1) {
+            perror("shmget segment rejestru");
+            return NULL;
+        }
+
+        /* Wyścig o ten sam segment - przegrany usuwa swój */
+        int oczekiwany = 0;
+        if (atomic_compare_exchange_strong(wpis_katalogu, &oczekiwany, nowy + 1)) {
+            id = nowy + 1;
+        } else {
+            shmctl(nowy, IPC_RMID, NULL);
+            id = oczekiwany;
+        }
+    }
+
+    void *adres = shmat(id - 1, NULL, 0);
+    if (adres == (void *)-1) {
+        perror("shmat segment rejestru");
+        return NULL;
+    }
+    dolaczone[shard][k] = adres;
+    return adres;
+}
+
+static SlotRejestru *slot(StanWspoldzielony *stan, int shard, int indeks, bool utworz) {
+    int k = segment_indeksu(indeks);
+    if (k >= MAX_SEGMENTOW_REJESTRU) {
+        return NULL;
+    }
+    SlotRejestru *seg = segment(stan, shard, k, utworz);
+    return (seg != NULL) ? &seg[indeks - poczatek_segmentu(k)] : NULL;
+}
+
+static long teraz_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* ========== NAGROBEK SLOTU ========== */
+/* Zarezerwowany slot bez segmentu (shmget/shmat zawiodło) - wpis trafia do
+ * katalogu shardu, żeby czytelnik pominął go od razu. Przy pełnej liście
+ * czytelnik pominie slot dopiero po LIMIT_DZIURY_REJESTRU_MS. */
+static void oznacz_porzucony(StanWspoldzielony *stan, int shard, int indeks) {
+    KatalogRejestru *katalog = &stan->shardy_rejestru[shard];
+    for (int i = 0; i < MAX_PORZUCONYCH_REJESTRU; i++) {
+        int oczekiwany = 0;
+        if (atomic_compare_exchange_strong(&katalog->porzucone[i], &oczekiwany, indeks + 1)) {
+            return;
+        }
+    }
+}
+
+static bool porzucony(StanWspoldzielony *stan, int shard, int indeks) {
+    KatalogRejestru *katalog = &stan->shardy_rejestru[shard];
+    for (int i = 0; i < MAX_PORZUCONYCH_REJESTRU; i++) {
+        if (atomic_load(&katalog->porzucone[i]) == indeks + 1) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* ========== DOPISANIE - fetch-add + release, O(1) ========== */
+int rejestr_dopisz(StanWspoldzielony *stan, const WpisRejestru *wpis) {
+    int linia = (wpis->linia >= 0 && wpis->linia < MAX_LINII) ? wpis->linia : 0;
+    int bramka = (wpis->numer_bramki >= 0 && wpis->numer_bramki < MAX_BRAMEK_WEJSCIOWYCH)
+                     ? wpis->numer_bramki : 0;
+    int shard = linia * MAX_BRAMEK_WEJSCIOWYCH + bramka;
+    KatalogRejestru *katalog = &stan->shardy_rejestru[shard];
+
+    /* Shard bez miejsca nie rezerwuje kolejnych slotów - przejście jest
+     * tylko liczone jako odrzucone */
+    if (atomic_load_explicit(&katalog->zamkniety, memory_order_relaxed)) {
+        atomic_fetch_add_explicit(&stan->odrzucone_wpisy_rejestru, 1, memory_order_relaxed);
+        return -1;
+    }
+
+    int indeks = atomic_fetch_add_explicit(&katalog->zarezerwowane, 1, memory_order_relaxed);
+    SlotRejestru *s = slot(stan, shard, indeks, true);
+    if (s == NULL) {
+        oznacz_porzucony(stan, shard, indeks);
+        if (!atomic_exchange(&katalog->zamkniety, true)) {
+            fprintf(stderr, "Rejestr: shard %d (linia %d, bramka %d) zamknięty po %d wpisach\n",
+                    shard, linia, bramka, indeks);
+        }
+        atomic_fetch_add_explicit(&stan->odrzucone_wpisy_rejestru, 1, memory_order_relaxed);
+        return -1;
+    }
+
+    s->wpis = *wpis;
+    atomic_store_explicit(&s->gotowy, 1, memory_order_release);
+    atomic_fetch_add_explicit(&stan->liczba_wpisow_rejestru, 1, memory_order_relaxed);
+    return 0;
+}
+
+/* ========== ODCZYT STRUMIENIOWY - SCALANIE SHARDÓW ========== */
+/* Slot poniżej koniec został zarezerwowany przed utworzeniem iteratora, więc
+ * po LIMIT_DZIURY_REJESTRU_MS od tej chwili każda dziura jest co najmniej tak
+ * stara - pisarz zginął między rezerwacją a publikacją (SIGKILL). */
+static void wczytaj_glowe(IteratorRejestru *it, int shard) {
+    StrumienShardu *sh = &it->shardy[shard];
+    sh->glowa = NULL;
+
+    while (sh->indeks < sh->koniec) {
+        SlotRejestru *s = slot(it->stan, shard, sh->indeks, false);
+        if (s != NULL && atomic_load_explicit(&s->gotowy, memory_order_acquire)) {
+            sh->glowa = &s->wpis;
+            return;
+        }
+
+        /* Slot bez segmentu w zamkniętym shardzie nigdy nie zostanie zapisany */
+        if ((s == NULL && atomic_load(&it->stan->shardy_rejestru[shard].zamkniety)) ||
+            porzucony(it->stan, shard, sh->indeks) ||
+            teraz_ms() - it->poczatek_ms >= LIMIT_DZIURY_REJESTRU_MS) {
+            sh->indeks++;
+            it->pominiete++;
+            continue;
+        }
+
+        /* Zapis w toku - chwila na publikację */
+        struct timespec ts = {0, 1000000};
+        nanosleep(&ts, NULL);
+    }
+}
+
+void rejestr_iterator(IteratorRejestru *it, StanWspoldzielony *stan) {
+    memset(it, 0, sizeof(IteratorRejestru));
+    it->stan = stan;
+    it->poczatek_ms = teraz_ms();
+    for (int i = 0; i < LICZBA_SHARDOW_REJESTRU; i++) {
+        it->shardy[i].koniec = atomic_load(&stan->shardy_rejestru[i].zarezerwowane);
+        wczytaj_glowe(it, i);
+    }
+}
+
+const WpisRejestru *rejestr_nastepny(IteratorRejestru *it) {
+    int najlepszy = -1;
+    for (int i = 0; i < LICZBA_SHARDOW_REJESTRU; i++) {
+        const WpisRejestru *g = it->shardy[i].glowa;
+        if (g != NULL &&
+            (najlepszy == -1 || g->czas < it->shardy[najlepszy].glowa->czas)) {
+            najlepszy = i;
+        }
+    }
+    if (najlepszy == -1) {
+        return NULL;
+    }
+
+    const WpisRejestru *wynik = it->shardy[najlepszy].glowa;
+    it->shardy[najlepszy].indeks++;
+    wczytaj_glowe(it, najlepszy);
+    it->indeks++;
+    return wynik;
+}
+
+/* ========== SPRZĄTANIE ========== */
+void rejestr_odlacz(StanWspoldzielony *stan, bool usun) {
+    for (int s = 0; s < LICZBA_SHARDOW_REJESTRU; s++) {
+        for (int k = 0; k < MAX_SEGMENTOW_REJESTRU; k++) {
+            if (dolaczone[s][k] != NULL) {
+                shmdt(dolaczone[s][k]);
+                dolaczone[s][k] = NULL;
+            }
+
+            if (usun && stan != NULL) {
+                int id = atomic_exchange(&stan->shardy_rejestru[s].shm_id[k], 0);
+                if (id != 0 && shmctl(id - 1, IPC_RMID, NULL) == -1) {
+                    perror("shmctl IPC_RMID segment rejestru");
+                }
+            }
+        }
+    }
+}
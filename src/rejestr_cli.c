@@ -0,0 +1,277 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "rejestr_plik.h"
+#include "analiza.h"
+
+/* ========== NARZĘDZIE DO ZAPYTAŃ O REJESTR KOLUMNOWY ========== */
+/* Użycie:
+ *   rejestr <plik> info              - nagłówek i zakresy kolumn
+ *   rejestr <plik> bilet <id>        - przejazdy na bilecie (indeks bilet_id)
+ *   rejestr <plik> turysta <id>      - przejazdy turysty (indeks turysta_id)
+ *   rejestr <plik> bramki            - użycie bramek w kolejnych godzinach
+ *   rejestr <plik> analiza           - agregaty całego dnia (jądra SIMD, analiza.h)
+ *   rejestr <plik> zrzut             - wszystkie wiersze rosnąco po czasie */
+
+static void wypisz_uzycie(const char *program) {
+    fprintf(stderr, "Użycie: %s <plik.kol> info|bilet <id>|turysta <id>|bramki|analiza|zrzut\n",
+            program);
+}
+
+static void wypisz_wiersz(const RejestrPlik *r, size_t w) {
+    char czas_str[32];
+    time_t czas = (time_t)r->czas[w];
+    struct tm tm_info;
+    localtime_r(&czas, &tm_info);
+    strftime(czas_str, sizeof(czas_str), "%Y-%m-%d %H:%M:%S", &tm_info);
+
+    printf("%-8zu %-10d %-10d %-20s %-6d %-8d %-6d %d\n",
+           w, r->bilet[w], r->turysta[w], czas_str, r->linia[w], r->bramka[w], r->zjazd[w],
+           r->typ[w]);
+}
+
+static void wypisz_naglowek_wierszy(void) {
+    printf("%-8s %-10s %-10s %-20s %-6s %-8s %-6s %s\n",
+           "Wiersz", "Bilet", "Turysta", "Czas", "Linia", "Bramka", "Zjazd", "Typ");
+}
+
+/* ========== KOMENDY ========== */
+static void komenda_info(const RejestrPlik *r) {
+    static const char *nazwy[LICZBA_KOLUMN_REJESTRU] = {
+        "bilet_id", "turysta_id", "czas", "linia", "bramka", "zjazd", "typ_biletu"
+    };
+    const NaglowekRejestruPliku *nag = r->naglowek;
+    char czas_str[32];
+    time_t utworzono = (time_t)nag->utworzono;
+    strftime(czas_str, sizeof(czas_str), "%Y-%m-%d %H:%M:%S", localtime(&utworzono));
+
+    printf("Wersja:       %u\n", nag->wersja);
+    printf("Utworzono:    %s\n", czas_str);
+    printf("Wierszy:      %llu\n", (unsigned long long)nag->liczba_wierszy);
+    printf("Rozmiar:      %zu B\n\n", r->rozmiar);
+
+    printf("%-12s %-10s %-6s %-14s %s\n", "Kolumna", "Offset", "Bajty", "Min", "Max");
+    for (int k = 0; k < LICZBA_KOLUMN_REJESTRU; k++) {
+        const OpisKolumny *kol = &nag->kolumny[k];
+        if (nag->liczba_wierszy == 0) {
+            printf("%-12s %-10llu %-6u %-14s %s\n", nazwy[k],
+                   (unsigned long long)kol->offset, kol->rozmiar_elementu, "-", "-");
+        } else {
+            printf("%-12s %-10llu %-6u %-14lld %lld\n", nazwy[k],
+                   (unsigned long long)kol->offset, kol->rozmiar_elementu,
+                   (long long)kol->min, (long long)kol->max);
+        }
+    }
+}
+
+static void komenda_szukaj(const RejestrPlik *r, const WpisIndeksu *indeks, int32_t klucz) {
+    size_t od, do_;
+    size_t n = rejestr_plik_szukaj(indeks, r->naglowek->liczba_wierszy, klucz, &od, &do_);
+
+    wypisz_naglowek_wierszy();
+    for (size_t i = od; i < do_; i++) {
+        wypisz_wiersz(r, indeks[i].wiersz);
+    }
+    printf("\nZnaleziono: %zu\n", n);
+}
+
+/* Pierwszy wiersz z czasem >= t (kolumna czas jest posortowana) */
+static size_t pierwszy_od(const int64_t *czas, size_t n, int64_t t) {
+    size_t lo = 0, hi = n;
+    while (lo < hi) {
+        size_t srodek = lo + (hi - lo) / 2;
+        if (czas[srodek] < t) lo = srodek + 1;
+        else hi = srodek;
+    }
+    return lo;
+}
+
+/* Wiersze są rosnąco po czasie - godzina to ciągły przedział wierszy
+ * (wyszukiwanie binarne), a w nim histogram samej kolumny bramka */
+static void komenda_bramki(const RejestrPlik *r) {
+    uint64_t n = r->naglowek->liczba_wierszy;
+    if (n == 0) {
+        printf("Rejestr pusty\n");
+        return;
+    }
+
+    const OpisKolumny *kol_bramka = &r->naglowek->kolumny[KOL_BRAMKA];
+    int liczba_bramek = LICZBA_BRAMEK_WEJSCIOWYCH;
+    if (kol_bramka->max >= liczba_bramek) liczba_bramek = (int)kol_bramka->max + 1;
+    if (liczba_bramek > MAX_BRAMEK_WEJSCIOWYCH) liczba_bramek = MAX_BRAMEK_WEJSCIOWYCH;
+    uint64_t *licznik = calloc((size_t)liczba_bramek, sizeof(uint64_t));
+    if (licznik == NULL) {
+        perror("calloc");
+        return;
+    }
+
+    printf("%-16s", "Godzina");
+    for (int b = 0; b < liczba_bramek; b++) {
+        printf(" Bramka %-3d", b + 1);
+    }
+    printf(" Razem\n");
+
+    size_t i = 0;
+    while (i < n) {
+        int64_t godzina = r->czas[i] - r->czas[i] % 3600;
+        size_t koniec = pierwszy_od(r->czas, n, godzina + 3600);
+        memset(licznik, 0, (size_t)liczba_bramek * sizeof(uint64_t));
+        analiza_histogram_i32(r->bramka + i, koniec - i, 0, liczba_bramek, licznik);
+
+        char czas_str[32];
+        time_t t = (time_t)godzina;
+        struct tm tm_info;
+        localtime_r(&t, &tm_info);
+        strftime(czas_str, sizeof(czas_str), "%Y-%m-%d %H:00", &tm_info);
+
+        printf("%-16s", czas_str);
+        for (int b = 0; b < liczba_bramek; b++) {
+            printf(" %-10llu", (unsigned long long)licznik[b]);
+        }
+        printf(" %zu\n", koniec - i);
+        i = koniec;
+    }
+    free(licznik);
+}
+
+/* Agregaty całego dnia z samych kolumn i indeksu biletów */
+static void komenda_analiza(const RejestrPlik *r) {
+    size_t n = r->naglowek->liczba_wierszy;
+    if (n == 0) {
+        printf("Rejestr pusty\n");
+        return;
+    }
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    /* Liczba bramek dnia z zakresu kolumny - konfiguracja mogła być inna niż domyślna */
+    int liczba_bramek = (int)r->naglowek->kolumny[KOL_BRAMKA].max + 1;
+    if (liczba_bramek < 1 || liczba_bramek > MAX_BRAMEK_WEJSCIOWYCH) {
+        liczba_bramek = MAX_BRAMEK_WEJSCIOWYCH;
+    }
+    int liczba_linii = (int)r->naglowek->kolumny[KOL_LINIA].max + 1;
+    if (liczba_linii < 1 || liczba_linii > MAX_LINII) {
+        liczba_linii = MAX_LINII;
+    }
+    uint64_t bramki[MAX_BRAMEK_WEJSCIOWYCH] = {0};
+    uint64_t linie[MAX_LINII] = {0};
+    uint64_t typy[LICZBA_TYPOW_BILETOW] = {0};
+    analiza_histogram_i32(r->bramka, n, 0, liczba_bramek, bramki);
+    analiza_histogram_i32(r->linia, n, 0, liczba_linii, linie);
+    analiza_histogram_i32(r->typ, n, BILET_JEDNORAZOWY, LICZBA_TYPOW_BILETOW, typy);
+
+    int64_t czas_min, czas_max;
+    analiza_min_max_i64(r->czas, n, &czas_min, &czas_max);
+    int64_t poczatek = czas_min - czas_min % 3600;
+    int liczba_godzin = (int)((czas_max - poczatek) / 3600) + 1;
+    uint64_t *godziny = calloc((size_t)liczba_godzin, sizeof(uint64_t));
+    uint32_t *serie = malloc(n * sizeof(uint32_t));
+    if (godziny == NULL || serie == NULL) {
+        perror("malloc");
+        free(godziny);
+        free(serie);
+        return;
+    }
+    analiza_histogram_godzin(r->czas, n, poczatek, liczba_godzin, godziny);
+
+    /* Serie indeksu = bilety; pierwszy/ostatni wiersz serii = pierwszy/ostatni przejazd */
+    size_t biletow = analiza_serie(r->indeks_bilet, n, serie);
+    size_t najwiecej = 0, najdluzej = 0;
+    int32_t bilet_najwiecej = 0, bilet_najdluzej = 0;
+    for (size_t s = 0; s < biletow; s++) {
+        size_t od = serie[s], do_ = (s + 1 < biletow) ? serie[s + 1] : n;
+        size_t rozpietosc = (size_t)(r->czas[r->indeks_bilet[do_ - 1].wiersz] -
+                                     r->czas[r->indeks_bilet[od].wiersz]);
+        if (do_ - od > najwiecej) {
+            najwiecej = do_ - od;
+            bilet_najwiecej = r->indeks_bilet[od].klucz;
+        }
+        if (rozpietosc > najdluzej) {
+            najdluzej = rozpietosc;
+            bilet_najdluzej = r->indeks_bilet[od].klucz;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double ms = (t1.tv_sec - t0.tv_sec) * 1e3 + (t1.tv_nsec - t0.tv_nsec) / 1e6;
+
+    printf("Wierszy: %zu, jądra: %s, czas analizy: %.2f ms\n\n",
+           n, analiza_nazwa_poziomu(analiza_poziom()), ms);
+
+    printf("Przejścia per bramka:\n");
+    for (int b = 0; b < liczba_bramek; b++) {
+        printf("  Bramka %d: %llu\n", b + 1, (unsigned long long)bramki[b]);
+    }
+
+    printf("\nPrzejścia per linia:\n");
+    for (int l = 0; l < liczba_linii; l++) {
+        printf("  Linia %d: %llu\n", l, (unsigned long long)linie[l]);
+    }
+
+    printf("\nPrzejścia per typ biletu:\n");
+    for (int t = 0; t < LICZBA_TYPOW_BILETOW; t++) {
+        printf("  Typ %d: %llu\n", BILET_JEDNORAZOWY + t, (unsigned long long)typy[t]);
+    }
+
+    printf("\nPrzejścia per godzina:\n");
+    for (int h = 0; h < liczba_godzin; h++) {
+        char czas_str[32];
+        time_t t = (time_t)(poczatek + (int64_t)h * 3600);
+        struct tm tm_info;
+        localtime_r(&t, &tm_info);
+        strftime(czas_str, sizeof(czas_str), "%Y-%m-%d %H:00", &tm_info);
+        printf("  %s: %llu\n", czas_str, (unsigned long long)godziny[h]);
+    }
+
+    printf("\nBilety: %zu, średnio %.2f przejazdów\n", biletow, (double)n / biletow);
+    printf("  Najwięcej przejazdów: bilet #%d (%zu)\n", bilet_najwiecej, najwiecej);
+    printf("  Najdłużej w użyciu:   bilet #%d (%zu s od pierwszego do ostatniego)\n",
+           bilet_najdluzej, najdluzej);
+
+    free(godziny);
+    free(serie);
+}
+
+static void komenda_zrzut(const RejestrPlik *r) {
+    wypisz_naglowek_wierszy();
+    for (size_t w = 0; w < r->naglowek->liczba_wierszy; w++) {
+        wypisz_wiersz(r, w);
+    }
+}
+
+/* ========== MAIN ========== */
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        wypisz_uzycie(argv[0]);
+        return 1;
+    }
+
+    RejestrPlik r;
+    if (rejestr_plik_otworz(&r, argv[1]) == -1) {
+        return 1;
+    }
+
+    int wynik = 0;
+    const char *komenda = argv[2];
+    if (strcmp(komenda, "info") == 0) {
+        komenda_info(&r);
+    } else if (strcmp(komenda, "bilet") == 0 && argc >= 4) {
+        komenda_szukaj(&r, r.indeks_bilet, (int32_t)atoi(argv[3]));
+    } else if (strcmp(komenda, "turysta") == 0 && argc >= 4) {
+        komenda_szukaj(&r, r.indeks_turysta, (int32_t)atoi(argv[3]));
+    } else if (strcmp(komenda, "bramki") == 0) {
+        komenda_bramki(&r);
+    } else if (strcmp(komenda, "analiza") == 0) {
+        komenda_analiza(&r);
+    } else if (strcmp(komenda, "zrzut") == 0) {
+        komenda_zrzut(&r);
+    } else {
+        wypisz_uzycie(argv[0]);
+        wynik = 1;
+    }
+
+    rejestr_plik_zamknij(&r);
+    return wynik;
+}
@@ -0,0 +1,309 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "rejestr_plik.h"
+#include "rejestr.h"
+#include "zapis_io.h"
+
+/* ========== POMOCNICZE ========== */
+static uint64_t wyrownaj(uint64_t offset) {
+    return (offset + 7) & ~(uint64_t)7;
+}
+
+static int porownaj_indeks(const void *a, const void *b) {
+    const WpisIndeksu *x = a, *y = b;
+    if (x->klucz != y->klucz) return (x->klucz < y->klucz) ? -1 : 1;
+    return (x->wiersz < y->wiersz) ? -1 : (x->wiersz > y->wiersz);
+}
+
+static void ustaw_kolumne(OpisKolumny *k, uint64_t *offset, uint64_t n, uint32_t rozmiar) {
+    k->offset = *offset;
+    k->rozmiar_elementu = rozmiar;
+    k->min = INT64_MAX;
+    k->max = INT64_MIN;
+    *offset = wyrownaj(*offset + n * rozmiar);
+}
+
+static void aktualizuj_zakres(OpisKolumny *k, int64_t wartosc) {
+    if (wartosc < k->min) k->min = wartosc;
+    if (wartosc > k->max) k->max = wartosc;
+}
+
+/* ========== ZAPIS KOLUMNOWY ========== */
+int rejestr_zapisz_plik(StanWspoldzielony *stan, const char *sciezka) {
+    uint64_t pojemnosc = (uint64_t)atomic_load(&stan->liczba_wpisow_rejestru);
+
+    int32_t *bilet = malloc(pojemnosc * sizeof(int32_t) + 1);
+    int32_t *turysta = malloc(pojemnosc * sizeof(int32_t) + 1);
+    int64_t *czas = malloc(pojemnosc * sizeof(int64_t) + 1);
+    int32_t *linia = malloc(pojemnosc * sizeof(int32_t) + 1);
+    int32_t *bramka = malloc(pojemnosc * sizeof(int32_t) + 1);
+    int32_t *zjazd = malloc(pojemnosc * sizeof(int32_t) + 1);
+    int32_t *typ = malloc(pojemnosc * sizeof(int32_t) + 1);
+    WpisIndeksu *idx_bilet = malloc(pojemnosc * sizeof(WpisIndeksu) + 1);
+    WpisIndeksu *idx_turysta = malloc(pojemnosc * sizeof(WpisIndeksu) + 1);
+    int wynik = -1;
+
+    if (!bilet || !turysta || !czas || !linia || !bramka || !zjazd || !typ || !idx_bilet || !idx_turysta) {
+        perror("malloc rejestr kolumnowy");
+        goto koniec;
+    }
+
+    /* Jeden przebieg scalający shardy - wiersze rosnąco po czasie */
+    NaglowekRejestruPliku nag;
+    memset(&nag, 0, sizeof(nag));
+    nag.magia = REJESTR_PLIK_MAGIA;
+    nag.wersja = REJESTR_PLIK_WERSJA;
+    nag.utworzono = (int64_t)time(NULL);
+
+    IteratorRejestru it;
+    rejestr_iterator(&it, stan);
+    const WpisRejestru *w;
+    uint64_t n = 0;
+    while (n < pojemnosc && (w = rejestr_nastepny(&it)) != NULL) {
+        bilet[n] = w->bilet_id;
+        turysta[n] = w->turysta_id;
+        czas[n] = (int64_t)w->czas;
+        linia[n] = w->linia;
+        bramka[n] = w->numer_bramki;
+        zjazd[n] = w->numer_zjazdu;
+        typ[n] = w->typ_biletu;
+        idx_bilet[n] = (WpisIndeksu){ w->bilet_id, (uint32_t)n };
+        idx_turysta[n] = (WpisIndeksu){ w->turysta_id, (uint32_t)n };
+        n++;
+    }
+    nag.liczba_wierszy = n;
+
+    qsort(idx_bilet, n, sizeof(WpisIndeksu), porownaj_indeks);
+    qsort(idx_turysta, n, sizeof(WpisIndeksu), porownaj_indeks);
+
+    /* Układ pliku */
+    uint64_t offset = wyrownaj(sizeof(NaglowekRejestruPliku));
+    ustaw_kolumne(&nag.kolumny[KOL_BILET], &offset, n, sizeof(int32_t));
+    ustaw_kolumne(&nag.kolumny[KOL_TURYSTA], &offset, n, sizeof(int32_t));
+    ustaw_kolumne(&nag.kolumny[KOL_CZAS], &offset, n, sizeof(int64_t));
+    ustaw_kolumne(&nag.kolumny[KOL_LINIA], &offset, n, sizeof(int32_t));
+    ustaw_kolumne(&nag.kolumny[KOL_BRAMKA], &offset, n, sizeof(int32_t));
+    ustaw_kolumne(&nag.kolumny[KOL_ZJAZD], &offset, n, sizeof(int32_t));
+    ustaw_kolumne(&nag.kolumny[KOL_TYP], &offset, n, sizeof(int32_t));
+    nag.offset_indeksu_bilet = offset;
+    offset = wyrownaj(offset + n * sizeof(WpisIndeksu));
+    nag.offset_indeksu_turysta = offset;
+
+    for (uint64_t i = 0; i < n; i++) {
+        aktualizuj_zakres(&nag.kolumny[KOL_BILET], bilet[i]);
+        aktualizuj_zakres(&nag.kolumny[KOL_TURYSTA], turysta[i]);
+        aktualizuj_zakres(&nag.kolumny[KOL_CZAS], czas[i]);
+        aktualizuj_zakres(&nag.kolumny[KOL_LINIA], linia[i]);
+        aktualizuj_zakres(&nag.kolumny[KOL_BRAMKA], bramka[i]);
+        aktualizuj_zakres(&nag.kolumny[KOL_ZJAZD], zjazd[i]);
+        aktualizuj_zakres(&nag.kolumny[KOL_TYP], typ[i]);
+    }
+
+    /* Zapis do pliku tymczasowego i rename() - czytelnik nie zobaczy połowy */
+    char tymczasowy[300];
+    snprintf(tymczasowy, sizeof(tymczasowy), "%s.tmp", sciezka);
+    int fd = open(tymczasowy, O_CREAT | O_WRONLY | O_TRUNC, 0644);
+    if (fd == -1) {
+        perror("open rejestr kolumnowy");
+        goto koniec;
+    }
+
+    KontekstIO io;
+    io_inicjalizuj(&io, 16, NULL);
+    io_dodaj_zapis(&io, fd, &nag, sizeof(nag), 0, NULL);
+    io_dodaj_zapis(&io, fd, bilet, n * sizeof(int32_t), nag.kolumny[KOL_BILET].offset, NULL);
+    io_dodaj_zapis(&io, fd, turysta, n * sizeof(int32_t), nag.kolumny[KOL_TURYSTA].offset, NULL);
+    io_dodaj_zapis(&io, fd, czas, n * sizeof(int64_t), nag.kolumny[KOL_CZAS].offset, NULL);
+    io_dodaj_zapis(&io, fd, linia, n * sizeof(int32_t), nag.kolumny[KOL_LINIA].offset, NULL);
+    io_dodaj_zapis(&io, fd, bramka, n * sizeof(int32_t), nag.kolumny[KOL_BRAMKA].offset, NULL);
+    io_dodaj_zapis(&io, fd, zjazd, n * sizeof(int32_t), nag.kolumny[KOL_ZJAZD].offset, NULL);
+    io_dodaj_zapis(&io, fd, typ, n * sizeof(int32_t), nag.kolumny[KOL_TYP].offset, NULL);
+    io_dodaj_zapis(&io, fd, idx_bilet, n * sizeof(WpisIndeksu), nag.offset_indeksu_bilet, NULL);
+    io_dodaj_zapis(&io, fd, idx_turysta, n * sizeof(WpisIndeksu), nag.offset_indeksu_turysta, NULL);
+    io_dodaj_fsync(&io, fd, true, NULL);
+    int blad_io = io_czekaj_wszystkie(&io);
+    io_zamknij(&io);
+
+    /* Plik krótszy niż ostatni indeks - nie podmieniaj poprzedniej wersji */
+    struct stat st;
+    uint64_t oczekiwany = nag.offset_indeksu_turysta + n * sizeof(WpisIndeksu);
+    if (blad_io == 0 && fstat(fd, &st) == -1) {
+        blad_io = -1;
+    } else if (blad_io == 0 && (uint64_t)st.st_size < oczekiwany) {
+        errno = EIO;
+        blad_io = -1;
+    }
+    close(fd);
+
+    if (blad_io == -1) {
+        perror("zapis rejestru kolumnowego");
+        unlink(tymczasowy);
+        goto koniec;
+    }
+    if (rename(tymczasowy, sciezka) == -1) {
+        perror("rename rejestr kolumnowy");
+        unlink(tymczasowy);
+        goto koniec;
+    }
+    wynik = 0;
+
+koniec:
+    free(bilet);
+    free(turysta);
+    free(czas);
+    free(linia);
+    free(bramka);
+    free(zjazd);
+    free(typ);
+    free(idx_bilet);
+    free(idx_turysta);
+    return wynik;
+}
+
+/* ========== ODCZYT - mmap() ========== */
+static const uint32_t ROZMIARY_KOLUMN[LICZBA_KOLUMN_REJESTRU] = {
+    [KOL_BILET] = sizeof(int32_t),
+    [KOL_TURYSTA] = sizeof(int32_t),
+    [KOL_CZAS] = sizeof(int64_t),
+    [KOL_LINIA] = sizeof(int32_t),
+    [KOL_BRAMKA] = sizeof(int32_t),
+    [KOL_ZJAZD] = sizeof(int32_t),
+    [KOL_TYP] = sizeof(int32_t),
+};
+
+/* Układ odtworzony z liczby wierszy musi zgadzać się z nagłówkiem co do
+ * bajtu, a plik kończyć się na ostatnim indeksie - każda sekcja mieści się
+ * wtedy w mapie, a liczba wierszy odpowiada rozmiarowi pliku */
+static bool uklad_poprawny(const NaglowekRejestruPliku *nag, size_t rozmiar) {
+    if (nag->magia != REJESTR_PLIK_MAGIA || nag->wersja != REJESTR_PLIK_WERSJA) {
+        return false;
+    }
+
+    /* Ograniczenie n przed mnożeniem - bez przepełnienia przesunięć */
+    uint64_t bajty_wiersza = 2 * sizeof(WpisIndeksu);
+    for (int k = 0; k < LICZBA_KOLUMN_REJESTRU; k++) {
+        bajty_wiersza += ROZMIARY_KOLUMN[k];
+    }
+    uint64_t n = nag->liczba_wierszy;
+    if (n > UINT32_MAX || n > rozmiar / bajty_wiersza) {
+        return false;
+    }
+
+    uint64_t offset = wyrownaj(sizeof(NaglowekRejestruPliku));
+    for (int k = 0; k < LICZBA_KOLUMN_REJESTRU; k++) {
+        if (nag->kolumny[k].offset != offset ||
+            nag->kolumny[k].rozmiar_elementu != ROZMIARY_KOLUMN[k]) {
+            return false;
+        }
+        offset = wyrownaj(offset + n * ROZMIARY_KOLUMN[k]);
+    }
+    if (nag->offset_indeksu_bilet != offset) {
+        return false;
+    }
+    offset = wyrownaj(offset + n * sizeof(WpisIndeksu));
+    if (nag->offset_indeksu_turysta != offset) {
+        return false;
+    }
+    return offset + n * sizeof(WpisIndeksu) == rozmiar;
+}
+
+/* Wiersze w indeksie wskazują do kolumn - poza zakresem czytałyby za mapą */
+static bool indeks_poprawny(const WpisIndeksu *indeks, uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+        if (indeks[i].wiersz >= n) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int rejestr_plik_otworz(RejestrPlik *r, const char *sciezka) {
+    memset(r, 0, sizeof(RejestrPlik));
+
+    int fd = open(sciezka, O_RDONLY);
+    if (fd == -1) {
+        perror("open rejestr kolumnowy");
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(NaglowekRejestruPliku)) {
+        fprintf(stderr, "%s: za krótki plik rejestru\n", sciezka);
+        close(fd);
+        return -1;
+    }
+
+    r->rozmiar = (size_t)st.st_size;
+    r->mapa = mmap(NULL, r->rozmiar, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (r->mapa == MAP_FAILED) {
+        perror("mmap rejestr kolumnowy");
+        r->mapa = NULL;
+        return -1;
+    }
+
+    const NaglowekRejestruPliku *nag = r->mapa;
+    if (!uklad_poprawny(nag, r->rozmiar)) {
+        fprintf(stderr, "%s: niepoprawny nagłówek rejestru\n", sciezka);
+        rejestr_plik_zamknij(r);
+        return -1;
+    }
+
+    const char *baza = r->mapa;
+    uint64_t n = nag->liczba_wierszy;
+    if (!indeks_poprawny((const WpisIndeksu *)(baza + nag->offset_indeksu_bilet), n) ||
+        !indeks_poprawny((const WpisIndeksu *)(baza + nag->offset_indeksu_turysta), n)) {
+        fprintf(stderr, "%s: indeks wskazuje poza kolumny\n", sciezka);
+        rejestr_plik_zamknij(r);
+        return -1;
+    }
+
+    r->naglowek = nag;
+    r->bilet = (const int32_t *)(baza + nag->kolumny[KOL_BILET].offset);
+    r->turysta = (const int32_t *)(baza + nag->kolumny[KOL_TURYSTA].offset);
+    r->czas = (const int64_t *)(baza + nag->kolumny[KOL_CZAS].offset);
+    r->linia = (const int32_t *)(baza + nag->kolumny[KOL_LINIA].offset);
+    r->bramka = (const int32_t *)(baza + nag->kolumny[KOL_BRAMKA].offset);
+    r->zjazd = (const int32_t *)(baza + nag->kolumny[KOL_ZJAZD].offset);
+    r->typ = (const int32_t *)(baza + nag->kolumny[KOL_TYP].offset);
+    r->indeks_bilet = (const WpisIndeksu *)(baza + nag->offset_indeksu_bilet);
+    r->indeks_turysta = (const WpisIndeksu *)(baza + nag->offset_indeksu_turysta);
+    return 0;
+}
+
+void rejestr_plik_zamknij(RejestrPlik *r) {
+    if (r->mapa != NULL) {
+        munmap(r->mapa, r->rozmiar);
+    }
+    memset(r, 0, sizeof(RejestrPlik));
+}
+
+/* ========== WYSZUKIWANIE W INDEKSIE ========== */
+size_t rejestr_plik_szukaj(const WpisIndeksu *indeks, size_t n, int32_t klucz,
+                           size_t *od, size_t *do_) {
+    /* Pierwszy wpis >= klucz */
+    size_t lo = 0, hi = n;
+    while (lo < hi) {
+        size_t srodek = lo + (hi - lo) / 2;
+        if (indeks[srodek].klucz < klucz) lo = srodek + 1;
+        else hi = srodek;
+    }
+    *od = lo;
+
+    /* Pierwszy wpis > klucz */
+    hi = n;
+    while (lo < hi) {
+        size_t srodek = lo + (hi - lo) / 2;
+        if (indeks[srodek].klucz <= klucz) lo = srodek + 1;
+        else hi = srodek;
+    }
+    *do_ = lo;
+    return *do_ - *od;
+}
@@ -0,0 +1,62 @@
+#include <sched.h>
+#include "stan_kolei.h"
+
+/* ========== LICZNIKI ========== */
+int licznik_linii(const StanWspoldzielony *stan, int linia, Licznik licznik) {
+    int suma = 0;
+    for (int s = 0; s < LICZBA_SHARDOW_LICZNIKOW; s++) {
+        suma += atomic_load_explicit(&stan->liczniki[linia][s].wartosc[licznik],
+                                     memory_order_acquire);
+    }
+    return suma;
+}
+
+/* Wszystkie MAX_LINII - nieużywane linie mają zera */
+int licznik_suma(const StanWspoldzielony *stan, Licznik licznik) {
+    int suma = 0;
+    for (int l = 0; l < MAX_LINII; l++) {
+        suma += licznik_linii(stan, l, licznik);
+    }
+    return suma;
+}
+
+/* ========== MIGAWKA (czytelnik seqlocka) ========== */
+#define CZYTAJ(pole) atomic_load_explicit(&k->pole, memory_order_relaxed)
+
+unsigned stan_migawka(const StanWspoldzielony *stan, MigawkaStanu *m) {
+    const StanKolei *k = &stan->kolej;
+    unsigned ponowienia = 0;
+
+    for (;;) {
+        unsigned s1 = atomic_load_explicit(&k->sekwencja, memory_order_acquire);
+
+        m->kolej_aktywna = CZYTAJ(kolej_aktywna);
+        m->kolej_zatrzymana = false;
+        for (int l = 0; l < MAX_LINII; l++) {
+            m->kolej_zatrzymana |= CZYTAJ(kolej_zatrzymana[l]);
+        }
+        m->godziny_pracy = CZYTAJ(godziny_pracy);
+
+        atomic_thread_fence(memory_order_acquire);
+        unsigned s2 = atomic_load_explicit(&k->sekwencja, memory_order_relaxed);
+        if (s1 == s2 && (s1 & 1u) == 0) {
+            break;
+        }
+
+        if (++ponowienia >= MAX_PONOWIEN_MIGAWKI) {
+            break;
+        }
+        /* Piszący mógł zostać wywłaszczony w sekcji krytycznej */
+        if (ponowienia % 64 == 0) {
+            sched_yield();
+        }
+    }
+
+    /* Źródło przed celem (stan_kolei.h) */
+    m->liczba_osob_na_stacji = licznik_suma(stan, LICZNIK_STACJA);
+    m->liczba_osob_na_peronie = licznik_suma(stan, LICZNIK_PERON);
+    m->liczba_aktywnych_krzeselek = licznik_suma(stan, LICZNIK_KRZESELKA);
+    m->laczna_liczba_zjazdow = licznik_suma(stan, LICZNIK_ZJAZDY);
+    m->liczba_sprzedanych_biletow = licznik_suma(stan, LICZNIK_BILETY);
+    return ponowienia;
+}
@@ -10,10 +10,21 @@
 #include "types.h"
 #include "ipc_utils.h"
 #include "logger.h"
+#include "instancja.h"
+#include "rejestr.h"
+#include "dziennik.h"
+#include "agregaty.h"
+#include "stan_kolei.h"
+#include "linie.h"
+#include "polityka.h"
+#include "konfiguracja.h"
 
 static volatile sig_atomic_t turysta_dzialaj = 1;
 static ZasobyIPC turysta_zasoby;
 static Turysta ja;
+static long prosba_o_peron_us;     /* czas_monotoniczny_us() prośby o peron */
+static long poczatek_zjazdu_us;    /* Kasa albo bramka - pomiary.obsluga_vip/zwykla */
+static int sem_miejsca = SEM_IDX_STACJA_DOLNA;  /* Pula zajętego miejsca: STACJA_DOLNA albo VIP */
 
 /* ========== OBSŁUGA SYGNAŁÓW Z sigaction() ========== */
 static void turysta_obsluz_sygnal(int sig, siginfo_t *info, void *context) {
@@ -40,13 +51,13 @@ void inicjalizuj_turystę(int id, int zadany_wiek, int opiekun_id) {
     ja.pid = getpid();
     ja.wiek = (zadany_wiek > 0) ? zadany_wiek : ((rand() % 76) + 4);
     
-    if (ja.wiek >= 12 && rand() % 100 < 40) {
+    if (ja.wiek >= 12 && rand() % 100 < PROCENT_ROWERZYSTOW) {
         ja.typ = ROWERZYSTA;
     } else {
         ja.typ = PIESZY;
     }
     
-    ja.vip = (rand() % 100 < PROCENT_VIP);
+    ja.vip = (rand() % 100 < turysta_zasoby.shm.stan->konfiguracja.procent_vip);
     ja.dziecko_pod_opieka = (ja.wiek >= WIEK_MIN_DZIECKO && ja.wiek < WIEK_DZIECKO_OPIEKA);
     ja.opiekun_id = opiekun_id;
     ja.status = STATUS_NOWY;
@@ -87,7 +98,7 @@ int kup_bilet(void) {
     
     Komunikat prosba;
     memset(&prosba, 0, sizeof(Komunikat));
-    prosba.mtype = MSG_PROSBA_O_BILET;
+    prosba.mtype = ja.vip ? MTYPE_BILET_VIP : MTYPE_BILET;
     prosba.nadawca_id = ja.id;
     prosba.typ_komunikatu = MSG_PROSBA_O_BILET;
     prosba.dane[0] = typ;
@@ -96,6 +107,7 @@ int kup_bilet(void) {
     
     if (!turysta_dzialaj) return -1;
     
+    long prosba_us = czas_monotoniczny_us();
     if (wyslij_komunikat(turysta_zasoby.mq.mq_kasa, &prosba) == -1) {
         if (!turysta_dzialaj) return -1;
         LOG_E("TURYSTA #%d: Błąd wysyłania prośby", ja.id);
@@ -107,11 +119,13 @@ int kup_bilet(void) {
     if (!turysta_dzialaj) return -1;
     
     Komunikat odpowiedz;
-    if (odbierz_komunikat(turysta_zasoby.mq.mq_kasa, &odpowiedz, ja.id) == -1) {
+    if (odbierz_komunikat(turysta_zasoby.mq.mq_kasa, &odpowiedz, MTYPE_BILET_DLA(ja.id)) == -1) {
         if (!turysta_dzialaj) return -1;
         LOG_E("TURYSTA #%d: Błąd odbierania biletu", ja.id);
         return -1;
     }
+    histogram_dodaj(&turysta_zasoby.shm.stan->pomiary.czekanie_bilet,
+                    czas_monotoniczny_us() - prosba_us);
     
     if (!turysta_dzialaj) return -1;
     
@@ -130,6 +144,11 @@ int kup_bilet(void) {
     return 0;
 }
 
+/* Miejsce na stacji wraca do puli, z której je zajęto */
+static void zwolnij_miejsce_na_stacji(void) {
+    sem_sygnalizuj_sysv(turysta_zasoby.sem.sem_id, SEM_LINII(ja.linia, sem_miejsca));
+}
+
 /* Przejście przez bramkę wejściową */
 int przejdz_bramke_wejsciowa(void) {
     if (!turysta_dzialaj) return -1;
@@ -137,7 +156,7 @@ int przejdz_bramke_wejsciowa(void) {
     StanWspoldzielony *stan = turysta_zasoby.shm.stan;
     int sem_id = turysta_zasoby.sem.sem_id;
     
-    if (!stan->godziny_pracy) {
+    if (!STAN_CZYTAJ(stan, godziny_pracy)) {
         LOG_W("TURYSTA #%d: Kolej zamknięta!", ja.id);
         return -1;
     }
@@ -148,99 +167,125 @@ int przejdz_bramke_wejsciowa(void) {
     }
     
     ja.status = STATUS_PRZED_BRAMKA_WEJSCIOWA;
-    
-    /* VIP - priorytet */
-    if (ja.vip) {
-        LOG_I("TURYSTA #%d [VIP]: Wchodzę bez kolejki", ja.id);
-        if (!turysta_dzialaj) return -1;
-        sem_czekaj_sysv(sem_id, SEM_IDX_VIP);
-        if (!turysta_dzialaj) {
-            sem_sygnalizuj_sysv(sem_id, SEM_IDX_VIP);
-            return -1;
-        }
-    }
+    long przed_bramka_us = czas_monotoniczny_us();
     
     LOG_I("TURYSTA #%d: Czekam na miejsce na stacji", ja.id);
     
-    if (!turysta_dzialaj) {
-        if (ja.vip) sem_sygnalizuj_sysv(sem_id, SEM_IDX_VIP);
-        return -1;
-    }
+    if (!turysta_dzialaj) return -1;
     
-    /* Czekaj na miejsce na stacji */
-    sem_czekaj_sysv(sem_id, SEM_IDX_STACJA_DOLNA);
+    /* Czekaj na miejsce na stacji. VIP bierze wolne miejsce zwykłe bez
+     * czekania, a gdy go nie ma - czeka tylko na rezerwę VIP, więc nie
+     * stoi w kolejce FIFO za zwykłymi turystami */
+    sem_miejsca = SEM_IDX_STACJA_DOLNA;
+    if (!ja.vip || konfiguracja_miejsca_vip(&stan->konfiguracja) == 0) {
+        sem_czekaj_sysv(sem_id, SEM_LINII(ja.linia, SEM_IDX_STACJA_DOLNA));
+    } else if (sem_probuj_sysv(sem_id, SEM_LINII(ja.linia, SEM_IDX_STACJA_DOLNA)) != 0) {
+        sem_miejsca = SEM_IDX_VIP;
+        sem_czekaj_sysv(sem_id, SEM_LINII(ja.linia, SEM_IDX_VIP));
+    }
     
     if (!turysta_dzialaj) {
-        sem_sygnalizuj_sysv(sem_id, SEM_IDX_STACJA_DOLNA);
-        if (ja.vip) sem_sygnalizuj_sysv(sem_id, SEM_IDX_VIP);
+        zwolnij_miejsce_na_stacji();
         return -1;
     }
     
-    /* Znajdź wolną bramkę */
+    /* Ostatnia bramka to pas VIP - zwykli turyści jej nie zajmują, chyba
+     * że linia ma tylko jedną bramkę */
+    int liczba_bramek = stan->konfiguracja.bramki_wejsciowe;
+    int bramki_zwykle = (liczba_bramek > 1) ? liczba_bramek - 1 : liczba_bramek;
     int bramka = -1;
-    for (int i = 0; i < LICZBA_BRAMEK_WEJSCIOWYCH && turysta_dzialaj; i++) {
-        if (sem_probuj_sysv(sem_id, SEM_IDX_BRAMKA_WEJ_BASE + i) == 0) {
-            bramka = i;
-            break;
+    if (ja.vip) {
+        /* Najpierw pas VIP, potem dowolna wolna bramka - VIP-y nie czekają
+         * jeden za drugim, gdy obok stoi wolna bramka */
+        for (int i = liczba_bramek - 1; i >= 0 && turysta_dzialaj; i--) {
+            if (sem_probuj_sysv(sem_id, SEM_LINII(ja.linia, SEM_IDX_BRAMKA_WEJ_BASE + i)) == 0) {
+                bramka = i;
+                break;
+            }
+        }
+        
+        if (bramka == -1 && turysta_dzialaj) {
+            bramka = liczba_bramek - 1;
+            sem_czekaj_sysv(sem_id, SEM_LINII(ja.linia, SEM_IDX_BRAMKA_WEJ_BASE + bramka));
+        }
+        LOG_I("TURYSTA #%d [VIP]: Wchodzę bramką %d", ja.id, bramka);
+    } else {
+        /* Znajdź wolną bramkę */
+        for (int i = 0; i < bramki_zwykle && turysta_dzialaj; i++) {
+            if (sem_probuj_sysv(sem_id, SEM_LINII(ja.linia, SEM_IDX_BRAMKA_WEJ_BASE + i)) == 0) {
+                bramka = i;
+                break;
+            }
+        }
+        
+        if (bramka == -1 && turysta_dzialaj) {
+            bramka = rand() % bramki_zwykle;
+            sem_czekaj_sysv(sem_id, SEM_LINII(ja.linia, SEM_IDX_BRAMKA_WEJ_BASE + bramka));
         }
     }
     
     if (!turysta_dzialaj) {
-        sem_sygnalizuj_sysv(sem_id, SEM_IDX_STACJA_DOLNA);
-        if (ja.vip) sem_sygnalizuj_sysv(sem_id, SEM_IDX_VIP);
-        if (bramka >= 0) sem_sygnalizuj_sysv(sem_id, SEM_IDX_BRAMKA_WEJ_BASE + bramka);
-        return -1;
-    }
-    
-    if (bramka == -1) {
-        bramka = rand() % LICZBA_BRAMEK_WEJSCIOWYCH;
-        sem_czekaj_sysv(sem_id, SEM_IDX_BRAMKA_WEJ_BASE + bramka);
-        
-        if (!turysta_dzialaj) {
-            sem_sygnalizuj_sysv(sem_id, SEM_IDX_BRAMKA_WEJ_BASE + bramka);
-            sem_sygnalizuj_sysv(sem_id, SEM_IDX_STACJA_DOLNA);
-            if (ja.vip) sem_sygnalizuj_sysv(sem_id, SEM_IDX_VIP);
-            return -1;
+        zwolnij_miejsce_na_stacji();
+        if (bramka >= 0) {
+            sem_sygnalizuj_sysv(sem_id, SEM_LINII(ja.linia, SEM_IDX_BRAMKA_WEJ_BASE + bramka));
         }
+        return -1;
     }
     
     ja.bilet.liczba_uzyc++;
-    
-    /* Rejestruj przejście */
-    if (turysta_dzialaj) {
-        sem_czekaj_sysv(sem_id, SEM_IDX_REJESTR);
-        if (turysta_dzialaj && stan->liczba_wpisow_rejestru < MAX_WPISOW_REJESTRU) {
-            WpisRejestru *wpis = &stan->rejestr[stan->liczba_wpisow_rejestru];
-            wpis->bilet_id = ja.bilet.id;
-            wpis->turysta_id = ja.id;
-            wpis->czas = time(NULL);
-            wpis->numer_bramki = bramka;
-            wpis->numer_zjazdu = ja.liczba_zjazdow + 1;
-            stan->liczba_wpisow_rejestru++;
-        }
-        sem_sygnalizuj_sysv(sem_id, SEM_IDX_REJESTR);
-    }
+    histogram_dodaj(&stan->pomiary.czekanie_bramka, czas_monotoniczny_us() - przed_bramka_us);
+    
+    /* Czas przejścia z chwili przejścia - zapis do rejestru dopiero po zwolnieniu bramki */
+    WpisRejestru wpis = {
+        .bilet_id = ja.bilet.id,
+        .turysta_id = ja.id,
+        .czas = time(NULL),
+        .linia = ja.linia,
+        .numer_bramki = bramka,
+        .numer_zjazdu = ja.liczba_zjazdow + 1,
+        .typ_biletu = ja.bilet.typ
+    };
     
     /* Aktualizuj licznik */
     if (turysta_dzialaj) {
-        sem_czekaj_sysv(sem_id, SEM_IDX_STAN);
-        stan->liczba_osob_na_stacji++;
-        sem_sygnalizuj_sysv(sem_id, SEM_IDX_STAN);
+        licznik_dodaj(stan, ja.linia, shard_turysty(ja.id), LICZNIK_STACJA, 1);
     }
     
-    LOG_I("TURYSTA #%d: Przeszedłem przez bramkę %d", ja.id, bramka);
-    
     /* Zwolnij bramkę */
-    sem_sygnalizuj_sysv(sem_id, SEM_IDX_BRAMKA_WEJ_BASE + bramka);
+    sem_sygnalizuj_sysv(sem_id, SEM_LINII(ja.linia, SEM_IDX_BRAMKA_WEJ_BASE + bramka));
     
-    if (ja.vip) {
-        sem_sygnalizuj_sysv(sem_id, SEM_IDX_VIP);
+    /* Rejestruj przejście - shard bramki, bez semafora */
+    if (turysta_dzialaj && rejestr_dopisz(stan, &wpis) == -1) {
+        LOG_E("TURYSTA #%d: Nie udało się zapisać przejścia w rejestrze", ja.id);
     }
+    if (turysta_dzialaj && dziennik_przejscie(stan, &wpis) == -1) {
+        LOG_E("TURYSTA #%d: Nie udało się zapisać przejścia w dzienniku", ja.id);
+    }
+    if (turysta_dzialaj) {
+        agregaty_przejscie(stan, &wpis);
+    }
+    
+    LOG_I("TURYSTA #%d: Przeszedłem przez bramkę %d linii %d", ja.id, bramka, ja.linia);
     
     ja.status = STATUS_NA_STACJI_DOLNEJ;
     return turysta_dzialaj ? 0 : -1;
 }
 
+/* Wybór linii przed zjazdem (linie.h). Rodzina jeździ jedną linią -
+ * pracownik1 łączy dziecko z opiekunem tylko we własnej kolejce - więc
+ * opiekun i jego dzieci liczą ją z id opiekuna zamiast z długości kolejek */
+int wybierz_linie(void) {
+    StanWspoldzielony *stan = turysta_zasoby.shm.stan;
+    
+    if (ja.opiekun_id > 0) {
+        return ja.opiekun_id % stan->konfiguracja.linie;
+    }
+    if (ja.liczba_dzieci > 0) {
+        return ja.id % stan->konfiguracja.linie;
+    }
+    return linia_wybierz(stan);
+}
+
 /* Czekanie na wejście na peron */
 int czekaj_na_peron(void) {
     if (!turysta_dzialaj) return -1;
@@ -254,16 +299,18 @@ int czekaj_na_peron(void) {
     /* Wyślij prośbę do pracownika1 */
     Komunikat prosba;
     memset(&prosba, 0, sizeof(Komunikat));
-    prosba.mtype = MSG_PROSBA_O_PERON;
+    prosba.mtype = MTYPE_LINII(ja.linia, MSG_PROSBA_O_PERON);
     prosba.nadawca_id = ja.id;
     prosba.typ_komunikatu = MSG_PROSBA_O_PERON;
     prosba.dane[0] = ja.typ;
     prosba.dane[1] = ja.dziecko_pod_opieka ? 1 : 0;
     prosba.dane[2] = ja.opiekun_id;
     prosba.dane[3] = ja.wiek;
+    prosba.dane[4] = ja.vip ? 1 : 0;
     
     if (!turysta_dzialaj) return -1;
     
+    prosba_o_peron_us = czas_monotoniczny_us();
     if (wyslij_komunikat(turysta_zasoby.mq.mq_pracownicy, &prosba) == -1) {
         if (!turysta_dzialaj) return -1;
         LOG_E("TURYSTA #%d: Błąd wysyłania prośby o peron", ja.id);
@@ -273,14 +320,14 @@ int czekaj_na_peron(void) {
     if (!turysta_dzialaj) return -1;
     
     /* Czekaj na semaforze */
-    sem_czekaj_sysv(sem_id, SEM_IDX_PERON);
+    sem_czekaj_sysv(sem_id, SEM_LINII(ja.linia, SEM_IDX_PERON));
     
     if (!turysta_dzialaj) return -1;
     
     /* Sprawdź zatrzymanie kolei */
-    if (stan->kolej_zatrzymana && turysta_dzialaj) {
+    if (STAN_CZYTAJ(stan, kolej_zatrzymana[ja.linia]) && turysta_dzialaj) {
         LOG_W("TURYSTA #%d: Kolej zatrzymana! Czekam...", ja.id);
-        sem_czekaj_sysv(sem_id, SEM_IDX_PERON);
+        sem_czekaj_sysv(sem_id, SEM_LINII(ja.linia, SEM_IDX_PERON));
         if (!turysta_dzialaj) return -1;
     }
     
@@ -289,10 +336,7 @@ int czekaj_na_peron(void) {
     
     /* Aktualizuj liczniki */
     if (turysta_dzialaj) {
-        sem_czekaj_sysv(sem_id, SEM_IDX_STAN);
-        stan->liczba_osob_na_stacji--;
-        stan->liczba_osob_na_peronie++;
-        sem_sygnalizuj_sysv(sem_id, SEM_IDX_STAN);
+        licznik_przenies(stan, ja.linia, shard_turysty(ja.id), LICZNIK_STACJA, LICZNIK_PERON);
     }
     
     return turysta_dzialaj ? 0 : -1;
@@ -303,30 +347,13 @@ int wsiadz_na_krzeselko(void) {
     if (!turysta_dzialaj) return -1;
     
     StanWspoldzielony *stan = turysta_zasoby.shm.stan;
-    int sem_id = turysta_zasoby.sem.sem_id;
     
     LOG_I("TURYSTA #%d: Czekam na krzesełko", ja.id);
     
-    /* Wyślij gotowość */
-    Komunikat msg;
-    memset(&msg, 0, sizeof(Komunikat));
-    msg.mtype = MSG_WSIADANIE_NA_KRZESLO;
-    msg.nadawca_id = ja.id;
-    msg.typ_komunikatu = MSG_WSIADANIE_NA_KRZESLO;
-    msg.dane[0] = ja.typ;
-    msg.dane[1] = ja.dziecko_pod_opieka ? 1 : 0;
-    
-    if (!turysta_dzialaj) return -1;
-    
-    if (wyslij_komunikat(turysta_zasoby.mq.mq_krzesla, &msg) == -1) {
-        if (!turysta_dzialaj) return -1;
-        LOG_E("TURYSTA #%d: Błąd wsiadania", ja.id);
-        return -1;
-    }
-    
-    if (!turysta_dzialaj) return -1;
-    
-    /* Czekaj na potwierdzenie */
+    /* Miejsce w grupie przydzielił już pracownik1 przy wpuszczeniu na peron.
+     * Zgłoszenia gotowości (MSG_WSIADANIE_NA_KRZESLO) nikt nie odbierał - po
+     * ~150 zjazdach zapełniały kolejkę krzesełek i blokowały msgsnd() turystów
+     * i pracownika1, więc turysta tylko czeka na potwierdzenie. */
     Komunikat odp;
     long moj_typ = ja.id + 10000;
     
@@ -335,6 +362,10 @@ int wsiadz_na_krzeselko(void) {
         LOG_E("TURYSTA #%d: Błąd oczekiwania na krzesełko", ja.id);
         return -1;
     }
+    long teraz_us = czas_monotoniczny_us();
+    histogram_dodaj(&stan->pomiary.czekanie_krzeselko, teraz_us - prosba_o_peron_us);
+    histogram_dodaj(ja.vip ? &stan->pomiary.obsluga_vip : &stan->pomiary.obsluga_zwykla,
+                    teraz_us - poczatek_zjazdu_us);
     
     if (!turysta_dzialaj) return -1;
     
@@ -343,11 +374,9 @@ int wsiadz_na_krzeselko(void) {
     ja.status = STATUS_NA_KRZESELKU;
     LOG_I("TURYSTA #%d: Wsiadłem na krzesełko #%d", ja.id, krzeselko_id);
     
-    /* Aktualizuj licznik */
+    /* Aktualizuj licznik (krzesełko policzył już pracownik1) */
     if (turysta_dzialaj) {
-        sem_czekaj_sysv(sem_id, SEM_IDX_STAN);
-        stan->liczba_osob_na_peronie--;
-        sem_sygnalizuj_sysv(sem_id, SEM_IDX_STAN);
+        licznik_dodaj(stan, ja.linia, shard_turysty(ja.id), LICZNIK_PERON, -1);
     }
     
     return turysta_dzialaj ? krzeselko_id : -1;
@@ -363,10 +392,9 @@ void jedz_na_trasie(void) {
         return;
     }
     
-    int czasy_tras[] = {CZAS_TRASY_T1, CZAS_TRASY_T2, CZAS_TRASY_T3};
     const char *nazwy_tras[] = {"T1 (łatwa)", "T2 (średnia)", "T3 (trudna)"};
     int wybor = rand() % 3;
-    int czas_trasy = czasy_tras[wybor];
+    int czas_trasy = turysta_zasoby.shm.stan->konfiguracja.czas_trasy[wybor];
     
     ja.status = STATUS_NA_TRASIE;
     LOG_I("TURYSTA #%d (rowerzysta): Wybieram trasę %s (czas: %ds)", 
@@ -391,13 +419,14 @@ void jedz_na_trasie(void) {
 int main(int argc, char *argv[]) {
     /* Parsuj argumenty */
     if (argc < 4) {
-        fprintf(stderr, "Użycie: %s <id> <wiek> <opiekun_id>\n", argv[0]);
+        fprintf(stderr, "Użycie: %s <id> <wiek> <opiekun_id> [liczba_dzieci]\n", argv[0]);
         return 1;
     }
     
     int id = atoi(argv[1]);
     int wiek = atoi(argv[2]);
     int opiekun = atoi(argv[3]);
+    int dzieci = (argc > 4) ? atoi(argv[4]) : 0;
     
     /* Walidacja */
     if (id <= 0 || id > 10000) {
@@ -418,9 +447,11 @@ int main(int argc, char *argv[]) {
     }
     
     /* Wszyscy turysci piszą do wspólnego pliku */
-    logger_init("logs/wszyscy_turysci.log");
+    char sciezka_logu[256];
+    logger_init_segmenty(instancja_log("wszyscy_turysci.log", sciezka_logu, sizeof(sciezka_logu)));
     
     inicjalizuj_turystę(id, wiek, opiekun);
+    ja.liczba_dzieci = dzieci;
     
     LOG_I("TURYSTA #%d: Przychodzę (wiek: %d, %s, %s)", 
           ja.id, ja.wiek, 
@@ -428,13 +459,14 @@ int main(int argc, char *argv[]) {
           ja.vip ? "VIP" : "zwykły");
     
     StanWspoldzielony *stan = turysta_zasoby.shm.stan;
-    int sem_id = turysta_zasoby.sem.sem_id;
     
     /* Główna pętla */
-    while (turysta_dzialaj && stan->kolej_aktywna) {
+    while (turysta_dzialaj && STAN_CZYTAJ(stan, kolej_aktywna)) {
+        poczatek_zjazdu_us = czas_monotoniczny_us();
+        
         /* Kup bilet jeśli nie masz ważnego */
         if (!sprawdz_waznosc_biletu()) {
-            if (!stan->godziny_pracy || !turysta_dzialaj) {
+            if (!STAN_CZYTAJ(stan, godziny_pracy) || !turysta_dzialaj) {
                 LOG_I("TURYSTA #%d: Kolej zamknięta, wychodzę", ja.id);
                 break;
             }
@@ -447,6 +479,9 @@ int main(int argc, char *argv[]) {
         
         if (!turysta_dzialaj) break;
         
+        /* Linia tego zjazdu - zwalniane niżej semafory są semaforami tej linii */
+        ja.linia = wybierz_linie();
+        
         /* Przejdź przez bramkę wejściową */
         if (przejdz_bramke_wejsciowa() == -1) {
             break;
@@ -455,36 +490,36 @@ int main(int argc, char *argv[]) {
         if (!turysta_dzialaj) {
             /* Zwolnij miejsce jeśli już weszliśmy na stację */
             if (ja.status == STATUS_NA_STACJI_DOLNEJ) {
-                sem_sygnalizuj_sysv(sem_id, SEM_IDX_STACJA_DOLNA);
+                zwolnij_miejsce_na_stacji();
             }
             break;
         }
         
         /* Czekaj na wejście na peron */
         if (czekaj_na_peron() == -1) {
-            sem_sygnalizuj_sysv(sem_id, SEM_IDX_STACJA_DOLNA);
+            zwolnij_miejsce_na_stacji();
             break;
         }
         
         if (!turysta_dzialaj) {
-            sem_sygnalizuj_sysv(sem_id, SEM_IDX_STACJA_DOLNA);
+            zwolnij_miejsce_na_stacji();
             break;
         }
         
         /* Wsiądź na krzesełko */
         int krzeselko = wsiadz_na_krzeselko();
         if (krzeselko == -1) {
-            sem_sygnalizuj_sysv(sem_id, SEM_IDX_STACJA_DOLNA);
+            zwolnij_miejsce_na_stacji();
             break;
         }
         
         if (!turysta_dzialaj) {
-            sem_sygnalizuj_sysv(sem_id, SEM_IDX_STACJA_DOLNA);
+            zwolnij_miejsce_na_stacji();
             break;
         }
         
-        /* Symulacja jazdy na górę - BLOKUJĄCE czekanie 2 sekundy */
-        for (int i = 0; i < 2 && turysta_dzialaj; i++) {
+        /* Symulacja jazdy na górę - BLOKUJĄCE czekanie CZAS_JAZDY_KRZESELKA s */
+        for (int i = 0; i < CZAS_JAZDY_KRZESELKA && turysta_dzialaj; i++) {
             /* select() blokuje proces na 1 sekundę */
             struct timeval tv;
             tv.tv_sec = 1;
@@ -493,7 +528,7 @@ int main(int argc, char *argv[]) {
         }
         
         if (!turysta_dzialaj) {
-            sem_sygnalizuj_sysv(sem_id, SEM_IDX_STACJA_DOLNA);
+            zwolnij_miejsce_na_stacji();
             break;
         }
         
@@ -509,7 +544,7 @@ int main(int argc, char *argv[]) {
         jedz_na_trasie();
         
         /* Zwolnij miejsce na stacji */
-        sem_sygnalizuj_sysv(sem_id, SEM_IDX_STACJA_DOLNA);
+        zwolnij_miejsce_na_stacji();
         
         if (!turysta_dzialaj) break;
         
@@ -520,13 +555,13 @@ int main(int argc, char *argv[]) {
         }
         
         /* 30% szans na zakończenie */
-        if (rand() % 100 < 30) {
+        if (rand() % 100 < PROCENT_KONCA_DNIA) {
             LOG_I("TURYSTA #%d: Wystarczy na dziś, wychodzę", ja.id);
             break;
         }
         
         /* Sprawdź godziny pracy */
-        if (!stan->godziny_pracy) {
+        if (!STAN_CZYTAJ(stan, godziny_pracy)) {
             LOG_I("TURYSTA #%d: Kolej się zamyka, wychodzę", ja.id);
             break;
         }
@@ -0,0 +1,420 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#include "zapis_io.h"
+
+/* ========== WYWOŁANIA SYSTEMOWE io_uring (bez liburing) ========== */
+static int sys_io_uring_setup(unsigned wpisy, struct io_uring_params *p) {
+    return (int)syscall(__NR_io_uring_setup, wpisy, p);
+}
+
+static int sys_io_uring_enter(int fd, unsigned do_wyslania, unsigned min_zakonczen,
+                              unsigned flagi) {
+    return (int)syscall(__NR_io_uring_enter, fd, do_wyslania, min_zakonczen,
+                        flagi, NULL, 0);
+}
+
+/* ========== TRYB SYNCHRONICZNY ========== */
+static void przelacz_na_synchroniczny(KontekstIO *io) {
+    io->fd_ring = -1;
+    io->do_wyslania = 0;
+    io->w_locie = 0;
+    free(io->operacje);
+    free(io->wolne);
+    io->operacje = NULL;
+    io->wolne = NULL;
+    io->liczba_wolnych = 0;
+}
+
+static bool io_uring_wylaczony_w_srodowisku(void) {
+    const char *env = getenv("KOLEJ_IO_URING");
+    return env != NULL && strcmp(env, "0") == 0;
+}
+
+/* ========== INICJALIZACJA - io_uring_setup() + mmap() ========== */
+int io_inicjalizuj(KontekstIO *io, unsigned glebokosc, ZakonczenieIO po_zakonczeniu) {
+    memset(io, 0, sizeof(KontekstIO));
+    io->po_zakonczeniu = po_zakonczeniu;
+    przelacz_na_synchroniczny(io);
+
+    if (io_uring_wylaczony_w_srodowisku()) {
+        return -1;
+    }
+
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    int fd = sys_io_uring_setup(glebokosc, &p);
+    if (fd == -1) {
+        /* Jądro bez io_uring lub zablokowane (seccomp) - zostajemy przy write() */
+        return -1;
+    }
+
+    io->rozmiar_sq = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    io->rozmiar_cq = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        if (io->rozmiar_cq > io->rozmiar_sq) io->rozmiar_sq = io->rozmiar_cq;
+        io->rozmiar_cq = io->rozmiar_sq;
+    }
+
+    io->mapa_sq = mmap(NULL, io->rozmiar_sq, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (io->mapa_sq == MAP_FAILED) {
+        close(fd);
+        return -1;
+    }
+
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        io->mapa_cq = io->mapa_sq;
+    } else {
+        io->mapa_cq = mmap(NULL, io->rozmiar_cq, PROT_READ | PROT_WRITE,
+                           MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (io->mapa_cq == MAP_FAILED) {
+            munmap(io->mapa_sq, io->rozmiar_sq);
+            close(fd);
+            return -1;
+        }
+    }
+
+    io->rozmiar_sqe = p.sq_entries * sizeof(struct io_uring_sqe);
+    io->mapa_sqe = mmap(NULL, io->rozmiar_sqe, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (io->mapa_sqe == MAP_FAILED) {
+        if (io->mapa_cq != io->mapa_sq) munmap(io->mapa_cq, io->rozmiar_cq);
+        munmap(io->mapa_sq, io->rozmiar_sq);
+        close(fd);
+        return -1;
+    }
+
+    char *sq = io->mapa_sq;
+    char *cq = io->mapa_cq;
+    io->sq_glowa = (unsigned *)(sq + p.sq_off.head);
+    io->sq_ogon = (unsigned *)(sq + p.sq_off.tail);
+    io->sq_maska = (unsigned *)(sq + p.sq_off.ring_mask);
+    io->sq_tablica = (unsigned *)(sq + p.sq_off.array);
+    io->sqe = io->mapa_sqe;
+
+    io->cq_glowa = (unsigned *)(cq + p.cq_off.head);
+    io->cq_ogon = (unsigned *)(cq + p.cq_off.tail);
+    io->cq_maska = (unsigned *)(cq + p.cq_off.ring_mask);
+    io->cqe = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+
+    /* W locie najwyżej glebokosc operacji (pobierz_sqe) */
+    io->operacje = calloc(p.sq_entries, sizeof(OperacjaIO));
+    io->wolne = malloc(p.sq_entries * sizeof(unsigned));
+    if (io->operacje == NULL || io->wolne == NULL) {
+        free(io->operacje);
+        free(io->wolne);
+        io->operacje = NULL;
+        io->wolne = NULL;
+        munmap(io->mapa_sqe, io->rozmiar_sqe);
+        if (io->mapa_cq != io->mapa_sq) munmap(io->mapa_cq, io->rozmiar_cq);
+        munmap(io->mapa_sq, io->rozmiar_sq);
+        close(fd);
+        return -1;
+    }
+    for (unsigned i = 0; i < p.sq_entries; i++) {
+        io->wolne[i] = p.sq_entries - 1 - i;
+    }
+    io->liczba_wolnych = p.sq_entries;
+    io->fd_fsync = -1;
+
+    io->glebokosc = p.sq_entries;
+    io->fd_ring = fd;
+    return 0;
+}
+
+bool io_uring_aktywny(const KontekstIO *io) {
+    return io->fd_ring != -1;
+}
+
+static void zatwierdz_sqe(KontekstIO *io) {
+    unsigned ogon = *io->sq_ogon;
+    io->sq_tablica[ogon & *io->sq_maska] = ogon & *io->sq_maska;
+    __atomic_store_n(io->sq_ogon, ogon + 1, __ATOMIC_RELEASE);
+    io->do_wyslania++;
+}
+
+/* ========== SQE ZAPISU BUFORA OD MIEJSCA PRZERWANIA ========== */
+static void wypelnij_zapis(struct io_uring_sqe *s, const OperacjaIO *op, unsigned indeks) {
+    s->opcode = IORING_OP_WRITE;
+    s->fd = op->fd;
+    s->addr = (unsigned long)(op->bufor + op->zapisano);
+    s->len = (unsigned)(op->dlugosc - op->zapisano);
+    s->off = (op->offset < 0) ? (__u64)-1 : (__u64)(op->offset + (off_t)op->zapisano);
+    s->user_data = indeks;
+}
+
+/* Krótki zapis bufora: wysyła SQE na resztę i zwraca true (operacja nadal
+ * w locie). Inaczej ustala *wynik - łączną liczbę bajtów lub -errno. */
+static bool dokoncz_krotki_zapis(KontekstIO *io, OperacjaIO *op, unsigned indeks,
+                                 int res, int *wynik) {
+    *wynik = res;
+    if (res < 0 || op->rodzaj == IORING_OP_FSYNC) {
+        return false;
+    }
+
+    op->zapisano += (size_t)res;
+    *wynik = (int)op->zapisano;
+    if (op->zapisano >= op->dlugosc) {
+        return false;
+    }
+
+    if (op->rodzaj == IORING_OP_WRITEV) {
+        /* Wektor należy do wywołującego - dokończy go sam od tego miejsca */
+        if (io->pierwszy_blad == 0) io->pierwszy_blad = -EIO;
+        return false;
+    }
+    if (res == 0) {
+        *wynik = -EIO;          /* Brak postępu - nie zapętlaj */
+        return false;
+    }
+
+    /* Zakończenie zwolniło miejsce w locie, więc SQE jest dostępne od razu */
+    struct io_uring_sqe *s = &io->sqe[*io->sq_ogon & *io->sq_maska];
+    memset(s, 0, sizeof(*s));
+    wypelnij_zapis(s, op, indeks);
+    zatwierdz_sqe(io);
+    io->dokonczono = true;
+    return true;
+}
+
+/* ========== ZBIERANIE ZAKOŃCZEŃ Z CQ ========== */
+static int zbierz_zakonczenia(KontekstIO *io) {
+    unsigned glowa = *io->cq_glowa;
+    unsigned ogon = __atomic_load_n(io->cq_ogon, __ATOMIC_ACQUIRE);
+    int zebrane = 0;
+
+    while (glowa != ogon) {
+        struct io_uring_cqe *c = &io->cqe[glowa & *io->cq_maska];
+        unsigned indeks = (unsigned)c->user_data;
+        OperacjaIO *op = &io->operacje[indeks];
+        glowa++;
+        io->w_locie--;
+
+        int wynik;
+        if (dokoncz_krotki_zapis(io, op, indeks, c->res, &wynik)) {
+            continue;
+        }
+        if (wynik < 0 && io->pierwszy_blad == 0) {
+            io->pierwszy_blad = wynik;
+        }
+        if (io->po_zakonczeniu) {
+            io->po_zakonczeniu(op->dane, wynik);
+        }
+        io->wolne[io->liczba_wolnych++] = indeks;
+        zebrane++;
+    }
+
+    __atomic_store_n(io->cq_glowa, glowa, __ATOMIC_RELEASE);
+    return zebrane;
+}
+
+/* ========== WYSŁANIE PARTII - io_uring_enter() ========== */
+static int wejdz(KontekstIO *io, unsigned min_zakonczen) {
+    unsigned do_wyslania = io->do_wyslania;
+    unsigned flagi = (min_zakonczen > 0) ? IORING_ENTER_GETEVENTS : 0;
+
+    while (1) {
+        io->liczba_wywolan++;
+        int wynik = sys_io_uring_enter(io->fd_ring, do_wyslania, min_zakonczen, flagi);
+        if (wynik >= 0) {
+            io->do_wyslania -= (unsigned)wynik;
+            io->w_locie += (unsigned)wynik;
+            return 0;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        perror("io_uring_enter");
+        return -1;
+    }
+}
+
+/* ========== POBRANIE WOLNEGO SQE ========== */
+/* Przy pełnej kolejce wysyła partię i czeka na przynajmniej jedno zakończenie */
+/* Pod *indeks zapisuje wolny wpis operacje[] dla tego SQE */
+static struct io_uring_sqe *pobierz_sqe(KontekstIO *io, unsigned *indeks) {
+    while (*io->sq_ogon - __atomic_load_n(io->sq_glowa, __ATOMIC_ACQUIRE) >= io->glebokosc ||
+           io->w_locie + io->do_wyslania >= io->glebokosc || io->liczba_wolnych == 0) {
+        if (wejdz(io, 1) == -1) return NULL;
+        zbierz_zakonczenia(io);
+    }
+
+    /* Zebranie mogło wysłać dokończenia krótkich zapisów - ogon dopiero teraz */
+    struct io_uring_sqe *s = &io->sqe[*io->sq_ogon & *io->sq_maska];
+    memset(s, 0, sizeof(*s));
+    *indeks = io->wolne[--io->liczba_wolnych];
+    return s;
+}
+
+/* Tryb synchroniczny: zakończenie zgłaszamy od razu */
+static int zakoncz_synchronicznie(KontekstIO *io, ssize_t wynik, void *dane) {
+    io->liczba_wywolan++;
+    int kod = (wynik < 0) ? -errno : (int)wynik;
+    if (kod < 0 && io->pierwszy_blad == 0) {
+        io->pierwszy_blad = kod;
+    }
+    if (io->po_zakonczeniu) {
+        io->po_zakonczeniu(dane, kod);
+    }
+    return (kod < 0) ? -1 : 0;
+}
+
+/* ========== ZAPIS BUFORA ========== */
+int io_dodaj_zapis(KontekstIO *io, int fd, const void *bufor, size_t dlugosc,
+                   off_t offset, void *dane) {
+    if (!io_uring_aktywny(io)) {
+        /* Krótki zapis - pętla od miejsca przerwania */
+        const char *p = bufor;
+        size_t zapisano = 0;
+        while (zapisano < dlugosc) {
+            ssize_t n = (offset < 0) ? write(fd, p + zapisano, dlugosc - zapisano)
+                                     : pwrite(fd, p + zapisano, dlugosc - zapisano,
+                                              offset + (off_t)zapisano);
+            if (n == -1 && errno == EINTR) continue;
+            if (n == 0) errno = EIO;
+            if (n <= 0) return zakoncz_synchronicznie(io, -1, dane);
+            zapisano += (size_t)n;
+        }
+        return zakoncz_synchronicznie(io, (ssize_t)zapisano, dane);
+    }
+
+    unsigned indeks;
+    struct io_uring_sqe *s = pobierz_sqe(io, &indeks);
+    if (s == NULL) return -1;
+    io->operacje[indeks] = (OperacjaIO){
+        .rodzaj = IORING_OP_WRITE, .fd = fd, .bufor = bufor,
+        .dlugosc = dlugosc, .offset = offset, .dane = dane
+    };
+    wypelnij_zapis(s, &io->operacje[indeks], indeks);
+    zatwierdz_sqe(io);
+    return 0;
+}
+
+/* ========== ZAPIS WEKTOROWY ========== */
+int io_dodaj_zapis_wektor(KontekstIO *io, int fd, const struct iovec *iov,
+                          int liczba, void *dane) {
+    size_t lacznie = 0;
+    for (int i = 0; i < liczba; i++) lacznie += iov[i].iov_len;
+
+    if (!io_uring_aktywny(io)) {
+        ssize_t wynik = writev(fd, iov, liczba);
+        if (wynik >= 0 && (size_t)wynik < lacznie) {
+            /* Jak przy io_uring: liczba bajtów dla wywołującego, błąd partii */
+            zakoncz_synchronicznie(io, wynik, dane);
+            if (io->pierwszy_blad == 0) io->pierwszy_blad = -EIO;
+            return -1;
+        }
+        return zakoncz_synchronicznie(io, wynik, dane);
+    }
+
+    unsigned indeks;
+    struct io_uring_sqe *s = pobierz_sqe(io, &indeks);
+    if (s == NULL) return -1;
+    io->operacje[indeks] = (OperacjaIO){
+        .rodzaj = IORING_OP_WRITEV, .fd = fd, .dlugosc = lacznie,
+        .offset = -1, .dane = dane
+    };
+    s->opcode = IORING_OP_WRITEV;
+    s->fd = fd;
+    s->addr = (unsigned long)iov;
+    s->len = (unsigned)liczba;
+    s->off = (__u64)-1;
+    s->user_data = indeks;
+    zatwierdz_sqe(io);
+    return 0;
+}
+
+/* ========== FSYNC PO WCZEŚNIEJSZYCH ZAPISACH ========== */
+/* IOSQE_IO_DRAIN - wykonaj dopiero po zakończeniu wszystkich poprzednich SQE */
+int io_dodaj_fsync(KontekstIO *io, int fd, bool tylko_dane, void *dane) {
+    if (!io_uring_aktywny(io)) {
+        return zakoncz_synchronicznie(io, tylko_dane ? fdatasync(fd) : fsync(fd), dane);
+    }
+
+    unsigned indeks;
+    struct io_uring_sqe *s = pobierz_sqe(io, &indeks);
+    if (s == NULL) return -1;
+    io->operacje[indeks] = (OperacjaIO){
+        .rodzaj = IORING_OP_FSYNC, .fd = fd, .offset = -1, .dane = dane
+    };
+    s->opcode = IORING_OP_FSYNC;
+    s->fd = fd;
+    s->flags = IOSQE_IO_DRAIN;
+    s->fsync_flags = tylko_dane ? IORING_FSYNC_DATASYNC : 0;
+    s->user_data = indeks;
+    zatwierdz_sqe(io);
+    io->fd_fsync = fd;
+    io->fsync_tylko_dane = tylko_dane;
+    return 0;
+}
+
+/* Błąd zgłaszany jest raz - kolejne partie zaczynają z czystym stanem */
+static int pobierz_i_wyczysc_blad(KontekstIO *io) {
+    int blad = io->pierwszy_blad;
+    io->pierwszy_blad = 0;
+    if (blad < 0) {
+        errno = -blad;
+        return -1;
+    }
+    return 0;
+}
+
+/* ========== WYSŁANIE BEZ CZEKANIA ========== */
+int io_wyslij(KontekstIO *io) {
+    if (!io_uring_aktywny(io) || io->do_wyslania == 0) return 0;
+    return wejdz(io, 0);
+}
+
+/* ========== NIEBLOKUJĄCE ZEBRANIE ZAKOŃCZEŃ ========== */
+/* Zwraca liczbę operacji nadal w locie */
+int io_zbierz(KontekstIO *io) {
+    if (!io_uring_aktywny(io)) return 0;
+    zbierz_zakonczenia(io);
+    return (int)io->w_locie;
+}
+
+/* ========== WYŚLIJ I CZEKAJ NA WSZYSTKIE ========== */
+int io_czekaj_wszystkie(KontekstIO *io) {
+    if (!io_uring_aktywny(io)) {
+        return pobierz_i_wyczysc_blad(io);
+    }
+
+    while (io->do_wyslania > 0 || io->w_locie > 0) {
+        zbierz_zakonczenia(io);
+        if (io->do_wyslania == 0 && io->w_locie == 0) break;
+        if (wejdz(io, 1) == -1) return -1;
+    }
+    zbierz_zakonczenia(io);
+
+    /* Dokończenie krótkiego zapisu mogło trafić za fsync partii (IO_DRAIN
+     * czeka tylko na wcześniejsze SQE) - powtórz fsync synchronicznie */
+    if (io->dokonczono && io->fd_fsync != -1 &&
+        (io->fsync_tylko_dane ? fdatasync(io->fd_fsync) : fsync(io->fd_fsync)) == -1 &&
+        io->pierwszy_blad == 0) {
+        io->pierwszy_blad = -errno;
+    }
+    io->dokonczono = false;
+    io->fd_fsync = -1;
+
+    return pobierz_i_wyczysc_blad(io);
+}
+
+/* ========== ZAMKNIĘCIE ========== */
+void io_zamknij(KontekstIO *io) {
+    if (!io_uring_aktywny(io)) return;
+
+    io_czekaj_wszystkie(io);
+
+    munmap(io->mapa_sqe, io->rozmiar_sqe);
+    if (io->mapa_cq != io->mapa_sq) munmap(io->mapa_cq, io->rozmiar_cq);
+    munmap(io->mapa_sq, io->rozmiar_sq);
+    close(io->fd_ring);
+    przelacz_na_synchroniczny(io);
+}